@@ -5,45 +5,53 @@
 
 
 
-CollisionTriangle::CollisionTriangle(const glm::vec3& pos0, const glm::vec3& pos1, const glm::vec3& pos2, const glm::vec3& _normal) {
-	m_positions[0] = pos0;
-	m_positions[1] = pos1;
-	m_positions[2] = pos2;
-	normal = _normal;
+CollisionShape CollisionShape::CreateTriangle(const glm::vec3& pos0, const glm::vec3& pos1, const glm::vec3& pos2, const glm::vec3& _normal) {
+	CollisionShape shape;
+	shape.m_type = Type::TRIANGLE;
+	shape.m_positions[0] = pos0;
+	shape.m_positions[1] = pos1;
+	shape.m_positions[2] = pos2;
+	shape.m_normal = _normal;
+	return shape;
 }
 
-glm::vec3 CollisionTriangle::getIntersectionPosition(const BoundingBox* boundingBox) {
-	// Calculate the plane that the triangle is on
-	glm::vec3 triangleToWorldOrigo = glm::vec3(0.0f) - m_positions[0];
-	float distance = -glm::dot(triangleToWorldOrigo, normal);
-	return Intersection::PointProjectedOnPlane(boundingBox->getPosition(), normal, distance);
+CollisionShape CollisionShape::CreateAABB(const glm::vec3& position, const glm::vec3& halfSize, const glm::vec3& _normal) {
+	CollisionShape shape;
+	shape.m_type = Type::AABB;
+	shape.m_positions[0] = position;
+	shape.m_positions[1] = halfSize;
+	shape.m_normal = _normal;
+	return shape;
 }
 
-bool CollisionTriangle::getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth) {
-	if (Intersection::AabbWithTriangle(boundingBox->getPosition(), boundingBox->getHalfSize(), m_positions[0], m_positions[1], m_positions[2], axis, depth)) {
-		return true;
+glm::vec3 CollisionShape::getIntersectionPosition(const BoundingBox* boundingBox) const {
+	switch (m_type) {
+	case Type::TRIANGLE:
+	{
+		// Calculate the plane that the triangle is on
+		glm::vec3 triangleToWorldOrigo = glm::vec3(0.0f) - m_positions[0];
+		float distance = -glm::dot(triangleToWorldOrigo, m_normal);
+		return Intersection::PointProjectedOnPlane(boundingBox->getPosition(), m_normal, distance);
+	}
+	case Type::AABB:
+	{
+		// Calculate the plane of bounding box
+		glm::vec3 planePositionToWorldOrigo = glm::vec3(0.0f) - (m_positions[0] + m_positions[1] * m_normal);
+		float distance = -glm::dot(planePositionToWorldOrigo, m_normal);
+		return Intersection::PointProjectedOnPlane(boundingBox->getPosition(), m_normal, distance);
+	}
+	default:
+		return boundingBox->getPosition();
 	}
-	return false;
-}
-
-
-
-CollisionAABB::CollisionAABB(const glm::vec3& position, const glm::vec3& halfSize, const glm::vec3& _normal) {
-	m_position = position;
-	m_halfSize = halfSize;
-	normal = _normal;
-}
-
-glm::vec3 CollisionAABB::getIntersectionPosition(const BoundingBox* boundingBox) {
-	// Calculate the plane of bounding box
-	glm::vec3 planePositionToWorldOrigo = glm::vec3(0.0f) - (m_position + m_halfSize * normal);
-	float distance = -glm::dot(planePositionToWorldOrigo, normal);
-	return Intersection::PointProjectedOnPlane(boundingBox->getPosition(), normal, distance);
 }
 
-bool CollisionAABB::getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth) {
-	if (Intersection::AabbWithAabb(boundingBox->getPosition(), boundingBox->getHalfSize(), m_position, m_halfSize, axis, depth)) {
-		return true;
+bool CollisionShape::getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth) const {
+	switch (m_type) {
+	case Type::TRIANGLE:
+		return Intersection::AabbWithTriangle(boundingBox->getPosition(), boundingBox->getHalfSize(), m_positions[0], m_positions[1], m_positions[2], axis, depth);
+	case Type::AABB:
+		return Intersection::AabbWithAabb(boundingBox->getPosition(), boundingBox->getHalfSize(), m_positions[0], m_positions[1], axis, depth);
+	default:
+		return false;
 	}
-	return false;
-}
\ No newline at end of file
+}
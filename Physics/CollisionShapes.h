@@ -2,44 +2,36 @@
 
 class BoundingBox;
 
+/*
+	Shape that an entity collided with, stored by value so that query results don't need any heap allocations.
+	Either a triangle or an axis aligned box, create them with CreateTriangle() or CreateAABB().
+*/
 class CollisionShape {
 public:
-	CollisionShape() : normal(glm::vec3(0.0f)) {};
-	virtual ~CollisionShape() {};
+	enum class Type : unsigned char {
+		NONE,
+		TRIANGLE,
+		AABB
+	};
 
-	virtual glm::vec3 getIntersectionPosition(const BoundingBox* boundingBox) = 0;
-	virtual bool getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth) = 0;
-
-	virtual glm::vec3 getNormal() { return normal; };
-
-	int keeperTracker = 1;
-
-protected:
-	glm::vec3 normal;
-};
+public:
+	CollisionShape() : m_type(Type::NONE), m_normal(glm::vec3(0.0f)) {};
+	~CollisionShape() {};
 
+	static CollisionShape CreateTriangle(const glm::vec3& pos0, const glm::vec3& pos1, const glm::vec3& pos2, const glm::vec3& _normal);
+	static CollisionShape CreateAABB(const glm::vec3& position, const glm::vec3& halfSize, const glm::vec3& _normal);
 
-class CollisionTriangle : public CollisionShape {
-public:
-	CollisionTriangle(const glm::vec3& pos0, const glm::vec3& pos1, const glm::vec3& pos2, const glm::vec3& _normal);
-	~CollisionTriangle() {};
+	glm::vec3 getIntersectionPosition(const BoundingBox* boundingBox) const;
+	bool getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth) const;
 
-	glm::vec3 getIntersectionPosition(const BoundingBox* boundingBox);
-	bool getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth);
+	const glm::vec3& getNormal() const { return m_normal; };
+	Type getType() const { return m_type; };
 
 private:
+	Type m_type;
+
+	// Triangle: the three corners
+	// AABB: position and half size in the first two
 	glm::vec3 m_positions[3];
+	glm::vec3 m_normal;
 };
-
-class CollisionAABB : public CollisionShape {
-public:
-	CollisionAABB(const glm::vec3& position, const glm::vec3& halfSize, const glm::vec3& _normal);
-	~CollisionAABB() {};
-
-	glm::vec3 getIntersectionPosition(const BoundingBox* boundingBox);
-	bool getIntersectionDepthAndAxis(const BoundingBox* boundingBox, glm::vec3* axis, float* depth);
-
-private:
-	glm::vec3 m_position;
-	glm::vec3 m_halfSize;
-};
\ No newline at end of file
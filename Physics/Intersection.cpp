@@ -1,9 +1,54 @@
 #include "PhysicsPCH.h"
 #include <algorithm>
+#include <atomic>
 
 #include "Intersection.h"
+#include "IntersectionKernels.h"
 #include "Sail/graphics/camera/Camera.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+	bool CpuSupportsAvx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+		__cpuid(info, 1);
+		const bool osUsesXsave = (info[2] & (1 << 27)) != 0;
+		const bool hasAvx = (info[2] & (1 << 28)) != 0;
+		// The OS also has to save the upper halves of the registers on context switches
+		if (!osUsesXsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	}
+
+	Intersection::SimdLevel FindMaxSimdLevel() {
+		if (CpuSupportsAvx2() && Intersection::HasAvx2Kernels()) {
+			return Intersection::SimdLevel::AVX2;
+		}
+#ifdef SAIL_SIMD_SSE2
+		return Intersection::SimdLevel::SSE;
+#else
+		return Intersection::SimdLevel::SCALAR;
+#endif
+	}
+
+	const Intersection::SimdLevel MAX_SIMD_LEVEL = FindMaxSimdLevel();
+	std::atomic<Intersection::SimdLevel> s_simdLevel(MAX_SIMD_LEVEL);
+}
+
 bool Intersection::AabbWithAabb(const glm::vec3& aabb1Pos, const glm::vec3& aabb1HalfSize, const glm::vec3& aabb2Pos, const glm::vec3& aabb2HalfSize) {
 	if (glm::abs(aabb1Pos.x - aabb2Pos.x) > (aabb1HalfSize.x + aabb2HalfSize.x)) {
 		return false;
@@ -814,3 +859,75 @@ bool Intersection::SATTest(const glm::vec3& testAxis, const glm::vec3& triPos1,
 	}
 	return true;
 }
+
+void Intersection::RayWithPaddedTriangles(const glm::vec3& rayStart, const glm::vec3& rayDir, const TrianglePacket& triangles, float padding, float outDistances[TrianglePacket::WIDTH], const bool checkBackfaces) {
+	switch (s_simdLevel.load(std::memory_order_relaxed)) {
+	case SimdLevel::AVX2:
+		RayWithPaddedTrianglesAVX2(glm::value_ptr(rayStart), glm::value_ptr(rayDir), triangles, padding, checkBackfaces, outDistances);
+		break;
+#ifdef SAIL_SIMD_SSE2
+	case SimdLevel::SSE:
+		for (unsigned int lane = 0; lane < triangles.count; lane += Simd::Float4::WIDTH) {
+			IntersectionKernels::RayWithPaddedTriangles<Simd::Float4>(glm::value_ptr(rayStart), glm::value_ptr(rayDir), triangles, lane, padding, checkBackfaces, outDistances);
+		}
+		break;
+#endif
+	default:
+		for (unsigned int lane = 0; lane < triangles.count; lane++) {
+			outDistances[lane] = RayWithPaddedTriangle(rayStart, rayDir, triangles.getVertex(lane, 0), triangles.getVertex(lane, 1), triangles.getVertex(lane, 2), padding, checkBackfaces);
+		}
+		break;
+	}
+
+	for (unsigned int lane = triangles.count; lane < TrianglePacket::WIDTH; lane++) {
+		outDistances[lane] = -1.0f;
+	}
+}
+
+unsigned int Intersection::AabbWithTriangles(const glm::vec3& aabbPos, const glm::vec3& aabbHalfSize, const TrianglePacket& triangles, const bool checkBackfaces) {
+	unsigned int mask = 0;
+	switch (s_simdLevel.load(std::memory_order_relaxed)) {
+	case SimdLevel::AVX2:
+		mask = AabbWithTrianglesAVX2(glm::value_ptr(aabbPos), glm::value_ptr(aabbHalfSize), triangles, checkBackfaces);
+		break;
+#ifdef SAIL_SIMD_SSE2
+	case SimdLevel::SSE:
+		for (unsigned int lane = 0; lane < triangles.count; lane += Simd::Float4::WIDTH) {
+			mask |= IntersectionKernels::AabbWithTriangles<Simd::Float4>(glm::value_ptr(aabbPos), glm::value_ptr(aabbHalfSize), triangles, lane, checkBackfaces) << lane;
+		}
+		break;
+#endif
+	default:
+		for (unsigned int lane = 0; lane < triangles.count; lane++) {
+			if (AabbWithTriangle(aabbPos, aabbHalfSize, triangles.getVertex(lane, 0), triangles.getVertex(lane, 1), triangles.getVertex(lane, 2), checkBackfaces)) {
+				mask |= 1u << lane;
+			}
+		}
+		break;
+	}
+
+	return mask & ((1u << triangles.count) - 1u);
+}
+
+void Intersection::SetSimdLevel(SimdLevel level) {
+	s_simdLevel.store(std::min(level, MAX_SIMD_LEVEL), std::memory_order_relaxed);
+}
+
+Intersection::SimdLevel Intersection::GetSimdLevel() {
+	return s_simdLevel.load(std::memory_order_relaxed);
+}
+
+Intersection::SimdLevel Intersection::GetMaxSimdLevel() {
+	return MAX_SIMD_LEVEL;
+}
+
+const char* Intersection::GetSimdLevelName(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::SSE:
+		return "SSE";
+	case SimdLevel::AVX2:
+		return "AVX2";
+	default:
+		return "scalar";
+	}
+}
@@ -3,10 +3,17 @@
 #include "BoundingBox.h"
 #include "Cylinder.h"
 #include "Sphere.h"
+#include "TrianglePacket.h"
 #include "Sail/graphics/camera/Frustum.h"
 
 class Intersection {
 public:
+	enum class SimdLevel {
+		SCALAR,
+		SSE,
+		AVX2
+	};
+
 	static bool AabbWithAabb(const glm::vec3& aabb1Pos, const glm::vec3& aabb1HalfSize, const glm::vec3& aabb2Pos, const glm::vec3& aabb2HalfSize);
 	static bool AabbWithAabb(const glm::vec3& aabb1Pos, const glm::vec3& aabb1HalfSize, const glm::vec3& aabb2Pos, const glm::vec3& aabb2HalfSize, glm::vec3* intersectionAxis, float* intersectionDepth);
 	static bool AabbWithTriangle(const glm::vec3& aabbPos, const glm::vec3& aabbHalfSize, const glm::vec3& triPos1, const glm::vec3& triPos2, const glm::vec3& triPos3, const bool checkBackfaces = false);
@@ -31,6 +38,25 @@ public:
 	static float RayWithPaddedAabb(const glm::vec3& rayStart, const glm::vec3& rayVec, const glm::vec3& aabbPos, const glm::vec3& aabbHalfSize, float padding, glm::vec3* intersectionAxis = nullptr);
 	static float RayWithPaddedTriangle(const glm::vec3& rayStart, const glm::vec3& rayDir, const glm::vec3& triPos1, const glm::vec3& triPos2, const glm::vec3& triPos3, float padding, const bool checkBackfaces = false);
 
+	/*
+		Batched versions of RayWithPaddedTriangle and AabbWithTriangle, giving the same results as calling them for every triangle in the packet
+		RayWithPaddedTriangles writes the distance to each triangle, or -1.0f for misses, to outDistances
+		AabbWithTriangles returns a mask with bit i set if the box intersects triangle i
+	*/
+	static void RayWithPaddedTriangles(const glm::vec3& rayStart, const glm::vec3& rayDir, const TrianglePacket& triangles, float padding, float outDistances[TrianglePacket::WIDTH], const bool checkBackfaces = false);
+	static unsigned int AabbWithTriangles(const glm::vec3& aabbPos, const glm::vec3& aabbHalfSize, const TrianglePacket& triangles, const bool checkBackfaces = false);
+
+	/*
+		The batched tests use the widest instruction set the CPU supports by default
+		Lower levels can be forced to compare them, higher levels than the CPU supports are clamped
+	*/
+	static void SetSimdLevel(SimdLevel level);
+	static SimdLevel GetSimdLevel();
+	static SimdLevel GetMaxSimdLevel();
+	static const char* GetSimdLevelName(SimdLevel level);
+	// False if IntersectionAVX2.cpp was built without AVX2 enabled
+	static bool HasAvx2Kernels();
+
 	static bool FrustumPlaneWithAabb(const glm::vec3& planeNormal, const float planeDistance, const glm::vec3* aabbCorners);
 	static bool FrustumWithAabb(const Frustum& frustum, const glm::vec3* aabbCorners);
 
@@ -44,5 +70,9 @@ private:
 	static void Barycentric(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& outU, float& outV, float& outW);
 	static bool OnTriangle(const float u, const float v, const float w);
 
+	// Implemented in IntersectionAVX2.cpp, only called if the CPU supports AVX2
+	static void RayWithPaddedTrianglesAVX2(const float rayStart[3], const float rayDir[3], const TrianglePacket& triangles, float padding, bool checkBackfaces, float* outDistances);
+	static unsigned int AabbWithTrianglesAVX2(const float aabbPos[3], const float aabbHalfSize[3], const TrianglePacket& triangles, bool checkBackfaces);
+
 	static bool SATTest(const glm::vec3& testAxis, const glm::vec3& triPos1, const glm::vec3& triPos2, const glm::vec3& triPos3, const glm::vec3& aabbHalfSize, glm::vec3* intersectionAxis, float* depth);
 };
@@ -0,0 +1,34 @@
+// Compiled with AVX2 enabled and without the precompiled header, see premake5.lua
+// Nothing in here may be called unless the CPU supports AVX2, Intersection checks that before using these
+#include "PhysicsPCH.h"
+
+#include "Intersection.h"
+#include "IntersectionKernels.h"
+
+#ifdef SAIL_SIMD_AVX2
+
+bool Intersection::HasAvx2Kernels() {
+	return true;
+}
+
+void Intersection::RayWithPaddedTrianglesAVX2(const float rayStart[3], const float rayDir[3], const TrianglePacket& triangles, float padding, bool checkBackfaces, float* outDistances) {
+	IntersectionKernels::RayWithPaddedTriangles<Simd::Float8>(rayStart, rayDir, triangles, 0, padding, checkBackfaces, outDistances);
+}
+
+unsigned int Intersection::AabbWithTrianglesAVX2(const float aabbPos[3], const float aabbHalfSize[3], const TrianglePacket& triangles, bool checkBackfaces) {
+	return IntersectionKernels::AabbWithTriangles<Simd::Float8>(aabbPos, aabbHalfSize, triangles, 0, checkBackfaces);
+}
+
+#else
+
+bool Intersection::HasAvx2Kernels() {
+	return false;
+}
+
+void Intersection::RayWithPaddedTrianglesAVX2(const float rayStart[3], const float rayDir[3], const TrianglePacket& triangles, float padding, bool checkBackfaces, float* outDistances) {}
+
+unsigned int Intersection::AabbWithTrianglesAVX2(const float aabbPos[3], const float aabbHalfSize[3], const TrianglePacket& triangles, bool checkBackfaces) {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "SimdFloat.h"
+#include "TrianglePacket.h"
+
+/*
+	Batched versions of Intersection::RayWithPaddedTriangle and Intersection::AabbWithTriangle, written once for every SIMD width.
+	F is one of the float types in SimdFloat.h, each call processes the lanes [laneOffset, laneOffset + F::WIDTH) of the packet.
+
+	The operations are done in the same order as in the scalar functions, so both give the same results.
+	These don't call into glm on purpose since IntersectionAVX2.cpp is compiled with different instruction set flags,
+	any inline function shared with the other translation units could end up with the AVX2 version linked in everywhere.
+	Only included by the translation units that instantiate them.
+*/
+namespace IntersectionKernels {
+
+	template<typename F>
+	struct Vec3 {
+		F x, y, z;
+	};
+
+	template<typename F>
+	inline Vec3<F> Set(const float v[3]) {
+		return { F::Set(v[0]), F::Set(v[1]), F::Set(v[2]) };
+	}
+
+	template<typename F>
+	inline Vec3<F> LoadVertex(const TrianglePacket& triangles, unsigned int vertex, unsigned int laneOffset) {
+		return { F::Load(&triangles.positions[vertex][0][laneOffset]), F::Load(&triangles.positions[vertex][1][laneOffset]), F::Load(&triangles.positions[vertex][2][laneOffset]) };
+	}
+
+	template<typename F>
+	inline Vec3<F> operator+(const Vec3<F>& a, const Vec3<F>& b) {
+		return { a.x + b.x, a.y + b.y, a.z + b.z };
+	}
+
+	template<typename F>
+	inline Vec3<F> operator-(const Vec3<F>& a, const Vec3<F>& b) {
+		return { a.x - b.x, a.y - b.y, a.z - b.z };
+	}
+
+	template<typename F>
+	inline Vec3<F> operator*(const Vec3<F>& a, const F& s) {
+		return { a.x * s, a.y * s, a.z * s };
+	}
+
+	template<typename F>
+	inline Vec3<F> operator/(const Vec3<F>& a, const F& s) {
+		return { a.x / s, a.y / s, a.z / s };
+	}
+
+	template<typename F>
+	inline F Dot(const Vec3<F>& a, const Vec3<F>& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	template<typename F>
+	inline Vec3<F> Cross(const Vec3<F>& a, const Vec3<F>& b) {
+		return { a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y };
+	}
+
+	// Same as glm::normalize, v * (1 / sqrt(dot(v, v)))
+	template<typename F>
+	inline Vec3<F> Normalize(const Vec3<F>& v) {
+		return v * (F::Set(1.0f) / F::Sqrt(Dot(v, v)));
+	}
+
+	template<typename F>
+	inline Vec3<F> Select(const F& mask, const Vec3<F>& ifTrue, const Vec3<F>& ifFalse) {
+		return { F::Select(mask, ifTrue.x, ifFalse.x), F::Select(mask, ifTrue.y, ifFalse.y), F::Select(mask, ifTrue.z, ifFalse.z) };
+	}
+
+	// Intersection::RayWithTriangle
+	template<typename F>
+	inline F RayWithTriangle(const Vec3<F>& rayStart, const Vec3<F>& rayDir, const Vec3<F>& a, const Vec3<F>& b, const Vec3<F>& c) {
+		const Vec3<F> edge1 = b - a;
+		const Vec3<F> edge2 = c - a;
+		const Vec3<F> planeNormal = Normalize(Cross(edge1, edge2));
+		const F originToPlaneDistance = Dot(a, planeNormal);
+
+		// Intersection::RayWithPlane
+		const F dirDotNormal = Dot(rayDir, planeNormal);
+		const F isParallelWithPlane = F::Abs(dirDotNormal) < F::Set(0.001f);
+		const Vec3<F> pointOnPlane = planeNormal * originToPlaneDistance;
+		const Vec3<F> startToPlane = pointOnPlane - rayStart;
+		const F distanceToPlane = Dot(startToPlane, planeNormal) / dirDotNormal;
+
+		// Intersection::Barycentric
+		const Vec3<F> p = rayStart + rayDir * distanceToPlane;
+		const Vec3<F> v0 = b - a;
+		const Vec3<F> v1 = c - a;
+		const Vec3<F> v2 = p - a;
+		const F d00 = Dot(v0, v0);
+		const F d01 = Dot(v0, v1);
+		const F d11 = Dot(v1, v1);
+		const F d20 = Dot(v2, v0);
+		const F d21 = Dot(v2, v1);
+		const F denom = d00 * d11 - d01 * d01;
+		const F divDenom = F::Set(1.0f) / denom;
+		const F u = (d11 * d20 - d01 * d21) * divDenom;
+		const F v = (d00 * d21 - d01 * d20) * divDenom;
+		const F w = F::Set(1.0f) - u - v;
+
+		// Intersection::OnTriangle
+		const F zero = F::Zero();
+		const F one = F::Set(1.0f);
+		const F onTriangle = (zero <= v) & (v <= one) & (zero <= w) & (w <= one) & (zero <= u) & (u <= one);
+
+		return F::Select(F::AndNot(onTriangle, isParallelWithPlane), distanceToPlane, F::Set(-1.0f));
+	}
+
+	template<typename F>
+	inline void RayWithPaddedTriangles(const float rayStartIn[3], const float rayDirIn[3], const TrianglePacket& triangles, unsigned int laneOffset, float padding, bool checkBackfaces, float* outDistances) {
+		const Vec3<F> rayStart = Set<F>(rayStartIn);
+		const Vec3<F> rayDir = Set<F>(rayDirIn);
+		const Vec3<F> oldV[3] = { LoadVertex<F>(triangles, 0, laneOffset), LoadVertex<F>(triangles, 1, laneOffset), LoadVertex<F>(triangles, 2, laneOffset) };
+
+		const Vec3<F> triangleNormal = Normalize(Cross(oldV[0] - oldV[1], oldV[0] - oldV[2]));
+
+		// Only check if triangle is facing ray start
+		F facing = Dot(oldV[0] - rayStart, triangleNormal) < F::Zero();
+		if (checkBackfaces) {
+			facing = F::Zero() < F::Set(1.0f);
+		}
+
+		F distance;
+		if (padding != 0.0f) {
+			const F paddingF = F::Set(padding);
+			const Vec3<F> normalPadding = triangleNormal * paddingF;
+			const Vec3<F> middle = ((oldV[0] + oldV[1] + oldV[2]) / F::Set(3.0f)) + normalPadding;
+
+			Vec3<F> newV[3];
+			for (int i = 0; i < 3; i++) {
+				newV[i] = oldV[i] + normalPadding;
+
+				const F oldRayDist = Dot(rayDir, oldV[i] - rayStart);
+				const F newRayDist = Dot(rayDir, newV[i] - rayStart);
+
+				const Vec3<F> oldProjectionOnRayDir = rayStart + rayDir * oldRayDist;
+				const Vec3<F> newProjectionOnRayDir = rayStart + rayDir * newRayDist;
+				const F oldNormalDot = Dot(oldProjectionOnRayDir - oldV[i], triangleNormal);
+				const F newNormalDot = Dot(newProjectionOnRayDir - newV[i], triangleNormal);
+
+				const F pullTowardsRay = (F::SignsDiffer(oldNormalDot, newNormalDot) & (Dot(middle - newV[i], rayDir) > F::Zero())) | F::SignsDiffer(oldRayDist, newRayDist);
+				if (F::MoveMask(pullTowardsRay)) {
+					const Vec3<F> toRayStart = rayStart - oldV[i];
+					const F length = F::Min(F::Sqrt(Dot(toRayStart, toRayStart)), paddingF) - F::Set(0.001f);
+					newV[i] = Select(pullTowardsRay, oldV[i] + Normalize(toRayStart) * length, newV[i]);
+				}
+			}
+
+			distance = RayWithTriangle(rayStart, rayDir, newV[0], newV[1], newV[2]);
+		} else {
+			distance = RayWithTriangle(rayStart, rayDir, oldV[0], oldV[1], oldV[2]);
+		}
+
+		F::Select(facing, distance, F::Set(-1.0f)).store(outDistances + laneOffset);
+	}
+
+	// Returns one bit per lane, starting at bit 0 for laneOffset
+	template<typename F>
+	inline unsigned int AabbWithTriangles(const float aabbPosIn[3], const float aabbHalfSizeIn[3], const TrianglePacket& triangles, unsigned int laneOffset, bool checkBackfaces) {
+		const Vec3<F> aabbPos = Set<F>(aabbPosIn);
+		const F halfX = F::Set(aabbHalfSizeIn[0]);
+		const F halfY = F::Set(aabbHalfSizeIn[1]);
+		const F halfZ = F::Set(aabbHalfSizeIn[2]);
+		const Vec3<F> triPos1 = LoadVertex<F>(triangles, 0, laneOffset);
+		const Vec3<F> triPos2 = LoadVertex<F>(triangles, 1, laneOffset);
+		const Vec3<F> triPos3 = LoadVertex<F>(triangles, 2, laneOffset);
+
+		const Vec3<F> triNormal = Normalize(Cross(triPos1 - triPos2, triPos1 - triPos3));
+
+		// Calculate triangle points relative to the AABB
+		const Vec3<F> newV1 = triPos1 - aabbPos;
+		const Vec3<F> newV2 = triPos2 - aabbPos;
+		const Vec3<F> newV3 = triPos3 - aabbPos;
+
+		// Don't intersect with triangles facing away from the bounding box, NaN normals of degenerate triangles fail the sphere test below
+		F hit = F::Zero() < F::Set(1.0f);
+		if (!checkBackfaces) {
+			hit = F::AndNot(hit, Dot(newV1, triNormal) > F::Zero());
+		}
+
+		// Intersection::SphereWithPlane, a sphere around the AABB has to intersect the triangle plane
+		const float radius = aabbHalfSizeIn[0] * aabbHalfSizeIn[0] + aabbHalfSizeIn[1] * aabbHalfSizeIn[1] + aabbHalfSizeIn[2] * aabbHalfSizeIn[2];
+		const Vec3<F> triangleToWorldOrigo = Vec3<F>{ F::Zero(), F::Zero(), F::Zero() } - triPos1;
+		const F distance = -Dot(triangleToWorldOrigo, triNormal);
+		const Vec3<F> centerToPlane = triNormal * distance - aabbPos;
+		hit = hit & (F::Abs(Dot(centerToPlane, triNormal)) < F::Sqrt(F::Set(radius)));
+		if (!F::MoveMask(hit)) {
+			return 0;
+		}
+
+		// Separating axis theorem with the cross products of the box axes and the triangle edges
+		// The zero components of the box axes are left out, which only changes the sign of zeros in the products
+		const Vec3<F> f[3] = { newV2 - newV1, newV3 - newV2, newV1 - newV3 };
+		for (int j = 0; j < 3; j++) {
+			const F fx = f[j].x;
+			const F fy = f[j].y;
+			const F fz = f[j].z;
+
+			// x cross f = (0, -f.z, f.y)
+			F p1 = -fz * newV1.y + fy * newV1.z;
+			F p2 = -fz * newV2.y + fy * newV2.z;
+			F p3 = -fz * newV3.y + fy * newV3.z;
+			F r = halfY * F::Abs(fz) + halfZ * F::Abs(fy);
+			hit = F::AndNot(hit, (F::Min(p1, F::Min(p2, p3)) > r) | (F::Max(p1, F::Max(p2, p3)) < -r));
+
+			// y cross f = (f.z, 0, -f.x)
+			p1 = fz * newV1.x + -fx * newV1.z;
+			p2 = fz * newV2.x + -fx * newV2.z;
+			p3 = fz * newV3.x + -fx * newV3.z;
+			r = halfX * F::Abs(fz) + halfZ * F::Abs(fx);
+			hit = F::AndNot(hit, (F::Min(p1, F::Min(p2, p3)) > r) | (F::Max(p1, F::Max(p2, p3)) < -r));
+
+			// z cross f = (-f.y, f.x, 0)
+			p1 = -fy * newV1.x + fx * newV1.y;
+			p2 = -fy * newV2.x + fx * newV2.y;
+			p3 = -fy * newV3.x + fx * newV3.y;
+			r = halfX * F::Abs(fy) + halfY * F::Abs(fx);
+			hit = F::AndNot(hit, (F::Min(p1, F::Min(p2, p3)) > r) | (F::Max(p1, F::Max(p2, p3)) < -r));
+		}
+
+		return F::MoveMask(hit);
+	}
+
+}
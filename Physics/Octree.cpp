@@ -9,29 +9,111 @@
 
 #include "Octree.h"
 
+namespace {
+	/*
+		Transforms the triangles of every mesh in the model to world space and calls func(const TrianglePacket&) for every
+		TrianglePacket::WIDTH of them, in the order they are stored in the meshes. Stops early if func returns true.
+	*/
+	template<typename Func>
+	bool ForEachTrianglePacket(Model* model, const glm::mat4& transformMatrix, Func&& func) {
+		TrianglePacket packet;
+		for (unsigned int j = 0; j < model->getNumberOfMeshes(); j++) {
+			const Mesh::Data& meshData = model->getMesh(j)->getData();
+			const unsigned int numIndices = (meshData.indices) ? meshData.numIndices : meshData.numVertices;
+
+			for (unsigned int k = 0; k + 2 < numIndices; k += 3) {
+				glm::vec3 v0, v1, v2;
+				if (meshData.indices) { //Has indices
+					v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k]].vec, 1.0f));
+					v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 1]].vec, 1.0f));
+					v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 2]].vec, 1.0f));
+				} else { //Does not have indices
+					v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k].vec, 1.0f));
+					v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 1].vec, 1.0f));
+					v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 2].vec, 1.0f));
+				}
+
+				packet.add(v0, v1, v2);
+				if (packet.isFull()) {
+					if (func(packet)) {
+						return true;
+					}
+					packet.clear();
+				}
+			}
+		}
+
+		return packet.count > 0 && func(packet);
+	}
+}
+
 
 Octree::Octree(Model* boundingBoxModel) {
 
 	m_boundingBoxModel = boundingBoxModel;
+	m_debugVisualization = false;
+	m_updateCount = 0;
+	m_numQueries = 0;
+	m_numResultAllocations = 0;
 	m_softLimitMeshes = 4;
 	m_minimumNodeHalfSize = 4.0f;
 
-	m_baseNode.bbEntity = ECS::Instance()->createEntity("OBB");
-	m_baseNode.bbEntity->addComponent<BoundingBoxComponent>(m_boundingBoxModel);
-	BoundingBoxComponent* bc = m_baseNode.bbEntity->getComponent<BoundingBoxComponent>();
-	BoundingBox* tempBoundingBox = bc->getBoundingBox();
-	tempBoundingBox->setPosition(glm::vec3(0.0f));
-	tempBoundingBox->setHalfSize(glm::vec3(20.0f, 20.0f, 20.0f));
+	m_nodes.emplace_back();
+	Node& baseNode = m_nodes[ROOT_NODE];
+	baseNode.position = glm::vec3(0.0f);
+	baseNode.halfSize = glm::vec3(20.0f, 20.0f, 20.0f);
+	baseNode.parent = -1;
+}
 
-	bc->getTransform()->setTranslation(tempBoundingBox->getPosition() - glm::vec3(0.0f, tempBoundingBox->getHalfSize().y, 0.0f));
-	bc->getTransform()->setScale(tempBoundingBox->getHalfSize() * 2.0f);
+Octree::~Octree() {
 
-	m_baseNode.parentNode = nullptr;
-	m_baseNode.nrOfEntities = 0;
 }
 
-Octree::~Octree() {
+int Octree::allocateChildBlock() {
+	int firstChild;
+	if (!m_freeChildBlocks.empty()) {
+		firstChild = m_freeChildBlocks.back();
+		m_freeChildBlocks.pop_back();
+	} else {
+		firstChild = (int)m_nodes.size();
+		m_nodes.resize(m_nodes.size() + 8);
+	}
+	return firstChild;
+}
 
+void Octree::freeChildBlock(int firstChild) {
+	for (int i = firstChild; i < firstChild + 8; i++) {
+		destroyDebugEntity(i);
+		m_nodes[i].entities.clear();
+		m_nodes[i].firstChild = -1;
+		m_nodes[i].parent = -1;
+	}
+	m_freeChildBlocks.push_back(firstChild);
+}
+
+void Octree::createDebugEntity(int nodeIndex) {
+	Node& node = m_nodes[nodeIndex];
+	if (!m_debugVisualization || node.debugEntity) {
+		return;
+	}
+
+	node.debugEntity = ECS::Instance()->createEntity("OBB");
+	node.debugEntity->addComponent<BoundingBoxComponent>(m_boundingBoxModel);
+	BoundingBoxComponent* bc = node.debugEntity->getComponent<BoundingBoxComponent>();
+	BoundingBox* boundingBox = bc->getBoundingBox();
+	boundingBox->setPosition(node.position);
+	boundingBox->setHalfSize(node.halfSize);
+
+	bc->getTransform()->setTranslation(node.position - glm::vec3(0.0f, node.halfSize.y, 0.0f));
+	bc->getTransform()->setScale(node.halfSize * 2.0f);
+}
+
+void Octree::destroyDebugEntity(int nodeIndex) {
+	Node& node = m_nodes[nodeIndex];
+	if (node.debugEntity) {
+		node.debugEntity->queueDestruction();
+		node.debugEntity.reset();
+	}
 }
 
 void Octree::expandBaseNode(glm::vec3 direction) {
@@ -41,63 +123,61 @@ void Octree::expandBaseNode(glm::vec3 direction) {
 	y = direction.y >= 0.0f;
 	z = direction.z >= 0.0f;
 
-	Node newBaseNode;
-	const BoundingBox* baseNodeBB = m_baseNode.bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox();
-	newBaseNode.bbEntity = ECS::Instance()->createEntity("OBB");
-
-	newBaseNode.bbEntity->addComponent<BoundingBoxComponent>(m_boundingBoxModel);
-	BoundingBoxComponent* bc = newBaseNode.bbEntity->getComponent<BoundingBoxComponent>();
-	BoundingBox* newBaseNodeBoundingBox = bc->getBoundingBox();
-	newBaseNodeBoundingBox->setPosition(baseNodeBB->getPosition() - baseNodeBB->getHalfSize() + glm::vec3(x * baseNodeBB->getHalfSize().x * 2.0f, y * baseNodeBB->getHalfSize().y * 2.0f, z * baseNodeBB->getHalfSize().z * 2.0f));
-	newBaseNodeBoundingBox->setHalfSize(baseNodeBB->getHalfSize() * 2.0f);
-
-	bc->getTransform()->setTranslation(newBaseNodeBoundingBox->getPosition() - glm::vec3(0.0f, newBaseNodeBoundingBox->getHalfSize().y, 0.0f));
-	bc->getTransform()->setScale(newBaseNodeBoundingBox->getHalfSize() * 2.0f);
-
-	newBaseNode.nrOfEntities = 0;
-	newBaseNode.parentNode = nullptr;
+	const glm::vec3 oldPosition = m_nodes[ROOT_NODE].position;
+	const glm::vec3 oldHalfSize = m_nodes[ROOT_NODE].halfSize;
+	const glm::vec3 newPosition = oldPosition - oldHalfSize + glm::vec3(x * oldHalfSize.x * 2.0f, y * oldHalfSize.y * 2.0f, z * oldHalfSize.z * 2.0f);
 
+	const int firstChild = allocateChildBlock();
+	int childIndex = firstChild;
 	for (int i = 0; i < 2; i++) {
 		for (int j = 0; j < 2; j++) {
 			for (int k = 0; k < 2; k++) {
-				Node tempChildNode;
+				Node& child = m_nodes[childIndex];
 				if (i != x && j != y && k != z) {
-					tempChildNode = m_baseNode;
+					// The old base node becomes one of the children, move it out of the root slot
+					child = std::move(m_nodes[ROOT_NODE]);
+					if (child.firstChild >= 0) {
+						for (int c = child.firstChild; c < child.firstChild + 8; c++) {
+							m_nodes[c].parent = childIndex;
+						}
+					}
 				} else {
-					tempChildNode.bbEntity = ECS::Instance()->createEntity("OBB");
-					tempChildNode.bbEntity->addComponent<BoundingBoxComponent>(m_boundingBoxModel);
-					bc = tempChildNode.bbEntity->getComponent<BoundingBoxComponent>();
-					BoundingBox* tempChildBoundingBox = bc->getBoundingBox();
-					tempChildBoundingBox->setHalfSize(baseNodeBB->getHalfSize());
-					tempChildBoundingBox->setPosition(newBaseNodeBoundingBox->getPosition() - baseNodeBB->getHalfSize() + glm::vec3(tempChildBoundingBox->getHalfSize().x * 2.0f * i, tempChildBoundingBox->getHalfSize().y * 2.0f * j, tempChildBoundingBox->getHalfSize().z * 2.0f * k));
-					tempChildNode.nrOfEntities = 0;
-
-					bc->getTransform()->setTranslation(tempChildBoundingBox->getPosition() - glm::vec3(0.0f, tempChildBoundingBox->getHalfSize().y, 0.0f));
-					bc->getTransform()->setScale(tempChildBoundingBox->getHalfSize() * 2.0f);
+					child.halfSize = oldHalfSize;
+					child.position = newPosition - oldHalfSize + glm::vec3(oldHalfSize.x * 2.0f * i, oldHalfSize.y * 2.0f * j, oldHalfSize.z * 2.0f * k);
+					child.firstChild = -1;
+					child.entities.clear();
+					createDebugEntity(childIndex);
 				}
-				tempChildNode.parentNode = &newBaseNode;
-				newBaseNode.childNodes.push_back(tempChildNode);
+				child.parent = ROOT_NODE;
+				childIndex++;
 			}
 		}
 	}
 
-	m_baseNode = newBaseNode;
+	Node& newBaseNode = m_nodes[ROOT_NODE];
+	newBaseNode.position = newPosition;
+	newBaseNode.halfSize = oldHalfSize * 2.0f;
+	newBaseNode.firstChild = firstChild;
+	newBaseNode.parent = -1;
+	newBaseNode.entities.clear();
+	newBaseNode.debugEntity.reset();
+	createDebugEntity(ROOT_NODE);
 }
 
 
-glm::vec3 Octree::findCornerOutside(Entity* entity, Node* testNode) {
+glm::vec3 Octree::findCornerOutside(Entity* entity, int nodeIndex) const {
 	//Find if any corner of a entity's bounding box is outside of node. Returns a vector towards the outside corner if one is found. Otherwise a 0.0f vec is returned.
 	glm::vec3 directionVec(0.0f, 0.0f, 0.0f);
 
 	const glm::vec3* corners = entity->getComponent<BoundingBoxComponent>()->getBoundingBox()->getCornersWithUpdate();
-	glm::vec3 testNodeHalfSize = testNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox()->getHalfSize();
+	const Node& testNode = m_nodes[nodeIndex];
 
 	for (int i = 0; i < 8; i++) {
-		glm::vec3 distanceVec = corners[i] - testNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox()->getPosition();
+		glm::vec3 distanceVec = corners[i] - testNode.position;
 
-		if (distanceVec.x <= -testNodeHalfSize.x || distanceVec.x >= testNodeHalfSize.x ||
-			distanceVec.y <= -testNodeHalfSize.y || distanceVec.y >= testNodeHalfSize.y ||
-			distanceVec.z <= -testNodeHalfSize.z || distanceVec.z >= testNodeHalfSize.z) {
+		if (distanceVec.x <= -testNode.halfSize.x || distanceVec.x >= testNode.halfSize.x ||
+			distanceVec.y <= -testNode.halfSize.y || distanceVec.y >= testNode.halfSize.y ||
+			distanceVec.z <= -testNode.halfSize.z || distanceVec.z >= testNode.halfSize.z) {
 			directionVec = distanceVec;
 			i = 8;
 		}
@@ -106,72 +186,68 @@ glm::vec3 Octree::findCornerOutside(Entity* entity, Node* testNode) {
 	return directionVec;
 }
 
-bool Octree::addEntityRec(Entity* newEntity, Node* currentNode) {
+bool Octree::addEntityRec(Entity* newEntity, int nodeIndex) {
+	// Note: m_nodes can grow during the recursion so node references can't be kept across calls
 	bool entityAdded = false;
 
-	glm::vec3 isInsideVec = findCornerOutside(newEntity, currentNode);
+	glm::vec3 isInsideVec = findCornerOutside(newEntity, nodeIndex);
 	if (glm::length(isInsideVec) < 1.0f) {
 		//The current node does contain the whole mesh. Keep going deeper or add to this node if no smaller nodes are allowed
 
-		if (currentNode->childNodes.size() > 0) { //Not leaf node
+		const int firstChild = m_nodes[nodeIndex].firstChild;
+		if (firstChild >= 0) { //Not leaf node
 			//Recursively call children
-
-			for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-				entityAdded = addEntityRec(newEntity, &currentNode->childNodes[i]);
-
-				if (entityAdded) {
-					//Mesh was added to child node. Break loop. No need to try the rest of the children
-					i = (unsigned int)currentNode->childNodes.size();
-				}
+			for (int i = firstChild; i < firstChild + 8 && !entityAdded; i++) {
+				//Stops at the first child which could contain the mesh
+				entityAdded = addEntityRec(newEntity, i);
 			}
 
 			if (!entityAdded) { //Mesh did not fit in any child node
 				//Add mesh to this node
-				currentNode->entities.push_back(newEntity);
-				currentNode->nrOfEntities++;
+				m_nodes[nodeIndex].entities.push_back(newEntity);
 				entityAdded = true;
 			}
 		} else { //Is leaf node
-			if (currentNode->nrOfEntities < m_softLimitMeshes || currentNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox()->getHalfSize().x / 2.0f < m_minimumNodeHalfSize) { //Soft limit not reached or smaller nodes are not allowed
+			if ((int)m_nodes[nodeIndex].entities.size() < m_softLimitMeshes || m_nodes[nodeIndex].halfSize.x / 2.0f < m_minimumNodeHalfSize) { //Soft limit not reached or smaller nodes are not allowed
 				//Add mesh to this node
-				currentNode->entities.push_back(newEntity);
-				currentNode->nrOfEntities++;
+				m_nodes[nodeIndex].entities.push_back(newEntity);
 				entityAdded = true;
 			} else {
 				//Create more children
+				const int newFirstChild = allocateChildBlock();
+				const glm::vec3 childHalfSize = m_nodes[nodeIndex].halfSize / 2.0f;
+				const glm::vec3 childStart = m_nodes[nodeIndex].position - childHalfSize;
+				int childIndex = newFirstChild;
 				for (int i = 0; i < 2; i++) {
 					for (int j = 0; j < 2; j++) {
 						for (int k = 0; k < 2; k++) {
-							const BoundingBox* currentNodeBB = currentNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox();
-							Node tempChildNode;
-							tempChildNode.bbEntity = ECS::Instance()->createEntity("OBB");
-							tempChildNode.bbEntity->addComponent<BoundingBoxComponent>(m_boundingBoxModel);
-							BoundingBoxComponent* bc = tempChildNode.bbEntity->getComponent<BoundingBoxComponent>();
-							BoundingBox* tempChildBoundingBox = bc->getBoundingBox();
-							tempChildBoundingBox->setHalfSize(currentNodeBB->getHalfSize() / 2.0f);
-							tempChildBoundingBox->setPosition(currentNodeBB->getPosition() - tempChildBoundingBox->getHalfSize() + glm::vec3(tempChildBoundingBox->getHalfSize().x * 2.0f * i, tempChildBoundingBox->getHalfSize().y * 2.0f * j, tempChildBoundingBox->getHalfSize().z * 2.0f * k));
-							tempChildNode.nrOfEntities = 0;
-							tempChildNode.parentNode = currentNode;
-							currentNode->childNodes.push_back(tempChildNode);
-
-							bc->getTransform()->setTranslation(tempChildBoundingBox->getPosition() - glm::vec3(0.0f, tempChildBoundingBox->getHalfSize().y, 0.0f));
-							bc->getTransform()->setScale(tempChildBoundingBox->getHalfSize() * 2.0f);
-
-							//Try to put meshes that was in this leaf node in the new child nodes.
-							for (int l = 0; l < currentNode->nrOfEntities; l++) {
-								if (addEntityRec(currentNode->entities[l], &currentNode->childNodes.back())) {
-									//Mesh was successfully added to child. Remove it from this node.
-									currentNode->entities.erase(currentNode->entities.begin() + l);
-									currentNode->nrOfEntities--;
-									l--;
-								}
-							}
+							Node& child = m_nodes[childIndex];
+							child.halfSize = childHalfSize;
+							child.position = childStart + glm::vec3(childHalfSize.x * 2.0f * i, childHalfSize.y * 2.0f * j, childHalfSize.z * 2.0f * k);
+							child.firstChild = -1;
+							child.parent = nodeIndex;
+							child.entities.clear();
+							createDebugEntity(childIndex);
+							childIndex++;
+						}
+					}
+				}
+				m_nodes[nodeIndex].firstChild = newFirstChild;
+
+				//Try to put meshes that was in this leaf node in the new child nodes.
+				for (int c = newFirstChild; c < newFirstChild + 8; c++) {
+					for (int l = 0; l < (int)m_nodes[nodeIndex].entities.size(); l++) {
+						if (addEntityRec(m_nodes[nodeIndex].entities[l], c)) {
+							//Mesh was successfully added to child. Remove it from this node.
+							std::vector<Entity*>& entities = m_nodes[nodeIndex].entities;
+							entities.erase(entities.begin() + l);
+							l--;
 						}
 					}
 				}
 
 				//Try to add the mesh to newly created child nodes. It gets placed in current node within recursion if the children can not contain it.
-				entityAdded = addEntityRec(newEntity, currentNode);
+				entityAdded = addEntityRec(newEntity, nodeIndex);
 			}
 		}
 	}
@@ -179,29 +255,29 @@ bool Octree::addEntityRec(Entity* newEntity, Node* currentNode) {
 	return entityAdded;
 }
 
-bool Octree::removeEntityRec(Entity* entityToRemove, Node* currentNode) {
+bool Octree::removeEntityRec(Entity* entityToRemove, int nodeIndex) {
 	bool entityRemoved = false;
 
 	//Look for mesh in this node
-	for (int i = 0; i < currentNode->nrOfEntities; i++) {
-		if (currentNode->entities[i]->getID() == entityToRemove->getID()) {
+	std::vector<Entity*>& entities = m_nodes[nodeIndex].entities;
+	for (size_t i = 0; i < entities.size(); i++) {
+		if (entities[i]->getID() == entityToRemove->getID()) {
 			//Mesh found - Remove it
-			currentNode->entities[i] = currentNode->entities.back();
-			currentNode->entities.pop_back();
-			//currentNode->entities.erase(currentNode->entities.begin() + i);
-			currentNode->nrOfEntities--;
+			entities[i] = entities.back();
+			entities.pop_back();
 			entityRemoved = true;
-			i = currentNode->nrOfEntities;
+			break;
 		}
 	}
 
 	if (!entityRemoved) {
 		//Mesh was not in this node. Recursively call this function for the children
-		for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-			if (removeEntityRec(entityToRemove, &currentNode->childNodes[i])) {
+		const int firstChild = m_nodes[nodeIndex].firstChild;
+		for (int i = firstChild; firstChild >= 0 && i < firstChild + 8; i++) {
+			if (removeEntityRec(entityToRemove, i)) {
 				//Mesh was removed by one of the children, break the loop
 				entityRemoved = true;
-				i = (unsigned int)currentNode->childNodes.size();
+				break;
 			}
 		}
 	}
@@ -209,46 +285,51 @@ bool Octree::removeEntityRec(Entity* entityToRemove, Node* currentNode) {
 	return entityRemoved;
 }
 
-void Octree::updateRec(Node* currentNode, std::vector<Entity*>* entitiesToReAdd) {
-	for (int i = 0; i < currentNode->nrOfEntities; i++) {
-		if (currentNode->entities[i]->getComponent<BoundingBoxComponent>()->getBoundingBox()->getChange()) { //Entity has changed
+void Octree::updateRec(int nodeIndex, std::vector<Entity*>* entitiesToReAdd) {
+	std::vector<Entity*>& entities = m_nodes[nodeIndex].entities;
+	for (int i = 0; i < (int)entities.size(); i++) {
+		if (entities[i]->getComponent<BoundingBoxComponent>()->getBoundingBox()->getChange()) { //Entity has changed
 			//Re-add the entity to get it in the right node
-			Entity* tempEntity = currentNode->entities[i];
-			//First remove the entity from this node to avoid duplicates
-			bool removed = removeEntityRec(currentNode->entities[i], currentNode);
-
-			if (removed) {
-				i--;
-				//Then store the entity to re-add it to the tree in the right node
-				entitiesToReAdd->push_back(tempEntity);
-			}
+			//First remove the entity from this node to avoid duplicates, then store it to re-add it to the tree in the right node
+			entitiesToReAdd->push_back(entities[i]);
+			entities[i] = entities.back();
+			entities.pop_back();
+			i--;
 		}
 	}
 
-	for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-		updateRec(&currentNode->childNodes[i], entitiesToReAdd);
+	const int firstChild = m_nodes[nodeIndex].firstChild;
+	for (int i = firstChild; firstChild >= 0 && i < firstChild + 8; i++) {
+		updateRec(i, entitiesToReAdd);
 	}
 }
 
-void Octree::getCollisionData(const BoundingBox* entityBoundingBox, Entity* meshEntity, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, std::vector<CollisionInfo>* outCollisionData, const bool checkBackfaces) {
-	if (Intersection::AabbWithTriangle(entityBoundingBox->getPosition(), entityBoundingBox->getHalfSize(), v0, v1, v2, checkBackfaces)) {
-		outCollisionData->emplace_back();
-		outCollisionData->back().entity = meshEntity;
-		outCollisionData->back().shape = SAIL_NEW CollisionTriangle(v0, v1, v2, glm::normalize(glm::cross(glm::vec3(v0 - v1), glm::vec3(v0 - v2))));
-		//SAIL_LOG("Collision detected with " + meshEntity->getName());
+void Octree::getCollisionData(const BoundingBox* entityBoundingBox, Entity* meshEntity, const TrianglePacket& triangles, std::vector<CollisionInfo>* outCollisionData, const bool checkBackfaces) {
+	unsigned int hits = Intersection::AabbWithTriangles(entityBoundingBox->getPosition(), entityBoundingBox->getHalfSize(), triangles, checkBackfaces);
+	for (unsigned int lane = 0; hits != 0; lane++, hits >>= 1) {
+		if (hits & 1) {
+			const glm::vec3 v0 = triangles.getVertex(lane, 0);
+			const glm::vec3 v1 = triangles.getVertex(lane, 1);
+			const glm::vec3 v2 = triangles.getVertex(lane, 2);
+
+			CollisionInfo info;
+			info.entity = meshEntity;
+			info.shape = CollisionShape::CreateTriangle(v0, v1, v2, glm::normalize(glm::cross(glm::vec3(v0 - v1), glm::vec3(v0 - v2))));
+			addResult(outCollisionData, info);
+		}
 	}
 }
 
 // Shouldn't modify any components
-void Octree::getCollisionsRec(Entity* entity, const BoundingBox* entityBoundingBox, Node* currentNode, std::vector<CollisionInfo>* outCollisionData, const bool doSimpleCollisions, const bool checkBackfaces) {
-	const BoundingBox* nodeBoundingBox = currentNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox();
+void Octree::getCollisionsRec(Entity* entity, const BoundingBox* entityBoundingBox, int nodeIndex, std::vector<CollisionInfo>* outCollisionData, const bool doSimpleCollisions, const bool checkBackfaces) {
+	const Node* currentNode = &m_nodes[nodeIndex];
 
 	// Early exit if Bounding box doesn't collide with the current node
-	if (!Intersection::AabbWithAabb(entityBoundingBox->getPosition(), entityBoundingBox->getHalfSize(), nodeBoundingBox->getPosition(), nodeBoundingBox->getHalfSize())) {
+	if (!Intersection::AabbWithAabb(entityBoundingBox->getPosition(), entityBoundingBox->getHalfSize(), currentNode->position, currentNode->halfSize)) {
 		return;
 	}
 	//Check against entities
-	for (int i = 0; i < currentNode->nrOfEntities; i++) {
+	for (size_t i = 0; i < currentNode->entities.size(); i++) {
 		//Don't let an entity collide with itself or its children
 		if (entity == currentNode->entities[i] || entity == currentNode->entities[i]->getParent()) {
 			continue;
@@ -274,26 +355,20 @@ void Octree::getCollisionsRec(Entity* entity, const BoundingBox* entityBoundingB
 				transformMatrix = transform->getMatrixWithoutUpdate();
 			}
 
-			for (unsigned int j = 0; j < model->getModel()->getNumberOfMeshes(); j++) {
-				const Mesh::Data& meshData = model->getModel()->getMesh(j)->getData();
-				if (meshData.indices) { //Has indices
-					for (unsigned int k = 0; k < meshData.numIndices; k += 3) {
-						glm::vec3 v0, v1, v2;
-						v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k]].vec, 1.0f));
-						v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 1]].vec, 1.0f));
-						v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 2]].vec, 1.0f));
-						getCollisionData(entityBoundingBox, currentNode->entities[i], v0, v1, v2, outCollisionData, checkBackfaces);
-					}
-				} else { //Does not have indices
-					for (unsigned int k = 0; k < meshData.numVertices; k += 3) {
-						glm::vec3 v0, v1, v2;
-						v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k].vec, 1.0f));
-						v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 1].vec, 1.0f));
-						v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 2].vec, 1.0f));
-						getCollisionData(entityBoundingBox, currentNode->entities[i], v0, v1, v2, outCollisionData, checkBackfaces);
-					}
+			if (const TriangleCache* cache = getTriangleCache(currentNode->entities[i], model, transformMatrix)) {
+				//Only test the cached triangles close to the bounding box
+				for (const TriangleBVH& mesh : cache->meshes) {
+					mesh.queryAabb(entityBoundingBox->getPosition(), entityBoundingBox->getHalfSize(), [&](const TrianglePacket& triangles) {
+						getCollisionData(entityBoundingBox, currentNode->entities[i], triangles, outCollisionData, checkBackfaces);
+					});
 				}
+				continue;
 			}
+
+			ForEachTrianglePacket(model->getModel(), transformMatrix, [&](const TrianglePacket& triangles) {
+				getCollisionData(entityBoundingBox, currentNode->entities[i], triangles, outCollisionData, checkBackfaces);
+				return false;
+			});
 		} else { //No model or simple collision opportunity
 			//Collide with bounding box
 			glm::vec3 intersectionAxis;
@@ -301,48 +376,80 @@ void Octree::getCollisionsRec(Entity* entity, const BoundingBox* entityBoundingB
 
 			Intersection::AabbWithAabb(entityBoundingBox->getPosition(), entityBoundingBox->getHalfSize(), otherBoundingBox->getPosition(), otherBoundingBox->getHalfSize(), &intersectionAxis, &intersectionDepth);
 
-			outCollisionData->emplace_back();
-			outCollisionData->back().shape = SAIL_NEW CollisionAABB(otherBoundingBox->getPosition(), otherBoundingBox->getHalfSize(), intersectionAxis);
-			outCollisionData->back().entity = currentNode->entities[i];
+			CollisionInfo info;
+			info.shape = CollisionShape::CreateAABB(otherBoundingBox->getPosition(), otherBoundingBox->getHalfSize(), intersectionAxis);
+			info.entity = currentNode->entities[i];
+			addResult(outCollisionData, info);
 		}
 	}
 
 	//Check for children
-	for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-		getCollisionsRec(entity, entityBoundingBox, &currentNode->childNodes[i], outCollisionData, doSimpleCollisions, checkBackfaces);
+	const int firstChild = currentNode->firstChild;
+	for (int i = firstChild; firstChild >= 0 && i < firstChild + 8; i++) {
+		getCollisionsRec(entity, entityBoundingBox, i, outCollisionData, doSimpleCollisions, checkBackfaces);
 	}
 }
 
-void Octree::getIntersectionData(const glm::vec3& rayStart, const glm::vec3& rayDir, Entity* meshEntity, const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3, RayIntersectionInfo* outIntersectionData, float padding, const bool checkBackfaces) {
-	float intersectionDistance = Intersection::RayWithPaddedTriangle(rayStart, rayDir, v1, v2, v3, padding, checkBackfaces);
+bool Octree::addRayHit(float distance, const CollisionInfo& info, RayIntersectionInfo* outIntersectionData, RayQueryMode mode, float maxDistance) {
+	if (distance > maxDistance) {
+		return false;
+	}
 
-	if (intersectionDistance >= 0.0f) {// && (intersectionDistance <= outIntersectionData->closestHit || outIntersectionData->closestHit < 0.0f)) {
-		//Save closest hit
+	if (mode == RayQueryMode::ANY_HIT) {
+		outIntersectionData->closestHit = distance;
+		return true;
+	}
 
-		if (intersectionDistance <= outIntersectionData->closestHit || outIntersectionData->closestHit < 0.0f) {
-			outIntersectionData->closestHit = intersectionDistance;
-			outIntersectionData->closestHitIndex = (int)outIntersectionData->info.size();
+	const bool isClosest = distance <= outIntersectionData->closestHit || outIntersectionData->closestHit < 0.0f;
+	if (mode == RayQueryMode::CLOSEST_HIT) {
+		if (!isClosest) {
+			return false;
 		}
+		// Only the closest hit is kept
+		outIntersectionData->info.clear();
+	}
 
-		outIntersectionData->info.emplace_back();
-		outIntersectionData->info.back().entity = meshEntity;
-		outIntersectionData->info.back().shape = SAIL_NEW CollisionTriangle(v1, v2, v3, glm::normalize(glm::cross(glm::vec3(v1 - v2), glm::vec3(v1 - v3))));
+	//Save closest hit
+	if (isClosest) {
+		outIntersectionData->closestHit = distance;
+		outIntersectionData->closestHitIndex = (int)outIntersectionData->info.size();
 	}
+	addResult(&outIntersectionData->info, info);
+
+	return false;
 }
 
-void Octree::getRayIntersectionRec(const glm::vec3& rayStart, const glm::vec3& rayDir, Node* currentNode, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces) {
+bool Octree::getIntersectionData(const glm::vec3& rayStart, const glm::vec3& rayDir, Entity* meshEntity, const TrianglePacket& triangles, RayIntersectionInfo* outIntersectionData, float padding, const bool checkBackfaces, RayQueryMode mode, float maxDistance) {
+	float intersectionDistances[TrianglePacket::WIDTH];
+	Intersection::RayWithPaddedTriangles(rayStart, rayDir, triangles, padding, intersectionDistances, checkBackfaces);
 
-	const BoundingBox* nodeBoundingBox = currentNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox();
-	float nodeIntersectionDistance = Intersection::RayWithPaddedAabb(rayStart, rayDir, nodeBoundingBox->getPosition(), nodeBoundingBox->getHalfSize(), padding, nullptr);
+	for (unsigned int lane = 0; lane < triangles.count; lane++) {
+		const float intersectionDistance = intersectionDistances[lane];
+		if (intersectionDistance < 0.0f || intersectionDistance > RayDistanceLimit(outIntersectionData, mode, maxDistance)) {
+			continue;
+		}
 
-	// Early exit if ray doesn't intersect with the current node closer than the closest hit
-	// Note: commented out code is a possible future optimization
-	if (nodeIntersectionDistance < 0.0f) {// && (nodeIntersectionDistance < outIntersectionData->closestHit || outIntersectionData->closestHit < 0.0f)) { 
-		return;
+		CollisionInfo info;
+		info.entity = meshEntity;
+		if (mode != RayQueryMode::ANY_HIT) {
+			const glm::vec3 v1 = triangles.getVertex(lane, 0);
+			const glm::vec3 v2 = triangles.getVertex(lane, 1);
+			const glm::vec3 v3 = triangles.getVertex(lane, 2);
+			info.shape = CollisionShape::CreateTriangle(v1, v2, v3, glm::normalize(glm::cross(glm::vec3(v1 - v2), glm::vec3(v1 - v3))));
+		}
+		if (addRayHit(intersectionDistance, info, outIntersectionData, mode, maxDistance)) {
+			return true;
+		}
 	}
 
+	return false;
+}
+
+bool Octree::getRayIntersectionRec(const glm::vec3& rayStart, const glm::vec3& rayDir, int nodeIndex, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces, RayQueryMode mode, float maxDistance) {
+	const Node* currentNode = &m_nodes[nodeIndex];
+
 	//Check against entities
-	for (int i = 0; i < currentNode->nrOfEntities; i++) {
+	for (size_t i = 0; i < currentNode->entities.size(); i++) {
 		if (currentNode->entities[i] == ignoreThis) {
 			continue;
 		}
@@ -352,8 +459,7 @@ void Octree::getRayIntersectionRec(const glm::vec3& rayStart, const glm::vec3& r
 		float entityIntersectionDistance = Intersection::RayWithPaddedAabb(rayStart, rayDir, collidableBoundingBox->getPosition(), collidableBoundingBox->getHalfSize(), padding, &intersectionAxis);
 
 		// Continue if ray doesn't intersect the entity bounding box closer than the closest hit
-		// Note: commented out code is a possible future optimization
-		if (entityIntersectionDistance < 0.0f) {// && (entityIntersectionDistance < outIntersectionData->closestHit || outIntersectionData->closestHit < 0.0f)) { 
+		if (entityIntersectionDistance < 0.0f || entityIntersectionDistance > RayDistanceLimit(outIntersectionData, mode, maxDistance)) {
 			continue;
 		}
 
@@ -369,83 +475,135 @@ void Octree::getRayIntersectionRec(const glm::vec3& rayStart, const glm::vec3& r
 				transformMatrix = transform->getMatrixWithoutUpdate();
 			}
 
-			for (unsigned int j = 0; j < model->getModel()->getNumberOfMeshes(); j++) {
-				const Mesh::Data& meshData = model->getModel()->getMesh(j)->getData();
-				if (meshData.indices) { //Has indices
-					for (unsigned int k = 0; k < meshData.numIndices; k += 3) {
-						glm::vec3 v0, v1, v2;
-						v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k]].vec, 1.0f));
-						v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 1]].vec, 1.0f));
-						v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 2]].vec, 1.0f));
-						getIntersectionData(rayStart, rayDir, currentNode->entities[i], v0, v1, v2, outIntersectionData, padding, checkBackfaces);
-					}
-				} else { //Does not have indices
-					for (unsigned int k = 0; k < meshData.numVertices; k += 3) {
-						glm::vec3 v0, v1, v2;
-						v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k].vec, 1.0f));
-						v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 1].vec, 1.0f));
-						v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 2].vec, 1.0f));
-						getIntersectionData(rayStart, rayDir, currentNode->entities[i], v0, v1, v2, outIntersectionData, padding, checkBackfaces);
-					}
+			bool done = false;
+			if (const TriangleCache* cache = getTriangleCache(currentNode->entities[i], model, transformMatrix)) {
+				//Only test the cached triangles close to the ray, in front of the closest hit
+				for (size_t j = 0; j < cache->meshes.size() && !done; j++) {
+					cache->meshes[j].queryRay(rayStart, rayDir, padding, RayDistanceLimit(outIntersectionData, mode, maxDistance), [&](const TrianglePacket& triangles) {
+						done = getIntersectionData(rayStart, rayDir, currentNode->entities[i], triangles, outIntersectionData, padding, checkBackfaces, mode, maxDistance);
+						return done ? -1.0f : RayDistanceLimit(outIntersectionData, mode, maxDistance);
+					});
 				}
+			} else {
+				done = ForEachTrianglePacket(model->getModel(), transformMatrix, [&](const TrianglePacket& triangles) {
+					return getIntersectionData(rayStart, rayDir, currentNode->entities[i], triangles, outIntersectionData, padding, checkBackfaces, mode, maxDistance);
+				});
+			}
+			if (done) {
+				return true;
 			}
 		} else { //No model or simple collision opportunity
 			//Intersect with bounding box
-
-			//Save closest hit
-			if (entityIntersectionDistance <= outIntersectionData->closestHit || outIntersectionData->closestHit < 0.0f) {
-				outIntersectionData->closestHit = entityIntersectionDistance;
-				outIntersectionData->closestHitIndex = (int)outIntersectionData->info.size();
+			CollisionInfo info;
+			info.entity = currentNode->entities[i];
+			info.shape = CollisionShape::CreateAABB(collidableBoundingBox->getPosition(), collidableBoundingBox->getHalfSize(), intersectionAxis);
+			if (addRayHit(entityIntersectionDistance, info, outIntersectionData, mode, maxDistance)) {
+				return true;
 			}
-
-			outIntersectionData->info.emplace_back();
-			outIntersectionData->info.back().entity = currentNode->entities[i];
-			outIntersectionData->info.back().shape = SAIL_NEW CollisionAABB(collidableBoundingBox->getPosition(), collidableBoundingBox->getHalfSize(), intersectionAxis);
 		}
 	}
 
 	//Check for children
-	for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-		getRayIntersectionRec(rayStart, rayDir, &currentNode->childNodes[i], outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces);
+	const int firstChild = currentNode->firstChild;
+	if (firstChild < 0) {
+		return false;
+	}
+
+	struct ChildHit {
+		int index;
+		float distance;
+	};
+	ChildHit childHits[8];
+	int numChildHits = 0;
+	for (int i = firstChild; i < firstChild + 8; i++) {
+		const float distance = Intersection::RayWithPaddedAabb(rayStart, rayDir, m_nodes[i].position, m_nodes[i].halfSize, padding, nullptr);
+		if (distance < 0.0f) {
+			continue;
+		}
+		if (mode == RayQueryMode::ALL_HITS) {
+			// Every node along the ray has to be visited anyway, keep the child order
+			getRayIntersectionRec(rayStart, rayDir, i, outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces, mode, maxDistance);
+			continue;
+		}
+
+		// Insertion sort, closest child first
+		int j = numChildHits++;
+		for (; j > 0 && childHits[j - 1].distance > distance; j--) {
+			childHits[j] = childHits[j - 1];
+		}
+		childHits[j] = { i, distance };
+	}
+
+	for (int i = 0; i < numChildHits; i++) {
+		// The closest hit might have moved closer while visiting the previous children
+		if (childHits[i].distance > RayDistanceLimit(outIntersectionData, mode, maxDistance)) {
+			break;
+		}
+		if (getRayIntersectionRec(rayStart, rayDir, childHits[i].index, outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces, mode, maxDistance)) {
+			return true;
+		}
 	}
+
+	return false;
+}
+
+void Octree::rayQuery(const glm::vec3& rayStart, const glm::vec3& rayDir, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces, RayQueryMode mode, float maxDistance) {
+	m_numQueries.fetch_add(1, std::memory_order_relaxed);
+
+	const Node& root = m_nodes[ROOT_NODE];
+	const float rootDistance = Intersection::RayWithPaddedAabb(rayStart, rayDir, root.position, root.halfSize, padding, nullptr);
+	if (rootDistance < 0.0f || rootDistance > maxDistance) {
+		return;
+	}
+	getRayIntersectionRec(rayStart, rayDir, ROOT_NODE, outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces, mode, maxDistance);
 }
 
-int Octree::pruneTreeRec(Node* currentNode) {
+float Octree::RayDistanceLimit(const RayIntersectionInfo* intersectionData, RayQueryMode mode, float maxDistance) {
+	if (mode == RayQueryMode::CLOSEST_HIT && intersectionData->closestHit >= 0.0f) {
+		return glm::min(intersectionData->closestHit, maxDistance);
+	}
+	return maxDistance;
+}
+
+int Octree::pruneTreeRec(int nodeIndex) {
 	int returnValue = 0;
 
-	if (currentNode->childNodes.size() > 0) { //Not a leaf node
+	const int firstChild = m_nodes[nodeIndex].firstChild;
+	if (firstChild >= 0) { //Not a leaf node
 		//Call for child nodes
-		for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-			returnValue += pruneTreeRec(&currentNode->childNodes[i]);
+		for (int i = firstChild; i < firstChild + 8; i++) {
+			returnValue += pruneTreeRec(i);
 		}
 
 		if (returnValue == 0) {
 			//No entities in any child - Prune the children
-			for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-				currentNode->childNodes[i].bbEntity->queueDestruction();
-				//ECS::Instance()->destroyEntity(currentNode->childNodes[i].bbEntity);
-			}
-			currentNode->childNodes.clear();
+			freeChildBlock(firstChild);
+			m_nodes[nodeIndex].firstChild = -1;
 		}
 	}
 
-	returnValue += currentNode->nrOfEntities;
+	returnValue += (int)m_nodes[nodeIndex].entities.size();
 
 	return returnValue;
 }
 
-int Octree::frustumCulledDrawRec(const Frustum& frustum, Node* currentNode) {
+int Octree::frustumCulledDrawRec(const Frustum& frustum, int nodeIndex) {
 	int returnValue = 0;
+	const Node& currentNode = m_nodes[nodeIndex];
+
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; i++) {
+		corners[i] = currentNode.position + currentNode.halfSize * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+	}
 
 	//Check if node is in frustum
-	BoundingBox* nodeBoundingBox = currentNode->bbEntity->getComponent<BoundingBoxComponent>()->getBoundingBox();
-	if (Intersection::FrustumWithAabb(frustum, nodeBoundingBox->getCornersWithUpdate())) {
+	if (Intersection::FrustumWithAabb(frustum, corners)) {
 		//In frustum
 
 		//Draw meshes in node
-		for (int i = 0; i < currentNode->nrOfEntities; i++) {
+		for (Entity* e : currentNode.entities) {
 			// Let the renderer know that this entity should be rendered.
-			auto* cullComponent = currentNode->entities[i]->getComponent<CullingComponent>();
+			auto* cullComponent = e->getComponent<CullingComponent>();
 			if (cullComponent) {
 				cullComponent->isVisible = true;
 			}
@@ -453,28 +611,112 @@ int Octree::frustumCulledDrawRec(const Frustum& frustum, Node* currentNode) {
 		}
 
 		//Call draw for all children
-		for (unsigned int i = 0; i < currentNode->childNodes.size(); i++) {
-			returnValue += frustumCulledDrawRec(frustum, &currentNode->childNodes[i]);
+		const int firstChild = currentNode.firstChild;
+		for (int i = firstChild; firstChild >= 0 && i < firstChild + 8; i++) {
+			returnValue += frustumCulledDrawRec(frustum, i);
 		}
 	}
 	return returnValue;
 }
 
-void Octree::addEntity(Entity* newEntity) {
+void Octree::insertEntity(Entity* newEntity) {
 	//See if the base node needs to be bigger
-	glm::vec3 directionVec = findCornerOutside(newEntity, &m_baseNode);
+	glm::vec3 directionVec = findCornerOutside(newEntity, ROOT_NODE);
 
 	if (glm::length(directionVec) != 0.0f) {
 		//Entity is outside base node
 		//Create bigger base node
 		expandBaseNode(directionVec);
 		//Recall this function to try to add the mesh again
-		addEntity(newEntity);
+		insertEntity(newEntity);
 	} else {
-		addEntityRec(newEntity, &m_baseNode);
+		addEntityRec(newEntity, ROOT_NODE);
 	}
 }
 
+void Octree::updateTriangleCaches() {
+	for (size_t i = 0; i < m_uncachedEntities.size(); i++) {
+		auto it = m_entityInfos.find(m_uncachedEntities[i]);
+		bool done = (it == m_entityInfos.end() || it->second.triangleCache);
+
+		if (!done && m_updateCount - it->second.lastChangedUpdate >= STATIC_UPDATES_BEFORE_CACHING) {
+			it->second.triangleCache = buildTriangleCache(it->first);
+			done = true;
+		}
+
+		if (done) {
+			m_uncachedEntities[i] = m_uncachedEntities.back();
+			m_uncachedEntities.pop_back();
+			i--;
+		}
+	}
+}
+
+std::unique_ptr<Octree::TriangleCache> Octree::buildTriangleCache(Entity* entity) const {
+	const ModelComponent* model = entity->getComponent<ModelComponent>();
+	const TransformComponent* transform = entity->getComponent<TransformComponent>();
+	if (!model || !model->getModel()) {
+		return nullptr;
+	}
+
+	auto cache = std::make_unique<TriangleCache>();
+	cache->model = model->getModel();
+	if (transform) {
+		cache->transform = transform->getMatrixWithoutUpdate();
+	}
+
+	const glm::mat4& transformMatrix = cache->transform;
+	for (unsigned int j = 0; j < model->getModel()->getNumberOfMeshes(); j++) {
+		const Mesh::Data& meshData = model->getModel()->getMesh(j)->getData();
+		const unsigned int numIndices = (meshData.indices) ? meshData.numIndices : meshData.numVertices;
+
+		std::vector<TriangleBVH::Triangle> triangles(numIndices / 3);
+		for (unsigned int k = 0; k + 2 < numIndices; k += 3) {
+			TriangleBVH::Triangle& t = triangles[k / 3];
+			if (meshData.indices) { //Has indices
+				t.v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k]].vec, 1.0f));
+				t.v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 1]].vec, 1.0f));
+				t.v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[meshData.indices[k + 2]].vec, 1.0f));
+			} else { //Does not have indices
+				t.v0 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k].vec, 1.0f));
+				t.v1 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 1].vec, 1.0f));
+				t.v2 = glm::vec3(transformMatrix * glm::vec4(meshData.positions[k + 2].vec, 1.0f));
+			}
+		}
+
+		cache->meshes.emplace_back();
+		cache->meshes.back().build(std::move(triangles));
+	}
+
+	return cache;
+}
+
+const Octree::TriangleCache* Octree::getTriangleCache(Entity* entity, const ModelComponent* model, const glm::mat4& transformMatrix) const {
+	auto it = m_entityInfos.find(entity);
+	if (it == m_entityInfos.end() || !it->second.triangleCache) {
+		return nullptr;
+	}
+
+	const TriangleCache* cache = it->second.triangleCache.get();
+	// The bounding box might not have caught up with a changed transform or model yet
+	if (cache->model != model->getModel() || cache->transform != transformMatrix) {
+		return nullptr;
+	}
+	return cache;
+}
+
+void Octree::addEntity(Entity* newEntity) {
+	auto result = m_entityInfos.emplace(newEntity, EntityInfo());
+	if (result.second) {
+		result.first->second.lastChangedUpdate = m_updateCount;
+		if (newEntity->hasComponent<ModelComponent>()) {
+			m_uncachedEntities.push_back(newEntity);
+		}
+	}
+
+	insertEntity(newEntity);
+}
+
 void Octree::addEntities(std::vector<Entity*>* newEntities) {
 	for (unsigned int i = 0; i < newEntities->size(); i++) {
 		addEntity(newEntities->at(i));
@@ -482,7 +724,8 @@ void Octree::addEntities(std::vector<Entity*>* newEntities) {
 }
 
 void Octree::removeEntity(Entity* entityToRemove) {
-	removeEntityRec(entityToRemove, &m_baseNode);
+	removeEntityRec(entityToRemove, ROOT_NODE);
+	m_entityInfos.erase(entityToRemove);
 }
 
 void Octree::removeEntities(std::vector<Entity*> entitiesToRemove) {
@@ -492,24 +735,114 @@ void Octree::removeEntities(std::vector<Entity*> entitiesToRemove) {
 }
 
 void Octree::update() {
-	std::vector<Entity*> entitiesToReAdd;
-	updateRec(&m_baseNode, &entitiesToReAdd);
+	m_updateCount++;
 
-	addEntities(&entitiesToReAdd);
+	m_lastQueryStats.queries = m_numQueries.exchange(0);
+	m_lastQueryStats.resultAllocations = m_numResultAllocations.exchange(0);
 
-	entitiesToReAdd.clear();
+	std::vector<Entity*> entitiesToReAdd;
+	updateRec(ROOT_NODE, &entitiesToReAdd);
+
+	for (Entity* e : entitiesToReAdd) {
+		// Moving entities are not cached until they have stopped
+		EntityInfo& info = m_entityInfos[e];
+		info.lastChangedUpdate = m_updateCount;
+		if (info.triangleCache) {
+			info.triangleCache.reset();
+			m_uncachedEntities.push_back(e);
+		}
+		insertEntity(e);
+	}
 
-	pruneTreeRec(&m_baseNode);
+	pruneTreeRec(ROOT_NODE);
+
+	updateTriangleCaches();
 }
 
 void Octree::getCollisions(Entity* entity, const BoundingBox* entityBoundingBox, std::vector<CollisionInfo>* outCollisionData, const bool doSimpleCollisions, const bool checkBackfaces) {
-	getCollisionsRec(entity, entityBoundingBox, &m_baseNode, outCollisionData, doSimpleCollisions, checkBackfaces);
+	m_numQueries.fetch_add(1, std::memory_order_relaxed);
+	getCollisionsRec(entity, entityBoundingBox, ROOT_NODE, outCollisionData, doSimpleCollisions, checkBackfaces);
 }
 
 void Octree::getRayIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces) {
-	getRayIntersectionRec(rayStart, rayDir, &m_baseNode, outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces);
+	rayQuery(rayStart, rayDir, outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces, RayQueryMode::ALL_HITS, std::numeric_limits<float>::max());
+}
+
+void Octree::getClosestRayIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces) {
+	rayQuery(rayStart, rayDir, outIntersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces, RayQueryMode::CLOSEST_HIT, std::numeric_limits<float>::max());
+}
+
+bool Octree::hasRayIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, float maxDistance, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces) {
+	// Nothing is added to the info vector in this mode, so this doesn't allocate
+	RayIntersectionInfo intersectionData;
+	rayQuery(rayStart, rayDir, &intersectionData, ignoreThis, padding, doSimpleIntersections, checkBackfaces, RayQueryMode::ANY_HIT, maxDistance);
+	return intersectionData.closestHit >= 0.0f;
 }
 
 int Octree::frustumCulledDraw(Camera& camera) {
-	return frustumCulledDrawRec(camera.getFrustum(), &m_baseNode);
-}
\ No newline at end of file
+	return frustumCulledDrawRec(camera.getFrustum(), ROOT_NODE);
+}
+
+void Octree::setDebugVisualization(bool enabled) {
+	if (m_debugVisualization == enabled) {
+		return;
+	}
+	m_debugVisualization = enabled;
+
+	// Walk the tree instead of the array to skip the nodes in freed child blocks
+	std::vector<int> nodesToVisit = { ROOT_NODE };
+	while (!nodesToVisit.empty()) {
+		const int nodeIndex = nodesToVisit.back();
+		nodesToVisit.pop_back();
+
+		if (enabled) {
+			createDebugEntity(nodeIndex);
+		} else {
+			destroyDebugEntity(nodeIndex);
+		}
+
+		const int firstChild = m_nodes[nodeIndex].firstChild;
+		for (int i = firstChild; firstChild >= 0 && i < firstChild + 8; i++) {
+			nodesToVisit.push_back(i);
+		}
+	}
+}
+
+bool Octree::isDebugVisualizationEnabled() const {
+	return m_debugVisualization;
+}
+
+void Octree::getTrianglePackets(std::vector<TrianglePacket>* outPackets) const {
+	for (auto& entityInfo : m_entityInfos) {
+		const ModelComponent* model = entityInfo.first->getComponent<ModelComponent>();
+		const TransformComponent* transform = entityInfo.first->getComponent<TransformComponent>();
+		if (!model || !model->getModel()) {
+			continue;
+		}
+
+		glm::mat4 transformMatrix;
+		if (transform) {
+			transformMatrix = transform->getMatrixWithoutUpdate();
+		}
+		ForEachTrianglePacket(model->getModel(), transformMatrix, [&](const TrianglePacket& triangles) {
+			outPackets->push_back(triangles);
+			return false;
+		});
+	}
+}
+
+size_t Octree::getNumNodes() const {
+	return m_nodes.size() - m_freeChildBlocks.size() * 8;
+}
+
+size_t Octree::getNumCachedEntities() const {
+	size_t count = 0;
+	for (auto& info : m_entityInfos) {
+		count += (info.second.triangleCache) ? 1 : 0;
+	}
+	return count;
+}
+
+const Octree::QueryStats& Octree::getLastQueryStats() const {
+	return m_lastQueryStats;
+}
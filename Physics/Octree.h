@@ -3,82 +3,139 @@
 #include "BoundingBox.h"
 #include "Sphere.h"
 #include "CollisionShapes.h"
+#include "TriangleBVH.h"
 #include "Sail/entities/Entity.h"
 
+#include <atomic>
+#include <unordered_map>
+
 class Model;
+class ModelComponent;
 class Camera;
 struct Frustum;
 
 class Octree {
 public:
-	class CollisionInfo {
-	public:
-		CollisionInfo() : intersectionAxis(glm::vec3(0.0f)), intersectionPosition(glm::vec3(0.0f)), shape(nullptr), entity(nullptr) {};
-		~CollisionInfo() {
-			if (shape != nullptr) {
-				shape->keeperTracker--;
-				if (shape->keeperTracker == 0) {
-					delete shape;
-				}
-			}
-		};
-
-
-		CollisionInfo(const CollisionInfo& other) {
-			this->intersectionAxis = other.intersectionAxis;
-			this->intersectionPosition = other.intersectionPosition;
-			other.shape->keeperTracker++;
-			this->shape = other.shape;
-			this->entity = other.entity;
-		}
-		CollisionInfo& operator=(const CollisionInfo& other) {
-			this->intersectionAxis = other.intersectionAxis;
-			this->intersectionPosition = other.intersectionPosition;
-			other.shape->keeperTracker++;
-			this->shape = other.shape;
-			this->entity = other.entity;
-			return *this;
-		}
-
-		glm::vec3 intersectionAxis;
-		glm::vec3 intersectionPosition;
-		CollisionShape* shape;
-		Entity* entity;
+	// Plain value type, results can be copied and stored without any extra allocations
+	struct CollisionInfo {
+		glm::vec3 intersectionAxis = glm::vec3(0.0f);
+		glm::vec3 intersectionPosition = glm::vec3(0.0f);
+		CollisionShape shape;
+		Entity* entity = nullptr;
 	};
 
+	/*
+		Reuse the same instance between queries, clear() keeps the memory of the info vector
+		closestHit is the distance to the closest hit along the ray and closestHitIndex its index in info, both are -1 if nothing was hit
+	*/
 	struct RayIntersectionInfo {
 		float closestHit = -1.0f;
 		int closestHitIndex = -1;
 		std::vector<Octree::CollisionInfo> info;
+
+		void clear() {
+			closestHit = -1.0f;
+			closestHitIndex = -1;
+			info.clear();
+		}
+	};
+
+	// Counted since the last call to update()
+	struct QueryStats {
+		unsigned int queries = 0;
+		unsigned int resultAllocations = 0; // Times a query had to grow the caller's result vector
 	};
 
 private:
+	/*
+		Nodes are stored in one flat array and reference each other by index.
+		The eight children of a node are always stored next to each other, starting at firstChild.
+		The root is always at index 0.
+	*/
 	struct Node {
-		std::vector<Node> childNodes;
-		Node* parentNode = nullptr;
-		Entity::SPtr bbEntity;
-		int nrOfEntities = 0;
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 halfSize = glm::vec3(0.0f);
+		int firstChild = -1; // -1 for leaf nodes
+		int parent = -1;
 		std::vector<Entity*> entities;
+		Entity::SPtr debugEntity; // Only created while the debug visualization is on
+	};
+
+	enum class RayQueryMode {
+		ALL_HITS,    // Every hit along the ray is added to the result
+		CLOSEST_HIT, // Children are visited front to back and everything behind the closest hit so far is skipped
+		ANY_HIT,     // Stops at the first hit closer than the max distance, nothing is added to the result
 	};
 
-	Node m_baseNode;
+	static constexpr int ROOT_NODE = 0;
+	// Number of updates an entity's bounding box has to stay unchanged before its triangles are cached
+	static constexpr unsigned int STATIC_UPDATES_BEFORE_CACHING = 10;
+
+	/*
+		World space triangles of a collidable entity's model, one tree per mesh.
+		Only valid as long as the entity has the same model and transform matrix as when it was built.
+	*/
+	struct TriangleCache {
+		const Model* model = nullptr;
+		glm::mat4 transform;
+		std::vector<TriangleBVH> meshes;
+	};
+
+	struct EntityInfo {
+		unsigned int lastChangedUpdate = 0;
+		std::unique_ptr<TriangleCache> triangleCache;
+	};
+
+	std::vector<Node> m_nodes;
+	std::vector<int> m_freeChildBlocks;
+
+	// Every entity in the tree has an entry, only modified outside of the queries
+	std::unordered_map<Entity*, EntityInfo> m_entityInfos;
+	std::vector<Entity*> m_uncachedEntities;
+	unsigned int m_updateCount;
+
+	std::atomic<unsigned int> m_numQueries;
+	std::atomic<unsigned int> m_numResultAllocations;
+	QueryStats m_lastQueryStats;
 
 	Model* m_boundingBoxModel;
+	bool m_debugVisualization;
 
 	int m_softLimitMeshes;
 	float m_minimumNodeHalfSize;
 
+	// Returns the index of the first of eight new nodes
+	int allocateChildBlock();
+	void freeChildBlock(int firstChild);
+	void createDebugEntity(int nodeIndex);
+	void destroyDebugEntity(int nodeIndex);
+
+	void insertEntity(Entity* newEntity);
+	void updateTriangleCaches();
+	std::unique_ptr<TriangleCache> buildTriangleCache(Entity* entity) const;
+	// Returns nullptr if the entity's triangles aren't cached or if the cache is outdated
+	const TriangleCache* getTriangleCache(Entity* entity, const ModelComponent* model, const glm::mat4& transformMatrix) const;
+
+	template<typename T>
+	void addResult(std::vector<T>* results, const T& result);
+
 	void expandBaseNode(glm::vec3 direction);
-	glm::vec3 findCornerOutside(Entity* entity, Node* testNode);
-	bool addEntityRec(Entity* newEntity, Node* currentNode);
-	bool removeEntityRec(Entity* entityToRemove, Node* currentNode);
-	void updateRec(Node* currentNode, std::vector<Entity*>* entitiesToReAdd);
-	void getCollisionData(const BoundingBox* entityBoundingBox, Entity* meshEntity, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, std::vector<Octree::CollisionInfo>* outCollisionData, const bool checkBackfaces = false);
-	void getCollisionsRec(Entity* entity, const BoundingBox* entityBoundingBox, Node* currentNode, std::vector<Octree::CollisionInfo>* outCollisionData, const bool doSimpleCollisions, const bool checkBackfaces = false);
-	void getIntersectionData(const glm::vec3& rayStart, const glm::vec3& rayDir, Entity* meshEntity, const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3, RayIntersectionInfo* outIntersectionData, float padding, const bool checkBackfaces = false);
-	void getRayIntersectionRec(const glm::vec3& rayStart, const glm::vec3& rayDir, Node* currentNode, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces);
-	int pruneTreeRec(Node* currentNode);
-	int frustumCulledDrawRec(const Frustum& frustum, Node* currentNode);
+	glm::vec3 findCornerOutside(Entity* entity, int nodeIndex) const;
+	bool addEntityRec(Entity* newEntity, int nodeIndex);
+	bool removeEntityRec(Entity* entityToRemove, int nodeIndex);
+	void updateRec(int nodeIndex, std::vector<Entity*>* entitiesToReAdd);
+	void getCollisionData(const BoundingBox* entityBoundingBox, Entity* meshEntity, const TrianglePacket& triangles, std::vector<Octree::CollisionInfo>* outCollisionData, const bool checkBackfaces);
+	void getCollisionsRec(Entity* entity, const BoundingBox* entityBoundingBox, int nodeIndex, std::vector<Octree::CollisionInfo>* outCollisionData, const bool doSimpleCollisions, const bool checkBackfaces = false);
+	// Returns true if the query is done
+	bool addRayHit(float distance, const CollisionInfo& info, RayIntersectionInfo* outIntersectionData, RayQueryMode mode, float maxDistance);
+	bool getIntersectionData(const glm::vec3& rayStart, const glm::vec3& rayDir, Entity* meshEntity, const TrianglePacket& triangles, RayIntersectionInfo* outIntersectionData, float padding, const bool checkBackfaces, RayQueryMode mode, float maxDistance);
+	// The ray has to hit the node, returns true if the query is done
+	bool getRayIntersectionRec(const glm::vec3& rayStart, const glm::vec3& rayDir, int nodeIndex, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces, RayQueryMode mode, float maxDistance);
+	void rayQuery(const glm::vec3& rayStart, const glm::vec3& rayDir, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis, float padding, const bool doSimpleIntersections, const bool checkBackfaces, RayQueryMode mode, float maxDistance);
+	// Distance beyond which nothing can affect the result of the query anymore
+	static float RayDistanceLimit(const RayIntersectionInfo* intersectionData, RayQueryMode mode, float maxDistance);
+	int pruneTreeRec(int nodeIndex);
+	int frustumCulledDrawRec(const Frustum& frustum, int nodeIndex);
 
 public:
 	Octree(Model *boundingBoxModel);
@@ -93,7 +150,45 @@ public:
 	void update();
 
 	void getCollisions(Entity* entity, const BoundingBox* entityBoundingBox, std::vector<CollisionInfo>* outCollisionData, const bool doSimpleCollisions = false, const bool checkBackfaces = false);
+	/*
+		Finds every hit along the ray
+	*/
 	void getRayIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis = nullptr, float padding = 0.0f, const bool doSimpleIntersections = false, const bool checkBackfaces = false);
+	/*
+		Finds the hit closest to the ray start, info contains at most that one hit
+		Use this instead of getRayIntersection() when only the closest hit is used, it skips everything behind it
+	*/
+	void getClosestRayIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, RayIntersectionInfo* outIntersectionData, Entity* ignoreThis = nullptr, float padding = 0.0f, const bool doSimpleIntersections = false, const bool checkBackfaces = false);
+	/*
+		Returns true if the ray hits anything closer than maxDistance, for line of sight and occlusion checks
+		Stops at the first hit found, which isn't necessarily the closest one
+	*/
+	bool hasRayIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, float maxDistance, Entity* ignoreThis = nullptr, float padding = 0.0f, const bool doSimpleIntersections = false, const bool checkBackfaces = false);
 
 	int frustumCulledDraw(Camera& camera);
-};
\ No newline at end of file
+
+	/*
+		Creates wireframe bounding box entities for all nodes so that they are drawn together with the hitboxes
+		Nodes don't have any entities while this is off
+	*/
+	void setDebugVisualization(bool enabled);
+	bool isDebugVisualizationEnabled() const;
+
+	/*
+		World space triangles of every entity in the tree with a model, for benchmarking the intersection tests
+	*/
+	void getTrianglePackets(std::vector<TrianglePacket>* outPackets) const;
+
+	size_t getNumNodes() const;
+	size_t getNumCachedEntities() const;
+	// Stats for the queries made between the last two calls to update()
+	const QueryStats& getLastQueryStats() const;
+};
+
+template<typename T>
+inline void Octree::addResult(std::vector<T>* results, const T& result) {
+	if (results->size() == results->capacity()) {
+		m_numResultAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+	results->push_back(result);
+}
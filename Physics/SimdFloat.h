@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+	Thin wrappers around SSE and AVX registers so that the batched intersection kernels can be written once for every width.
+	Comparisons return masks with all bits set in the lanes where they are true, select() and the logical operators work on those.
+
+	Float4 is available whenever SSE2 is, which is every x64 build and the default for x86.
+	Float8 is only available in translation units compiled with AVX2 enabled, see IntersectionAVX2.cpp.
+*/
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SAIL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define SAIL_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Simd {
+
+#ifdef SAIL_SIMD_SSE2
+	struct Float4 {
+		static constexpr unsigned int WIDTH = 4;
+		__m128 v;
+
+		// p has to be 16 byte aligned
+		static Float4 Load(const float* p) { return { _mm_load_ps(p) }; }
+		static Float4 Set(float f) { return { _mm_set1_ps(f) }; }
+		static Float4 Zero() { return { _mm_setzero_ps() }; }
+		void store(float* p) const { _mm_storeu_ps(p, v); }
+
+		friend Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+		friend Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+		friend Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+		friend Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+		friend Float4 operator-(Float4 a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; }
+
+		friend Float4 operator<(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+		friend Float4 operator<=(Float4 a, Float4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+		friend Float4 operator>(Float4 a, Float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+		friend Float4 operator&(Float4 a, Float4 b) { return { _mm_and_ps(a.v, b.v) }; }
+		friend Float4 operator|(Float4 a, Float4 b) { return { _mm_or_ps(a.v, b.v) }; }
+		// a & ~b
+		static Float4 AndNot(Float4 a, Float4 b) { return { _mm_andnot_ps(b.v, a.v) }; }
+
+		static Float4 Sqrt(Float4 a) { return { _mm_sqrt_ps(a.v) }; }
+		static Float4 Abs(Float4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+		// Same as glm::min/max, b is only returned if it is smaller/larger than a
+		static Float4 Min(Float4 a, Float4 b) { return { _mm_min_ps(b.v, a.v) }; }
+		static Float4 Max(Float4 a, Float4 b) { return { _mm_max_ps(b.v, a.v) }; }
+		// Lanes where std::signbit(a) != std::signbit(b)
+		static Float4 SignsDiffer(Float4 a, Float4 b) {
+			return { _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(_mm_xor_ps(a.v, b.v)), 31)) };
+		}
+		static Float4 Select(Float4 mask, Float4 ifTrue, Float4 ifFalse) {
+			return { _mm_or_ps(_mm_and_ps(mask.v, ifTrue.v), _mm_andnot_ps(mask.v, ifFalse.v)) };
+		}
+		// One bit per lane
+		static unsigned int MoveMask(Float4 mask) { return static_cast<unsigned int>(_mm_movemask_ps(mask.v)); }
+	};
+#endif
+
+#ifdef SAIL_SIMD_AVX2
+	struct Float8 {
+		static constexpr unsigned int WIDTH = 8;
+		__m256 v;
+
+		// p has to be 32 byte aligned
+		static Float8 Load(const float* p) { return { _mm256_load_ps(p) }; }
+		static Float8 Set(float f) { return { _mm256_set1_ps(f) }; }
+		static Float8 Zero() { return { _mm256_setzero_ps() }; }
+		void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+		friend Float8 operator+(Float8 a, Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+		friend Float8 operator-(Float8 a, Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		friend Float8 operator*(Float8 a, Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+		friend Float8 operator/(Float8 a, Float8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+		friend Float8 operator-(Float8 a) { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; }
+
+		friend Float8 operator<(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		friend Float8 operator<=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+		friend Float8 operator>(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+		friend Float8 operator&(Float8 a, Float8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+		friend Float8 operator|(Float8 a, Float8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+		// a & ~b
+		static Float8 AndNot(Float8 a, Float8 b) { return { _mm256_andnot_ps(b.v, a.v) }; }
+
+		static Float8 Sqrt(Float8 a) { return { _mm256_sqrt_ps(a.v) }; }
+		static Float8 Abs(Float8 a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+		// Same as glm::min/max, b is only returned if it is smaller/larger than a
+		static Float8 Min(Float8 a, Float8 b) { return { _mm256_min_ps(b.v, a.v) }; }
+		static Float8 Max(Float8 a, Float8 b) { return { _mm256_max_ps(b.v, a.v) }; }
+		// Lanes where std::signbit(a) != std::signbit(b)
+		static Float8 SignsDiffer(Float8 a, Float8 b) {
+			return { _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(_mm256_xor_ps(a.v, b.v)), 31)) };
+		}
+		static Float8 Select(Float8 mask, Float8 ifTrue, Float8 ifFalse) { return { _mm256_blendv_ps(ifFalse.v, ifTrue.v, mask.v) }; }
+		// One bit per lane
+		static unsigned int MoveMask(Float8 mask) { return static_cast<unsigned int>(_mm256_movemask_ps(mask.v)); }
+	};
+#endif
+
+}
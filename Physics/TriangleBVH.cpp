@@ -0,0 +1,112 @@
+#include "PhysicsPCH.h"
+
+#include "TriangleBVH.h"
+
+#include <algorithm>
+
+TriangleBVH::TriangleBVH() {
+
+}
+
+TriangleBVH::~TriangleBVH() {
+
+}
+
+void TriangleBVH::build(std::vector<Triangle> triangles) {
+	m_triangles = std::move(triangles);
+	m_numTriangles = m_triangles.size();
+	m_nodes.clear();
+	m_packets.clear();
+	if (m_triangles.empty()) {
+		return;
+	}
+
+	std::vector<glm::vec3> centroids(m_triangles.size());
+	for (size_t i = 0; i < m_triangles.size(); i++) {
+		centroids[i] = (m_triangles[i].v0 + m_triangles[i].v1 + m_triangles[i].v2) / 3.0f;
+	}
+
+	// A binary tree with n leaves has 2n - 1 nodes
+	m_nodes.reserve((m_triangles.size() / MAX_TRIANGLES_PER_LEAF + 1) * 2);
+	m_nodes.emplace_back();
+	buildRec(0, 0, (unsigned int)m_triangles.size(), centroids);
+	m_nodes.shrink_to_fit();
+	m_packets.shrink_to_fit();
+
+	// The packets hold all triangle data needed by the queries
+	m_triangles.clear();
+	m_triangles.shrink_to_fit();
+}
+
+size_t TriangleBVH::getNumTriangles() const {
+	return m_numTriangles;
+}
+
+size_t TriangleBVH::getByteSize() const {
+	return sizeof(*this) + m_nodes.capacity() * sizeof(Node) + m_packets.capacity() * sizeof(TrianglePacket);
+}
+
+void TriangleBVH::buildRec(unsigned int nodeIndex, unsigned int first, unsigned int count, std::vector<glm::vec3>& centroids) {
+	glm::vec3 min(std::numeric_limits<float>::max());
+	glm::vec3 max(-std::numeric_limits<float>::max());
+	glm::vec3 centroidMin = min;
+	glm::vec3 centroidMax = max;
+	for (unsigned int i = first; i < first + count; i++) {
+		const Triangle& t = m_triangles[i];
+		min = glm::min(min, glm::min(t.v0, glm::min(t.v1, t.v2)));
+		max = glm::max(max, glm::max(t.v0, glm::max(t.v1, t.v2)));
+		centroidMin = glm::min(centroidMin, centroids[i]);
+		centroidMax = glm::max(centroidMax, centroids[i]);
+	}
+	m_nodes[nodeIndex].min = min;
+	m_nodes[nodeIndex].max = max;
+
+	if (count <= MAX_TRIANGLES_PER_LEAF) {
+		m_nodes[nodeIndex].first = (unsigned int)m_packets.size();
+		m_nodes[nodeIndex].count = count;
+		m_packets.emplace_back();
+		for (unsigned int i = first; i < first + count; i++) {
+			m_packets.back().add(m_triangles[i].v0, m_triangles[i].v1, m_triangles[i].v2);
+		}
+		return;
+	}
+
+	// Split at the median centroid along the longest axis
+	const glm::vec3 extent = centroidMax - centroidMin;
+	int axis = 0;
+	if (extent.y > extent[axis]) {
+		axis = 1;
+	}
+	if (extent.z > extent[axis]) {
+		axis = 2;
+	}
+
+	// Sort indices instead of the triangles and centroids directly to keep them paired
+	std::vector<unsigned int> order(count);
+	for (unsigned int i = 0; i < count; i++) {
+		order[i] = first + i;
+	}
+	const unsigned int half = count / 2;
+	std::nth_element(order.begin(), order.begin() + half, order.end(), [&](unsigned int a, unsigned int b) {
+		return centroids[a][axis] < centroids[b][axis];
+	});
+
+	std::vector<Triangle> sortedTriangles(count);
+	std::vector<glm::vec3> sortedCentroids(count);
+	for (unsigned int i = 0; i < count; i++) {
+		sortedTriangles[i] = m_triangles[order[i]];
+		sortedCentroids[i] = centroids[order[i]];
+	}
+	std::copy(sortedTriangles.begin(), sortedTriangles.end(), m_triangles.begin() + first);
+	std::copy(sortedCentroids.begin(), sortedCentroids.end(), centroids.begin() + first);
+
+	// Children are allocated next to each other
+	const unsigned int leftChild = (unsigned int)m_nodes.size();
+	m_nodes.emplace_back();
+	m_nodes.emplace_back();
+	m_nodes[nodeIndex].first = leftChild;
+	m_nodes[nodeIndex].count = 0;
+
+	buildRec(leftChild, first, half, centroids);
+	buildRec(leftChild + 1, first + half, count - half, centroids);
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "TrianglePacket.h"
+
+/*
+	Bounding volume hierarchy over a fixed set of triangles.
+	Used by Octree to cache the world space triangles of collidable entities whose transforms don't change,
+	so that queries only have to test the triangles close to the query box or ray.
+
+	The tree is built once and can't be modified, build a new one if the triangles change.
+	Each leaf stores its triangles in one TrianglePacket so that they can be tested together with the batched tests in Intersection.
+*/
+class TriangleBVH {
+public:
+	struct Triangle {
+		glm::vec3 v0;
+		glm::vec3 v1;
+		glm::vec3 v2;
+	};
+
+public:
+	TriangleBVH();
+	~TriangleBVH();
+
+	void build(std::vector<Triangle> triangles);
+
+	/*
+		Calls func(const TrianglePacket&) for every leaf whose bounds overlap the box
+	*/
+	template<typename Func>
+	void queryAabb(const glm::vec3& aabbPos, const glm::vec3& aabbHalfSize, Func&& func) const;
+
+	/*
+		Calls func(const TrianglePacket&) for every leaf whose bounds, grown by padding, are hit by the ray closer than maxDistance
+		Nodes are visited front to back. func returns the new maxDistance, which lets closest hit queries skip everything behind their
+		current hit. Returning a negative value stops the query.
+	*/
+	template<typename Func>
+	void queryRay(const glm::vec3& rayStart, const glm::vec3& rayDir, float padding, float maxDistance, Func&& func) const;
+
+	size_t getNumTriangles() const;
+	size_t getByteSize() const;
+
+private:
+	// Leaves have count > 0 triangles, stored in m_packets[first]
+	// Inner nodes have count == 0, their children are at first and first + 1
+	struct Node {
+		glm::vec3 min;
+		glm::vec3 max;
+		unsigned int first = 0;
+		unsigned int count = 0;
+	};
+
+	static constexpr unsigned int MAX_TRIANGLES_PER_LEAF = TrianglePacket::WIDTH;
+	// Median splits keep the depth at log2(number of leaves), this is enough for any mesh in the game
+	static constexpr unsigned int MAX_DEPTH = 64;
+
+	void buildRec(unsigned int nodeIndex, unsigned int first, unsigned int count, std::vector<glm::vec3>& centroids);
+
+	// Returns the distance to where the ray enters the bounds, or a negative value if it misses them or enters them after maxDistance
+	static float RayHitsBounds(const glm::vec3& rayStart, const glm::vec3& invDir, const glm::vec3& min, const glm::vec3& max, float maxDistance);
+
+private:
+	std::vector<Node> m_nodes;
+	std::vector<TrianglePacket> m_packets;
+	// Only used while building
+	std::vector<Triangle> m_triangles;
+	size_t m_numTriangles = 0;
+};
+
+template<typename Func>
+inline void TriangleBVH::queryAabb(const glm::vec3& aabbPos, const glm::vec3& aabbHalfSize, Func&& func) const {
+	if (m_nodes.empty()) {
+		return;
+	}
+
+	const glm::vec3 queryMin = aabbPos - aabbHalfSize;
+	const glm::vec3 queryMax = aabbPos + aabbHalfSize;
+
+	unsigned int stack[MAX_DEPTH * 2];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const Node& node = m_nodes[stack[--stackSize]];
+		if (glm::any(glm::greaterThan(queryMin, node.max)) || glm::any(glm::lessThan(queryMax, node.min))) {
+			continue;
+		}
+
+		if (node.count > 0) {
+			func(m_packets[node.first]);
+		} else {
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+		}
+	}
+}
+
+template<typename Func>
+inline void TriangleBVH::queryRay(const glm::vec3& rayStart, const glm::vec3& rayDir, float padding, float maxDistance, Func&& func) const {
+	if (m_nodes.empty()) {
+		return;
+	}
+
+	// Division by zero gives infinity which the slab test handles
+	const glm::vec3 invDir = 1.0f / rayDir;
+	const glm::vec3 pad(padding);
+
+	// Entry distances are kept on the stack so that nodes can be skipped if a closer hit was found after they were pushed
+	struct StackEntry {
+		unsigned int node;
+		float distance;
+	};
+	StackEntry stack[MAX_DEPTH * 2];
+	unsigned int stackSize = 0;
+
+	const float rootDistance = RayHitsBounds(rayStart, invDir, m_nodes[0].min - pad, m_nodes[0].max + pad, maxDistance);
+	if (rootDistance < 0.0f) {
+		return;
+	}
+	stack[stackSize++] = { 0, rootDistance };
+
+	while (stackSize > 0) {
+		const StackEntry entry = stack[--stackSize];
+		if (entry.distance > maxDistance) {
+			continue;
+		}
+
+		const Node& node = m_nodes[entry.node];
+		if (node.count > 0) {
+			maxDistance = func(m_packets[node.first]);
+			if (maxDistance < 0.0f) {
+				return;
+			}
+			continue;
+		}
+
+		const float leftDistance = RayHitsBounds(rayStart, invDir, m_nodes[node.first].min - pad, m_nodes[node.first].max + pad, maxDistance);
+		const float rightDistance = RayHitsBounds(rayStart, invDir, m_nodes[node.first + 1].min - pad, m_nodes[node.first + 1].max + pad, maxDistance);
+
+		// Push the farther child first so that the closer one is visited first
+		if (leftDistance >= 0.0f && rightDistance >= 0.0f) {
+			if (leftDistance < rightDistance) {
+				stack[stackSize++] = { node.first + 1, rightDistance };
+				stack[stackSize++] = { node.first, leftDistance };
+			} else {
+				stack[stackSize++] = { node.first, leftDistance };
+				stack[stackSize++] = { node.first + 1, rightDistance };
+			}
+		} else if (leftDistance >= 0.0f) {
+			stack[stackSize++] = { node.first, leftDistance };
+		} else if (rightDistance >= 0.0f) {
+			stack[stackSize++] = { node.first + 1, rightDistance };
+		}
+	}
+}
+
+inline float TriangleBVH::RayHitsBounds(const glm::vec3& rayStart, const glm::vec3& invDir, const glm::vec3& min, const glm::vec3& max, float maxDistance) {
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+	for (int i = 0; i < 3; i++) {
+		if (std::isinf(invDir[i])) {
+			// Parallel to the slab
+			if (rayStart[i] < min[i] || rayStart[i] > max[i]) {
+				return -1.0f;
+			}
+			continue;
+		}
+		float t1 = (min[i] - rayStart[i]) * invDir[i];
+		float t2 = (max[i] - rayStart[i]) * invDir[i];
+		if (t1 > t2) {
+			std::swap(t1, t2);
+		}
+		tMin = glm::max(tMin, t1);
+		tMax = glm::min(tMax, t2);
+		if (tMin > tMax) {
+			return -1.0f;
+		}
+	}
+	return tMin;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/*
+	Up to WIDTH triangles stored as a structure of arrays, used by the batched intersection tests in Intersection.
+	Lanes at count and above are kept zeroed, a degenerate triangle never intersects anything.
+*/
+struct TrianglePacket {
+	static constexpr unsigned int WIDTH = 8;
+
+	// [vertex][axis][lane]
+	alignas(32) float positions[3][3][WIDTH];
+	unsigned int count;
+
+	TrianglePacket() {
+		clear();
+	}
+
+	void clear() {
+		for (unsigned int v = 0; v < 3; v++) {
+			for (unsigned int a = 0; a < 3; a++) {
+				for (unsigned int l = 0; l < WIDTH; l++) {
+					positions[v][a][l] = 0.0f;
+				}
+			}
+		}
+		count = 0;
+	}
+
+	bool isFull() const {
+		return count == WIDTH;
+	}
+
+	// The packet must not be full
+	void add(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+		set(count++, v0, v1, v2);
+	}
+
+	void set(unsigned int lane, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+		for (unsigned int a = 0; a < 3; a++) {
+			positions[0][a][lane] = v0[a];
+			positions[1][a][lane] = v1[a];
+			positions[2][a][lane] = v2[a];
+		}
+	}
+
+	glm::vec3 getVertex(unsigned int lane, unsigned int vertex) const {
+		return glm::vec3(positions[vertex][0][lane], positions[vertex][1][lane], positions[vertex][2][lane]);
+	}
+};
@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "HeadlessReceiverSystem.h"
+
+#include <cstring>
+
+namespace {
+	// FNV-1a, the same state always hashes to the same value on every machine
+	constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+	constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+	void Hash(std::uint64_t& hash, const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash = (hash ^ bytes[i]) * FNV_PRIME;
+		}
+	}
+
+	template<typename T>
+	void Hash(std::uint64_t& hash, const T& value) {
+		Hash(hash, &value, sizeof(value));
+	}
+}
+
+HeadlessReceiverSystem::HeadlessReceiverSystem() : ReceiverBase() {
+	m_eventHash = FNV_OFFSET;
+}
+
+HeadlessReceiverSystem::~HeadlessReceiverSystem() {
+}
+
+void HeadlessReceiverSystem::init(Netcode::PlayerID player) {
+	initBase(player);
+	m_entities.clear();
+	m_waterHits.clear();
+	m_numEvents = 0;
+	m_eventHash = FNV_OFFSET;
+}
+
+void HeadlessReceiverSystem::handleIncomingData(const std::string& data) {
+}
+
+void HeadlessReceiverSystem::update(float dt) {
+}
+
+size_t HeadlessReceiverSystem::getNumEntities() {
+	return m_entities.size();
+}
+
+size_t HeadlessReceiverSystem::getNumEvents() const {
+	return m_numEvents;
+}
+
+std::uint64_t HeadlessReceiverSystem::getChecksum() const {
+	std::uint64_t hash = m_eventHash;
+	for (const auto& [id, e] : m_entities) {
+		Hash(hash, id);
+		Hash(hash, e.position);
+		Hash(hash, e.euler);
+		Hash(hash, e.rotation);
+		Hash(hash, e.velocity);
+		Hash(hash, e.center);
+		Hash(hash, e.animation);
+		Hash(hash, e.animationTime);
+		Hash(hash, e.pitch);
+		Hash(hash, e.health);
+		Hash(hash, e.sanity);
+		Hash(hash, e.lit);
+		Hash(hash, e.held);
+	}
+	for (const auto& [cell, hits] : m_waterHits) {
+		Hash(hash, cell);
+		Hash(hash, hits);
+	}
+	return hash;
+}
+
+HeadlessReceiverSystem::HeadlessEntity& HeadlessReceiverSystem::getEntity(const Netcode::ComponentID id) {
+	return m_entities[id];
+}
+
+void HeadlessReceiverSystem::addEvent(const char* name, const Netcode::ComponentID id) {
+	Hash(m_eventHash, name, std::strlen(name));
+	Hash(m_eventHash, id);
+	m_numEvents++;
+}
+
+
+void HeadlessReceiverSystem::destroyEntity(const Netcode::ComponentID entityID) {
+	m_entities.erase(entityID);
+	addEvent("destroyEntity", entityID);
+}
+
+void HeadlessReceiverSystem::enableSprinklers() {
+	addEvent("enableSprinklers", 0);
+}
+
+void HeadlessReceiverSystem::endMatch(const GameDataForOthersInfo& info) {
+	addEvent("endMatch", 0);
+}
+
+void HeadlessReceiverSystem::extinguishCandle(const Netcode::ComponentID candleID, const Netcode::PlayerID shooterID) {
+	getEntity(candleID).lit = false;
+	addEvent("extinguishCandle", candleID);
+}
+
+void HeadlessReceiverSystem::hitBySprinkler(const Netcode::ComponentID candleOwnerID) {
+	addEvent("hitBySprinkler", candleOwnerID);
+}
+
+void HeadlessReceiverSystem::igniteCandle(const Netcode::ComponentID candleID) {
+	getEntity(candleID).lit = true;
+	addEvent("igniteCandle", candleID);
+}
+
+void HeadlessReceiverSystem::matchEnded() {
+	addEvent("matchEnded", 0);
+}
+
+void HeadlessReceiverSystem::playerDied(const Netcode::ComponentID id, const KillInfo& info) {
+	addEvent("playerDied", id);
+}
+
+void HeadlessReceiverSystem::setAnimation(const Netcode::ComponentID id, const AnimationInfo& info) {
+	HeadlessEntity& e = getEntity(id);
+	e.animation = info.index;
+	e.animationTime = info.time;
+	e.pitch = info.pitch;
+}
+
+void HeadlessReceiverSystem::setCandleHealth(const Netcode::ComponentID candleID, const float health) {
+	getEntity(candleID).health = health;
+}
+
+void HeadlessReceiverSystem::setCandleState(const Netcode::ComponentID id, const bool isHeld) {
+	getEntity(id).held = isHeld;
+	addEvent("setCandleState", id);
+}
+
+void HeadlessReceiverSystem::setLocalPosition(const Netcode::ComponentID id, const glm::vec3& pos) {
+	getEntity(id).position = pos;
+}
+
+void HeadlessReceiverSystem::setLocalRotation(const Netcode::ComponentID id, const glm::vec3& rot) {
+	getEntity(id).euler = rot;
+}
+
+void HeadlessReceiverSystem::setLocalRotation(const Netcode::ComponentID id, const glm::quat& rot) {
+	getEntity(id).rotation = rot;
+}
+
+void HeadlessReceiverSystem::setPlayerStats(const PlayerStatsInfo& info) {
+	addEvent("setPlayerStats", info.player);
+}
+
+void HeadlessReceiverSystem::updateSanity(const Netcode::ComponentID id, const float sanity) {
+	getEntity(id).sanity = sanity;
+}
+
+void HeadlessReceiverSystem::updateProjectile(const Netcode::ComponentID id, const glm::vec3& pos, const glm::vec3& vel) {
+	HeadlessEntity& e = getEntity(id);
+	e.position = pos;
+	e.velocity = vel;
+}
+
+void HeadlessReceiverSystem::spawnProjectile(const ProjectileInfo& info) {
+	HeadlessEntity& e = getEntity(info.projectileID);
+	e.position = info.position;
+	e.velocity = info.velocity;
+	addEvent("spawnProjectile", info.projectileID);
+}
+
+void HeadlessReceiverSystem::submitWaterCells(const Netcode::WaterCells& cells) {
+	for (const Netcode::WaterCells::Cell& cell : cells.getCells()) {
+		m_waterHits[cell.index] += cell.hits;
+	}
+}
+
+void HeadlessReceiverSystem::waterHitPlayer(const Netcode::ComponentID id, const Netcode::ComponentID projectileID) {
+	addEvent("waterHitPlayer", id);
+}
+
+void HeadlessReceiverSystem::spawnPowerup(const int type, const glm::vec3& pos, const Netcode::ComponentID compID, const Netcode::ComponentID parentCompID) {
+	getEntity(compID).position = pos;
+	addEvent("spawnPowerup", compID);
+}
+
+void HeadlessReceiverSystem::destroyPowerup(const Netcode::ComponentID compID, const Netcode::ComponentID playerId) {
+	m_entities.erase(compID);
+	addEvent("destroyPowerup", compID);
+}
+
+void HeadlessReceiverSystem::setCenter(const Netcode::ComponentID compID, const glm::vec3 offset) {
+	getEntity(compID).center = offset;
+}
+
+
+// AUDIO
+void HeadlessReceiverSystem::playerJumped(const Netcode::ComponentID id) {
+	addEvent("playerJumped", id);
+}
+
+void HeadlessReceiverSystem::playerLanded(const Netcode::ComponentID id) {
+	addEvent("playerLanded", id);
+}
+
+void HeadlessReceiverSystem::shootStart(const Netcode::ComponentID id, float frequency) {
+	addEvent("shootStart", id);
+}
+
+void HeadlessReceiverSystem::shootLoop(const Netcode::ComponentID id, float frequency) {
+	addEvent("shootLoop", id);
+}
+
+void HeadlessReceiverSystem::shootEnd(const Netcode::ComponentID id, float frequency) {
+	addEvent("shootEnd", id);
+}
+
+void HeadlessReceiverSystem::runningMetalStart(const Netcode::ComponentID id) {
+	addEvent("runningMetalStart", id);
+}
+
+void HeadlessReceiverSystem::runningWaterMetalStart(const Netcode::ComponentID id) {
+	addEvent("runningWaterMetalStart", id);
+}
+
+void HeadlessReceiverSystem::runningTileStart(const Netcode::ComponentID id) {
+	addEvent("runningTileStart", id);
+}
+
+void HeadlessReceiverSystem::runningWaterTileStart(const Netcode::ComponentID id) {
+	addEvent("runningWaterTileStart", id);
+}
+
+void HeadlessReceiverSystem::runningStopSound(const Netcode::ComponentID id) {
+	addEvent("runningStopSound", id);
+}
+
+void HeadlessReceiverSystem::throwingStartSound(const Netcode::ComponentID id) {
+	addEvent("throwingStartSound", id);
+}
+
+void HeadlessReceiverSystem::throwingEndSound(const Netcode::ComponentID id) {
+	addEvent("throwingEndSound", id);
+}
+
+
+// HOST ONLY, a replay is never played back as the host
+void HeadlessReceiverSystem::endMatchAfterTimer(const float dt) {
+}
+
+void HeadlessReceiverSystem::mergeHostsStats() {
+}
+
+void HeadlessReceiverSystem::prepareEndScreen(const Netcode::PlayerID sender, const EndScreenInfo& info) {
+	addEvent("prepareEndScreen", sender);
+}
+
+
+void HeadlessReceiverSystem::playerDisconnect(const Netcode::PlayerID playerID) {
+	addEvent("playerDisconnect", playerID);
+}
+
+// There are no entities, everything is looked up in m_entities
+Entity* HeadlessReceiverSystem::findFromNetID(const Netcode::ComponentID id) const {
+	return nullptr;
+}
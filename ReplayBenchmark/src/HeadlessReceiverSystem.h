@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Sail/entities/systems/network/receivers/ReceiverBase.h"
+
+#include <map>
+
+/*
+  Receives the packets of a replay without a game to apply them to. There are no entities, renderer or resources,
+  everything the messages would change is kept in plain structs instead so that reading a replay can be timed on its own.
+
+  getChecksum() hashes that state, two runs over the same ticks of the same replay have to end with the same checksum.
+*/
+class HeadlessReceiverSystem : public ReceiverBase {
+public:
+	HeadlessReceiverSystem();
+	virtual ~HeadlessReceiverSystem();
+
+	void init(Netcode::PlayerID player);
+	void handleIncomingData(const std::string& data) override;
+	void update(float dt) override;
+
+	size_t getNumEntities() override;
+	size_t getNumEvents() const;
+	std::uint64_t getChecksum() const;
+
+private:
+	void destroyEntity   (const Netcode::ComponentID entityID)                                       override;
+	void enableSprinklers()                                                                          override;
+	void endMatch        (const GameDataForOthersInfo& info)                                         override;
+	void extinguishCandle(const Netcode::ComponentID candleID, const Netcode::PlayerID shooterID)    override;
+	void hitBySprinkler  (const Netcode::ComponentID candleOwnerID)                                  override;
+	void igniteCandle    (const Netcode::ComponentID candleID)                                       override;
+	void matchEnded      ()                                                                          override;
+	void playerDied      (const Netcode::ComponentID id, const KillInfo& info)                       override;
+	void setAnimation    (const Netcode::ComponentID id, const AnimationInfo& info)                  override;
+	void setCandleHealth (const Netcode::ComponentID candleID, const float health)                   override;
+	void setCandleState  (const Netcode::ComponentID id, const bool isHeld)                          override;
+	void setLocalPosition(const Netcode::ComponentID id, const glm::vec3& pos)                       override;
+	void setLocalRotation(const Netcode::ComponentID id, const glm::vec3& rot)                       override;
+	void setLocalRotation(const Netcode::ComponentID id, const glm::quat& rot)                       override;
+	void setPlayerStats  (const PlayerStatsInfo& info)                                               override;
+	void updateSanity    (const Netcode::ComponentID id, const float sanity)                         override;
+	void updateProjectile(const Netcode::ComponentID id, const glm::vec3& pos, const glm::vec3& vel) override;
+	void spawnProjectile (const ProjectileInfo& info)                                                override;
+	void submitWaterCells(const Netcode::WaterCells& cells)                                          override;
+	void waterHitPlayer  (const Netcode::ComponentID id, const Netcode::ComponentID projectileID)    override;
+	void spawnPowerup(const int type, const glm::vec3& pos, const Netcode::ComponentID compID, const Netcode::ComponentID parentCompID) override;
+	void destroyPowerup(const Netcode::ComponentID compID, const Netcode::ComponentID playerId)     override;
+	void setCenter(const Netcode::ComponentID compID, const glm::vec3 offset)                        override;
+
+	// AUDIO
+	void playerJumped (const Netcode::ComponentID id)                  override;
+	void playerLanded (const Netcode::ComponentID id)                  override;
+	void shootStart   (const Netcode::ComponentID id, float frequency) override;
+	void shootLoop    (const Netcode::ComponentID id, float frequency) override;
+	void shootEnd     (const Netcode::ComponentID id, float frequency) override;
+	void runningMetalStart     (const Netcode::ComponentID id)         override;
+	void runningWaterMetalStart(const Netcode::ComponentID id)         override;
+	void runningTileStart      (const Netcode::ComponentID id)         override;
+	void runningWaterTileStart (const Netcode::ComponentID id)         override;
+	void runningStopSound      (const Netcode::ComponentID id)         override;
+	void throwingStartSound    (const Netcode::ComponentID id)         override;
+	void throwingEndSound      (const Netcode::ComponentID id)         override;
+
+	// HOST ONLY
+	void endMatchAfterTimer(const float dt) override;
+	void mergeHostsStats()                  override;
+	void prepareEndScreen(const Netcode::PlayerID sender, const EndScreenInfo& info) override;
+
+	// NOT FROM SERIALIZED MESSAGES
+	void playerDisconnect(const Netcode::PlayerID playerID) override;
+
+	// Helper function
+	Entity* findFromNetID(const Netcode::ComponentID id) const override;
+
+private:
+	// What the messages have set on an entity
+	struct HeadlessEntity {
+		glm::vec3 position = glm::vec3(0.f);
+		glm::vec3 euler = glm::vec3(0.f);
+		glm::quat rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
+		glm::vec3 velocity = glm::vec3(0.f);
+		glm::vec3 center = glm::vec3(0.f);
+		unsigned int animation = 0;
+		float animationTime = 0.f;
+		float pitch = 0.f;
+		float health = 0.f;
+		float sanity = 0.f;
+		bool lit = true;
+		bool held = true;
+	};
+
+	// Creates the entity the first time it is mentioned, the same as the receivers create them from the first message
+	HeadlessEntity& getEntity(const Netcode::ComponentID id);
+	void addEvent(const char* name, const Netcode::ComponentID id);
+
+private:
+	// Sorted so that the checksum doesn't depend on the order of a hash map
+	std::map<Netcode::ComponentID, HeadlessEntity> m_entities;
+	// Hits per water cell, what the renderer would add to the water voxels
+	std::map<std::uint32_t, unsigned int> m_waterHits;
+	// Every event and who it was for, in the order they were read
+	size_t m_numEvents = 0;
+	std::uint64_t m_eventHash = 0;
+};
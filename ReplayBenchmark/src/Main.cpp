@@ -0,0 +1,185 @@
+#include "pch.h"
+#include "HeadlessReceiverSystem.h"
+#include "Network/NWrapperSingleton.h"
+#include "Sail/entities/ECS.h"
+#include "Sail/entities/systems/Gameplay/LevelSystem/LevelSystem.h"
+#include "Sail/netcode/ReplayFile.h"
+#include "Sail/utils/Benchmarks/ReplayBenchmark.h"
+#include "Sail/TimeSettings.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+/*
+  Times how long it takes to read the ticks of a replay, without a window, renderer or resources so that it can run on
+  a build server. Takes the replay, the number of runs with -r <runs> and the number of ticks with -t <ticks>.
+
+  Every run starts from the first tick with rand() seeded from the map seed the match was recorded with, the same
+  way the level is generated, and feeds the recorded packets to ReceiverBase::processData() one tick at a time.
+  The packets are applied to a HeadlessReceiverSystem instead of entities, the checksum of its state at the end
+  is printed after every run and the tool fails if two runs don't end with the same checksum.
+
+  For the time the systems take when the replay is played back in the game, see the "benchmark replay" console command.
+*/
+
+struct ReplayInfo {
+	std::vector<Player> players;
+	int seed = 0;
+	int sizeX = 1;
+	int sizeY = 1;
+};
+
+// Same metadata as MatchRecordSystem::initReplay() reads, only the map settings are needed from the settings
+static bool ReadMetadata(const Netcode::ReplayReader& reader, ReplayInfo& info) {
+	size_t metadataSize = 0;
+	const char* metadata = reader.getMetadata(metadataSize);
+	const char* metadataEnd = metadata + metadataSize;
+	auto read = [&](void* dst, size_t size) {
+		if (size > (size_t)(metadataEnd - metadata)) {
+			return false;
+		}
+		std::memcpy(dst, metadata, size);
+		metadata += size;
+		return true;
+	};
+
+	unsigned np = 0;
+	unsigned strLen = 0;
+	if (!read(&np, sizeof(np))) {
+		return false;
+	}
+	for (unsigned i = 0; i < np; i++) {
+		Player p;
+		strLen = 0;
+		if (!read(&p.id, 1) || !read(&p.team, 1) || !read(&strLen, sizeof(strLen))) {
+			return false;
+		}
+		p.name.resize(std::min<size_t>(strLen, metadataEnd - metadata));
+		read(&p.name[0], p.name.size());
+		info.players.push_back(p);
+	}
+
+	strLen = 0;
+	if (!read(&strLen, sizeof(strLen))) {
+		return false;
+	}
+	std::string settings(std::min<size_t>(strLen, metadataEnd - metadata), '\0');
+	read(&settings[0], settings.size());
+
+	// Lines of name=value under #area, see SettingStorage::serialize()
+	std::istringstream lines(settings);
+	std::string line;
+	std::string area;
+	while (std::getline(lines, line)) {
+		if (!line.empty() && line[0] == '#') {
+			area = line.substr(1);
+			continue;
+		}
+		const size_t divider = line.find('=');
+		if (area != "map" || divider == std::string::npos) {
+			continue;
+		}
+		const std::string name = line.substr(0, divider);
+		const int value = static_cast<int>(std::atof(line.c_str() + divider + 1));
+		if (name == "seed") {
+			info.seed = value;
+		} else if (name == "sizeX") {
+			info.sizeX = value;
+		} else if (name == "sizeY") {
+			info.sizeY = value;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int numRuns = 3;
+	size_t numTicks = 0;
+	std::string path;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "-r" && i + 1 < argc) {
+			numRuns = static_cast<unsigned int>(std::max(std::atoi(argv[++i]), 1));
+		} else if (arg == "-t" && i + 1 < argc) {
+			numTicks = static_cast<size_t>(std::max(std::atoi(argv[++i]), 0));
+		} else {
+			path = arg;
+		}
+	}
+	if (path.empty()) {
+		std::cout << "Usage: ReplayBenchmark [-r <runs>] [-t <ticks>] <replay>\n"
+			<< "Times reading the ticks of a " << REPLAY_EXTENSION << " replay without the game, every tick if -t isn't given\n";
+		return 1;
+	}
+
+	Netcode::ReplayReader reader;
+	if (!reader.open(path)) {
+		std::cerr << "Could not open " << path << ", replays in the old format have to be converted with ReplayConverter first\n";
+		return 1;
+	}
+	ReplayInfo info;
+	if (!ReadMetadata(reader, info)) {
+		std::cerr << "Could not read the players and settings of " << path << "\n";
+		return 1;
+	}
+	numTicks = (numTicks == 0) ? reader.getNumTicks() : std::min(numTicks, reader.getNumTicks());
+
+	// The players are looked up by the error messages of packets that can't be read
+	NWrapperSingleton::getInstance().resetPlayerList();
+	for (const Player& p : info.players) {
+		NWrapperSingleton::getInstance().playerJoined(p, false);
+	}
+	const Netcode::PlayerID myPlayerID = static_cast<Netcode::PlayerID>(info.players.size());
+
+	// The transform snapshots are quantized within the bounds of the recorded map, see TransformSnapshot::Bounds::FromLevel()
+	LevelSystem* level = ECS::Instance()->createSystem<LevelSystem>();
+	level->seed = info.seed;
+	level->xsize = info.sizeX;
+	level->ysize = info.sizeY;
+	level->generateMap();
+
+	std::vector<Netcode::ReplayReader::Packet> packets;
+	std::queue<std::string> tickPackets;
+	HeadlessReceiverSystem receiver;
+	std::uint64_t firstChecksum = 0;
+	bool reproducible = true;
+
+	for (unsigned int run = 0; run < numRuns; run++) {
+		srand(info.seed);
+		receiver.init(myPlayerID);
+
+		Benchmarks::ReplayBenchmark benchmark;
+		benchmark.start(path + ", run " + std::to_string(run + 1) + " of " + std::to_string(numRuns) + ", headless", numTicks);
+		for (size_t tick = 0; tick < numTicks; tick++) {
+			reader.readTick(tick, packets);
+			for (const Netcode::ReplayReader::Packet& packet : packets) {
+				tickPackets.emplace(packet.data, packet.size);
+			}
+
+			benchmark.beginTick();
+			benchmark.time("ReceiverBase::processData", [&]() {
+				receiver.processData(TIMESTEP, tickPackets);
+			});
+			benchmark.endTick();
+		}
+
+		const std::uint64_t checksum = receiver.getChecksum();
+		std::cout << benchmark.getReport() << receiver.getNumEntities() << " entities, " << receiver.getNumEvents() << " events, checksum "
+			<< std::hex << checksum << std::dec << "\n\n";
+		if (run == 0) {
+			firstChecksum = checksum;
+		} else if (checksum != firstChecksum) {
+			reproducible = false;
+		}
+	}
+
+	ECS::Instance()->destroyAllSystems();
+
+	if (!reproducible) {
+		std::cerr << "The runs ended in different states, the timings can't be compared\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "Sail/netcode/ReplayFile.h"
+#include "Sail/entities/systems/network/receivers/MatchRecordSystem.h"
+
+#include <filesystem>
+#include <iostream>
+
+/*
+  Converts replays recorded before replays had an index and keyframes to the current format.
+  Takes replay files and directories to look for replays in, and the keyframe interval in ticks with -k <ticks>.
+  Every replay is replaced by the converted one and the old file is kept next to it with LEGACY_EXTENSION added.
+
+  Run it from the game's directory, keyframes are compressed with the packet dictionary the game uses.
+*/
+
+constexpr char LEGACY_EXTENSION[] = ".legacy";
+
+static bool ConvertReplay(const std::filesystem::path& path, unsigned int keyframeInterval) {
+	if (!Netcode::IsLegacyReplay(path.string())) {
+		std::cout << "Skipping " << path.string() << ", it is already in the current format\n";
+		return true;
+	}
+
+	std::filesystem::path converted = path;
+	converted += ".converting";
+	std::filesystem::path legacy = path;
+	legacy += LEGACY_EXTENSION;
+
+	if (!Netcode::ConvertLegacyReplay(path.string(), converted.string(), keyframeInterval)) {
+		std::cerr << "Could not convert " << path.string() << "\n";
+		std::error_code err;
+		std::filesystem::remove(converted, err);
+		return false;
+	}
+
+	std::error_code err;
+	std::filesystem::rename(path, legacy, err);
+	if (!err) {
+		std::filesystem::rename(converted, path, err);
+	}
+	if (err) {
+		std::cerr << "Could not replace " << path.string() << ": " << err.message() << "\n";
+		return false;
+	}
+
+	Netcode::ReplayReader reader;
+	if (reader.open(path.string())) {
+		std::cout << "Converted " << path.string() << ": " << reader.getNumTicks() << " ticks, " << reader.getNumKeyframes() << " keyframes\n";
+	}
+	return true;
+}
+
+static void FindReplays(const std::filesystem::path& directory, std::vector<std::filesystem::path>& replays) {
+	std::error_code err;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory, err)) {
+		if (entry.path().extension() == REPLAY_EXTENSION) {
+			replays.push_back(entry.path());
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int keyframeInterval = Netcode::ReplayWriter::DEFAULT_KEYFRAME_INTERVAL;
+	std::vector<std::filesystem::path> replays;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "-k" && i + 1 < argc) {
+			keyframeInterval = static_cast<unsigned int>(std::max(std::atoi(argv[++i]), 1));
+		} else if (std::filesystem::is_directory(arg)) {
+			FindReplays(arg, replays);
+		} else {
+			replays.emplace_back(arg);
+		}
+	}
+
+	// Without any replays given, the ones the game has saved
+	if (replays.empty() && std::filesystem::is_directory(REPLAY_PATH)) {
+		FindReplays(REPLAY_PATH, replays);
+	}
+	if (replays.empty()) {
+		std::cout << "Usage: ReplayConverter [-k <ticks between keyframes>] <replay or directory>...\n"
+			<< "Converts old " << REPLAY_EXTENSION << " replays to the indexed format, the ones in " << REPLAY_PATH << " if none are given\n";
+		return 1;
+	}
+
+	int failed = 0;
+	for (const std::filesystem::path& replay : replays) {
+		if (!ConvertReplay(replay, keyframeInterval)) {
+			failed++;
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -3,10 +3,12 @@
 #include "Sail/events/Event.h"
 
 struct NetworkSerializedPackageEvent : public Event {
-	NetworkSerializedPackageEvent(const std::string& _serializedData)
+	NetworkSerializedPackageEvent(const std::string& _serializedData, bool _reliable = true)
 		: Event(Event::Type::NETWORK_SERIALIZED_DATA_RECIEVED)
-		, serializedData(_serializedData) { }
+		, serializedData(_serializedData)
+		, reliable(_reliable) { }
 	~NetworkSerializedPackageEvent() = default;
 
 	const std::string serializedData;
+	const bool reliable; // False for per-tick state received over the unreliable channel
 };
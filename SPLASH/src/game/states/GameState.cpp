@@ -27,6 +27,13 @@
 #include "Sail/graphics/shader/postprocess/BilateralBlurVertical.h"
 #include "Sail/graphics/shader/dxr/ShadePassShader.h"
 #include "Sail/utils/SailImGui/SailImGui.h"
+#include "Sail/utils/Benchmarks/AnimationBenchmark.h"
+#include "Sail/utils/Benchmarks/ECSBenchmark.h"
+#include "Sail/utils/Benchmarks/IntersectionBenchmark.h"
+#include "Sail/utils/Benchmarks/NetworkBenchmark.h"
+#include "Sail/utils/Benchmarks/CompressionBenchmark.h"
+#include "Sail/netcode/PacketDictionary.h"
+#include "Sail/entities/systems/network/receivers/MatchRecordSystem.h"
 
 
 constexpr int SPECTATOR_TEAM = -1;
@@ -251,8 +258,11 @@ GameState::~GameState() {
 	EventDispatcher::Instance().unsubscribe(Event::Type::NETWORK_JOINED, this);
 	EventDispatcher::Instance().unsubscribe(Event::Type::NETWORK_UPDATE_STATE_LOAD_STATUS, this);
 
+	// A replay that restarts the match to seek carries on in the next GameState
 	MatchRecordSystem*& mrs = NWrapperSingleton::getInstance().recordSystem;
-	if (mrs) {
+	if (mrs && mrs->isRestartPending()) {
+		mrs->onMatchRestarted();
+	} else if (mrs) {
 		delete mrs;
 		mrs = nullptr;
 	}
@@ -326,12 +336,13 @@ bool GameState::processInput(float dt) {
 	// Show boudning boxes
 	if (Input::WasKeyJustPressed(KeyBinds::TOGGLE_BOUNDINGBOXES)) {
 		m_componentSystems.boundingboxSubmitSystem->toggleHitboxes();
+		m_octree->setDebugVisualization(!m_octree->isDebugVisualizationEnabled());
 	}
 
 	//Test ray intersection
 	if (Input::IsKeyPressed(KeyBinds::TEST_RAYINTERSECTION)) {
 		Octree::RayIntersectionInfo tempInfo;
-		m_octree->getRayIntersection(m_cam.getPosition(), m_cam.getDirection(), &tempInfo);
+		m_octree->getClosestRayIntersection(m_cam.getPosition(), m_cam.getDirection(), &tempInfo);
 		if (tempInfo.closestHitIndex != -1) {
 			SAIL_LOG("Ray intersection with " + tempInfo.info[tempInfo.closestHitIndex].entity->getName() + ", " + std::to_string(tempInfo.closestHit) + " meters away");
 		}
@@ -429,6 +440,7 @@ void GameState::initSystems(const unsigned char playerID) {
 	m_componentSystems.speedLimitSystem = ECS::Instance()->createSystem<SpeedLimitSystem>();
 
 	m_componentSystems.animationSystem = ECS::Instance()->createSystem<AnimationSystem<RenderInActiveGameComponent>>();
+	m_componentSystems.animationSystem->setLOD(true, &m_cam); // Update distant animations less often
 	m_componentSystems.animationChangerSystem = ECS::Instance()->createSystem<AnimationChangerSystem>();
 
 	m_componentSystems.updateBoundingBoxSystem = ECS::Instance()->createSystem<UpdateBoundingBoxSystem>();
@@ -546,6 +558,7 @@ void GameState::initSystems(const unsigned char playerID) {
 	m_componentSystems.killCamReceiverSystem->init(playerID, &m_cam);
 
 	m_componentSystems.killCamAnimationSystem             = ECS::Instance()->createSystem<AnimationSystem<RenderInReplayComponent>>();
+	m_componentSystems.killCamAnimationSystem->setLOD(true, &m_cam);
 	m_componentSystems.killCamLightSystem                 = ECS::Instance()->createSystem<LightSystem<RenderInReplayComponent>>();
 	m_componentSystems.killCamMetaballSubmitSystem        = ECS::Instance()->createSystem<MetaballSubmitSystem<RenderInReplayComponent>>();
 	m_componentSystems.killCamModelSubmitSystem           = ECS::Instance()->createSystem<ModelSubmitSystem<RenderInReplayComponent>>();
@@ -558,6 +571,38 @@ void GameState::initSystems(const unsigned char playerID) {
 	m_componentSystems.killCamOctreeAddRemoverSystem = ECS::Instance()->createSystem<OctreeAddRemoverSystem<RenderInReplayComponent>>();
 	m_componentSystems.killCamOctreeAddRemoverSystem->provideOctree(m_killCamOctree);
 	m_componentSystems.killCamOctreeAddRemoverSystem->setCulling(true, &m_cam); // Enable frustum culling
+
+	initSystemScheduler();
+}
+
+void GameState::initSystemScheduler() {
+	using S = SystemScheduler;
+
+	// Added in the order they would run in serially, conflicting systems will keep this order
+	// Systems writing to AudioComponents read RESOURCE_GAME_EVENTS since AudioSystem updates them when the events are emitted
+	// Events are handled on the emitting thread, so a system also writes whatever the subscribers of its events write
+	if (m_componentSystems.aiSystem) {
+		m_systemScheduler.addSystem(m_componentSystems.aiSystem, "AiSystem", S::RESOURCE_COLLISION_WORLD, S::RESOURCE_ENTITY_LIFETIME);
+	}
+	m_systemScheduler.addSystem(m_componentSystems.projectileSystem, "ProjectileSystem", S::RESOURCE_NONE, S::RESOURCE_ENTITY_LIFETIME | S::RESOURCE_NETWORK_EVENTS | S::RESOURCE_RENDERER);
+	m_systemScheduler.addSystem(m_componentSystems.animationChangerSystem, "AnimationChangerSystem");
+	m_systemScheduler.addSystem(m_componentSystems.sprinklerSystem, "SprinklerSystem", S::RESOURCE_COLLISION_WORLD, S::RESOURCE_NETWORK_EVENTS | S::RESOURCE_RENDERER);
+	m_systemScheduler.addSystem(m_componentSystems.candleThrowingSystem, "CandleThrowingSystem", S::RESOURCE_NONE, S::RESOURCE_NETWORK_EVENTS | S::RESOURCE_GAME_EVENTS | S::RESOURCE_COLLISION_WORLD);
+	m_systemScheduler.addSystem(m_componentSystems.candleHealthSystem, "CandleHealthSystem", S::RESOURCE_GAME_EVENTS, S::RESOURCE_NETWORK_EVENTS);
+	m_systemScheduler.addSystem(m_componentSystems.candlePlacementSystem, "CandlePlacementSystem", S::RESOURCE_NONE, S::RESOURCE_NETWORK_EVENTS | S::RESOURCE_GAME_EVENTS | S::RESOURCE_COLLISION_WORLD);
+	m_systemScheduler.addSystem(m_componentSystems.candleReignitionSystem, "CandleReignitionSystem", S::RESOURCE_NONE, S::RESOURCE_NETWORK_EVENTS);
+	m_systemScheduler.addSystem(m_componentSystems.updateBoundingBoxSystem, "UpdateBoundingBoxSystem", S::RESOURCE_NONE, S::RESOURCE_COLLISION_WORLD);
+	m_systemScheduler.addSystem(m_componentSystems.gunSystem, "GunSystem", S::RESOURCE_COLLISION_WORLD, S::RESOURCE_NETWORK_EVENTS | S::RESOURCE_GAME_EVENTS);
+	m_systemScheduler.addSystem(m_componentSystems.lifeTimeSystem, "LifeTimeSystem", S::RESOURCE_NONE, S::RESOURCE_ENTITY_LIFETIME);
+	m_systemScheduler.addSystem(m_componentSystems.teamColorSystem, "TeamColorSystem");
+	m_systemScheduler.addSystem(m_componentSystems.particleSystem, "ParticleSystem", S::RESOURCE_NONE, S::RESOURCE_RENDERER);
+	m_systemScheduler.addSystem(m_componentSystems.sanitySystem, "SanitySystem");
+	m_systemScheduler.addSystem(m_componentSystems.sanitySoundSystem, "SanitySoundSystem", S::RESOURCE_GAME_EVENTS);
+	// SpawnPowerUp makes PowerUpCollectibleSystem create the power up and tell the others about it
+	m_systemScheduler.addSystem(m_componentSystems.waterCleaningSystem, "WaterCleaningSystem", S::RESOURCE_NONE, S::RESOURCE_RENDERER | S::RESOURCE_GAME_EVENTS | S::RESOURCE_ENTITY_LIFETIME | S::RESOURCE_NETWORK_EVENTS);
+
+	// Shots should use this tick's animation
+	m_systemScheduler.addDependency(m_componentSystems.animationChangerSystem, m_componentSystems.gunSystem);
 }
 
 void GameState::initConsole() {
@@ -604,6 +649,125 @@ void GameState::initConsole() {
 
 		return std::string("Match ended.");
 		}, "GameState");
+	console.addCommand("scheduler", [&]() { return m_systemScheduler.getTimingsString(); }, "GameState");
+	console.addCommand("scheduler <string>", [&](const std::string& param) {
+		if (param == "serial" || param == "parallel") {
+			m_systemScheduler.setSerial(param == "serial");
+			return std::string("Running systems ") + (m_systemScheduler.isSerial() ? "serially" : "in parallel");
+		}
+		return std::string("Error: expected \"serial\" or \"parallel\"");
+		}, "GameState");
+	console.addCommand("benchmark ecs <int> <int>", [&](std::vector<int> in) {
+		if (in.size() == 2 && in[0] > 0 && in[1] > 0) {
+			return Benchmarks::RunECSStorage(in[0], in[1]);
+		}
+		return std::string("Error: expected <number of entities> <number of ticks>");
+		}, "GameState");
+	console.addCommand("benchmark animation <int> <int>", [&](std::vector<int> in) {
+		if (in.size() == 2 && in[0] > 0 && in[1] > 0) {
+			return Benchmarks::RunAnimationBlend(*m_componentSystems.animationSystem, m_app->getResourceManager().getAnimationStack("Doc"), in[0], in[1]);
+		}
+		return std::string("Error: expected <number of players> <number of ticks>");
+		}, "GameState");
+	console.addCommand("benchmark intersections <int>", [&](std::vector<int> in) {
+		if (in.size() == 1 && in[0] > 0) {
+			return Benchmarks::RunIntersection(m_octree, in[0]);
+		}
+		return std::string("Error: expected <number of queries>");
+		}, "GameState");
+	console.addCommand("benchmark network <int> <int>", [&](std::vector<int> in) {
+		if (in.size() == 2 && in[0] > 0 && in[1] > 0) {
+			return Benchmarks::RunNetworkSerialization(in[0], in[1]);
+		}
+		return std::string("Error: expected <number of entities> <number of ticks>");
+		}, "GameState");
+	console.addCommand("network simulate <int> <int> <int>", [&](std::vector<int> in) {
+		if (in.size() == 3 && in[0] >= 0 && in[0] <= 100 && in[1] >= 0 && in[2] >= 0) {
+			LossSimulator::Settings settings;
+			settings.lossRate = in[0] / 100.f;
+			settings.latencyMs = in[1];
+			settings.jitterMs = in[2];
+			NWrapperSingleton::getInstance().setLossSimulation(settings);
+			return std::string("Simulating " + std::to_string(in[0]) + "% loss and " + std::to_string(in[1]) + "+" + std::to_string(in[2]) + "ms latency on received datagrams");
+		}
+		return std::string("Error: expected <loss percent> <latency ms> <jitter ms>");
+		}, "GameState");
+	console.addCommand("network interest <int>", [&](std::vector<int> in) {
+		if (in.size() == 1 && in[0] >= 0) {
+			if (in[0] == 0) {
+				m_componentSystems.networkSenderSystem->setInterestManagement(false);
+				return std::string("Forwarding all per-tick state to every client");
+			}
+			Netcode::InterestFilter& filter = m_componentSystems.networkSenderSystem->getInterestFilter();
+			Netcode::InterestFilter::Settings settings = filter.getSettings();
+			settings.distance = static_cast<float>(in[0]);
+			filter.setSettings(settings);
+			m_componentSystems.networkSenderSystem->setInterestManagement(true);
+			return std::string("Forwarding per-tick state within " + std::to_string(in[0]) + "m, in the same room or of teammates");
+		}
+		return std::string("Error: expected <distance in meters>, 0 to forward everything");
+		}, "GameState");
+	console.addCommand("benchmark interest <int> <int>", [&](std::vector<int> in) {
+		if (in.size() == 2 && in[0] > 1 && in[1] > 0) {
+			return Benchmarks::RunInterestManagement(in[0], in[1]);
+		}
+		return std::string("Error: expected <number of players> <number of ticks>");
+		}, "GameState");
+	console.addCommand("replay skip forward <int>", [&](std::vector<int> in) {
+		MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
+		if (!mrs || mrs->status != 2) {
+			return std::string("Error: not watching a replay");
+		}
+		if (in.size() != 1 || in[0] <= 0) {
+			return std::string("Error: expected <seconds> to skip ahead");
+		}
+		return seekReplay(mrs->getReplayTick() + static_cast<size_t>(in[0]) * TICKRATE);
+		}, "GameState");
+	console.addCommand("replay skip back <int>", [&](std::vector<int> in) {
+		MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
+		if (!mrs || mrs->status != 2) {
+			return std::string("Error: not watching a replay");
+		}
+		if (in.size() != 1 || in[0] <= 0) {
+			return std::string("Error: expected <seconds> to skip back");
+		}
+		const size_t ticks = static_cast<size_t>(in[0]) * TICKRATE;
+		return seekReplay(mrs->getReplayTick() - std::min(ticks, mrs->getReplayTick()));
+		}, "GameState");
+	console.addCommand("benchmark replay <int>", [&](std::vector<int> in) {
+		MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
+		if (!mrs || mrs->status != 2) {
+			return std::string("Error: only replays can be benchmarked, start one from the menu first");
+		}
+		if (in.size() != 1 || in[0] <= 0) {
+			return std::string("Error: expected <number of ticks>");
+		}
+		const size_t firstTick = mrs->getReplayTick();
+		const size_t numTicks = std::min(static_cast<size_t>(in[0]), mrs->getNumReplayTicks() - std::min(firstTick, mrs->getNumReplayTicks()));
+		m_replayBenchmark.start("ticks " + std::to_string(firstTick) + " to " + std::to_string(firstTick + numTicks) + " of " + std::to_string(mrs->getNumReplayTicks())
+			+ (m_systemScheduler.isSerial() ? ", serial" : ", parallel"), numTicks);
+
+		// The level of the recorded match, the same seed gives the same level
+		SettingStorage& settings = m_app->getSettings();
+		const std::string report = Benchmarks::RunLevelGeneration(static_cast<int>(settings.gameSettingsDynamic["map"]["seed"].value),
+			static_cast<int>(settings.gameSettingsDynamic["map"]["sizeX"].value), static_cast<int>(settings.gameSettingsDynamic["map"]["sizeY"].value), 20);
+
+		// Systems that call rand() make the same choices every time the same ticks are benchmarked
+		srand(static_cast<unsigned int>(settings.gameSettingsDynamic["map"]["seed"].value) + static_cast<unsigned int>(firstTick));
+		return report + "Timing the next " + std::to_string(numTicks) + " ticks, the report is logged when they have been played";
+		}, "GameState");
+	console.addCommand("benchmark compression", [&]() {
+		return Benchmarks::RunPacketCompression(Netcode::PacketDictionary::LoadReplayPackets(REPLAY_PATH));
+		}, "GameState");
+	console.addCommand("network traindictionary", [&]() {
+		const std::vector<std::string> packets = Netcode::PacketDictionary::LoadReplayPackets(REPLAY_PATH);
+		const Netcode::PacketDictionary dictionary = Netcode::PacketDictionary::Train(packets);
+		if (dictionary.empty() || !dictionary.save(Netcode::PacketDictionary::DEFAULT_PATH)) {
+			return std::string("Error: could not train a dictionary from the " + std::to_string(packets.size()) + " packets in " + REPLAY_PATH);
+		}
+		return "Trained a " + std::to_string(dictionary.size()) + " byte dictionary on " + std::to_string(packets.size()) + " packets and saved it to "
+			+ Netcode::PacketDictionary::DEFAULT_PATH + ", packets are sent with plain LZ until a dictionary is shipped with the game";
+		}, "GameState");
 #endif
 #ifdef _DEBUG
 	console.addCommand("AddCube", [&]() {
@@ -657,7 +821,11 @@ bool GameState::onResize(const WindowResizeEvent& event) {
 }
 
 bool GameState::onNetworkSerializedPackageEvent(const NetworkSerializedPackageEvent& event) {
-	m_componentSystems.networkReceiverSystem->handleIncomingData(event.serializedData);
+	if (event.reliable) {
+		m_componentSystems.networkReceiverSystem->handleIncomingData(event.serializedData);
+	} else {
+		m_componentSystems.networkReceiverSystem->handleIncomingUnreliableData(event.serializedData);
+	}
 	m_componentSystems.killCamReceiverSystem->handleIncomingData(event.serializedData);
 	return true;
 }
@@ -992,13 +1160,16 @@ void GameState::updatePerTickKillCamComponentSystems(float dt) {
 // HERE BE DRAGONS
 // Make sure things are updated in the correct order or things will behave strangely
 void GameState::updatePerTickComponentSystems(float dt) {
-	
+	m_replayBenchmark.beginTick();
+
 	if (!m_player->getComponent<SpectatorComponent>() || m_isInKillCamMode) {
 		m_playerNamesinGameGui.setMaxDistance(10);
 
-		Octree::RayIntersectionInfo tempInfo;
+		// Reused every tick to avoid allocating the hit list
+		Octree::RayIntersectionInfo& tempInfo = m_crosshairRayInfo;
+		tempInfo.clear();
 		Octree* octree = m_isInKillCamMode ? m_killCamOctree : m_octree;
-		octree->getRayIntersection(m_cam.getPosition(), m_cam.getDirection(), &tempInfo, m_player, 0.0, true);
+		octree->getClosestRayIntersection(m_cam.getPosition(), m_cam.getDirection(), &tempInfo, m_player, 0.0, true);
 		
 		if (tempInfo.closestHitIndex != -1) {
 			Netcode::PlayerID owner = Netcode::UNINITIALIZED_PLAYER;
@@ -1031,11 +1202,6 @@ void GameState::updatePerTickComponentSystems(float dt) {
 	}
 	
 	///////////////////////////////////////
-	m_currentlyReadingMask = 0;
-	m_currentlyWritingMask = 0;
-	m_runningSystemJobs.clear();
-	m_runningSystems.clear();
-
 	m_componentSystems.gameInputSystem->fixedUpdate(dt);
 	m_componentSystems.spectateInputSystem->fixedUpdate(dt);
 
@@ -1045,31 +1211,17 @@ void GameState::updatePerTickComponentSystems(float dt) {
 
 	// Update entities with info from the network and from ourself
 	// DON'T MOVE, should happen at the start of each tick
-	m_componentSystems.networkReceiverSystem->update(dt);
-	m_componentSystems.killCamReceiverSystem->update(dt); // This just increments the killcam's ringbuffer.
-
-	m_componentSystems.movementSystem->update(dt);
-	m_componentSystems.speedLimitSystem->update();
-	m_componentSystems.collisionSystem->update(dt);
-	m_componentSystems.movementPostCollisionSystem->update(dt);
-	m_componentSystems.powerUpUpdateSystem->update(dt);
-	m_componentSystems.powerUpCollectibleSystem->update(dt);
-	// TODO: Investigate this
-	// Systems sent to runSystem() need to override the update(float dt) in BaseComponentSystem
-	if (NWrapperSingleton::getInstance().isHost() && m_app->getSettings().gameSettingsStatic["map"]["bots"].getSelected().value == 0.f) {
-		runSystem(dt, m_componentSystems.aiSystem);
-	}
-	runSystem(dt, m_componentSystems.projectileSystem);
-	runSystem(dt, m_componentSystems.animationChangerSystem);
-	runSystem(dt, m_componentSystems.sprinklerSystem);
-	runSystem(dt, m_componentSystems.candleThrowingSystem);
-	runSystem(dt, m_componentSystems.candleHealthSystem);
-	runSystem(dt, m_componentSystems.candlePlacementSystem);
-	runSystem(dt, m_componentSystems.candleReignitionSystem);
-	runSystem(dt, m_componentSystems.updateBoundingBoxSystem);
-	runSystem(dt, m_componentSystems.gunSystem); // Run after animationSystem to make shots more in sync
-	runSystem(dt, m_componentSystems.lifeTimeSystem);
-	runSystem(dt, m_componentSystems.teamColorSystem);
+	m_replayBenchmark.time("NetworkReceiverSystem", [&] { m_componentSystems.networkReceiverSystem->update(dt); });
+	m_replayBenchmark.time("KillCamReceiverSystem", [&] { m_componentSystems.killCamReceiverSystem->update(dt); }); // This just increments the killcam's ringbuffer.
+
+	m_replayBenchmark.time("MovementSystem", [&] { m_componentSystems.movementSystem->update(dt); });
+	m_replayBenchmark.time("SpeedLimitSystem", [&] { m_componentSystems.speedLimitSystem->update(); });
+	m_replayBenchmark.time("CollisionSystem", [&] { m_componentSystems.collisionSystem->update(dt); });
+	m_replayBenchmark.time("MovementPostCollisionSystem", [&] { m_componentSystems.movementPostCollisionSystem->update(dt); });
+	// Everything attached to the players gets its world matrix here instead of pulling it through its parents later in the tick
+	m_replayBenchmark.time("TransformHierarchies", [&] { m_componentSystems.prepareUpdateSystem->updateHierarchies(); });
+	m_replayBenchmark.time("PowerUpUpdateSystem", [&] { m_componentSystems.powerUpUpdateSystem->update(dt); });
+	m_replayBenchmark.time("PowerUpCollectibleSystem", [&] { m_componentSystems.powerUpCollectibleSystem->update(dt); });
 
 	auto& particleSettingSelectedValue = Application::getInstance()->getSettings().applicationSettingsStatic["graphics"]["particles"].getSelected().value;
 	if (particleSettingSelectedValue > 0.0f && !m_componentSystems.particleSystem->isEnabled()) {
@@ -1080,22 +1232,24 @@ void GameState::updatePerTickComponentSystems(float dt) {
 		m_componentSystems.particleSystem->setEnabled(false);
 	}
 
-	runSystem(dt, m_componentSystems.particleSystem);
+	if (m_componentSystems.aiSystem) {
+		m_systemScheduler.setActive(m_componentSystems.aiSystem,
+			NWrapperSingleton::getInstance().isHost() && m_app->getSettings().gameSettingsStatic["map"]["bots"].getSelected().value == 0.f);
+	}
 
-	runSystem(dt, m_componentSystems.sanitySystem);
-	runSystem(dt, m_componentSystems.sanitySoundSystem);
-	runSystem(dt, m_componentSystems.waterCleaningSystem);
+	// Runs the gameplay systems, concurrently where their component and resource usage allows it
+	m_systemScheduler.run(dt);
 
-	// Wait for all the systems to finish before starting the removal system
-	for (auto& fut : m_runningSystemJobs) {
-		fut.get();
-	}
 	m_componentSystems.hazardLightSystem->enableHazardLights(m_componentSystems.sprinklerSystem->getActiveRooms());
 
 	// Send out your entity info to the rest of the players
 	// DON'T MOVE, should happen at the end of each tick
-	m_componentSystems.networkSenderSystem->update();
-	m_componentSystems.octreeAddRemoverSystem->update(dt);
+	m_replayBenchmark.time("NetworkSenderSystem", [&] { m_componentSystems.networkSenderSystem->update(); });
+	m_replayBenchmark.time("OctreeAddRemoverSystem", [&] { m_componentSystems.octreeAddRemoverSystem->update(dt); });
+
+	if (m_replayBenchmark.endTick(m_systemScheduler)) {
+		SAIL_LOG(m_replayBenchmark.getReport());
+	}
 }
 
 void GameState::updatePerFrameComponentSystems(float dt, float alpha) {
@@ -1166,56 +1320,6 @@ void GameState::updatePerFrameComponentSystems(float dt, float alpha) {
 	m_componentSystems.entityRemovalSystem->update();
 }
 
-#define DISABLE_RUNSYSTEM_MT
-void GameState::runSystem(float dt, BaseComponentSystem* toRun) {
-#ifdef DISABLE_RUNSYSTEM_MT
-	toRun->update(dt);
-#else
-	bool started = false;
-	while (!started) {
-		// First check if the system can be run
-		if (!(m_currentlyReadingMask & toRun->getWriteBitMask()).any() &&
-			!(m_currentlyWritingMask & toRun->getReadBitMask()).any() &&
-			!(m_currentlyWritingMask & toRun->getWriteBitMask()).any()) {
-
-			m_currentlyWritingMask |= toRun->getWriteBitMask();
-			m_currentlyReadingMask |= toRun->getReadBitMask();
-			started = true;
-			m_runningSystems.push_back(toRun);
-			m_runningSystemJobs.push_back(m_app->pushJobToThreadPool([this, dt, toRun](int id) {toRun->update(dt); return toRun; }));
-
-		} else {
-			// Then loop through all futures and see if any of them are done
-			for (int i = 0; i < m_runningSystemJobs.size(); i++) {
-				if (m_runningSystemJobs[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-					auto doneSys = m_runningSystemJobs[i].get();
-
-					m_runningSystemJobs.erase(m_runningSystemJobs.begin() + i);
-					i--;
-
-					m_currentlyWritingMask ^= doneSys->getWriteBitMask();
-					m_currentlyReadingMask ^= doneSys->getReadBitMask();
-
-					int toRemoveIndex = -1;
-					for (int j = 0; j < m_runningSystems.size(); j++) {
-						// Currently just compares memory addresses (if they point to the same location they're the same object)
-						if (m_runningSystems[j] == doneSys)
-							toRemoveIndex = j;
-					}
-
-					m_runningSystems.erase(m_runningSystems.begin() + toRemoveIndex);
-
-					// Since multiple systems can read from components concurrently, currently best solution I came up with
-					for (auto _sys : m_runningSystems) {
-						m_currentlyReadingMask |= _sys->getReadBitMask();
-					}
-				}
-			}
-		}
-	}
-#endif
-}
-
 const std::string GameState::teleportToMap() {
 	m_player->getComponent<TransformComponent>()->setStartTranslation(glm::vec3(30.6f, 0.9f, 40.f));
 	return "";
@@ -1226,6 +1330,28 @@ const std::string GameState::toggleProfiler() {
 	return "Toggling profiler";
 }
 
+const std::string GameState::seekReplay(size_t tick) {
+	MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
+	if (!mrs->seek(tick)) {
+		return "Error: could not skip in the replay";
+	}
+	const std::string msg = "Skipping to tick " + std::to_string(std::min(tick, mrs->getNumReplayTicks() - 1)) + " of " + std::to_string(mrs->getNumReplayTicks());
+
+	if (mrs->isRestartPending()) {
+		// The keyframe is restored on a new match, the spectators have to load it again before the replay goes on
+		for (const Player& p : NWrapperSingleton::getInstance().getPlayers()) {
+			if (p.lastStateStatus.status != -1) {
+				NWrapperSingleton::getInstance().getPlayer(p.id)->lastStateStatus.status = 0;
+			}
+		}
+		NWrapperSingleton::getInstance().getNetworkWrapper()->setClientState(States::Game);
+		requestStackClear();
+		requestStackPush(States::Game);
+		return msg + ", restarting the match from the last keyframe";
+	}
+	return msg;
+}
+
 void GameState::logSomeoneDisconnected(unsigned char id) {
 	// Construct log message
 	std::string logMessage = "'";
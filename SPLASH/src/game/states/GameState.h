@@ -10,6 +10,8 @@
 #include "../events/NetworkNameEvent.h"
 #include "../events/NetworkWelcomeEvent.h"
 #include "Sail/entities/systems/SystemDeclarations.h"
+#include "Sail/entities/systems/SystemScheduler.h"
+#include "Sail/utils/Benchmarks/ReplayBenchmark.h"
 
 class DX12DDSTexture;
 
@@ -35,6 +37,7 @@ public:
 
 private:
 	void initSystems(const unsigned char playerID);
+	void initSystemScheduler();
 	void initConsole();
 
 	bool onResize(const WindowResizeEvent& event);
@@ -52,13 +55,13 @@ private:
 	void updatePerTickKillCamComponentSystems(float dt);
 	void updatePerTickComponentSystems(float dt);
 	void updatePerFrameComponentSystems(float dt, float alpha);
-	void runSystem(float dt, BaseComponentSystem* toRun);
 
 	void createBots();
 	void createLevel(Shader* shader, Model* boundingBoxModel);
 	const std::string createCube(const glm::vec3& position);
 	const std::string teleportToMap();
 	const std::string toggleProfiler();
+	const std::string seekReplay(size_t tick);
 
 	void logSomeoneDisconnected(unsigned char id);
 
@@ -100,13 +103,12 @@ private:
 
 	Octree* m_octree;
 	Octree* m_killCamOctree;
+	Octree::RayIntersectionInfo m_crosshairRayInfo;
 	bool m_showcaseProcGen;
 
-	std::bitset<MAX_NUM_COMPONENTS_TYPES> m_currentlyWritingMask;
-	std::bitset<MAX_NUM_COMPONENTS_TYPES> m_currentlyReadingMask;
-
-	std::vector<std::future<BaseComponentSystem*>> m_runningSystemJobs;
-	std::vector<BaseComponentSystem*> m_runningSystems;
+	SystemScheduler m_systemScheduler;
+	// Started from the console while watching a replay
+	Benchmarks::ReplayBenchmark m_replayBenchmark;
 
 	bool m_wasDropped = false;
 
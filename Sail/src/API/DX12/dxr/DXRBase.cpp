@@ -270,46 +270,40 @@ void DXRBase::updateSceneData(Camera* cam, LightSetup* lights, const std::vector
 }
 
 void DXRBase::addWaterAtWorldPosition(const glm::vec3& position) {
-	static auto& mapSettings = Application::getInstance()->getSettings().gameSettingsDynamic["map"];
-	auto mapSize = glm::vec3(mapSettings["sizeX"].value, 0.8f, mapSettings["sizeY"].value) * (float)mapSettings["tileSize"].value;
-	auto mapStart = -glm::vec3((float)mapSettings["tileSize"].value / 2.0f, 0.f, (float)mapSettings["tileSize"].value / 2.0f);
+	std::uint32_t cell;
+	// Ignore water points that are outside the map
+	if (m_waterGrid.toCell(position, cell)) {
+		addWaterToCell(cell, 1);
+	}
+}
 
-	// Convert position to index, stored as floats
-	glm::vec3 floatInd = ((position - mapStart) / mapSize) * m_waterArrSizes;
-	// Convert triple-number index to a single index value
-	int quarterIndex = glm::floor((int)glm::floor(floatInd.x * 4.f) % 4);
-	// Convert triple-number (float) to triple-number (int)
-	glm::i32vec3 ind = floor(floatInd);
-	// Convert to final 1-D index
-	int arrIndex = Utils::to1D(ind, m_waterArrSizes.x, m_waterArrSizes.y);
+void DXRBase::addWaterAtCells(const Netcode::WaterCells& cells) {
+	// Cells are sorted, so neighbouring hits are written to the water data in order
+	for (const Netcode::WaterCells::Cell& cell : cells.getCells()) {
+		addWaterToCell(cell.index, cell.hits);
+	}
+}
 
-	// Ignore water points that are outside the map
-	if (arrIndex >= 0 && arrIndex <= m_waterArrSize - 1) {
-		// Make sure to update this water
-		m_updateWater[arrIndex] = true;
-		uint8_t up0 = Utils::unpackQuarterFloat(m_waterDataCPU[arrIndex], 0);
-		uint8_t up1 = Utils::unpackQuarterFloat(m_waterDataCPU[arrIndex], 1);
-		uint8_t up2 = Utils::unpackQuarterFloat(m_waterDataCPU[arrIndex], 2);
-		uint8_t up3 = Utils::unpackQuarterFloat(m_waterDataCPU[arrIndex], 3);
-
-		switch (quarterIndex) {
-		case 0:
-			m_waterDeltas[arrIndex] = Utils::packQuarterFloat(std::min(255U, up0 + std::rand() % 50U + 50U), up1, up2, up3);
-			break;
-		case 1:
-			m_waterDeltas[arrIndex] = Utils::packQuarterFloat(up0, std::min(255U, up1 + std::rand() % 50U + 50U), up2, up3);
-			break;
-		case 2:
-			m_waterDeltas[arrIndex] = Utils::packQuarterFloat(up0, up1, std::min(255U, up2 + std::rand() % 50U + 50U), up3);
-			break;
-		case 3:
-			m_waterDeltas[arrIndex] = Utils::packQuarterFloat(up0, up1, up2, std::min(255U, up3 + std::rand() % 50U + 50U));
-			break;
-		}
+void DXRBase::addWaterToCell(std::uint32_t cell, unsigned int hits) {
+	const unsigned int arrIndex = cell / Netcode::WaterCells::QUARTERS_PER_VOXEL;
+	const unsigned int quarterIndex = cell % Netcode::WaterCells::QUARTERS_PER_VOXEL;
+	if (arrIndex >= m_waterArrSize || !m_waterDataCPU) {
+		return;
+	}
 
-		m_waterDataCPU[arrIndex] = m_waterDeltas[arrIndex];
-		m_waterChanged = true;
+	unsigned int quarters[Netcode::WaterCells::QUARTERS_PER_VOXEL];
+	for (unsigned int i = 0; i < Netcode::WaterCells::QUARTERS_PER_VOXEL; i++) {
+		quarters[i] = Utils::unpackQuarterFloat(m_waterDataCPU[arrIndex], i);
+	}
+	for (unsigned int i = 0; i < hits; i++) {
+		quarters[quarterIndex] = std::min(255U, quarters[quarterIndex] + std::rand() % 50U + 50U);
 	}
+
+	// Make sure to update this water
+	m_updateWater[arrIndex] = true;
+	m_waterDeltas[arrIndex] = Utils::packQuarterFloat(quarters[0], quarters[1], quarters[2], quarters[3]);
+	m_waterDataCPU[arrIndex] = m_waterDeltas[arrIndex];
+	m_waterChanged = true;
 }
 
 unsigned int DXRBase::removeWaterAtWorldPosition(const glm::vec3& position, const glm::ivec3& posOffset, const glm::ivec3& negOffset) {
@@ -527,24 +521,12 @@ void DXRBase::simulateWater(float dt) {
 }
 
 void DXRBase::rebuildWater() {
-	// Get some map settings
-	auto& mapSettings = Application::getInstance()->getSettings().gameSettingsDynamic["map"];
-	m_mapSize = glm::vec3(mapSettings["sizeX"].value, 0.8f, mapSettings["sizeY"].value) * (float)mapSettings["tileSize"].value;
-	m_mapStart = -glm::vec3((float)mapSettings["tileSize"].value / 2.0f, 0.f, (float)mapSettings["tileSize"].value / 2.0f);
-	auto tileSize = mapSettings["tileSize"].value;
-	float mapSizeX = mapSettings["sizeX"].value * tileSize;
-	float mapSizeZ = mapSettings["sizeY"].value * tileSize;
-
-	// Water voxel apperance setting, increase to improve water resolution
-	const float voxelCellsPerWorldUnit = 5.f;
-	// How many values are packed into each X, don't change this
-	const int valuesPerX = 4;
-
-	m_waterArrSizes.x = glm::floor(mapSizeX * voxelCellsPerWorldUnit / valuesPerX);
-	m_waterArrSizes.y = 37;
-	m_waterArrSizes.z = glm::floor(mapSizeZ * voxelCellsPerWorldUnit);
-	
-	m_waterArrSize = m_waterArrSizes.x * m_waterArrSizes.y * m_waterArrSizes.z;
+	// Same grid as the water hits are sent in, see Netcode::WaterCells
+	m_waterGrid = Netcode::WaterCells::Grid::FromSettings();
+	m_mapSize = m_waterGrid.mapSize;
+	m_mapStart = m_waterGrid.mapStart;
+	m_waterArrSizes = glm::vec3(m_waterGrid.size);
+	m_waterArrSize = m_waterGrid.getNumVoxels();
 
 	// Init water "decals"
 	unsigned int numElements = m_waterArrSize;
@@ -7,6 +7,7 @@
 #include "../shader/DX12ConstantBuffer.h"
 #include "../shader/DX12StructuredBuffer.h"
 #include "API/DX12/resources/DX12RenderableTexture.h"
+#include "Sail/netcode/WaterCells.h"
 
 #include <bitset>
 
@@ -45,6 +46,8 @@ public:
 
 	void updateSceneData(Camera* cam, LightSetup* lights, const std::vector<DXRBase::MetaballGroup*>& metaballGroups, const std::vector<glm::vec3>& teamColors, unsigned int numShadowTextures);
 	void addWaterAtWorldPosition(const glm::vec3& position);
+	// Adds the hits of every cell in one pass
+	void addWaterAtCells(const Netcode::WaterCells& cells);
 	unsigned int removeWaterAtWorldPosition(const glm::vec3& position, const glm::ivec3& posOffset, const glm::ivec3& negOffset);
 	bool checkWaterAtWorldPosition(const glm::vec3& position);
 	// THIS WAS IMPLEMENTED SPECIFICALLY FOR CLEANING STATE!
@@ -118,6 +121,8 @@ private:
 
 	void addMetaballGroupAABB(int index);
 
+	void addWaterToCell(std::uint32_t cell, unsigned int hits);
+
 private:
 	DX12API* m_context;
 
@@ -207,6 +212,7 @@ private:
 	unsigned int* m_waterDataCPU;
 	bool* m_updateWater;
 	bool m_waterChanged;
+	Netcode::WaterCells::Grid m_waterGrid;
 	glm::vec3 m_waterArrSizes;
 	unsigned int m_waterArrSize;
 	glm::vec3 m_mapSize;
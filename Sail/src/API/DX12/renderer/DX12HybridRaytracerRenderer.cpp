@@ -48,6 +48,10 @@ void DX12HybridRaytracerRenderer::submitWaterPoint(const glm::vec3& pos) {
 	m_rendererRaytrace->submitWaterPoint(pos);
 }
 
+void DX12HybridRaytracerRenderer::submitWaterCells(const Netcode::WaterCells& cells) {
+	m_rendererRaytrace->submitWaterCells(cells);
+}
+
 void DX12HybridRaytracerRenderer::setLightSetup(LightSetup* lightSetup) {
 	m_rendererGbuffer->setLightSetup(lightSetup);
 	m_rendererRaytrace->setLightSetup(lightSetup);
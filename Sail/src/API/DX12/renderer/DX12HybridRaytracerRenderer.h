@@ -17,6 +17,7 @@ public:
 	virtual void submitMetaball(RenderCommandType type, Material* material, const glm::vec3& pos, RenderFlag flags, int group) override;
 
 	virtual void submitWaterPoint(const glm::vec3& pos) override;
+	virtual void submitWaterCells(const Netcode::WaterCells& cells) override;
 	virtual void setLightSetup(LightSetup* lightSetup) override;
 	virtual void end() override;
 	virtual void present(PostProcessPipeline* postProcessPipeline = nullptr, RenderableTexture* output = nullptr) override;
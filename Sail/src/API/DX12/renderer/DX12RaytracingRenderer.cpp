@@ -461,6 +461,10 @@ void DX12RaytracingRenderer::submitWaterPoint(const glm::vec3& pos) {
 	m_dxr.addWaterAtWorldPosition(pos);
 }
 
+void DX12RaytracingRenderer::submitWaterCells(const Netcode::WaterCells& cells) {
+	m_dxr.addWaterAtCells(cells);
+}
+
 unsigned int DX12RaytracingRenderer::removeWaterPoint(const glm::vec3& pos, const glm::ivec3& posOffset, const glm::ivec3& negOffset) {
 	return m_dxr.removeWaterAtWorldPosition(pos, posOffset, negOffset);
 }
@@ -24,6 +24,7 @@ public:
 	virtual void submit(Mesh* mesh, const glm::mat4& modelMatrix, RenderFlag flags, int teamColorID, bool castShadows) override;
 	virtual void submitMetaball(RenderCommandType type, Material* material, const glm::vec3& pos, RenderFlag flags, int group) override;
 	virtual void submitWaterPoint(const glm::vec3& pos) override;
+	virtual void submitWaterCells(const Netcode::WaterCells& cells) override;
 	virtual unsigned int removeWaterPoint(const glm::vec3& pos, const glm::ivec3& posOffset, const glm::ivec3& negOffset) override;
 	virtual bool checkIfOnWater(const glm::vec3& pos) override;
 	virtual std::pair<bool, glm::vec3> getNearestWaterPosition(const glm::vec3& position, const glm::vec3& maxOffset) override;
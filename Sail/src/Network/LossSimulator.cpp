@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "LossSimulator.h"
+
+#include <cstring>
+
+void LossSimulator::setSettings(const Settings& settings) {
+	std::lock_guard<std::mutex> lock(m_settingsMutex);
+	m_settings = settings;
+	m_enabled = settings.lossRate > 0.f || settings.latencyMs > 0 || settings.jitterMs > 0;
+}
+
+LossSimulator::Settings LossSimulator::getSettings() {
+	std::lock_guard<std::mutex> lock(m_settingsMutex);
+	return m_settings;
+}
+
+bool LossSimulator::isEnabled() const {
+	// Datagrams that are already delayed are still delivered after the simulation has been turned off
+	return m_enabled || !m_delayed.empty();
+}
+
+void LossSimulator::push(const char* data, size_t size, const void* address, size_t addressSize) {
+	const Settings settings = getSettings();
+
+	if (std::uniform_real_distribution<float>(0.f, 1.f)(m_random) < settings.lossRate) {
+		return;
+	}
+
+	unsigned int latencyMs = settings.latencyMs;
+	if (settings.jitterMs) {
+		latencyMs += std::uniform_int_distribution<unsigned int>(0, settings.jitterMs)(m_random);
+	}
+
+	Delayed delayed;
+	delayed.arrival = Clock::now() + std::chrono::milliseconds(latencyMs);
+	delayed.data.assign(data, data + size);
+	delayed.address.assign(static_cast<const char*>(address), static_cast<const char*>(address) + addressSize);
+	m_delayed.push(std::move(delayed));
+}
+
+bool LossSimulator::pop(std::vector<char>& data, void* address) {
+	if (m_delayed.empty() || m_delayed.top().arrival > Clock::now()) {
+		return false;
+	}
+
+	const Delayed& delayed = m_delayed.top();
+	data = delayed.data;
+	std::memcpy(address, delayed.address.data(), delayed.address.size());
+	m_delayed.pop();
+	return true;
+}
+
+int LossSimulator::getTimeoutMs() const {
+	if (m_delayed.empty()) {
+		return -1;
+	}
+
+	const auto untilArrival = std::chrono::duration_cast<std::chrono::milliseconds>(m_delayed.top().arrival - Clock::now()).count();
+	// Rounded up so that the datagram has arrived once the wait is over
+	return static_cast<int>(std::max<long long>(untilArrival + 1, 0));
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+/*
+	Drops and delays incoming datagrams to test the unreliable channel over loopback as if it was a bad connection.
+	Jitter makes datagrams arrive out of order as well.
+
+	The settings can be changed from any thread, the datagrams are only pushed and popped by the network I/O thread.
+*/
+class LossSimulator {
+public:
+	struct Settings {
+		float lossRate = 0.f;		// 0 to 1
+		unsigned int latencyMs = 0;
+		unsigned int jitterMs = 0;	// Random extra latency up to this
+	};
+
+	void setSettings(const Settings& settings);
+	Settings getSettings();
+	bool isEnabled() const;
+
+	// Either drops the datagram or keeps it until its latency has passed
+	void push(const char* data, size_t size, const void* address, size_t addressSize);
+	// Returns the datagrams whose latency has passed one at a time, the address is copied into address
+	bool pop(std::vector<char>& data, void* address);
+	// Milliseconds until the next datagram can be popped, -1 if there aren't any
+	int getTimeoutMs() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Delayed {
+		Clock::time_point arrival;
+		std::vector<char> data;
+		std::vector<char> address;
+
+		bool operator>(const Delayed& other) const { return arrival > other.arrival; }
+	};
+
+	std::mutex m_settingsMutex;
+	Settings m_settings;
+	std::atomic<bool> m_enabled{ false };
+
+	std::priority_queue<Delayed, std::vector<Delayed>, std::greater<Delayed>> m_delayed;
+	std::mt19937 m_random{ std::random_device{}() };
+};
@@ -125,4 +125,18 @@ void NWrapper::sendSerializedDataToHost(const std::string& data) {
 	msg += ML_SERIALIZED;
 	msg += data;
 	m_network->send(msg.c_str(), msg.length());
+}
+
+void NWrapper::sendUnreliableSerializedDataAllClients(const std::string& data) {
+	std::string msg;
+	msg += ML_SERIALIZED_UNRELIABLE;
+	msg += data;
+	m_network->sendUnreliable(msg.c_str(), msg.length(), -1);
+}
+
+void NWrapper::sendUnreliableSerializedDataToHost(const std::string& data) {
+	std::string msg;
+	msg += ML_SERIALIZED_UNRELIABLE;
+	msg += data;
+	m_network->sendUnreliable(msg.c_str(), msg.length());
 }
\ No newline at end of file
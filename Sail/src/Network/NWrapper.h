@@ -79,7 +79,11 @@ public:
 
 	void sendSerializedDataAllClients(const std::string& data);
 	void sendSerializedDataToHost(const std::string& data);
+	// For per-tick state that is replaced by the next tick, may be lost or dropped if it arrives after a newer one
+	void sendUnreliableSerializedDataAllClients(const std::string& data);
+	void sendUnreliableSerializedDataToHost(const std::string& data);
 	virtual void sendSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayerId) = 0;
+	virtual void sendUnreliableSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayerId) = 0;
 
 	/*
 		Host Only
@@ -109,6 +113,7 @@ protected:
 		ML_UPDATE_SETTINGS,
 		ML_TEAM_REQUEST,
 		ML_TEAMCOLOR_REQUEST,
+		ML_SERIALIZED_UNRELIABLE,
 	};
 
 protected:
@@ -175,6 +175,11 @@ void NWrapperClient::decodeMessage(NetworkEvent nEvent) {
 		// Send the serialized stringData as an event to the networkSystem which parses it.
 		EventDispatcher::Instance().emit(NetworkSerializedPackageEvent(dataString));
 		break;
+	case ML_SERIALIZED_UNRELIABLE: // Same as ML_SERIALIZED but received over the unreliable channel
+		dataString = std::string(nEvent.data->Message.rawMsg, nEvent.data->Message.sizeOfMsg);
+		dataString.erase(0, 1);
+		EventDispatcher::Instance().emit(NetworkSerializedPackageEvent(dataString, false));
+		break;
 
 	case ML_UPDATE_SETTINGS:
 	{
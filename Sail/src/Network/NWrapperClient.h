@@ -12,6 +12,7 @@ public:
 
 	// Client can't send these messages
 	void sendSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayerId) override {}
+	void sendUnreliableSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayerId) override {}
 private:
 	void sendChatMsg(std::string msg);
 
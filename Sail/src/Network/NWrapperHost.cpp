@@ -69,6 +69,19 @@ void NWrapperHost::sendSerializedDataToClient(const std::string& data, Netcode::
 	}
 }
 
+void NWrapperHost::sendUnreliableSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayeriD) {
+	std::string msg;
+	msg += ML_SERIALIZED_UNRELIABLE;
+	msg += data;
+
+	for (auto p : m_connectionsMap) {
+		if (p.second == PlayeriD) {
+			m_network->sendUnreliable(msg.c_str(), msg.length(), p.first);
+			break;
+		}
+	}
+}
+
 #ifdef DEVELOPMENT
 
 const std::map<TCP_CONNECTION_ID, unsigned char>& NWrapperHost::getConnectionMap() {
@@ -202,6 +215,11 @@ void NWrapperHost::decodeMessage(NetworkEvent nEvent) {
 		// Send the serialized stringData as an event to the networkSystem which parses it.
 		EventDispatcher::Instance().emit(NetworkSerializedPackageEvent(dataString));
 		break;
+	case ML_SERIALIZED_UNRELIABLE: // Same as ML_SERIALIZED but received over the unreliable channel
+		dataString = std::string(nEvent.data->Message.rawMsg, nEvent.data->Message.sizeOfMsg);
+		dataString.erase(0, 1);
+		EventDispatcher::Instance().emit(NetworkSerializedPackageEvent(dataString, false));
+		break;
 	case ML_TEAM_REQUEST:
 	{
 		char team = nEvent.data->Message.rawMsg[1];
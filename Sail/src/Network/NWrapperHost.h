@@ -40,6 +40,7 @@ private:
 
 
 	void sendSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayeriD) override;
+	void sendUnreliableSerializedDataToClient(const std::string& data, Netcode::PlayerID PlayeriD) override;
 	/*
 		This will request clients to enter a new state. GameState, EndGameState etc.
 		id == 0 will send to all
@@ -224,6 +224,20 @@ size_t NWrapperSingleton::averagePacketSizeSinceLastCheck() {
 	return average;
 }
 
+Network::UnreliableStats NWrapperSingleton::getUnreliableStats() {
+	Network::UnreliableStats stats;
+	if (m_network) {
+		stats = m_network->getUnreliableStats();
+	}
+	return stats;
+}
+
+void NWrapperSingleton::setLossSimulation(const LossSimulator::Settings& settings) {
+	if (m_network) {
+		m_network->setLossSimulation(settings);
+	}
+}
+
 Netcode::PlayerID NWrapperSingleton::reservePlayerID() {
 	
 	if (m_unusedPlayerIds.empty()) {
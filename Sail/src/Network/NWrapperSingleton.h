@@ -3,6 +3,7 @@
 
 #include "NWrapperHost.h"
 #include "NWrapperClient.h"
+#include "NetworkModule.hpp"
 #include "Sail/entities/systems/network/receivers/MatchRecordSystem.h"
 
 class NetworkSenderSystem;
@@ -64,6 +65,9 @@ public:
 	void queueGameStateNetworkSenderEvent(Netcode::MessageType type, Netcode::MessageData* messageData, bool alsoSendToSelf = true);
 	unsigned char getPlayerLimit();
 	size_t averagePacketSizeSinceLastCheck();
+	Network::UnreliableStats getUnreliableStats();
+	// Drops and delays the datagrams this player receives on the unreliable channel
+	void setLossSimulation(const LossSimulator::Settings& settings);
 
 	MatchRecordSystem* recordSystem = nullptr;
 
@@ -16,16 +16,6 @@ Network::Network() {}
 Network::~Network() {
 	shutdown();
 
-	for (int i = 0; i < MAX_AWAITING_PACKAGES; ++i) {
-		if (m_awaitingEvents[i].eventType != NETWORK_EVENT_TYPE::HOST_ON_LAN_FOUND && m_awaitingMessages[i].Message.rawMsg != nullptr) {
-			delete[] m_awaitingMessages[i].Message.rawMsg;
-			m_awaitingMessages[i].Message.rawMsg = nullptr;
-		}
-	}
-
-	delete[] m_awaitingEvents;
-	delete[] m_awaitingMessages;
-
 	WSACleanup();
 }
 
@@ -46,8 +36,7 @@ bool Network::initialize() {
 		return false;
 	}
 
-	m_awaitingMessages = SAIL_NEW NetworkEventData[MAX_AWAITING_PACKAGES];
-	m_awaitingEvents = SAIL_NEW NetworkEvent[MAX_AWAITING_PACKAGES];
+	m_awaitingEvents.resize(MAX_AWAITING_PACKAGES);
 
 	m_initializedStatus = INITIALIZED_STATUS::INITIALIZED;
 	m_shutdown = false;
@@ -56,40 +45,33 @@ bool Network::initialize() {
 }
 
 void Network::checkForPackages(NetworkEventHandler& handler) {
-	//for (auto& temp : m_connections) {
-	//	std::cout << "--------------------\n";
-	//	std::cout << temp.second->id << "\n";
-	//	std::cout << "--------------------\n\n";
-	//}
-
-	bool morePackages = true;
-	while (morePackages) {
-		std::lock_guard<std::mutex> lock(m_mutex_packages);
-
-#if defined(DEVELOPMENT) && defined(_LOG_TO_FILE)
-		out << "nPackages: " << std::to_string(std::abs(m_pend - m_pstart)) << "\n";
-#endif
-
-		if (m_pstart == m_pend) {
-			morePackages = false;
-			break;
+	AwaitingEvent awaiting;
+	const unsigned int session = m_session;
+	while (popNetworkEvent(awaiting)) {
+		if (!handleInternally(awaiting)) {
+			handler.handleNetworkEvents(awaiting.event);
+		}
+		// Shutting down from the handler has already deleted the connections
+		if (m_session == session) {
+			releaseNetworkEvent(awaiting);
 		}
-		handler.handleNetworkEvents(m_awaitingEvents[m_pstart]);
-		m_pstart = (m_pstart + 1) % MAX_AWAITING_PACKAGES;
 	}
+	m_packagesHandled.notify_all();
 }
 
 void Network::checkForPackages(void (*m_callbackfunction)(NetworkEvent)) {
-	bool morePackages = true;
-	while (morePackages) {
-		std::lock_guard<std::mutex> lock(m_mutex_packages);
-		if (m_pstart == m_pend) {
-			morePackages = false;
-			break;
+	AwaitingEvent awaiting;
+	const unsigned int session = m_session;
+	while (popNetworkEvent(awaiting)) {
+		if (!handleInternally(awaiting)) {
+			m_callbackfunction(awaiting.event);
+		}
+		// Shutting down from the handler has already deleted the connections
+		if (m_session == session) {
+			releaseNetworkEvent(awaiting);
 		}
-		m_callbackfunction(m_awaitingEvents[m_pstart]);
-		m_pstart = (m_pstart + 1) % MAX_AWAITING_PACKAGES;
 	}
+	m_packagesHandled.notify_all();
 }
 
 bool Network::host(unsigned short port, USHORT hostFlags) {
@@ -136,8 +118,13 @@ bool Network::host(unsigned short port, USHORT hostFlags) {
 	m_shutdown = false;
 	m_initializedStatus = INITIALIZED_STATUS::IS_SERVER;
 
-	//Start a new thread that will wait for new connections
-	m_clientAcceptThread = SAIL_NEW std::thread(&Network::waitForNewConnections, this);
+	//Start the thread that will wait for new connections and messages
+	m_poller = SAIL_NEW SocketPoller;
+	m_poller->add(m_soc, nullptr);
+	if (!startUnreliableChannel(m_myAddr)) {
+		SAIL_LOG_WARNING("Could not start the unreliable channel, everything will be sent over TCP");
+	}
+	startIOThread();
 	if (m_hostFlags & (USHORT)HostFlags::ENABLE_LAN_SEARCH_VISIBILITY && !startUDPSocket(m_udp_localbroadcastport)) {
 		return false;
 	}
@@ -187,11 +174,31 @@ bool Network::join(const char* IP_adress, unsigned short hostport) {
 	conn->ip = "";
 	conn->port = ntohs(m_myAddr.sin_port);
 	conn->tcp_id = 0;
-	conn->thread = SAIL_NEW std::thread(&Network::listen, this, conn); //Create new listening thread listening for the host
-	m_connections[conn->tcp_id] = conn;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		m_connections[conn->tcp_id] = conn;
+	}
 
+	m_shutdown = false;
 	m_initializedStatus = INITIALIZED_STATUS::IS_CLIENT;
 
+	NetworkEvent nEvent;
+	nEvent.from_tcp_id = conn->tcp_id;
+	nEvent.eventType = NETWORK_EVENT_TYPE::CONNECTION_ESTABLISHED;
+	addNetworkEvent(nEvent, 0);
+
+	//Start the thread that will listen for messages from the host
+	m_poller = SAIL_NEW SocketPoller;
+	m_poller->add(m_soc, conn);
+	sockaddr_in anyAddress = { 0 };
+	anyAddress.sin_family = AF_INET;
+	anyAddress.sin_addr.S_un.S_addr = ADDR_ANY;
+	anyAddress.sin_port = 0;
+	if (!startUnreliableChannel(anyAddress)) {
+		SAIL_LOG_WARNING("Could not start the unreliable channel, everything will be sent over TCP");
+	}
+	startIOThread();
+
 	return true;
 }
 
@@ -207,118 +214,118 @@ bool Network::send(const char* message, size_t size, TCP_CONNECTION_ID receiverI
 		SAIL_LOG("Packet size: " + std::to_string(size));
 	}
 
-	if (size > 10000) {
+	if (size > MAX_MESSAGE_SIZE) {
 		abort();
 	}
 
+	std::lock_guard<std::mutex> sendLock(m_mutex_send);
+	frameMessage(message, size);
 
-	if (receiverID == -1 && m_initializedStatus == INITIALIZED_STATUS::IS_SERVER) {
-		int success = 0;
-		Connection* conn = nullptr;
-		for (auto it : m_connections) {
-			conn = it.second;
-			if (send(message, size, conn))
-				success++;
+	m_sendConnections.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		if (receiverID == -1 && m_initializedStatus == INITIALIZED_STATUS::IS_SERVER) {
+			for (auto it : m_connections) {
+				m_sendConnections.push_back(it.second);
+			}
+		} else {
+			auto it = m_connections.find(receiverID);
+			if (it == m_connections.end()) {
+				return false;
+			}
+			m_sendConnections.push_back(it->second);
 		}
-		return true;
 	}
 
+	bool success = true;
+	for (Connection* conn : m_sendConnections) {
+		success = sendFrame(conn) && success;
+	}
+	return success;
+}
 
-	size_t upper = size >> 8;
-	char t[2] = { reinterpret_cast<char&>(size), reinterpret_cast<char&>(upper) };
-	size_t packetSize = 2 + size;
-	char* msg = SAIL_NEW char[packetSize]();
-
-	// The message starts with a size_t stating how large the message is
-	memcpy(&msg[0], t, 2);
-
-	// The rest of msg is the actual message
-	memcpy(&msg[2], message, size);
-
-	//// serialize the packet size and place that information at the beginning of the packet
-	//std::ostringstream os(std::ios::binary);
-	//{
-	//	cereal::PortableBinaryOutputArchive ar(os);
-	//	ar(size);
-	//}
-	//std::string msgSizeString = os.str();
-
-	//size_t packetSize = MSG_SIZE_STR_LEN + size;
-	//char* msg = SAIL_NEW char[packetSize]();
+bool Network::sendUnreliable(const char* message, size_t size, TCP_CONNECTION_ID receiverID) {
+	if (DATAGRAM_HEADER_SIZE + size > MAX_DATAGRAM_SIZE || m_udpGameSocket == 0) {
+		return send(message, size, receiverID);
+	}
 
-	//// The message starts with a size_t stating how large the message is
-	//memcpy(&msg[0], msgSizeString.c_str(), MSG_SIZE_STR_LEN);
+	m_nrOfPacketsSentSinceLast++;
+	m_sizeOfPacketsSentSinceLast += size;
 
-	//// The rest of msg is the actual message
-	//memcpy(&msg[MSG_SIZE_STR_LEN], message, size);
+	std::lock_guard<std::mutex> sendLock(m_mutex_send);
 
-	Connection* conn = nullptr;
+	m_sendConnections.clear();
 	{
-		std::lock_guard<std::mutex> mu(m_mutex_connections);
-		if (!m_connections.count(receiverID)) {
-			delete[] msg;
-			return false;
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		if (receiverID == -1 && m_initializedStatus == INITIALIZED_STATUS::IS_SERVER) {
+			for (auto it : m_connections) {
+				m_sendConnections.push_back(it.second);
+			}
+		} else {
+			auto it = m_connections.find(receiverID);
+			if (it == m_connections.end()) {
+				return false;
+			}
+			m_sendConnections.push_back(it->second);
 		}
-
-		conn = m_connections[receiverID];
 	}
 
-	if (!conn) {
-		delete[] msg;
-		return false;
+	m_datagramBuffer.resize(DATAGRAM_HEADER_SIZE + size);
+	if (size) {
+		memcpy(&m_datagramBuffer[DATAGRAM_HEADER_SIZE], message, size);
 	}
 
-	if (!conn->isConnected) {
-		delete[] msg;
-		return false;
-	}
+	bool success = true;
+	bool framed = false;
+	for (Connection* conn : m_sendConnections) {
+		sockaddr_in address;
+		std::uint32_t token;
+		{
+			// The I/O thread sets the address when the first datagram from the client arrives
+			std::lock_guard<std::mutex> lock(m_mutex_connections);
+			if (!conn->isConnected) {
+				success = false;
+				continue;
+			}
+			if (!conn->hasUdpAddress) {
+				if (!framed) {
+					frameMessage(message, size);
+					framed = true;
+				}
+				success = sendFrame(conn) && success;
+				continue;
+			}
+			address = conn->udpAddress;
+			token = conn->udpToken;
+		}
 
-	if (::send(conn->socket, msg, packetSize, 0) == SOCKET_ERROR) {
-		delete[] msg;
-		return false;
+		const std::uint16_t sequence = ++conn->udpSendSequence;
+		memcpy(&m_datagramBuffer[0], &token, sizeof(token));
+		memcpy(&m_datagramBuffer[sizeof(token)], &sequence, sizeof(sequence));
+		if (::sendto(m_udpGameSocket, m_datagramBuffer.data(), (int)m_datagramBuffer.size(), 0, (sockaddr*)& address, sizeof(address)) == SOCKET_ERROR) {
+			success = false;
+		}
 	}
-
-	delete[] msg;
-	return true;
+	return success;
 }
 
-bool Network::send(const char* message, size_t size, Connection* conn) {
-	if (!conn->isConnected) {
-		return false;
-	}
-
-	// serialize the packet size and place that information at the beginning of the packet
-	//std::ostringstream os(std::ios::binary);
-	//{
-	//	cereal::PortableBinaryOutputArchive ar(os);
-	//	ar(size);
-	//}
-	//std::string msgSizeString = os.str();
-
-	if (size > 10000) {
-		abort();
+void Network::frameMessage(const char* message, size_t size, unsigned int flags) {
+	// The message starts with two bytes stating how large the message is, the rest of it is the actual message
+	const size_t header = size | flags;
+	m_sendBuffer.resize(ReceiveRing::HEADER_SIZE + size);
+	m_sendBuffer[0] = static_cast<char>(header & 0xFF);
+	m_sendBuffer[1] = static_cast<char>(header >> 8);
+	if (size) {
+		memcpy(&m_sendBuffer[ReceiveRing::HEADER_SIZE], message, size);
 	}
+}
 
-	size_t upper = size >> 8;
-	char t[2] = { reinterpret_cast<char&>(size), reinterpret_cast<char&>(upper) };
-	size_t packetSize = 2 + size;
-	char* msg = SAIL_NEW char[packetSize]();
-
-	// The message starts with a size_t stating how large the message is
-	//memcpy(&msg[0], msgSizeString.c_str(), MSG_SIZE_STR_LEN);
-	memcpy(&msg[0], t, 2);
-
-	// The rest of msg is the actual message
-	//memcpy(&msg[MSG_SIZE_STR_LEN], message, size);
-	memcpy(&msg[2], message, size);
-
-	if (::send(conn->socket, msg, packetSize, 0) == SOCKET_ERROR) {
-		delete[] msg;
+bool Network::sendFrame(Connection* conn) {
+	if (!conn->isConnected) {
 		return false;
 	}
 
-	delete[] msg;
-	return true;
+	return ::send(conn->socket, m_sendBuffer.data(), (int)m_sendBuffer.size(), 0) != SOCKET_ERROR;
 }
 
 void Network::setServerMetaDescription(const char* desc, int descSize) {
@@ -522,39 +529,64 @@ void Network::shutdown() {
 
 	m_shutdown = true;
 
+	// Stop the I/O thread first, nothing else removes or reads from the sockets
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_packages);
+	}
+	m_packagesHandled.notify_all();
+	if (m_ioThread) {
+		m_poller->wake();
+		m_ioThread->join();
+		delete m_ioThread;
+		m_ioThread = nullptr;
+	}
+
 	if (m_initializedStatus == INITIALIZED_STATUS::IS_SERVER) {
 		::shutdown(m_soc, 2);
 		if (closesocket(m_soc) == SOCKET_ERROR) {
-			m_soc = 0;
 #ifdef DEBUG_NETWORK
 			printf("Error closing m_soc\n");
 #endif
-		} else if (m_clientAcceptThread) {
-			m_clientAcceptThread->join();
-			delete m_clientAcceptThread;
 		}
+		m_soc = 0;
 	}
 
 	{
+		std::lock_guard<std::mutex> sendLock(m_mutex_send);
 		std::lock_guard<std::mutex> lock(m_mutex_connections);
 		for (auto it : m_connections) {
 			Connection* conn = it.second;
 			::shutdown(conn->socket, 2);
 			if (closesocket(conn->socket) == SOCKET_ERROR) {
 #ifdef DEBUG_NETWORK
-				printf((std::string("Error closing socket") + std::to_string(conn->id) + "\n").c_str());
+				printf((std::string("Error closing socket") + std::to_string(conn->tcp_id) + "\n").c_str());
 #endif
-			} else if (conn->thread) {
-				conn->thread->join();
-				delete conn->thread;
-				delete conn;
 			}
+			delete conn;
 		}
+		m_connections.clear();
+		m_udpTokens.clear();
+	}
+
+	// The events that haven't been handled point into the receive buffers of the deleted connections
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_packages);
+		m_pstart = 0;
+		m_pend = 0;
 	}
+	m_session++;
+
+	delete m_poller;
+	m_poller = nullptr;
+
+	if (m_udpGameSocket) {
+		closesocket(m_udpGameSocket);
+		m_udpGameSocket = 0;
+	}
+	m_datagramRing.reset();
 
 	stopUDP();
 
-	m_connections.clear();
 	m_initializedStatus = INITIALIZED_STATUS::INITIALIZED;
 }
 
@@ -592,26 +624,27 @@ void Network::startUDP() {
 }
 
 void Network::kickConnection(TCP_CONNECTION_ID tcp_id) {
-	if (m_connections.find(tcp_id) != m_connections.end()) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		auto it = m_connections.find(tcp_id);
+		if (it == m_connections.end()) {
+			return;
+		}
 		//TODO: Send Kicked Message to be nice.
+		it->second->wasKicked = true;
+	}
 
-		Connection* conn = m_connections[tcp_id];
-		conn->wasKicked = true;
-		::shutdown(conn->socket, 2);
-		if (closesocket(conn->socket) == SOCKET_ERROR) {
-#ifdef DEBUG_NETWORK
-			printf((std::string("Error closing socket") + std::to_string(conn->id) + "\n").c_str());
-#endif
-		} else if (conn->thread) {
-			conn->thread->join();
-			delete conn->thread;
-			delete conn;
-		}
+	// Only the I/O thread closes connections
+	m_kickRequested = true;
+	if (m_poller) {
+		m_poller->wake();
 	}
 }
 
 bool Network::wasKicked(TCP_CONNECTION_ID tcp_id) {
-	return m_connections[tcp_id]->wasKicked;
+	std::lock_guard<std::mutex> lock(m_mutex_connections);
+	auto it = m_connections.find(tcp_id);
+	return it != m_connections.end() && it->second->wasKicked;
 }
 
 size_t Network::averagePacketSizeSinceLastCheck() {
@@ -624,156 +657,393 @@ size_t Network::averagePacketSizeSinceLastCheck() {
 	return averageSize;
 }
 
-void Network::addNetworkEvent(NetworkEvent n, int dataSize, const char* data) {
-	std::lock_guard<std::mutex> lock(m_mutex_packages);
-	// delete previous message if there is one
-	if (m_awaitingEvents[m_pend].eventType != NETWORK_EVENT_TYPE::HOST_ON_LAN_FOUND && m_awaitingMessages[m_pend].Message.rawMsg != nullptr) {
-		delete[] m_awaitingMessages[m_pend].Message.rawMsg;
-		m_awaitingMessages[m_pend].Message.rawMsg = nullptr;
+Network::UnreliableStats Network::getUnreliableStats() {
+	UnreliableStats stats;
+	stats.received = m_datagramsReceivedCount;
+	stats.lost = m_datagramsLost;
+	stats.late = m_datagramsLate;
+	return stats;
+}
+
+void Network::setLossSimulation(const LossSimulator::Settings& settings) {
+	m_lossSimulator.setSettings(settings);
+	if (m_poller) {
+		m_poller->wake();
 	}
+}
 
-	// Copy the incoming data to a message
+void Network::addNetworkEvent(NetworkEvent n, int dataSize, char* data, ReceiveRing* ring, size_t frameSize, Connection* conn, bool control) {
+	std::unique_lock<std::mutex> lock(m_mutex_packages);
+	auto isFull = [&] { return (m_pend + 1) % MAX_AWAITING_PACKAGES == m_pstart; };
+
+	if (n.eventType == NETWORK_EVENT_TYPE::HOST_ON_LAN_FOUND) {
+		// Hosts keep answering, so it doesn't matter if one answer is lost
+		if (isFull()) {
+			return;
+		}
+	} else {
+		// Wait for the game to handle the older events instead of overwriting them
+		m_packagesHandled.wait(lock, [&] { return !isFull() || m_shutdown; });
+		if (m_shutdown) {
+			return;
+		}
+	}
 
+	AwaitingEvent& awaiting = m_awaitingEvents[m_pend];
 	if (n.eventType == NETWORK_EVENT_TYPE::HOST_ON_LAN_FOUND) {
 		// UDP MESSAGE
-		memcpy(&m_awaitingMessages[m_pend].HostFoundOnLanData, &n.data->HostFoundOnLanData, sizeof(n.data->HostFoundOnLanData));
+		memcpy(&awaiting.data.HostFoundOnLanData, &n.data->HostFoundOnLanData, sizeof(n.data->HostFoundOnLanData));
 	} else {
 		// All other messages
-		m_awaitingMessages[m_pend].Message.rawMsg = SAIL_NEW char[dataSize]();
-		memcpy(m_awaitingMessages[m_pend].Message.rawMsg, data, dataSize);
-		m_awaitingMessages[m_pend].Message.sizeOfMsg = dataSize;
+		awaiting.data.Message.rawMsg = data;
+		awaiting.data.Message.sizeOfMsg = dataSize;
 	}
 
-
-
-	m_awaitingEvents[m_pend].eventType = n.eventType;
-	m_awaitingEvents[m_pend].from_tcp_id = n.from_tcp_id;
-	m_awaitingEvents[m_pend].data = &m_awaitingMessages[m_pend];
+	awaiting.event.eventType = n.eventType;
+	awaiting.event.from_tcp_id = n.from_tcp_id;
+	awaiting.event.data = &awaiting.data;
+	awaiting.ring = ring;
+	awaiting.frameSize = frameSize;
+	awaiting.conn = conn;
+	awaiting.control = control;
 
 	m_pend = (m_pend + 1) % MAX_AWAITING_PACKAGES;
-	if (m_pend == m_pstart) {
-		m_pstart++;
+}
+
+bool Network::popNetworkEvent(AwaitingEvent& awaiting) {
+	std::lock_guard<std::mutex> lock(m_mutex_packages);
+	if (m_pstart == m_pend) {
+		return false;
 	}
+
+	awaiting = m_awaitingEvents[m_pstart];
+	awaiting.event.data = &awaiting.data;
+	m_pstart = (m_pstart + 1) % MAX_AWAITING_PACKAGES;
+	return true;
 }
 
-void Network::waitForNewConnections() {
-	while (!m_shutdown) {
-		sockaddr_in client;
-		int clientSize = sizeof(client);
+bool Network::handleInternally(const AwaitingEvent& awaiting) {
+	if (awaiting.event.eventType == NETWORK_EVENT_TYPE::CONNECTION_ESTABLISHED && m_initializedStatus == INITIALIZED_STATUS::IS_SERVER) {
+		// Give the client its token so that it can start using the unreliable channel
+		std::uint32_t token = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex_connections);
+			auto it = m_connections.find(awaiting.event.from_tcp_id);
+			if (it == m_connections.end()) {
+				return false;
+			}
+			token = it->second->udpToken;
+		}
+		char msg[1 + sizeof(token)] = { CONTROL_UDP_TOKEN };
+		memcpy(&msg[1], &token, sizeof(token));
 
-		SOCKET clientSocket = accept(m_soc, (sockaddr*)& client, &clientSize);
-		if (clientSocket == INVALID_SOCKET) {
-			//Do something
-			continue;
+		std::lock_guard<std::mutex> sendLock(m_mutex_send);
+		frameMessage(msg, sizeof(msg), ReceiveRing::CONTROL_FLAG);
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		auto it = m_connections.find(awaiting.event.from_tcp_id);
+		if (it != m_connections.end()) {
+			sendFrame(it->second);
 		}
+		return false;
+	}
 
-		char host[NI_MAXHOST] = { 0 }; // Client's remote name
+	if (!awaiting.control) {
+		return false;
+	}
 
-		inet_ntop(AF_INET, &client.sin_addr, host, NI_MAXHOST);
+	const NetworkEventData& data = awaiting.data;
+	if (data.Message.sizeOfMsg == 1 + sizeof(std::uint32_t) && data.Message.rawMsg[0] == CONTROL_UDP_TOKEN && m_udpGameSocket) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex_connections);
+			memcpy(&awaiting.conn->udpToken, &data.Message.rawMsg[1], sizeof(std::uint32_t));
+			awaiting.conn->udpAddress = m_myAddr;
+			awaiting.conn->hasUdpAddress = true;
+		}
+		// An empty datagram tells the host where to send datagrams until the first real one arrives
+		sendUnreliable(nullptr, 0, awaiting.conn->tcp_id);
+	}
+	return true;
+}
 
-		if (m_allowConnections) {
-			Connection* conn = SAIL_NEW Connection;
-			conn->isConnected = true;
-			conn->socket = clientSocket;
-			conn->ip = host;
-			conn->port = ntohs(client.sin_port);
+void Network::releaseNetworkEvent(const AwaitingEvent& awaiting) {
+	if (awaiting.frameSize) {
+		// Released with the lock so that the I/O thread can't miss it while waiting for space
+		std::lock_guard<std::mutex> lock(m_mutex_packages);
+		awaiting.ring->release(awaiting.frameSize);
+	}
 
-			bool ok = false;
-			do {
-				conn->tcp_id = generateID();
-				if (m_connections.find(conn->tcp_id) == m_connections.end()) {
-					ok = true;
-				}
-			} while (!ok);
+	// The closed event is the last one of a connection, nothing refers to it after that
+	if (awaiting.event.eventType == NETWORK_EVENT_TYPE::CONNECTION_CLOSED && awaiting.conn) {
+		std::lock_guard<std::mutex> sendLock(m_mutex_send);
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		m_connections.erase(awaiting.conn->tcp_id);
+		m_udpTokens.erase(awaiting.conn->udpToken);
+		closesocket(awaiting.conn->socket);
+		delete awaiting.conn;
+	}
+}
 
-			conn->thread = SAIL_NEW std::thread(&Network::listen, this, conn); //Create new listening thread for the new connection
-			m_connections[conn->tcp_id] = conn;
-		} else {
-			//TODO: send event that a connection was denied joining(maybe)?
+void Network::startIOThread() {
+	m_kickRequested = false;
+	m_ioThread = SAIL_NEW std::thread(&Network::processSocketEvents, this);
+}
 
-			//Close connection if m_allowConnections == false
-			closesocket(clientSocket);
-			continue;
+void Network::processSocketEvents() {
+	std::vector<SocketPoller::Event> events;
+	std::vector<Connection*> kicked;
+
+	std::vector<char> delayed;
+	sockaddr_in delayedFrom;
+
+	while (!m_shutdown) {
+		m_poller->wait(events, m_lossSimulator.getTimeoutMs());
+
+		for (const SocketPoller::Event& e : events) {
+			if (m_shutdown) {
+				break;
+			}
+			if (e.userData == &m_udpGameSocket) {
+				receiveDatagram();
+			} else if (e.userData) {
+				receive(static_cast<Connection*>(e.userData));
+			} else {
+				acceptConnection();
+			}
+		}
+
+		while (!m_shutdown && m_lossSimulator.pop(delayed, &delayedFrom)) {
+			handleDatagram(delayed.data(), delayed.size(), delayedFrom);
+		}
+
+		if (m_kickRequested.exchange(false)) {
+			kicked.clear();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex_connections);
+				for (auto it : m_connections) {
+					if (it.second->wasKicked && it.second->isConnected) {
+						kicked.push_back(it.second);
+					}
+				}
+			}
+			for (Connection* conn : kicked) {
+				closeConnection(conn);
+			}
 		}
 	}
 }
 
-void Network::listen(Connection* conn) {
+void Network::acceptConnection() {
+	sockaddr_in client;
+	int clientSize = sizeof(client);
+
+	SOCKET clientSocket = accept(m_soc, (sockaddr*)& client, &clientSize);
+	if (clientSocket == INVALID_SOCKET) {
+		return;
+	}
+
+	if (!m_allowConnections) {
+		//TODO: send event that a connection was denied joining(maybe)?
+		closesocket(clientSocket);
+		return;
+	}
+
+	char host[NI_MAXHOST] = { 0 }; // Client's remote name
+	inet_ntop(AF_INET, &client.sin_addr, host, NI_MAXHOST);
+
+	Connection* conn = SAIL_NEW Connection;
+	conn->isConnected = true;
+	conn->socket = clientSocket;
+	conn->ip = host;
+	conn->port = ntohs(client.sin_port);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		do {
+			conn->tcp_id = generateID();
+		} while (m_connections.find(conn->tcp_id) != m_connections.end());
+		m_connections[conn->tcp_id] = conn;
+
+		// Zero is never used so that datagrams without a token are ignored
+		do {
+			conn->udpToken = static_cast<std::uint32_t>(m_random());
+		} while (conn->udpToken == 0 || m_udpTokens.find(conn->udpToken) != m_udpTokens.end());
+		m_udpTokens[conn->udpToken] = conn;
+	}
+
 	NetworkEvent nEvent;
 	nEvent.from_tcp_id = conn->tcp_id;
 	nEvent.eventType = NETWORK_EVENT_TYPE::CONNECTION_ESTABLISHED;
 	addNetworkEvent(nEvent, 0);
 
-	//bool connectionIsClosed = false;
-	//char incomingPackageSize[MSG_SIZE_STR_LEN];
-	char incomingPackageSize[2];
-	size_t bytesToReceive = 0;
-
-	while (conn->isConnected && !m_shutdown) {
-		//ZeroMemory(incomingPackageSize, MSG_SIZE_STR_LEN);
-		ZeroMemory(incomingPackageSize, 2);
-
-		// Find out how large the incoming packet is
-		//int b = recv(conn->socket, incomingPackageSize, MSG_SIZE_STR_LEN, 0);
-		int b = recv(conn->socket, incomingPackageSize, 2, 0);
-		if (b == 0 || b == SOCKET_ERROR) {
-			conn->isConnected = false;
-			nEvent.eventType = NETWORK_EVENT_TYPE::CONNECTION_CLOSED;
-			addNetworkEvent(nEvent, 0);
-			break;
-		}
-
-		// Read how many bytes to receive
-		//std::istringstream is(std::string(incomingPackageSize, MSG_SIZE_STR_LEN));
-		//{
-		//	cereal::PortableBinaryInputArchive ar(is);
-		//	ar(bytesToReceive);
-		//}
-
-		bytesToReceive = (unsigned char)(incomingPackageSize[0]);
-		size_t test = 0;
-		test = (unsigned char)(incomingPackageSize[1]);
-		test <<= 8;
-		bytesToReceive |= test;
-
-		if (bytesToReceive>10000) {
-			SAIL_LOG("INVALID SIZE");
-		}
-
+	m_poller->add(clientSocket, conn);
+}
 
-		// Get the incoming packet and place it in a char array
-		char* msg = SAIL_NEW char[bytesToReceive]();
-		int bytesReceived = recv(conn->socket, msg, bytesToReceive, 0);
+void Network::receive(Connection* conn) {
+	size_t space = 0;
+	char* dst = nullptr;
+	{
+		// Wait for the game to handle the messages that have already been received if there is no space left for more
+		std::unique_lock<std::mutex> lock(m_mutex_packages);
+		m_packagesHandled.wait(lock, [&] {
+			dst = conn->received.getWritePointer(space);
+			return space > 0 || m_shutdown;
+		});
+	}
+	if (m_shutdown) {
+		return;
+	}
 
+	// Doesn't block since the socket is readable, reads as much as has arrived
+	int bytesReceived = recv(conn->socket, dst, (int)space, 0);
+	if (bytesReceived == 0 || bytesReceived == SOCKET_ERROR) {
 #ifdef DEBUG_NETWORK
-		printf((std::string("bytesReceived: ") + std::to_string(bytesReceived) + "\n").c_str());
-#endif // DEBUG_NETWORK		
-		switch (bytesReceived) {
-		case 0:
-#ifdef DEBUG_NETWORK
-			printf("Client Disconnected\n");
-#else
-		case SOCKET_ERROR:
+		printf("Client Disconnected\n");
 #endif // DEBUG_NETWORK
-			conn->isConnected = false;
-			nEvent.eventType = NETWORK_EVENT_TYPE::CONNECTION_CLOSED;
-			addNetworkEvent(nEvent, 0);
-			break;
-#ifdef DEBUG_NETWORK
-		case SOCKET_ERROR:
-			printf("Error Receiving: Disconnecting client.\n");
-			connectionIsClosed = true;
-			nEvent.eventType = NETWORK_EVENT_TYPE::CONNECTION_CLOSED;
-			addNetworkEvent(nEvent, 0);
-			break;
-#endif // DEBUG_NETWORK
-		default:
-			nEvent.eventType = NETWORK_EVENT_TYPE::MSG_RECEIVED;
-			addNetworkEvent(nEvent, bytesReceived, msg);
+		closeConnection(conn);
+		return;
+	}
+	conn->received.commit(bytesReceived);
+
+	NetworkEvent nEvent;
+	nEvent.from_tcp_id = conn->tcp_id;
+	nEvent.eventType = NETWORK_EVENT_TYPE::MSG_RECEIVED;
+
+	char* msg = nullptr;
+	size_t size = 0;
+	size_t frameSize = 0;
+	ReceiveRing::FrameResult result;
+	while ((result = conn->received.nextFrame(msg, size, frameSize)) == ReceiveRing::FrameResult::FRAME || result == ReceiveRing::FrameResult::CONTROL) {
+		addNetworkEvent(nEvent, (int)size, msg, &conn->received, frameSize, conn, result == ReceiveRing::FrameResult::CONTROL);
+	}
+
+	if (result == ReceiveRing::FrameResult::INVALID) {
+		SAIL_LOG_WARNING("Received a message larger than " + std::to_string(MAX_MESSAGE_SIZE) + " bytes, closing the connection");
+		closeConnection(conn);
+	}
+}
 
-			break;
+void Network::closeConnection(Connection* conn) {
+	m_poller->remove(conn->socket);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		conn->isConnected = false;
+	}
+	// The socket is closed when the connection is deleted, so that its handle can't be reused while it is still in m_connections
+	::shutdown(conn->socket, 2);
+
+	NetworkEvent nEvent;
+	nEvent.from_tcp_id = conn->tcp_id;
+	nEvent.eventType = NETWORK_EVENT_TYPE::CONNECTION_CLOSED;
+	addNetworkEvent(nEvent, 0, nullptr, nullptr, 0, conn);
+}
+
+bool Network::startUnreliableChannel(const sockaddr_in& address) {
+	m_udpGameSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (m_udpGameSocket == INVALID_SOCKET) {
+		m_udpGameSocket = 0;
+		return false;
+	}
+	if (bind(m_udpGameSocket, (sockaddr*)& address, sizeof(address)) == SOCKET_ERROR) {
+		closesocket(m_udpGameSocket);
+		m_udpGameSocket = 0;
+		return false;
+	}
+
+	m_datagramsReceivedCount = 0;
+	m_datagramsLost = 0;
+	m_datagramsLate = 0;
+	m_poller->add(m_udpGameSocket, &m_udpGameSocket);
+	return true;
+}
+
+void Network::receiveDatagram() {
+	char buffer[MAX_DATAGRAM_SIZE];
+	sockaddr_in from = { 0 };
+	int fromSize = sizeof(from);
+
+	int bytesReceived = recvfrom(m_udpGameSocket, buffer, sizeof(buffer), 0, (sockaddr*)& from, &fromSize);
+	if (bytesReceived < (int)DATAGRAM_HEADER_SIZE) {
+		return;
+	}
+
+	if (m_lossSimulator.isEnabled()) {
+		m_lossSimulator.push(buffer, bytesReceived, &from, sizeof(from));
+		return;
+	}
+	handleDatagram(buffer, bytesReceived, from);
+}
+
+void Network::handleDatagram(const char* data, size_t size, const sockaddr_in& from) {
+	std::uint32_t token;
+	std::uint16_t sequence;
+	memcpy(&token, data, sizeof(token));
+	memcpy(&sequence, data + sizeof(token), sizeof(sequence));
+
+	// Connections are only deleted after this thread has closed them, so conn stays valid as long as it is connected
+	Connection* conn = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex_connections);
+		if (m_initializedStatus == INITIALIZED_STATUS::IS_SERVER) {
+			auto it = m_udpTokens.find(token);
+			if (it == m_udpTokens.end()) {
+				return;
+			}
+			conn = it->second;
+			// The client's address can change, datagrams are sent to wherever the latest one came from
+			conn->udpAddress = from;
+			conn->hasUdpAddress = true;
+		} else {
+			auto it = m_connections.find(0);
+			if (it == m_connections.end() || it->second->udpToken != token || token == 0) {
+				return;
+			}
+			conn = it->second;
+		}
+		if (!conn->isConnected) {
+			return;
+		}
+	}
+
+	// Sequence numbers wrap around, a datagram is newer if it is less than half of the range ahead
+	if (conn->hasReceivedDatagram) {
+		const std::int16_t ahead = static_cast<std::int16_t>(sequence - conn->udpReceiveSequence);
+		if (ahead <= 0) {
+			// It was counted as lost when a newer one arrived first, only the I/O thread changes the counters
+			m_datagramsLate++;
+			if (ahead < 0 && m_datagramsLost > 0) {
+				m_datagramsLost--;
+			}
+			return;
 		}
+		m_datagramsLost += ahead - 1;
+	}
+	conn->udpReceiveSequence = sequence;
+	conn->hasReceivedDatagram = true;
+
+	const size_t messageSize = size - DATAGRAM_HEADER_SIZE;
+	if (messageSize == 0) {
+		return;
+	}
+	m_datagramsReceivedCount++;
+
+	{
+		// Wait for the game to handle older messages if there is no space left
+		std::unique_lock<std::mutex> lock(m_mutex_packages);
+		m_packagesHandled.wait(lock, [&] {
+			return m_datagramRing.writeFrame(data + DATAGRAM_HEADER_SIZE, messageSize) || m_shutdown;
+		});
+	}
+	if (m_shutdown) {
+		return;
+	}
 
-		delete[] msg;
+	NetworkEvent nEvent;
+	nEvent.from_tcp_id = conn->tcp_id;
+	nEvent.eventType = NETWORK_EVENT_TYPE::MSG_RECEIVED;
+
+	char* msg = nullptr;
+	size_t msgSize = 0;
+	size_t frameSize = 0;
+	if (m_datagramRing.nextFrame(msg, msgSize, frameSize) == ReceiveRing::FrameResult::FRAME) {
+		addNetworkEvent(nEvent, (int)msgSize, msg, &m_datagramRing, frameSize);
 	}
-}
\ No newline at end of file
+}
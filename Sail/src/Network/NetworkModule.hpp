@@ -1,13 +1,18 @@
 #pragma once
-#include <WS2tcpip.h>
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 #include <string>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <random>
 
 #include "NetworkStructs.hpp"
-#pragma comment (lib, "ws2_32.lib")
+#include "LossSimulator.h"
+#include "ReceiveRing.h"
+#include "SocketPoller.h"
 
 struct Connection
 {
@@ -17,15 +22,30 @@ struct Connection
 	bool isConnected;
 	bool wasKicked;
 	SOCKET socket;
-	std::thread* thread;//The thread used to listen for messages
-
-	Connection() {
+	ReceiveRing received; // Written by the I/O thread, read by checkForPackages()
+
+	// Unreliable channel, datagrams can't be sent before the address is known
+	std::uint32_t udpToken;
+	bool hasUdpAddress;
+	sockaddr_in udpAddress;
+	std::uint16_t udpSendSequence;
+	std::uint16_t udpReceiveSequence;
+	bool hasReceivedDatagram;
+
+	Connection()
+		: received(MAX_MESSAGE_SIZE)
+	{
 		tcp_id = 0;
 		isConnected = false;
 		wasKicked = false;
 		socket = NULL;
 		ip = port = "";
-		thread = nullptr;
+		udpToken = 0;
+		hasUdpAddress = false;
+		udpAddress = { 0 };
+		udpSendSequence = 0;
+		udpReceiveSequence = 0;
+		hasReceivedDatagram = false;
 	}
 };
 
@@ -58,6 +78,10 @@ public:
 	*/
 	bool initialize();
 
+	/*
+		Handles all events that have arrived since the last call.
+		The messages point straight into the receive buffer of their connection and are only valid during the call to the handler.
+	*/
 	void checkForPackages(NetworkEventHandler& handler);
 	void checkForPackages(void (*m_callbackfunction)(NetworkEvent));
 
@@ -82,6 +106,23 @@ public:
 		Return true if message could be sent to all receivers.
 	*/
 	bool send(const char* message, size_t size, TCP_CONNECTION_ID receiverID = 0);
+	/*
+		Same as send() but over UDP, for state that is sent every tick and where only the latest message matters.
+		The message can be lost but is never received after a newer one, older messages are dropped by the receiver.
+		It arrives as a normal MSG_RECEIVED event.
+
+		Messages sent before the UDP address of the receiver is known, and messages larger than MAX_UNRELIABLE_MESSAGE_SIZE,
+		are sent with send() instead.
+	*/
+	bool sendUnreliable(const char* message, size_t size, TCP_CONNECTION_ID receiverID = 0);
+
+	// Every datagram on the unreliable channel starts with the token of the client and a sequence number
+	static constexpr size_t DATAGRAM_HEADER_SIZE = sizeof(std::uint32_t) + sizeof(std::uint16_t);
+	// Datagrams larger than one ethernet frame are fragmented by IP and lost if any of the fragments are.
+	// 1200 bytes leaves room for the IP and UDP headers and for tunnels that lower the MTU.
+	static constexpr size_t MAX_DATAGRAM_SIZE = 1200;
+	// Larger messages have to be split by the sender to be sent unreliably
+	static constexpr size_t MAX_UNRELIABLE_MESSAGE_SIZE = MAX_DATAGRAM_SIZE - DATAGRAM_HEADER_SIZE;
 	/*
 		Set server meta description.
 		This meta data is optional and sent to the clients on lan when a client calls searchHostsOnLan().
@@ -144,12 +185,33 @@ public:
 	*/
 	void startUDP();
 
+	/*
+		Closes the connection, the CONNECTION_CLOSED event is sent once the I/O thread has stopped listening to it.
+	*/
 	void kickConnection(TCP_CONNECTION_ID tcp_id);
 	bool wasKicked(TCP_CONNECTION_ID tcp_id);
 
 	size_t averagePacketSizeSinceLastCheck();
+
+	struct UnreliableStats {
+		size_t received = 0;
+		size_t lost = 0;	// Datagrams that never arrived, found from gaps in the sequence numbers
+		size_t late = 0;	// Datagrams that arrived after a newer one and were dropped
+	};
+	UnreliableStats getUnreliableStats();
+	/*
+		Drops and delays the datagrams that are received from now on, to test the unreliable channel over loopback.
+		Stays on until it is turned off with default settings.
+	*/
+	void setLossSimulation(const LossSimulator::Settings& settings);
 private:
 
+	// Messages sent with ReceiveRing::CONTROL_FLAG, handled by the Network instead of the game
+	enum CONTROL_MESSAGE_TYPE : char
+	{
+		CONTROL_UDP_TOKEN = 1, // Sent by the host, the client puts it in every datagram so that the host knows who sent it
+	};
+
 	enum UDP_DATA_PACKAGE_TYPE : char
 	{
 		UDP_DATA_PACKAGE_TYPE_HOSTINFO = 1,
@@ -177,7 +239,7 @@ private:
 	};
 	static_assert(sizeof(UDP_DATA) == MAX_PACKAGE_SIZE, "sizeof(UDP_DATA) is not what you expect! Check your struct man.");
 
-	bool m_shutdown = false;
+	std::atomic<bool> m_shutdown{ false };
 	bool m_shutdownUDP = false;
 	char m_serverMetaDesc[HOST_META_DESC_SIZE];
 	bool m_allowConnections = true;
@@ -185,9 +247,13 @@ private:
 	//TCP CONNECTION
 	SOCKET m_soc = 0;
 	sockaddr_in m_myAddr = { 0 };
-	std::thread* m_clientAcceptThread = nullptr;
 	USHORT m_hostPort = 0;
 
+	// One thread accepts connections and receives messages from all of them
+	SocketPoller* m_poller = nullptr;
+	std::thread* m_ioThread = nullptr;
+	std::atomic<bool> m_kickRequested{ false };
+
 	//UDP CONNECTION
 	const USHORT m_udp_localbroadcastport = 444;
 	SOCKET m_udp_broadcast_socket = 0;
@@ -197,6 +263,17 @@ private:
 
 	std::thread* m_UDPListener = nullptr;
 
+	// Unreliable channel, uses the same port number as TCP on the host
+	SOCKET m_udpGameSocket = 0;
+	ReceiveRing m_datagramRing{ MAX_MESSAGE_SIZE };
+	std::unordered_map<std::uint32_t, Connection*> m_udpTokens; // Host only, do not access without m_mutex_connections
+	std::vector<char> m_datagramBuffer;
+	LossSimulator m_lossSimulator;
+	std::atomic<size_t> m_datagramsReceivedCount{ 0 };
+	std::atomic<size_t> m_datagramsLost{ 0 };
+	std::atomic<size_t> m_datagramsLate{ 0 };
+	std::mt19937 m_random{ std::random_device{}() };
+
 	//GENERIC
 	INITIALIZED_STATUS m_initializedStatus = INITIALIZED_STATUS::NOT_INITIALIZED;
 
@@ -206,13 +283,28 @@ private:
 	/*Do not access m_connections without mutex lock*/
 	std::unordered_map<size_t, Connection*> m_connections;
 	std::mutex m_mutex_connections;
-
-	NetworkEventData* m_awaitingMessages;
-	NetworkEvent* m_awaitingEvents;
+	// The length prefixed message being sent and who it is sent to, closed connections aren't deleted while it is locked
+	std::vector<char> m_sendBuffer;
+	std::vector<Connection*> m_sendConnections;
+	std::mutex m_mutex_send;
+
+	struct AwaitingEvent {
+		NetworkEvent event;
+		NetworkEventData data;
+		// The part of the receive buffer to release once the event has been handled
+		ReceiveRing* ring = nullptr;
+		size_t frameSize = 0;
+		Connection* conn = nullptr;
+		bool control = false; // Handled by the Network instead of the handler
+	};
+	std::vector<AwaitingEvent> m_awaitingEvents;
 
 	int m_pstart = 0;
 	int m_pend = 0;
+	unsigned int m_session = 0; // Increased by shutdown()
 	std::mutex m_mutex_packages;
+	// Notified when events have been handled, the I/O thread waits for it when the events or a receive buffer is full
+	std::condition_variable m_packagesHandled;
 
 	size_t m_nrOfPacketsSentSinceLast = 0;
 	size_t m_sizeOfPacketsSentSinceLast = 0;
@@ -222,22 +314,33 @@ private:
 	bool udpSend(sockaddr* addr, char* msg, int msgSize);
 
 	TCP_CONNECTION_ID generateID();
-	bool send(const char* message, size_t size, Connection* conn);
-	void addNetworkEvent(NetworkEvent n, int dataSize, const char* data = nullptr);
-
+	// Puts the message in m_sendBuffer with its length in front of it
+	void frameMessage(const char* message, size_t size, unsigned int flags = 0);
+	// Sends the message in m_sendBuffer
+	bool sendFrame(Connection* conn);
 	/*
-		Only used by the server. This function is called in a new thread and waits for new incomming connection requests.
-		Accepted connections are stored in m_connections. A new thread is created for each connection directly Listen() in order to listen for incomming messages from that connection.
+		Queues an event for checkForPackages(), waits for it to handle older events if the queue is full.
+		Messages aren't copied, data has to stay valid until the event has been handled.
 	*/
-	void waitForNewConnections();
+	void addNetworkEvent(NetworkEvent n, int dataSize, char* data = nullptr, ReceiveRing* ring = nullptr, size_t frameSize = 0, Connection* conn = nullptr, bool control = false);
+	bool popNetworkEvent(AwaitingEvent& awaiting);
+	// Returns true if the event was only meant for the Network and shouldn't be handed to the handler
+	bool handleInternally(const AwaitingEvent& awaiting);
+	void releaseNetworkEvent(const AwaitingEvent& awaiting);
 
 	/*
-		This function is called by multiple threads. Listen for incomming messages from one specific connection.
-		If this application is a client, only one thread will call Listen() which will listen to the host.
-		If this application is a host, this function will be called by one thread for each client connected to the host.
-
-		Host connection requests is handled in WaitForNewConnections()
+		Runs on m_ioThread. Waits for the sockets of all connections, and the listening socket of the host, at once and
+		receives whatever has arrived into the receive buffer of each connection.
 	*/
-	void listen(Connection* conn);//Rename this function
+	void processSocketEvents();
+	void acceptConnection();
+	void receive(Connection* conn);
+	void receiveDatagram();
+	// Checks that the datagram comes from a connection and is newer than the last one before it is queued
+	void handleDatagram(const char* data, size_t size, const sockaddr_in& from);
+	bool startUnreliableChannel(const sockaddr_in& address);
+	// Stops listening to the connection, it is deleted once the CONNECTION_CLOSED event has been handled
+	void closeConnection(Connection* conn);
+	void startIOThread();
 };
 
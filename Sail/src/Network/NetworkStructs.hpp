@@ -1,6 +1,8 @@
 #pragma once
 const unsigned int MAX_PACKAGE_SIZE = 64;
 const unsigned int MAX_AWAITING_PACKAGES = 1000;
+// Messages sent over TCP can't be larger than this, their size is sent as two bytes
+const unsigned int MAX_MESSAGE_SIZE = 10000;
 const unsigned int HOST_META_DESC_SIZE = MAX_PACKAGE_SIZE - 6;
 
 // The length of the string you get from archiving an int.
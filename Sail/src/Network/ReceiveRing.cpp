@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "ReceiveRing.h"
+
+#include <cstring>
+
+ReceiveRing::ReceiveRing(size_t maxMessageSize, size_t capacity)
+	: m_capacity(std::max(capacity, HEADER_SIZE + maxMessageSize))
+	, m_maxMessageSize(maxMessageSize)
+{
+	// The space after m_capacity is only used for the wrapped part of messages
+	m_buffer.resize(m_capacity + maxMessageSize);
+}
+
+char* ReceiveRing::getWritePointer(size_t& size) {
+	const size_t position = m_written % m_capacity;
+	const size_t free = m_capacity - (m_written - m_released.load(std::memory_order_acquire));
+	size = std::min(free, m_capacity - position);
+	return &m_buffer[position];
+}
+
+void ReceiveRing::commit(size_t size) {
+	m_written += size;
+}
+
+bool ReceiveRing::writeFrame(const char* data, size_t size) {
+	if (size > m_maxMessageSize || HEADER_SIZE + size > m_capacity - (m_written - m_released.load(std::memory_order_acquire))) {
+		return false;
+	}
+
+	const char header[HEADER_SIZE] = { static_cast<char>(size & 0xFF), static_cast<char>(size >> 8) };
+	for (size_t i = 0; i < HEADER_SIZE; i++) {
+		m_buffer[m_written++ % m_capacity] = header[i];
+	}
+	const size_t position = m_written % m_capacity;
+	const size_t first = std::min(size, m_capacity - position);
+	std::memcpy(&m_buffer[position], data, first);
+	std::memcpy(&m_buffer[0], data + first, size - first);
+	m_written += size;
+	return true;
+}
+
+ReceiveRing::FrameResult ReceiveRing::nextFrame(char*& data, size_t& size, size_t& frameSize) {
+	const size_t available = m_written - m_parsed;
+	if (available < HEADER_SIZE) {
+		return FrameResult::NONE;
+	}
+
+	const size_t header =
+		static_cast<unsigned char>(m_buffer[m_parsed % m_capacity]) |
+		static_cast<unsigned char>(m_buffer[(m_parsed + 1) % m_capacity]) << 8;
+	const size_t length = header & ~CONTROL_FLAG;
+	if (length > m_maxMessageSize) {
+		return FrameResult::INVALID;
+	}
+	if (available < HEADER_SIZE + length) {
+		return FrameResult::NONE;
+	}
+
+	const size_t start = (m_parsed + HEADER_SIZE) % m_capacity;
+	if (start + length > m_capacity) {
+		// The previous message that wrapped has been released since then, otherwise the buffer couldn't have wrapped again
+		std::memcpy(&m_buffer[m_capacity], &m_buffer[0], start + length - m_capacity);
+	}
+
+	data = &m_buffer[start];
+	size = length;
+	frameSize = HEADER_SIZE + length;
+	m_parsed += frameSize;
+	return (header & CONTROL_FLAG) ? FrameResult::CONTROL : FrameResult::FRAME;
+}
+
+void ReceiveRing::release(size_t frameSize) {
+	m_released.fetch_add(frameSize, std::memory_order_release);
+}
+
+void ReceiveRing::reset() {
+	m_written = 0;
+	m_parsed = 0;
+	m_released = 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+/*
+	Receive buffer of one connection, filled by the network I/O thread and read by checkForPackages().
+
+	Messages are framed with a two byte little endian length followed by the message itself. The highest bit of the
+	length marks messages that are used by the Network itself instead of being handed to the game.
+	Complete messages are handed out as pointers straight into the buffer and stay valid until they are released, which
+	is done in the same order as they were handed out. A message that wraps around the end of the buffer has its wrapped
+	part copied to the extra space after the end so that every message is contiguous.
+
+	One thread writes and parses, another thread releases.
+*/
+class ReceiveRing {
+public:
+	static constexpr size_t HEADER_SIZE = 2;
+	static constexpr unsigned int CONTROL_FLAG = 0x8000;
+	static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+	enum class FrameResult {
+		NONE,		// No complete message yet
+		FRAME,		// data and size points to the next message
+		CONTROL,	// Same as FRAME but the message was sent with CONTROL_FLAG
+		INVALID,	// The message is larger than maxMessageSize, the stream can't be trusted anymore
+	};
+
+	ReceiveRing(size_t maxMessageSize, size_t capacity = DEFAULT_CAPACITY);
+
+	/*
+		The free space that can be written to without wrapping, the size is 0 if the buffer is full.
+		Call commit() with the number of bytes actually written.
+	*/
+	char* getWritePointer(size_t& size);
+	void commit(size_t size);
+	// Writes a whole message and its header, for messages that don't arrive as a stream. Returns false if it doesn't fit
+	bool writeFrame(const char* data, size_t size);
+
+	/*
+		Finds the next message after the last one returned.
+		frameSize is the number of bytes in the buffer used by the message, including the header, pass it to release().
+	*/
+	FrameResult nextFrame(char*& data, size_t& size, size_t& frameSize);
+
+	// Frees the space of the oldest message that hasn't been released
+	void release(size_t frameSize);
+	// Forgets all messages, neither thread can be using the buffer
+	void reset();
+
+private:
+	std::vector<char> m_buffer;
+	size_t m_capacity;
+	size_t m_maxMessageSize;
+
+	// Total number of bytes since the start, positions in the buffer are these modulo the capacity
+	size_t m_written = 0;
+	size_t m_parsed = 0;
+	std::atomic<size_t> m_released{ 0 };
+};
@@ -0,0 +1,76 @@
+#include "pch.h"
+#include "SocketPoller.h"
+
+SocketPoller::SocketPoller() {
+	m_wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	m_wakeAddress.sin_family = AF_INET;
+	m_wakeAddress.sin_port = 0;
+	inet_pton(AF_INET, "127.0.0.1", &m_wakeAddress.sin_addr);
+
+	// Let the system pick a free port and remember it so that wake() knows where to send
+	int addressSize = sizeof(m_wakeAddress);
+	if (bind(m_wakeSocket, (sockaddr*)&m_wakeAddress, sizeof(m_wakeAddress)) == SOCKET_ERROR ||
+		getsockname(m_wakeSocket, (sockaddr*)&m_wakeAddress, &addressSize) == SOCKET_ERROR) {
+		closesocket(m_wakeSocket);
+		m_wakeSocket = INVALID_SOCKET;
+		return;
+	}
+
+	WSAPOLLFD fd = { 0 };
+	fd.fd = m_wakeSocket;
+	fd.events = POLLRDNORM;
+	m_fds.push_back(fd);
+	m_userData.push_back(nullptr);
+}
+
+SocketPoller::~SocketPoller() {
+	if (m_wakeSocket != INVALID_SOCKET) {
+		closesocket(m_wakeSocket);
+	}
+}
+
+bool SocketPoller::add(SOCKET socket, void* userData) {
+	WSAPOLLFD fd = { 0 };
+	fd.fd = socket;
+	fd.events = POLLRDNORM;
+	m_fds.push_back(fd);
+	m_userData.push_back(userData);
+	return true;
+}
+
+void SocketPoller::remove(SOCKET socket) {
+	// The wake socket is always first
+	for (size_t i = 1; i < m_fds.size(); i++) {
+		if (m_fds[i].fd == socket) {
+			m_fds[i] = m_fds.back();
+			m_fds.pop_back();
+			m_userData[i] = m_userData.back();
+			m_userData.pop_back();
+			return;
+		}
+	}
+}
+
+void SocketPoller::wait(std::vector<Event>& events, int timeoutMs) {
+	events.clear();
+	if (WSAPoll(m_fds.data(), (ULONG)m_fds.size(), timeoutMs) <= 0) {
+		return;
+	}
+
+	if (m_fds[0].revents) {
+		char buffer[16];
+		recv(m_wakeSocket, buffer, sizeof(buffer), 0);
+	}
+	for (size_t i = 1; i < m_fds.size(); i++) {
+		const SHORT revents = m_fds[i].revents;
+		if (revents) {
+			events.push_back({ m_userData[i], (revents & (POLLRDNORM | POLLHUP)) != 0, (revents & (POLLERR | POLLNVAL)) != 0 });
+		}
+	}
+}
+
+void SocketPoller::wake() {
+	const char msg = 0;
+	sendto(m_wakeSocket, &msg, sizeof(msg), 0, (sockaddr*)&m_wakeAddress, sizeof(m_wakeAddress));
+}
+
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include <WS2tcpip.h>
+#pragma comment (lib, "ws2_32.lib")
+
+/*
+	Waits for any number of sockets to become readable on a single thread, with WSAPoll.
+
+	Sockets can only be added and removed by the thread that calls wait(), wake() can be called from any thread.
+*/
+class SocketPoller {
+public:
+	struct Event {
+		void* userData;
+		// Either there is something to read or the socket has been closed, recv() will tell which without blocking
+		bool readable;
+		bool error;
+	};
+
+	SocketPoller();
+	~SocketPoller();
+	SocketPoller(const SocketPoller&) = delete;
+	SocketPoller& operator=(const SocketPoller&) = delete;
+
+	bool add(SOCKET socket, void* userData);
+	void remove(SOCKET socket);
+
+	/*
+		Blocks until at least one socket is readable or wake() is called, and replaces the content of events.
+		A timeout of -1 waits forever.
+	*/
+	void wait(std::vector<Event>& events, int timeoutMs = -1);
+	// Makes the current or next call to wait() return
+	void wake();
+
+private:
+	// WSAPoll can't wait for anything but sockets, so wake() sends a datagram to a socket of its own
+	SOCKET m_wakeSocket = INVALID_SOCKET;
+	sockaddr_in m_wakeAddress = { 0 };
+	std::vector<WSAPOLLFD> m_fds;
+	std::vector<void*> m_userData;
+};
@@ -27,6 +27,14 @@ void NodeSystem::setNodes(const std::vector<Node>& nodes, const std::vector<std:
 	m_nodes = nodes;
 	m_connections = connections;
 
+	// The nodes are laid out in a regular grid, find its origin and spacing so that positions can be mapped to nodes directly
+	m_isGrid = m_nodes.size() == static_cast<size_t>(xMax) * zMax && m_nodes.size() > 1;
+	if (m_isGrid) {
+		m_gridOrigin = glm::vec2(m_nodes[0].position.x, m_nodes[0].position.z);
+		m_gridSpacing = (xMax > 1) ? m_nodes[1].position.x - m_gridOrigin.x : m_nodes[xMax].position.z - m_gridOrigin.y;
+		m_isGrid = m_gridSpacing > 0.f;
+	}
+
 #ifdef _DEBUG_NODESYSTEM
 	int currNodeEntity = 0;
 	for ( int i = 0; i < m_nodes.size(); i++ ) {
@@ -89,13 +97,13 @@ std::vector<NodeSystem::Node> NodeSystem::getPath(const NodeSystem::Node& from,
 #endif
 		auto path = aStar(from.index, to.index);
 #ifdef DEVELOPMENT
-		m_pathSearchTimes[m_currSearchTimeIndex % NUM_SEARCH_TIMES] = 
-			static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
-		if (m_pathSearchTimes[m_currSearchTimeIndex % NUM_SEARCH_TIMES] > 5000) {
+		// Paths are searched from several threads at once, each search gets its own slot
+		const float searchTime = static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
+		m_pathSearchTimes[m_currSearchTimeIndex++ % NUM_SEARCH_TIMES] = searchTime;
+		if (searchTime > 5000) {
 			SAIL_LOG("Finding a path (" + Utils::toStr(from.position) + "->" + Utils::toStr(to.position) + ") took " + 
-					 std::to_string(static_cast<float>(m_pathSearchTimes[m_currSearchTimeIndex % NUM_SEARCH_TIMES]) / 1000.f) + "ms, size of path: " + std::to_string(path.size()));
+					 std::to_string(searchTime / 1000.f) + "ms, size of path: " + std::to_string(path.size()));
 		}
-		m_currSearchTimeIndex++;
 #endif
 		
 		size_t size = path.size();
@@ -111,13 +119,68 @@ std::vector<NodeSystem::Node> NodeSystem::getPath(const glm::vec3& from, const g
 }
 
 const NodeSystem::Node& NodeSystem::getNearestNode(const glm::vec3& position) const {
+	if (!m_isGrid) {
+		return getNearestNodeLinear(position);
+	}
+
+	const int xMax = static_cast<int>(m_xMax);
+	const int zMax = static_cast<int>(m_zMax);
+	const glm::vec2 cellPos = (glm::vec2(position.x, position.z) - m_gridOrigin) / m_gridSpacing;
+	const int cx = glm::clamp(static_cast<int>(std::round(cellPos.x)), 0, xMax - 1);
+	const int cz = glm::clamp(static_cast<int>(std::round(cellPos.y)), 0, zMax - 1);
+
+	// Every node in ring r around the start cell is at least r * spacing - offset away horizontally,
+	// where offset is how far the position is from the start cell's node along the furthest axis
+	const float offset = glm::max(std::abs(cellPos.x - cx), std::abs(cellPos.y - cz)) * m_gridSpacing;
+	const int maxRing = glm::max(glm::max(cx, xMax - 1 - cx), glm::max(cz, zMax - 1 - cz));
+
+	float dist = FLT_MAX;
+	unsigned int index = 0;
+	auto checkCell = [&](int x, int z) {
+		if (x < 0 || x >= xMax || z < 0 || z >= zMax) {
+			return;
+		}
+		const unsigned int i = static_cast<unsigned int>(z * xMax + x);
+		if (isWalkable(i)) {
+			float d = glm::distance2(m_nodes[i].position, position);
+			if (d < dist) {
+				index = i;
+				dist = d;
+			}
+		}
+	};
+
+	for (int r = 0; r <= maxRing; r++) {
+		const float minRingDist = r * m_gridSpacing - offset;
+		if (minRingDist > 0.f && minRingDist * minRingDist > dist) {
+			break;
+		}
+
+		if (r == 0) {
+			checkCell(cx, cz);
+			continue;
+		}
+		for (int x = cx - r; x <= cx + r; x++) {
+			checkCell(x, cz - r);
+			checkCell(x, cz + r);
+		}
+		for (int z = cz - r + 1; z < cz + r; z++) {
+			checkCell(cx - r, z);
+			checkCell(cx + r, z);
+		}
+	}
+
+	return m_nodes[index];
+}
+
+const NodeSystem::Node& NodeSystem::getNearestNodeLinear(const glm::vec3& position) const {
 	float dist = FLT_MAX;
 	unsigned int index = 0;
 
 	for ( unsigned int i = 0; i < m_nodes.size(); i++ ) {
-		if (!m_nodes[i].blocked && m_connections[m_nodes[i].index].size() > 0) {
+		if (isWalkable(i)) {
 			float d = glm::distance2(m_nodes[i].position, position);
-			if (d < dist && !m_nodes[i].blocked) {
+			if (d < dist) {
 				index = i;
 				dist = d;
 			}
@@ -127,6 +190,10 @@ const NodeSystem::Node& NodeSystem::getNearestNode(const glm::vec3& position) co
 	return m_nodes[index];
 }
 
+bool NodeSystem::isWalkable(unsigned int node) const {
+	return !m_nodes[node].blocked && m_connections[node].size() > 0;
+}
+
 unsigned int NodeSystem::getDistance2(unsigned int n1, unsigned int n2) const {
 	return glm::distance2(m_nodes[n1].position, m_nodes[n2].position); // TOOD: Check this - should be ceil, floor or round
 }
@@ -157,6 +224,7 @@ void NodeSystem::stop() {
 
 	m_nodes.clear();
 	m_connections.clear();
+	m_isGrid = false;
 }
 
 #ifdef _DEBUG_NODESYSTEM
@@ -210,12 +278,13 @@ void NodeSystem::setDebugModelAndScene(Shader* shader) {
 #endif
 
 #ifdef DEVELOPMENT
-const unsigned int NodeSystem::getAverageSearchTime() const {
+const float NodeSystem::getAverageSearchTime() const {
 	float searchTime = 0.f;
-	for (unsigned int i = 0; i < std::min(m_currSearchTimeIndex, NUM_SEARCH_TIMES); i++) {
+	const unsigned int numSearchTimes = std::min(m_currSearchTimeIndex.load(), NUM_SEARCH_TIMES);
+	for (unsigned int i = 0; i < numSearchTimes; i++) {
 		searchTime += m_pathSearchTimes[i];
 	}
-	return searchTime / static_cast<float>(std::min(m_currSearchTimeIndex, NUM_SEARCH_TIMES));
+	return searchTime / static_cast<float>(numSearchTimes);
 }
 
 unsigned int NodeSystem::getByteSize() const {
@@ -268,75 +337,145 @@ std::vector<unsigned int> NodeSystem::BFS(const unsigned int from, const unsigne
 	return path;
 }
 
-/*
-Can be optimized
-*/
 std::vector<unsigned int> NodeSystem::aStar(const unsigned int from, const unsigned int to) {
-	std::list<unsigned int> openSet;
-	std::list<unsigned int> closedSet;
 	std::vector<unsigned int> path;
+	SearchContext& ctx = GetSearchContext();
+	ctx.begin(m_nodes.size());
 
-	openSet.push_back(from);
-	unsigned int current = from;
-	unsigned int maxNodes = (unsigned int)m_nodes.size();
-	unsigned int* camefrom = SAIL_NEW unsigned int[maxNodes];
-	unsigned int* gScores = SAIL_NEW unsigned int[maxNodes];
-	unsigned int* fScores = SAIL_NEW unsigned int[maxNodes];
-
-	memset(gScores, UCHAR_MAX, maxNodes * sizeof(unsigned int));
-	memset(fScores, UCHAR_MAX, maxNodes * sizeof(unsigned int));
-
-	gScores[from] = 0;
-	fScores[from] = 0;
-	camefrom[from] = from;
-
-	unsigned int numNodesChecked = 0;
-	while (!openSet.empty() && numNodesChecked < 100) {
-		current = openSet.front();
-		for (unsigned int n : openSet) {
-			if (fScores[n] < fScores[current]) {
-				current = n;
-			}
-		}
+	const glm::vec3& goal = m_nodes[to].position;
+	ctx.reachedGeneration[from] = ctx.generation;
+	ctx.cameFrom[from] = from;
+	ctx.gScores[from] = 0.f;
+	ctx.fScores[from] = glm::distance(m_nodes[from].position, goal);
+	ctx.push(from);
+
+	while (!ctx.openHeap.empty()) {
+		const unsigned int current = ctx.pop();
 
 		if (current == to) {
 			path.push_back(to);
 
-			int cur = to;
-			while (camefrom[cur] != cur) {
-				path.push_back(camefrom[cur]);
-				cur = camefrom[cur];
+			unsigned int cur = to;
+			while (ctx.cameFrom[cur] != cur) {
+				path.push_back(ctx.cameFrom[cur]);
+				cur = ctx.cameFrom[cur];
 			}
 
 			break;
-		} else {
-			openSet.remove((unsigned int)(current));
-			closedSet.push_back(current);
-			
-			for (auto neighbor : m_connections[current]) {
-				if (m_nodes[neighbor].blocked || contains<std::list, unsigned int>(closedSet, neighbor)) {
-					continue;
+		}
+
+		ctx.closedGeneration[current] = ctx.generation;
+		const glm::vec3& currentPos = m_nodes[current].position;
+
+		for (unsigned int neighbor : m_connections[current]) {
+			if (m_nodes[neighbor].blocked || ctx.closedGeneration[neighbor] == ctx.generation) {
+				continue;
+			}
+
+			// Distance from start to neighbor through current
+			const float dist = ctx.gScores[current] + glm::distance(currentPos, m_nodes[neighbor].position);
+			const bool reached = ctx.reachedGeneration[neighbor] == ctx.generation;
+			if (!reached || dist < ctx.gScores[neighbor]) {
+				ctx.cameFrom[neighbor] = current;
+				ctx.gScores[neighbor] = dist;
+				ctx.fScores[neighbor] = dist + glm::distance(m_nodes[neighbor].position, goal);
+
+				if (!reached) {
+					ctx.reachedGeneration[neighbor] = ctx.generation;
+					ctx.push(neighbor);
 				} else {
-					//Distance From Start To Neighbor Through Current
-					unsigned int dist = gScores[current] + getDistance2(current, neighbor);
-					if (dist < gScores[neighbor]) {
-						camefrom[neighbor] = current;
-						gScores[neighbor] = dist;
-						fScores[neighbor] = dist + getDistance2(neighbor, to);
-						
-						if (!contains<std::list, unsigned int>(openSet, neighbor)) {
-							openSet.push_back(neighbor);
-						}
-					}
+					// Still in the open set since it isn't closed, its score only went down
+					ctx.siftUp(ctx.heapIndex[neighbor]);
 				}
 			}
 		}
-		numNodesChecked++;
 	}
 
-	delete[] camefrom;
-	delete[] gScores;
-	delete[] fScores;
+	return path;
+}
+
+NodeSystem::SearchContext& NodeSystem::GetSearchContext() {
+	thread_local SearchContext ctx;
+	return ctx;
+}
 
- 	return path;
-}
\ No newline at end of file
+void NodeSystem::SearchContext::begin(size_t numNodes) {
+	if (reachedGeneration.size() < numNodes) {
+		reachedGeneration.resize(numNodes, 0);
+		closedGeneration.resize(numNodes, 0);
+		cameFrom.resize(numNodes);
+		gScores.resize(numNodes);
+		fScores.resize(numNodes);
+		heapIndex.resize(numNodes);
+	}
+	openHeap.clear();
+
+	// Generation 0 is never used so that new entries always count as unvisited
+	if (++generation == 0) {
+		std::fill(reachedGeneration.begin(), reachedGeneration.end(), 0);
+		std::fill(closedGeneration.begin(), closedGeneration.end(), 0);
+		generation = 1;
+	}
+}
+
+bool NodeSystem::SearchContext::isBetter(unsigned int a, unsigned int b) const {
+	// Prefer nodes further along the path when the estimates are equal, which avoids expanding every equally good node on open floors
+	if (fScores[a] != fScores[b]) {
+		return fScores[a] < fScores[b];
+	}
+	return gScores[a] > gScores[b];
+}
+
+void NodeSystem::SearchContext::push(unsigned int node) {
+	heapIndex[node] = static_cast<unsigned int>(openHeap.size());
+	openHeap.push_back(node);
+	siftUp(heapIndex[node]);
+}
+
+unsigned int NodeSystem::SearchContext::pop() {
+	const unsigned int top = openHeap.front();
+	openHeap.front() = openHeap.back();
+	heapIndex[openHeap.front()] = 0;
+	openHeap.pop_back();
+	if (!openHeap.empty()) {
+		siftDown(0);
+	}
+	return top;
+}
+
+void NodeSystem::SearchContext::siftUp(unsigned int position) {
+	const unsigned int node = openHeap[position];
+	while (position > 0) {
+		const unsigned int parent = (position - 1) / 2;
+		if (!isBetter(node, openHeap[parent])) {
+			break;
+		}
+		openHeap[position] = openHeap[parent];
+		heapIndex[openHeap[position]] = position;
+		position = parent;
+	}
+	openHeap[position] = node;
+	heapIndex[node] = position;
+}
+
+void NodeSystem::SearchContext::siftDown(unsigned int position) {
+	const unsigned int node = openHeap[position];
+	const unsigned int size = static_cast<unsigned int>(openHeap.size());
+	while (true) {
+		unsigned int child = position * 2 + 1;
+		if (child >= size) {
+			break;
+		}
+		if (child + 1 < size && isBetter(openHeap[child + 1], openHeap[child])) {
+			child++;
+		}
+		if (!isBetter(openHeap[child], node)) {
+			break;
+		}
+		openHeap[position] = openHeap[child];
+		heapIndex[openHeap[position]] = position;
+		position = child;
+	}
+	openHeap[position] = node;
+	heapIndex[node] = position;
+}
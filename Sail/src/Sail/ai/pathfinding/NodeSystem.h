@@ -52,6 +52,7 @@ public:
 	std::vector<NodeSystem::Node> getPath(const NodeSystem::Node& from, const NodeSystem::Node& to);
 	std::vector<NodeSystem::Node> getPath(const glm::vec3& from, const glm::vec3& to);
 
+	// Returns the closest node that isn't blocked, searching outwards from the grid cell of the position
 	const NodeSystem::Node& getNearestNode(const glm::vec3& position) const;
 	unsigned int getDistance2(unsigned int n1, unsigned int n2) const;
 	const std::vector<NodeSystem::Node>& getNodes() const;
@@ -75,22 +76,55 @@ public:
 	const unsigned int m_maxColourID = 12;
 #endif
 #ifdef DEVELOPMENT
-	const unsigned int getAverageSearchTime() const;
+	// In microseconds
+	const float getAverageSearchTime() const;
 	unsigned int getByteSize() const;
 #endif
 
 private:
+	bool isWalkable(unsigned int node) const;
+	const NodeSystem::Node& getNearestNodeLinear(const glm::vec3& position) const;
 	std::vector<unsigned int> BFS(const unsigned int from, const unsigned int to);
 	std::vector<unsigned int> aStar(const unsigned int from, const unsigned int to);
+
+	/*
+		Buffers reused by every search on a thread, they only allocate when a larger node system is searched
+		A node's scores are only valid if its generation matches the current search, so nothing has to be cleared between searches
+	*/
+	struct SearchContext {
+		unsigned int generation = 0;
+		// Generation in which the node was last reached/expanded
+		std::vector<unsigned int> reachedGeneration;
+		std::vector<unsigned int> closedGeneration;
+		std::vector<unsigned int> cameFrom;
+		std::vector<float> gScores;
+		std::vector<float> fScores;
+		// Binary min-heap of node indices ordered by fScore, heapIndex holds each open node's position in it
+		std::vector<unsigned int> openHeap;
+		std::vector<unsigned int> heapIndex;
+
+		void begin(size_t numNodes);
+		bool isBetter(unsigned int a, unsigned int b) const;
+		void push(unsigned int node);
+		unsigned int pop();
+		void siftUp(unsigned int position);
+		void siftDown(unsigned int position);
+	};
+	static SearchContext& GetSearchContext();
+
 	std::vector<std::vector<unsigned int>> m_connections;
 	std::vector<NodeSystem::Node> m_nodes;
 
 #ifdef DEVELOPMENT
 	const static unsigned int NUM_SEARCH_TIMES = 10;
 	float m_pathSearchTimes[NUM_SEARCH_TIMES];
-	unsigned int m_currSearchTimeIndex = 0;
+	std::atomic<unsigned int> m_currSearchTimeIndex{ 0 };
 #endif
 
 	unsigned int m_xMax = 0;
 	unsigned int m_zMax = 0;
+	// Node i lies at m_gridOrigin + (i % m_xMax, i / m_xMax) * m_gridSpacing in the xz-plane
+	bool m_isGrid = false;
+	glm::vec2 m_gridOrigin = glm::vec2(0.f);
+	float m_gridSpacing = 1.f;
 };
\ No newline at end of file
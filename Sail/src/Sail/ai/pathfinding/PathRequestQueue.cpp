@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "PathRequestQueue.h"
+#include "Sail/Application.h"
+
+PathRequestQueue::PathRequestQueue(NodeSystem* nodeSystem)
+	: m_nodeSystem(nodeSystem)
+	, m_timeBudget(2000.f)
+	, m_nextSearch(0)
+{
+
+}
+
+PathRequestQueue::~PathRequestQueue() {
+	clear();
+}
+
+void PathRequestQueue::request(int requesterID, const glm::vec3& from, const glm::vec3& to) {
+	// The node lookup is cheap enough to do right away and lets requests between the same nodes share a search
+	const unsigned long long key = Key(m_nodeSystem->getNearestNode(from).index, m_nodeSystem->getNearestNode(to).index);
+
+	auto it = m_pendingRequesters.find(requesterID);
+	if (it == m_pendingRequesters.end()) {
+		// The search that is already running answers the same request
+		auto running = m_batchRequesters.find(requesterID);
+		if (running != m_batchRequesters.end() && running->second == key) {
+			return;
+		}
+	} else {
+		if (it->second == key) {
+			return;
+		}
+		// Replace the previous request
+		std::vector<int>& requesters = m_pending[it->second].requesters;
+		requesters.erase(std::remove(requesters.begin(), requesters.end(), requesterID), requesters.end());
+		if (requesters.empty()) {
+			m_pending.erase(it->second);
+		}
+	}
+	m_pendingRequesters[requesterID] = key;
+
+	Search& search = m_pending[key];
+	search.from = static_cast<unsigned int>(key >> 32);
+	search.to = static_cast<unsigned int>(key & 0xFFFFFFFF);
+	search.done = false;
+	search.requesters.push_back(requesterID);
+}
+
+void PathRequestQueue::update() {
+	// Results are only kept for one tick, anything left belongs to requesters that are gone
+	m_results.clear();
+
+	// Never wait for the workers, a batch that isn't finished is collected on a later tick
+	for (auto& worker : m_workers) {
+		if (worker.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return;
+		}
+	}
+	finishBatch();
+
+	if (m_pending.empty()) {
+		return;
+	}
+
+	m_batch.reserve(m_pending.size());
+	for (auto& pair : m_pending) {
+		m_batch.emplace_back(std::move(pair.second));
+	}
+	m_batchRequesters = std::move(m_pendingRequesters);
+	m_pending.clear();
+	m_pendingRequesters.clear();
+	m_nextSearch = 0;
+
+	const auto deadline = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(static_cast<long long>(m_timeBudget));
+	const size_t numWorkers = std::min<size_t>(NUM_WORKERS, m_batch.size());
+	for (size_t i = 0; i < numWorkers; i++) {
+		m_workers.emplace_back(Application::getInstance()->pushJobToThreadPool([this, deadline](int id) {
+			searchJob(deadline);
+		}));
+	}
+}
+
+bool PathRequestQueue::collect(int requesterID, std::vector<NodeSystem::Node>* outPath) {
+	auto it = m_results.find(requesterID);
+	if (it == m_results.end()) {
+		return false;
+	}
+	*outPath = std::move(it->second);
+	m_results.erase(it);
+	return true;
+}
+
+bool PathRequestQueue::isPending(int requesterID) const {
+	return m_pendingRequesters.find(requesterID) != m_pendingRequesters.end() || m_batchRequesters.find(requesterID) != m_batchRequesters.end();
+}
+
+void PathRequestQueue::clear() {
+	for (auto& worker : m_workers) {
+		worker.wait();
+	}
+	m_workers.clear();
+	m_batch.clear();
+	m_batchRequesters.clear();
+	m_pending.clear();
+	m_pendingRequesters.clear();
+	m_results.clear();
+}
+
+void PathRequestQueue::setTimeBudget(float microseconds) {
+	m_timeBudget = microseconds;
+}
+
+size_t PathRequestQueue::getNumPending() const {
+	return m_pending.size() + m_batch.size();
+}
+
+unsigned long long PathRequestQueue::Key(unsigned int from, unsigned int to) {
+	return (static_cast<unsigned long long>(from) << 32) | to;
+}
+
+void PathRequestQueue::searchJob(std::chrono::high_resolution_clock::time_point deadline) {
+	// Always do at least one search per worker so that a single long search can't stall the queue forever
+	bool first = true;
+	while (first || std::chrono::high_resolution_clock::now() < deadline) {
+		const size_t i = m_nextSearch++;
+		if (i >= m_batch.size()) {
+			return;
+		}
+		const std::vector<NodeSystem::Node>& nodes = m_nodeSystem->getNodes();
+		m_batch[i].path = m_nodeSystem->getPath(nodes[m_batch[i].from], nodes[m_batch[i].to]);
+		m_batch[i].done = true;
+		first = false;
+	}
+}
+
+void PathRequestQueue::finishBatch() {
+	m_workers.clear();
+
+	for (Search& search : m_batch) {
+		if (search.done) {
+			// Requesters that asked for a new path while this one was searched still get it,
+			// they follow it until the newer request is done instead of being starved by frequent requests
+			for (int requester : search.requesters) {
+				m_results[requester] = search.path;
+			}
+		} else {
+			// Out of time, search it in the next batch
+			for (int requester : search.requesters) {
+				if (m_pendingRequesters.find(requester) == m_pendingRequesters.end()) {
+					m_pendingRequesters[requester] = Key(search.from, search.to);
+					Search& pending = m_pending[Key(search.from, search.to)];
+					pending.from = search.from;
+					pending.to = search.to;
+					pending.done = false;
+					pending.requesters.push_back(requester);
+				}
+			}
+		}
+	}
+	m_batch.clear();
+	m_batchRequesters.clear();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "NodeSystem.h"
+
+/*
+	Resolves path requests on the thread pool so that bots never search for paths inside their own update.
+	Requests are submitted with the id of the requester and the result can be collected on a later tick.
+
+	Requests between the same pair of nodes are only searched once, and a new request from a requester replaces its old queued one.
+	A request that is already being searched is still delivered, isPending() tells if a newer request is on its way.
+	Each tick the workers stop starting new searches once the time budget is spent, what is left is searched on later ticks.
+	The node system must not be changed while searches are running, call clear() before that.
+*/
+class PathRequestQueue {
+public:
+	PathRequestQueue(NodeSystem* nodeSystem);
+	~PathRequestQueue();
+
+	void request(int requesterID, const glm::vec3& from, const glm::vec3& to);
+	// Should be called once per tick, before the results are collected
+	void update();
+	// Returns true and moves the path into outPath if a result arrived for the requester this tick
+	bool collect(int requesterID, std::vector<NodeSystem::Node>* outPath);
+	// True if the requester has a request that is queued or being searched
+	bool isPending(int requesterID) const;
+	// Waits for the running searches and drops every request and result
+	void clear();
+
+	void setTimeBudget(float microseconds);
+	size_t getNumPending() const;
+
+private:
+	struct Search {
+		unsigned int from;
+		unsigned int to;
+		std::vector<int> requesters;
+		std::vector<NodeSystem::Node> path;
+		bool done;
+	};
+
+	static unsigned long long Key(unsigned int from, unsigned int to);
+	void searchJob(std::chrono::high_resolution_clock::time_point deadline);
+	void finishBatch();
+
+private:
+	static const unsigned int NUM_WORKERS = 2;
+
+	NodeSystem* m_nodeSystem;
+	float m_timeBudget;
+
+	// Requests waiting for the next batch, indexed by the node pair
+	std::unordered_map<unsigned long long, Search> m_pending;
+	std::unordered_map<int, unsigned long long> m_pendingRequesters;
+
+	// The batch being searched on the thread pool, only touched by the workers until all futures are ready
+	std::vector<Search> m_batch;
+	std::unordered_map<int, unsigned long long> m_batchRequesters;
+	std::atomic<size_t> m_nextSearch;
+	std::vector<std::future<void>> m_workers;
+
+	std::unordered_map<int, std::vector<NodeSystem::Node>> m_results;
+};
@@ -99,6 +99,8 @@ void CleaningState::createCleaningPath(Entity* entity) {// First try to walk to
 		aiComp->currPath = tempPath;
 
 		aiComp->updatePath = false;
+		// A path that is still queued in the AiSystem would replace this one
+		aiComp->waitingForPath = false;
 	}
 
 	m_cleaningPathStart = aiComp->currPath.size();
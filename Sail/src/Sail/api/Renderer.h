@@ -10,6 +10,9 @@ class LightSetup;
 class RenderableTexture;
 class PostProcessPipeline;
 class Material;
+namespace Netcode {
+	class WaterCells;
+}
 
 class Renderer : public EventReceiver {
 public:
@@ -69,6 +72,8 @@ public:
 	virtual void submitMetaball(RenderCommandType type, Material* material, const glm::vec3& pos, RenderFlag flags, int group) {}
 
 	virtual void submitWaterPoint(const glm::vec3& pos) { };
+	// Adds a tick's worth of water hits at once
+	virtual void submitWaterCells(const Netcode::WaterCells& cells) { };
 	virtual bool checkIfOnWater(const glm::vec3& pos) { return false; }
 	virtual unsigned int removeWaterPoint(const glm::vec3& pos, const glm::ivec3& posOffset, const glm::ivec3& negOffset) { return 0; };
 	virtual std::pair<bool, glm::vec3> getNearestWaterPosition(const glm::vec3& position, const glm::vec3& maxOffset) { return std::pair(false, glm::vec3(0.f)); };
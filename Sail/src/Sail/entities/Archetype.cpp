@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "Archetype.h"
+#include "Sail/utils/Utils.h"
+
+Archetype::Archetype(std::vector<Column> columns)
+	: m_signature(0x0)
+	, m_columns(std::move(columns))
+	, m_chunkCapacity(0)
+	, m_chunkDataSize(0)
+	, m_chunkAlignment(alignof(std::max_align_t))
+	, m_numEntities(0)
+{
+	std::fill(std::begin(m_columnLookup), std::end(m_columnLookup), static_cast<signed char>(-1));
+
+	size_t rowSize = 0;
+	for (size_t i = 0; i < m_columns.size(); i++) {
+		m_signature |= GetBIDofID(m_columns[i].id);
+		m_columnLookup[m_columns[i].id] = static_cast<signed char>(i);
+		m_chunkAlignment = std::max(m_chunkAlignment, m_columns[i].alignment);
+		rowSize += m_columns[i].size;
+	}
+
+	// Fit as many rows as possible into CHUNK_BYTE_SIZE while keeping chunks reasonably filled
+	m_chunkCapacity = static_cast<unsigned int>(glm::clamp<size_t>(CHUNK_BYTE_SIZE / std::max<size_t>(rowSize, 1), 8, 256));
+
+	// Lay out the columns back to back, each column starts at its type's alignment
+	for (auto& column : m_columns) {
+		m_chunkDataSize = (m_chunkDataSize + column.alignment - 1) & ~(column.alignment - 1);
+		column.offset = m_chunkDataSize;
+		m_chunkDataSize += column.size * m_chunkCapacity;
+	}
+}
+
+Archetype::~Archetype() {
+	for (auto& chunk : m_chunks) {
+		::operator delete(chunk.data, std::align_val_t(m_chunkAlignment));
+	}
+}
+
+const ComponentTypeBitID& Archetype::getSignature() const {
+	return m_signature;
+}
+
+Archetype::Slot Archetype::reserve(Entity* entity) {
+	Slot slot;
+	if (!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	} else {
+		if (m_chunks.empty() || m_chunks.back().used == m_chunkCapacity) {
+			addChunk();
+		}
+		slot.chunk = static_cast<unsigned int>(m_chunks.size() - 1);
+		slot.row = m_chunks.back().used++;
+	}
+
+	Chunk& chunk = m_chunks[slot.chunk];
+	chunk.entities[slot.row] = entity;
+	chunk.present[slot.row] = 0;
+	chunk.states[slot.row] = ROW_RESERVED;
+	m_numEntities++;
+
+	return slot;
+}
+
+void Archetype::release(const Slot& slot) {
+	Chunk& chunk = m_chunks[slot.chunk];
+	if (chunk.states[slot.row] == ROW_FREE) {
+		return;
+	}
+
+	if (chunk.present[slot.row] != 0) {
+		SAIL_LOG_WARNING("Released an archetype row which still has components in it");
+	}
+
+	chunk.entities[slot.row] = nullptr;
+	chunk.present[slot.row] = 0;
+	chunk.states[slot.row] = ROW_FREE;
+	m_freeSlots.push_back(slot);
+	m_numEntities--;
+}
+
+void* Archetype::allocateComponent(const Slot& slot, ComponentTypeID id) {
+	const int column = getColumnIndex(id);
+	if (column < 0) {
+		return nullptr;
+	}
+
+	Chunk& chunk = m_chunks[slot.chunk];
+	const unsigned long long bit = 1ULL << column;
+	if (chunk.present[slot.row] & bit) {
+		return nullptr;
+	}
+	chunk.present[slot.row] |= bit;
+
+	return chunk.data + m_columns[column].offset + m_columns[column].size * slot.row;
+}
+
+void Archetype::freeComponent(const Slot& slot, ComponentTypeID id) {
+	const int column = getColumnIndex(id);
+	if (column >= 0) {
+		m_chunks[slot.chunk].present[slot.row] &= ~(1ULL << column);
+	}
+}
+
+bool Archetype::ownsComponent(const Slot& slot, ComponentTypeID id) const {
+	const int column = getColumnIndex(id);
+	return column >= 0 && (m_chunks[slot.chunk].present[slot.row] & (1ULL << column));
+}
+
+void Archetype::queueActivation(const Slot& slot) {
+	RowState& state = m_chunks[slot.chunk].states[slot.row];
+	if (state == ROW_RESERVED) {
+		state = ROW_QUEUED;
+		m_queuedActivations.push_back(slot);
+	}
+}
+
+void Archetype::activateQueued() {
+	for (const Slot& slot : m_queuedActivations) {
+		RowState& state = m_chunks[slot.chunk].states[slot.row];
+		// The row might have been released and reused before being activated
+		if (state == ROW_QUEUED) {
+			state = ROW_ACTIVE;
+		}
+	}
+	m_queuedActivations.clear();
+}
+
+int Archetype::getColumnIndex(ComponentTypeID id) const {
+	return m_columnLookup[id];
+}
+
+size_t Archetype::getNumChunks() const {
+	return m_chunks.size();
+}
+
+const Archetype::Chunk& Archetype::getChunk(size_t chunkIndex) const {
+	return m_chunks[chunkIndex];
+}
+
+unsigned int Archetype::getChunkCapacity() const {
+	return m_chunkCapacity;
+}
+
+size_t Archetype::getNumEntities() const {
+	return m_numEntities;
+}
+
+#ifdef DEVELOPMENT
+unsigned int Archetype::getByteSize() const {
+	unsigned int size = sizeof(*this);
+	size += m_columns.capacity() * sizeof(Column);
+	size += m_freeSlots.capacity() * sizeof(Slot);
+	size += m_queuedActivations.capacity() * sizeof(Slot);
+	for (auto& chunk : m_chunks) {
+		size += sizeof(Chunk);
+		size += m_chunkDataSize;
+		size += m_chunkCapacity * (sizeof(Entity*) + sizeof(unsigned long long) + sizeof(RowState));
+	}
+	return size;
+}
+#endif
+
+void Archetype::addChunk() {
+	m_chunks.emplace_back();
+	Chunk& chunk = m_chunks.back();
+	chunk.data = static_cast<unsigned char*>(::operator new(m_chunkDataSize, std::align_val_t(m_chunkAlignment)));
+	chunk.entities.resize(m_chunkCapacity, nullptr);
+	chunk.present.resize(m_chunkCapacity, 0);
+	chunk.states.resize(m_chunkCapacity, ROW_FREE);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "components/Component.h"
+
+#include <vector>
+#include <memory>
+
+/*
+	Chunked storage for entities sharing a component signature.
+
+	Every component type in the signature gets its own column inside each chunk,
+	so components of the same type are laid out contiguously and can be iterated linearly (see ArchetypeView.h).
+	Rows never move once reserved, which keeps the component pointers stored in Entity valid
+	for as long as the component lives, exactly like the heap allocated components.
+
+	Archetypes are created and owned by ECS, use ECS::createPackedEntity<...>() to place an entity in one.
+*/
+class Archetype final {
+public:
+	// Upper limit of component types in one archetype, one bit per column in the row masks
+	static constexpr unsigned int MAX_COLUMNS = 64;
+	// Approximate size of the component data in a chunk, the row count is derived from this
+	static constexpr size_t CHUNK_BYTE_SIZE = 16 * 1024;
+
+	enum RowState : unsigned char {
+		ROW_FREE = 0,
+		ROW_RESERVED, // Owned by an entity which has not yet been added to the systems
+		ROW_QUEUED,   // Will become active the next time ECS adds queued entities
+		ROW_ACTIVE    // Visible to views
+	};
+
+	struct Slot {
+		unsigned int chunk = 0;
+		unsigned int row = 0;
+	};
+
+	struct Chunk {
+		unsigned char* data = nullptr;
+		std::vector<Entity*> entities;
+		std::vector<unsigned long long> present; // One bit per column
+		std::vector<RowState> states;
+		unsigned int used = 0;                   // High water mark of rows that have been handed out
+	};
+
+public:
+	template<typename... ComponentTypes>
+	static std::unique_ptr<Archetype> Create();
+
+	~Archetype();
+
+	const ComponentTypeBitID& getSignature() const;
+
+	/*
+		Reserves a row for an entity
+		The row stays invisible to views until activate() has been called for it
+	*/
+	Slot reserve(Entity* entity);
+
+	/*
+		Frees the row, all components in it must already have been destroyed
+	*/
+	void release(const Slot& slot);
+
+	/*
+		Returns the memory for the component in the slot and marks it as present
+		Returns nullptr if the component type is not a part of this archetype or if it is already present
+	*/
+	void* allocateComponent(const Slot& slot, ComponentTypeID id);
+
+	/*
+		Marks the component as no longer present, the component itself has to be destroyed by the caller
+	*/
+	void freeComponent(const Slot& slot, ComponentTypeID id);
+
+	bool ownsComponent(const Slot& slot, ComponentTypeID id) const;
+
+	/*
+		Queues the row to be visible to views the next time activateQueued() is called
+	*/
+	void queueActivation(const Slot& slot);
+	void activateQueued();
+
+	// Returns -1 if the component type is not a part of this archetype
+	int getColumnIndex(ComponentTypeID id) const;
+
+	template<typename ComponentType>
+	ComponentType* getColumn(size_t chunkIndex);
+
+	size_t getNumChunks() const;
+	const Chunk& getChunk(size_t chunkIndex) const;
+	unsigned int getChunkCapacity() const;
+	size_t getNumEntities() const;
+
+#ifdef DEVELOPMENT
+	unsigned int getByteSize() const;
+#endif
+
+private:
+	struct Column {
+		ComponentTypeID id;
+		size_t size;
+		size_t alignment;
+		size_t offset; // Offset into the chunk's data
+	};
+
+	Archetype(std::vector<Column> columns);
+
+	void addChunk();
+
+private:
+	ComponentTypeBitID m_signature;
+	std::vector<Column> m_columns;
+	signed char m_columnLookup[MAX_NUM_COMPONENTS_TYPES];
+
+	unsigned int m_chunkCapacity;
+	size_t m_chunkDataSize;
+	size_t m_chunkAlignment;
+
+	std::vector<Chunk> m_chunks;
+	std::vector<Slot> m_freeSlots;
+	std::vector<Slot> m_queuedActivations;
+	size_t m_numEntities;
+};
+
+template<typename... ComponentTypes>
+inline std::unique_ptr<Archetype> Archetype::Create() {
+	static_assert(sizeof...(ComponentTypes) <= MAX_COLUMNS, "Too many component types in one archetype");
+
+	std::vector<Column> columns = { Column{ ComponentTypes::ID, sizeof(ComponentTypes), alignof(ComponentTypes), 0 }... };
+	// Constructor is private so make_unique can't be used
+	return std::unique_ptr<Archetype>(SAIL_NEW Archetype(std::move(columns)));
+}
+
+template<typename ComponentType>
+inline ComponentType* Archetype::getColumn(size_t chunkIndex) {
+	const int column = getColumnIndex(ComponentType::ID);
+	if (column < 0) {
+		return nullptr;
+	}
+	return reinterpret_cast<ComponentType*>(m_chunks[chunkIndex].data + m_columns[column].offset);
+}
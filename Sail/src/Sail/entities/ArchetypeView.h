@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Archetype.h"
+
+#include <tuple>
+#include <utility>
+
+/*
+	Linear iteration over every packed entity that has all of the given component types.
+	Retrieve one with ECS::Instance()->view<ComponentTypes...>().
+
+	Only entities created with ECS::createPackedEntity<...>() are visited, and only once they have been
+	added to the systems (same timing as a system's entity list).
+	Components stored outside the archetype (added after creation without being a part of the signature) are not
+	reachable through a view, use entity->getComponent<T>() for those.
+
+	Example:
+		ECS::Instance()->view<TransformComponent, MovementComponent>().each(
+			[&](Entity* e, TransformComponent& transform, MovementComponent& movement) {
+				...
+			});
+*/
+template<typename... ComponentTypes>
+class ArchetypeView final {
+public:
+	ArchetypeView() = default;
+
+	void addArchetype(Archetype* archetype) {
+		for (size_t i = 0; i < archetype->getNumChunks(); i++) {
+			if (archetype->getChunk(i).used > 0) {
+				m_chunks.push_back({ archetype, i });
+			}
+		}
+	}
+
+	/*
+		Number of chunks in the view
+		Used to split the iteration into jobs with eachInChunks()
+	*/
+	size_t getNumChunks() const {
+		return m_chunks.size();
+	}
+
+	template<typename Func>
+	void each(Func&& func) const {
+		eachInChunks(0, m_chunks.size(), std::forward<Func>(func));
+	}
+
+	// Iterates over the chunks in [firstChunk, lastChunk)
+	template<typename Func>
+	void eachInChunks(size_t firstChunk, size_t lastChunk, Func&& func) const {
+		lastChunk = std::min(lastChunk, m_chunks.size());
+		for (size_t c = firstChunk; c < lastChunk; c++) {
+			iterateChunk(m_chunks[c], func, std::index_sequence_for<ComponentTypes...>{});
+		}
+	}
+
+private:
+	struct ChunkRef {
+		Archetype* archetype;
+		size_t chunkIndex;
+	};
+
+	template<typename Func, size_t... I>
+	static void iterateChunk(const ChunkRef& ref, Func& func, std::index_sequence<I...>) {
+		const Archetype::Chunk& chunk = ref.archetype->getChunk(ref.chunkIndex);
+		std::tuple<ComponentTypes*...> columns(ref.archetype->template getColumn<ComponentTypes>(ref.chunkIndex)...);
+
+		unsigned long long rowMask = 0;
+		((rowMask |= 1ULL << ref.archetype->getColumnIndex(ComponentTypes::ID)), ...);
+
+		for (unsigned int row = 0; row < chunk.used; row++) {
+			if (chunk.states[row] == Archetype::ROW_ACTIVE && (chunk.present[row] & rowMask) == rowMask) {
+				func(chunk.entities[row], std::get<I>(columns)[row]...);
+			}
+		}
+	}
+
+private:
+	std::vector<ChunkRef> m_chunks;
+};
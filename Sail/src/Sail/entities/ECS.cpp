@@ -6,6 +6,11 @@
 #include "Sail.h"
 
 void ECS::addAllQueuedEntities() {
+	// Packed entities become visible to views at the same time as they are added to the systems
+	for (auto& archetype : m_archetypes) {
+		archetype.second->activateQueued();
+	}
+
 	for (auto& s : m_systems) {
 		if (s.second) {
 			s.second->addQueuedEntities();
@@ -79,6 +84,9 @@ void ECS::destroyEntity(int ecsIndex) {
 		m_entities[ecsIndex]->getParent()->removeChildEntity(m_entities[ecsIndex].get());
 	}
 
+	// Give the archetype row back so it can be reused
+	m_entities[ecsIndex]->releaseArchetype();
+
 	// Move the last entity in the vector
 	m_entities[ecsIndex] = m_entities.back();
 
@@ -100,6 +108,10 @@ void ECS::destroyAllEntities() {
 }
 
 void ECS::addEntityToSystems(Entity* entity) {
+	if (entity->m_archetype) {
+		entity->m_archetype->queueActivation(entity->m_archetypeSlot);
+	}
+
 	SystemMap::iterator it = m_systems.begin();
 
 	// Check which systems this entity can be placed in
@@ -132,6 +144,14 @@ void ECS::removeEntityFromSystems(Entity* entity) {
 size_t ECS::getNumEntities() {
 	return m_entities.size();
 }
+
+size_t ECS::getNumPackedEntities() const {
+	size_t count = 0;
+	for (auto& archetype : m_archetypes) {
+		count += archetype.second->getNumEntities();
+	}
+	return count;
+}
 #ifdef DEVELOPMENT
 const ECS::SystemMap& ECS::getSystems() const {
 	return m_systems;
@@ -150,6 +170,10 @@ const unsigned int ECS::getByteSize() const {
 	size += m_entityRemovalSystem->getByteSize();
 	size += m_entityAdderSystem->getByteSize();
 
+	for (auto& archetype : m_archetypes) {
+		size += archetype.second->getByteSize();
+	}
+
 	return size;
 }
 
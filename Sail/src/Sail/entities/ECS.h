@@ -4,6 +4,7 @@
 #include <memory>
 #include <vector>
 #include "Entity.h"
+#include "ArchetypeView.h"
 #include "systems/BaseComponentSystem.h"
 #include "Sail/entities/EntityFactory.hpp"
 
@@ -26,6 +27,9 @@ class EntityRemovalSystem;
 			Call ecs->addEntityToSystems() to add it to every system it fits within.
 			Call system->addEntity() to add it to a specific system.
 		NOTE: A system needs to exist before an entity can be added to it. It will NOT check each entity if created after them.
+		NOTE: Entities with many short lived siblings (projectiles etc.) can be created with createPackedEntity<...>().
+			Their components of the listed types are then stored contiguously per archetype (see Archetype.h)
+			and can be iterated linearly with view<...>() instead of through a system's entity list.
 
 	Simple example:
 		std::vector<Entity::SPtr> entities;
@@ -57,6 +61,21 @@ public:
 	*/
 	Entity::SPtr createEntity(const std::string& name = "");
 
+	/*
+		Creates and adds an entity whose components of the given types will be placed in archetype storage
+		The components still have to be added with addComponent() as usual,
+		any component type not listed is heap allocated like for a normal entity
+	*/
+	template<typename... ComponentTypes>
+	Entity::SPtr createPackedEntity(const std::string& name = "");
+
+	/*
+		Returns a view over every packed entity which has all of the given components
+		The view is only valid until the next packed entity is created
+	*/
+	template<typename... ComponentTypes>
+	ArchetypeView<ComponentTypes...> view();
+
 	/*
 		Destroys an entity and removes it from the systems it was stored in
 	*/
@@ -134,6 +153,7 @@ public:
 	void addAllQueuedEntities();
 
 	size_t getNumEntities();
+	size_t getNumPackedEntities() const;
 #ifdef DEVELOPMENT
 	const SystemMap& getSystems() const;
 	const unsigned int getByteSize() const;
@@ -145,6 +165,10 @@ private:
 	ECS();
 	~ECS();
 
+	typedef std::unordered_map<ComponentTypeBitID, std::unique_ptr<Archetype>> ArchetypeMap;
+	// Declared before m_entities so that every entity is destroyed before the chunks their components live in
+	ArchetypeMap m_archetypes;
+
 	std::vector<Entity::SPtr> m_entities;
 	SystemMap m_systems;
 
@@ -154,6 +178,35 @@ private:
 	EntityRemovalSystem* m_entityRemovalSystem;
 };
 
+template<typename... ComponentTypes>
+inline Entity::SPtr ECS::createPackedEntity(const std::string& name) {
+	ComponentTypeBitID signature = 0;
+	((signature |= ComponentTypes::getBID()), ...);
+
+	auto it = m_archetypes.find(signature);
+	if (it == m_archetypes.end()) {
+		it = m_archetypes.emplace(signature, Archetype::Create<ComponentTypes...>()).first;
+	}
+
+	Entity::SPtr entity = createEntity(name);
+	entity->setArchetype(it->second.get(), it->second->reserve(entity.get()));
+	return entity;
+}
+
+template<typename... ComponentTypes>
+inline ArchetypeView<ComponentTypes...> ECS::view() {
+	ComponentTypeBitID signature = 0;
+	((signature |= ComponentTypes::getBID()), ...);
+
+	ArchetypeView<ComponentTypes...> view;
+	for (auto& archetype : m_archetypes) {
+		if ((archetype.first & signature) == signature) {
+			view.addArchetype(archetype.second.get());
+		}
+	}
+	return view;
+}
+
 template<typename T>
 inline void ECS::addSystem(T* system) {
 	SystemMap::iterator it = m_systems.find(typeid(T));
@@ -28,6 +28,18 @@ void Entity::setParent(Entity* entity) {
 	m_parent = entity;
 }
 
+void Entity::setArchetype(Archetype* archetype, const Archetype::Slot& slot) {
+	m_archetype = archetype;
+	m_archetypeSlot = slot;
+}
+
+void Entity::releaseArchetype() {
+	if (m_archetype) {
+		m_archetype->release(m_archetypeSlot);
+		m_archetype = nullptr;
+	}
+}
+
 int Entity::getECSIndex() const {
 	return m_ECSIndex;
 }
@@ -35,7 +47,8 @@ int Entity::getECSIndex() const {
 Entity::Entity(const std::string& name) 
 	: m_componentTypes(0x0),
 	m_name(name),
-	m_parent(nullptr)
+	m_parent(nullptr),
+	m_archetype(nullptr)
 {
 	m_id = s_id++;
 	m_ECSIndex = -1;
@@ -44,12 +57,28 @@ Entity::Entity(const std::string& name)
 }
 
 Entity::~Entity() {
+	// Packed entities normally give back their row in ECS::destroyEntity
+	if (m_archetype) {
+		for (int i = 0; i < BaseComponent::nrOfComponentTypes(); i++) {
+			m_components[i].reset(nullptr);
+			m_archetype->freeComponent(m_archetypeSlot, i);
+		}
+		releaseArchetype();
+	}
 	delete[] m_components;
 }
 
 bool Entity::hasComponents(std::bitset<MAX_NUM_COMPONENTS_TYPES> componentTypes) const {
 	return (m_componentTypes & componentTypes) == componentTypes;
 }
+
+bool Entity::isPacked() const {
+	return m_archetype != nullptr;
+}
+
+bool Entity::isPackedWith(const std::bitset<MAX_NUM_COMPONENTS_TYPES>& componentTypes) const {
+	return m_archetype && (m_archetype->getSignature() & componentTypes) == componentTypes;
+}
 #ifdef DEVELOPMENT
 const BaseComponent::Ptr* Entity::getComponents() const {
 	return m_components;
@@ -73,6 +102,9 @@ void Entity::removeComponent(ComponentTypeID id) {
 
 	if ((m_componentTypes & bid).any()) {
 		m_components[id].reset(nullptr);
+		if (m_archetype) {
+			m_archetype->freeComponent(m_archetypeSlot, id);
+		}
 
 		// Set the component type bit to 0 if it was 1
 		std::bitset<MAX_NUM_COMPONENTS_TYPES> bits = 1;
@@ -89,6 +121,9 @@ void Entity::removeComponent(ComponentTypeID id) {
 void Entity::removeAllComponents() {
 	for (int i = 0; i < BaseComponent::nrOfComponentTypes(); i++) {
 		m_components[i].reset(nullptr);
+		if (m_archetype) {
+			m_archetype->freeComponent(m_archetypeSlot, i);
+		}
 	}
 	//m_components.clear();
 	m_componentTypes = std::bitset<MAX_NUM_COMPONENTS_TYPES>(0);
@@ -3,6 +3,7 @@
 #include <memory>
 #include <bitset>
 #include "components/Component.h"
+#include "Archetype.h"
 
 #include "../utils/Utils.h"
 
@@ -37,6 +38,11 @@ public:
 
 
 	bool hasComponents(std::bitset<MAX_NUM_COMPONENTS_TYPES> componentTypes) const;
+
+	// True if the entity was created with ECS::createPackedEntity<...>()
+	bool isPacked() const;
+	// True if all of the component types are a part of the entity's archetype
+	bool isPackedWith(const std::bitset<MAX_NUM_COMPONENTS_TYPES>& componentTypes) const;
 #ifdef DEVELOPMENT
 	const BaseComponent::Ptr* getComponents() const;
 #endif
@@ -74,6 +80,9 @@ private:
 
 	void setParent(Entity* entity);
 
+	void setArchetype(Archetype* archetype, const Archetype::Slot& slot);
+	void releaseArchetype();
+
 	BaseComponent::Ptr* m_components;
 	std::bitset<MAX_NUM_COMPONENTS_TYPES> m_componentTypes;
 	std::string m_name;
@@ -83,6 +92,10 @@ private:
 	ECS* m_ecs;
 	Entity* m_parent;
 
+	// Components in the archetype's signature are placed in its chunk instead of on the heap
+	Archetype* m_archetype;
+	Archetype::Slot m_archetypeSlot;
+
 	std::vector<Entity*> m_children;
 };
 
@@ -91,7 +104,12 @@ inline ComponentType* Entity::addComponent(Targs... args) {
 	if (m_components[ComponentType::ID]) {
 		SAIL_LOG_WARNING("Tried to add a duplicate component to an entity");
 	} else {
-		m_components[ComponentType::ID] = std::make_unique<ComponentType>(args...);
+		void* chunkMemory = m_archetype ? m_archetype->allocateComponent(m_archetypeSlot, ComponentType::ID) : nullptr;
+		if (chunkMemory) {
+			m_components[ComponentType::ID] = BaseComponent::Ptr(new (chunkMemory) ComponentType(args...), BaseComponent::Deleter{ true });
+		} else {
+			m_components[ComponentType::ID] = BaseComponent::Ptr(SAIL_NEW ComponentType(args...));
+		}
 
 		m_componentTypes |= ComponentType::getBID();
 
@@ -109,6 +127,9 @@ template<typename ComponentType>
 inline void Entity::removeComponent() {
 	if ( hasComponent<ComponentType>() ) {
 		m_components[ComponentType::ID].reset(nullptr);
+		if (m_archetype) {
+			m_archetype->freeComponent(m_archetypeSlot, ComponentType::ID);
+		}
 
 		// Set the component type bit to 0 if it was 1
 		std::bitset<MAX_NUM_COMPONENTS_TYPES> bits = 0;
@@ -498,6 +498,29 @@ Entity::SPtr EntityFactory::CreateStaticMapObject(const std::string& name, Model
 	return e;
 }
 
+Entity::SPtr EntityFactory::CreateProjectileEntity() {
+	return ECS::Instance()->createPackedEntity<
+		TransformComponent,
+		MovementComponent,
+		BoundingBoxComponent,
+		CollisionComponent,
+		LifeTimeComponent,
+		ProjectileComponent,
+		MetaballComponent,
+		RenderInActiveGameComponent>("projectile");
+}
+
+Entity::SPtr EntityFactory::CreateReplayProjectileEntity() {
+	return ECS::Instance()->createPackedEntity<
+		TransformComponent,
+		MovementComponent,
+		BoundingBoxComponent,
+		CollisionComponent,
+		LifeTimeComponent,
+		MetaballComponent,
+		RenderInReplayComponent>("projectile");
+}
+
 Entity::SPtr EntityFactory::CreateProjectile(Entity::SPtr e, const EntityFactory::ProjectileArguments& info) {
 	constexpr float radius = 0.075f; // the radius of the projectile's hitbox (in meters)
 
@@ -44,6 +44,9 @@ namespace EntityFactory {
 	Entity::SPtr CreatePowerUp(glm::vec3& spawn, const int type, Netcode::ComponentID comID = 0);
 	Entity::SPtr CreateStaticMapObject(const std::string& name, Model * model, Model* boundingBoxModel, const glm::vec3& pos = glm::vec3(0,0,0), const glm::vec3& rot = glm::vec3(0,0,0), const glm::vec3& scale = glm::vec3(1,1,1));
 	
+	// Projectiles are numerous and short lived so the components updated every tick are packed (see Archetype.h)
+	Entity::SPtr CreateProjectileEntity();
+	Entity::SPtr CreateReplayProjectileEntity();
 	Entity::SPtr CreateProjectile(Entity::SPtr projectileEntity, const ProjectileArguments& info);
 	Entity::SPtr CreateReplayProjectile(Entity::SPtr projectileEntity, const ProjectileArguments& info);
 	Entity::SPtr CreateReplayCleaningBot(Netcode::ComponentID compID);
@@ -11,6 +11,7 @@ public:
 		: timeTakenOnPath(0.f)
 		, timeBetweenPathUpdate(3.f)
 		, updatePath(true)
+		, waitingForPath(false)
 		, doWalk(false)
 		, automaticallyUpdatePath(true)
 		, currNodeIndex(0)
@@ -22,6 +23,8 @@ public:
 	float timeBetweenPathUpdate;
 	
 	bool updatePath;
+	// A path has been requested from the AiSystem's path queue and hasn't arrived yet
+	bool waitingForPath;
 	bool doWalk;
 	bool automaticallyUpdatePath;
 
@@ -44,6 +47,7 @@ public:
 		ImGui::Text(("timeBetweenPathUpdate " + std::to_string(timeBetweenPathUpdate)).c_str());
 
 		ImGui::Text(("updatePath " + std::to_string(updatePath)).c_str());
+		ImGui::Text(("waitingForPath " + std::to_string(waitingForPath)).c_str());
 		ImGui::Text(("doWalk " + std::to_string(doWalk)).c_str());
 		ImGui::Text(("automaticallyUpdatePath " + std::to_string(automaticallyUpdatePath)).c_str());
 
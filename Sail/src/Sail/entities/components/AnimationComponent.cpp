@@ -10,6 +10,9 @@ AnimationComponent::AnimationComponent(AnimationStack* animationStack) :
 	animationName(""),
 	currentAnimation(nullptr),
 	nextAnimation(nullptr),
+	frameCursor(0),
+	nextFrameCursor(0),
+	lodSkippedTime(0.0f),
 	blending(false),
 	transformSize(0),
 	hasUpdated(false),
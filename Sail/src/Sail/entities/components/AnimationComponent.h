@@ -107,6 +107,11 @@ public:
 	std::string animationName;
 	Animation* currentAnimation;
 	Animation* nextAnimation;
+	// Closest frames of the last lookups in currentAnimation and nextAnimation, see Animation::getFrameAtTime()
+	unsigned int frameCursor;
+	unsigned int nextFrameCursor;
+	// Time passed since the last update, distant entities are not updated every frame
+	float lodSkippedTime;
 	bool blending;
 	unsigned int transformSize;
 	bool hasUpdated;
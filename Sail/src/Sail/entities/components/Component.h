@@ -35,7 +35,21 @@ extern ComponentTypeID global_componentID;
 */
 class BaseComponent {
 public:
-	typedef std::unique_ptr<BaseComponent> Ptr;
+	/*
+		Components are either heap allocated or placed inside an archetype chunk (see Archetype.h)
+		Components placed in a chunk are only destructed since the chunk owns the memory
+	*/
+	struct Deleter {
+		bool inPlace = false;
+		void operator()(BaseComponent* component) const {
+			if (inPlace) {
+				component->~BaseComponent();
+			} else {
+				delete component;
+			}
+		}
+	};
+	typedef std::unique_ptr<BaseComponent, Deleter> Ptr;
 
 	virtual ~BaseComponent() {}
 	
@@ -36,7 +36,11 @@ bool BaseComponentSystem::instantAddEntity(Entity* entity) {
 		return false;
 	}
 
-	entities.push_back(entity);
+	if (isIteratedThroughView(entity)) {
+		packedEntities.push_back(entity);
+	} else {
+		entities.push_back(entity);
+	}
 	entities_set.insert(entity->getID());
 
 	return true;
@@ -44,6 +48,9 @@ bool BaseComponentSystem::instantAddEntity(Entity* entity) {
 
 void BaseComponentSystem::removeEntity(Entity* entity) {
 	entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
+	if (!packedEntities.empty()) {
+		packedEntities.erase(std::remove(packedEntities.begin(), packedEntities.end(), entity), packedEntities.end());
+	}
 	entitiesQueuedToAdd.erase(std::remove(entitiesQueuedToAdd.begin(), entitiesQueuedToAdd.end(), entity), entitiesQueuedToAdd.end());
 
 	entitiesQueuedToAdd_set.erase(entity->getID());
@@ -64,6 +71,7 @@ const std::bitset<MAX_NUM_COMPONENTS_TYPES>& BaseComponentSystem::getWriteBitMas
 
 void BaseComponentSystem::clearEntities() {
 	entities.clear();
+	packedEntities.clear();
 	entities_set.clear();
 
 	entitiesQueuedToAdd.clear();
@@ -71,7 +79,7 @@ void BaseComponentSystem::clearEntities() {
 }
 
 size_t BaseComponentSystem::getNumEntities() {
-	return entities.size();
+	return entities.size() + packedEntities.size();
 }
 #ifdef DEVELOPMENT
 const std::vector<Entity*>& BaseComponentSystem::getEntities() const{
@@ -81,6 +89,7 @@ void BaseComponentSystem::imguiPrint(Entity** selectedEntity) {
 }
 unsigned int BaseComponentSystem::getByteSize() const {
 	unsigned int size = entities.size() * sizeof(Entity*);
+	size += packedEntities.size() * sizeof(Entity*);
 	size += entitiesQueuedToAdd.size() * sizeof(Entity*);
 	size += entities_set.size() * sizeof(int);
 	size += entitiesQueuedToAdd_set.size() * sizeof(int);
@@ -90,9 +99,18 @@ unsigned int BaseComponentSystem::getByteSize() const {
 void BaseComponentSystem::addQueuedEntities() {
 	for (Entity* e : entitiesQueuedToAdd) {
 		entities_set.insert(e->getID());
+
+		if (isIteratedThroughView(e)) {
+			packedEntities.push_back(e);
+		} else {
+			entities.push_back(e);
+		}
 	}
 
-	entities.insert(entities.end(), entitiesQueuedToAdd.begin(), entitiesQueuedToAdd.end());
 	entitiesQueuedToAdd.clear();
 	entitiesQueuedToAdd_set.clear();
 }
+
+bool BaseComponentSystem::isIteratedThroughView(Entity* entity) const {
+	return iteratesArchetypes && entity->isPackedWith(requiredComponentTypes);
+}
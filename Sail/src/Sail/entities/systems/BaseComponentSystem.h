@@ -15,6 +15,10 @@ class Entity;
 	However, there can still be optional components if the system wants it, which should be checked before used.
 
 	Example: See PhysicSystem.h and PhysicSystem.cpp
+
+	Systems which iterate packed entities through ECS::view<...>() (see ArchetypeView.h) should set iteratesArchetypes = true.
+	Packed entities whose archetype contains all of the required components are then kept out of 'entities'
+	so that they aren't updated twice. The view must be created with the system's required component types.
 */
 
 class BaseComponentSystem {
@@ -35,7 +39,7 @@ public:
 
 	/*
 		Does not have to be overridden, a different function can be created and called in the sub systems
-		This is only here to make GameState::runSystem() work for now
+		This is what SystemScheduler calls for the systems it runs
 	*/
 	virtual void update(float dt) { }
 
@@ -79,6 +83,9 @@ protected:
 	template<typename ComponentType>
 	void registerComponent(bool required, bool read, bool write);
 
+private:
+	bool isIteratedThroughView(Entity* entity) const;
+
 protected:
 #ifdef DEVELOPMENT
 	std::string systemName;
@@ -87,6 +94,10 @@ protected:
 	std::vector<Entity*> entities;
 	std::unordered_set<int> entities_set;
 
+	// Only used when iteratesArchetypes is true, these entities are updated through a view instead
+	std::vector<Entity*> packedEntities;
+	bool iteratesArchetypes = false;
+
 	std::vector<Entity*> entitiesQueuedToAdd;
 	std::unordered_set<int> entitiesQueuedToAdd_set;
 
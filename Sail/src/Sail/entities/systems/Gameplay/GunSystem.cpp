@@ -166,12 +166,11 @@ void GunSystem::fireGun(Entity* e, GunComponent* gun, PowerUpComponent* powC) {
 		
 		auto rayFrom = e->getComponent<TransformComponent>()->getTranslation();
 		rayFrom.y = gun->position.y;
-		Octree::RayIntersectionInfo rayInfo;
 		auto rayDir = gun->position - rayFrom;
 		auto rayDirNorm = glm::normalize(rayDir);
 
-		m_octree->getRayIntersection(rayFrom, rayDirNorm, &rayInfo, e, 0.1f);
-		if (!(rayInfo.closestHit < glm::length(rayDir))) {
+		// Only spawn the projectile if nothing is between the player and the gun
+		if (!m_octree->hasRayIntersection(rayFrom, rayDirNorm, glm::length(rayDir), e, 0.1f)) {
 			// Tell yours and everybody else's NetworkReceiverSystem to spawn the projectile
 			NWrapperSingleton::getInstance().queueGameStateNetworkSenderEvent(
 				Netcode::MessageType::SPAWN_PROJECTILE,
@@ -31,7 +31,8 @@ ProjectileSystem::~ProjectileSystem() {
 }
 
 void ProjectileSystem::update(float dt) {
-	//std::vector<glm::vec3> pointsToSubmit;
+	m_waterHits.clear();
+	m_waterHits.setGrid(Netcode::WaterCells::Grid::FromSettings());
 
 	for (auto& e : entities) {
 		CollisionComponent*  collisionComp = e->getComponent<CollisionComponent>();
@@ -53,9 +54,7 @@ void ProjectileSystem::update(float dt) {
 				//glm::mat4 rotMat = glm::rotate(glm::identity<glm::mat4>(), Utils::fastrand() * 3.14f, glm::vec3(0.0f, 0.0f, 1.0f));
 
 				// Place water point at intersection position
-				Application::getInstance()->getRenderWrapper()->getCurrentRenderer()->submitWaterPoint(collision.intersectionPosition);
-
-				//pointsToSubmit.push_back(collision.intersectionPosition);
+				m_waterHits.add(collision.intersectionPosition);
 
 				projComp->timeSinceLastDecal = 0.f;
 			}
@@ -111,10 +110,14 @@ void ProjectileSystem::update(float dt) {
 		projComp->timeSinceLastDecal += dt;
 	}
 
-	//if (!pointsToSubmit.empty()) {
+	if (!m_waterHits.empty()) {
+		Application::getInstance()->getRenderWrapper()->getCurrentRenderer()->submitWaterCells(m_waterHits);
+	}
+
+	//if (!m_waterHits.empty()) {
 	//	NWrapperSingleton::getInstance().queueGameStateNetworkSenderEvent(
 	//		Netcode::MessageType::SUBMIT_WATER_POINTS,
-	//		SAIL_NEW Netcode::MessageSubmitWaterPoints{ pointsToSubmit }, 
+	//		SAIL_NEW Netcode::MessageSubmitWaterPoints{ m_waterHits }, 
 	//		false
 	//	);
 	//}
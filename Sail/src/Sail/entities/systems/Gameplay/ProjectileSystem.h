@@ -1,5 +1,6 @@
 #pragma once
 #include "..//BaseComponentSystem.h"
+#include "Sail/netcode/WaterCells.h"
 
 class ProjectileSystem final : public BaseComponentSystem {
 public:
@@ -17,4 +18,6 @@ private:
 	// TODO: Replace with game settings
 	float m_projectileSplashSize;
 	Entity* m_crosshair = nullptr;
+	// The water hits of a tick, added to the water all at once
+	Netcode::WaterCells m_waterHits;
 };
@@ -47,6 +47,8 @@ void SprinklerSystem::update(float dt) {
 			m_endGameTimer += dt;
 
 			// Randomize a water spot with a ray for each active sprinkler
+			m_waterHits.clear();
+			m_waterHits.setGrid(Netcode::WaterCells::Grid::FromSettings());
 			for (int i = 0; i < m_sprinklers.size(); i++) {
 				if (m_sprinklers[i].active) {
 					Octree::RayIntersectionInfo tempInfo;
@@ -56,11 +58,14 @@ void SprinklerSystem::update(float dt) {
 
 					glm::vec3 waterDir = glm::vec3(((2.f * Utils::rnd()) - 1.0f) * sprinklerXspread, -m_sprinklers[i].pos.y, ((2.f * Utils::rnd()) - 1.0f) * sprinklerZspread) + m_sprinklers[i].pos;
 					waterDir = glm::normalize(waterDir - m_sprinklers[i].pos);
-					m_octree->getRayIntersection(m_sprinklers[i].pos, waterDir, &tempInfo);
+					m_octree->getClosestRayIntersection(m_sprinklers[i].pos, waterDir, &tempInfo);
 					glm::vec3 hitPos = m_sprinklers[i].pos + waterDir * tempInfo.closestHit;
-					Application::getInstance()->getRenderWrapper()->getCurrentRenderer()->submitWaterPoint(hitPos);
+					m_waterHits.add(hitPos);
 				}
 			}
+			if (!m_waterHits.empty()) {
+				Application::getInstance()->getRenderWrapper()->getCurrentRenderer()->submitWaterCells(m_waterHits);
+			}
 
 			for (auto& e : entities) {
 
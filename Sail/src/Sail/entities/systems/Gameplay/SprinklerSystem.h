@@ -3,6 +3,7 @@
 #include "Sail/entities/systems/BaseComponentSystem.h"
 #include "Sail/entities/systems/Gameplay/LevelSystem/LevelSystem.h"
 #include "Sail/utils/Storage/SettingStorage.h"
+#include "Sail/netcode/WaterCells.h"
 
 class Octree;
 class Entity;
@@ -48,6 +49,8 @@ private:
 	std::vector<int> m_activeSprinklers;
 	std::vector<int> m_roomsToBeActivated;
 	std::vector<Sprinkler> m_sprinklers;
+	// The water hits of a tick, added to the water all at once
+	Netcode::WaterCells m_waterHits;
 
 	void addSprinkler(int x, int y, Entity* ownerEntity);
 };
\ No newline at end of file
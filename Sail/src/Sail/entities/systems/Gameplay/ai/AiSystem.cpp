@@ -43,6 +43,7 @@ AiSystem::AiSystem() {
 	registerComponent<NetworkSenderComponent>(true, false, false);
 
 	m_nodeSystem = std::make_unique<NodeSystem>();
+	m_pathRequests = std::make_unique<PathRequestQueue>(m_nodeSystem.get());
 
 	m_targetReachedThreshold = 5.f;
 }
@@ -106,9 +107,9 @@ void AiSystem::initNodeSystem(Octree* octree) {
 		bool blocked = false;
 		Octree::RayIntersectionInfo tempInfo;
 		glm::vec3 down(0.f, -1.f, 0.f);
-		m_octree->getRayIntersection(glm::vec3(nodePos.x + 0.01f, nodePos.y + collisionBoxHalfHeight, nodePos.z), down, &tempInfo, e.get(), 0.1f);
+		m_octree->getClosestRayIntersection(glm::vec3(nodePos.x + 0.01f, nodePos.y + collisionBoxHalfHeight, nodePos.z), down, &tempInfo, e.get(), 0.1f);
 		if (tempInfo.closestHitIndex != -1) {
-			float floorCheckVal = glm::angle(tempInfo.info[tempInfo.closestHitIndex].shape->getNormal(), -down);
+			float floorCheckVal = glm::angle(tempInfo.info[tempInfo.closestHitIndex].shape.getNormal(), -down);
 			// If there's a low angle between the up-vector and the normal of the surface, it can be counted as floor
 			bool isFloor = (floorCheckVal < 0.1f) ? true : false;
 			if (!isFloor) {
@@ -189,6 +190,7 @@ void AiSystem::initNodeSystem(Octree* octree) {
 
 	e->queueDestruction();
 
+	m_pathRequests->clear();
 	m_nodeSystem->setNodes(nodes, connections, xMax, zMax);
 	m_targetReachedThreshold = glm::pow(nodePadding, 2.f) / 2.f + 0.1f;
 }
@@ -201,6 +203,9 @@ void AiSystem::update(float dt) {
 #ifdef DEVELOPMENT
 	auto start = std::chrono::high_resolution_clock::now();
 #endif
+	// Paths requested on earlier ticks are searched on the thread pool, collect the finished ones and start the next batch
+	m_pathRequests->update();
+
 	for ( auto& entity : entities ) {
 		aiUpdateFunc(entity, dt);
 	}
@@ -215,6 +220,7 @@ NodeSystem* AiSystem::getNodeSystem() {
 }
 
 void AiSystem::stop() {
+	m_pathRequests->clear();
 	m_nodeSystem->stop();
 }
 
@@ -228,6 +234,9 @@ unsigned int AiSystem::getByteSize() const {
 const float AiSystem::getAveragePathSearchTime() const {
 	return m_nodeSystem->getAverageSearchTime();
 }
+size_t AiSystem::getNumQueuedPathRequests() const {
+	return m_pathRequests->getNumPending();
+}
 const float AiSystem::getAverageAiUpdateTime() const {
 	float updateTime = 0.f;
 	for (unsigned int i = 0; i < std::min(m_currUpdateTimeIndex, NUM_UPDATE_TIMES); i++) {
@@ -264,17 +273,8 @@ bool AiSystem::nodeConnectionCheck(glm::vec3 nodePos, glm::vec3 otherNodePos, En
 	float dst = glm::distance(nodePos, otherNodePos);
 	glm::vec3 dir = glm::normalize(otherNodePos - nodePos);
 
-	// Intersection check
-	Octree::RayIntersectionInfo tempInfo;
-	m_octree->getRayIntersection(glm::vec3(nodePos.x, nodePos.y + 0.5f, nodePos.z), dir, &tempInfo, nodeEnt, 0.5f, false, true);
-
 	// Nothing between the two nodes
-	if (tempInfo.closestHit > dst || tempInfo.closestHit < 0.0f) {
-		return true;
-	}
-
-	// The nodes shouldn't be connected
-	return false;
+	return !m_octree->hasRayIntersection(glm::vec3(nodePos.x, nodePos.y + 0.5f, nodePos.z), dir, dst, nodeEnt, 0.5f, false, true);
 }
 
 glm::vec3 AiSystem::getNodePos(const int x, const int z, float nodeSize, float nodePadding, float startOffsetX, float startOffsetZ) {
@@ -286,14 +286,21 @@ glm::vec3 AiSystem::getNodePos(const int x, const int z, float nodeSize, float n
 void AiSystem::updatePath(Entity* e) {
 	AiComponent* ai = e->getComponent<AiComponent>();
 	TransformComponent* transform = e->getComponent<TransformComponent>();
-	if (ai->updatePath ) {
+
+	// The bot keeps following its current path until the new one arrives.
+	// Asking again while waiting replaces the queued request so that a target changed in the meantime isn't lost
+	if (ai->updatePath) {
+		ai->timeTakenOnPath = 0.f;
+		m_pathRequests->request(e->getID(), transform->getTranslation(), ai->posTarget);
+		ai->waitingForPath = true;
+		ai->updatePath = false;
+	}
+
+	std::vector<NodeSystem::Node> tempPath;
+	if (ai->waitingForPath && m_pathRequests->collect(e->getID(), &tempPath)) {
 #ifdef _DEBUG_NODESYSTEM
 		m_nodeSystem->colorPath(ai->currPath, m_nodeSystem->getMaxColourID());
 #endif
-		ai->timeTakenOnPath = 0.f;
-
-		auto tempPath = m_nodeSystem->getPath(transform->getTranslation(), ai->posTarget);
-
 		ai->currNodeIndex = 0;
 
 		// Fix problem of always going toward closest node
@@ -301,13 +308,18 @@ void AiSystem::updatePath(Entity* e) {
 			ai->currNodeIndex += 1;
 		}
 
-		ai->currPath = tempPath;
+		ai->currPath = std::move(tempPath);
 
 #ifdef _DEBUG_NODESYSTEM
 		m_nodeSystem->colorPath(ai->currPath, e->getID() % (m_nodeSystem->getMaxColourID() - 1));
 #endif
 
-		ai->updatePath = false;
+		// The path may answer an older request, keep waiting if a newer one is still on its way
+		ai->waitingForPath = m_pathRequests->isPending(e->getID());
+	} else if (ai->waitingForPath && !m_pathRequests->isPending(e->getID())) {
+		// The request was dropped, for example when the queue was cleared, ask again
+		ai->waitingForPath = false;
+		ai->updatePath = true;
 	}
 }
 
@@ -341,7 +353,7 @@ void AiSystem::updatePhysics(Entity* e, float dt) {
 			auto currVelDir = glm::normalize(currVel);
 			// Intersection check
 			Octree::RayIntersectionInfo tempInfo;
-			m_octree->getRayIntersection(glm::vec3(aiPos), currVelDir, &tempInfo, e, 0.5f);
+			m_octree->getClosestRayIntersection(glm::vec3(aiPos), currVelDir, &tempInfo, e, 0.5f);
 
 			glm::vec3 adjustedAcc(0.f);
 			if (tempInfo.closestHitIndex != -1) {
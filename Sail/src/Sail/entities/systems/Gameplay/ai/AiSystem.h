@@ -2,6 +2,7 @@
 
 #include "../../BaseComponentSystem.h"
 #include "Sail/ai/pathfinding/NodeSystem.h"
+#include "Sail/ai/pathfinding/PathRequestQueue.h"
 
 class TransformComponent;
 class AiComponent;
@@ -41,6 +42,7 @@ public:
 	unsigned int getByteSize() const override;
 	const float getAveragePathSearchTime() const;
 	const float getAverageAiUpdateTime() const;
+	size_t getNumQueuedPathRequests() const;
 #endif
 
 private:
@@ -54,6 +56,7 @@ private:
 
 private:
 	std::unique_ptr<NodeSystem> m_nodeSystem;
+	std::unique_ptr<PathRequestQueue> m_pathRequests;
 
 	Octree* m_octree;
 
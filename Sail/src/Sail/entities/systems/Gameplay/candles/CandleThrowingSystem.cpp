@@ -117,7 +117,7 @@ void CandleThrowingSystem::update(float dt) {
 					Octree::RayIntersectionInfo rayInfo;
 					auto rayDir = throwPos - rayFrom;
 					auto rayDirNorm = glm::normalize(rayDir);
-					m_octree->getRayIntersection(rayFrom, rayDirNorm, &rayInfo, e, 0.1f);
+					m_octree->getClosestRayIntersection(rayFrom, rayDirNorm, &rayInfo, e, 0.1f);
 					if (!throwC->isDropping) {
 						// Keep this until throw is "flawless"
 						/*throwPos += throwC->direction * 0.8f;
@@ -7,6 +7,7 @@
 #include "Sail/entities/components/RenderInActiveGameComponent.h"
 #include "Sail/entities/components/RenderInReplayComponent.h"
 #include "Sail/graphics/geometry/Model.h"
+#include "Sail/graphics/camera/Camera.h"
 #include "sail/api/VertexBuffer.h"
 #include "API/DX12/DX12API.h"
 #include "API/DX12/DX12VertexBuffer.h"
@@ -25,10 +26,27 @@
 #include "Sail/graphics/shader/dxr/GBufferOutShader.h"
 // --------------------------
 
+namespace {
+	// Entities further from the camera than these distances get the next LOD
+	constexpr float LOD_DISTANCES[] = { 15.0f, 30.0f };
+	// Entities at each LOD are updated once every this many updates
+	constexpr unsigned int LOD_UPDATE_INTERVALS[] = { 1, 2, 4 };
+	// Entities at this LOD or above hold their frames instead of interpolating between them
+	constexpr unsigned int LOD_NO_INTERPOLATION = 2;
+	// Animation times are snapped to steps of this length when their poses are shared through the cache
+	constexpr float POSE_CACHE_STEP = 1.0f / 120.0f;
+}
+
 template <typename T>
 AnimationSystem<T>::AnimationSystem() 
 	: BaseComponentSystem()
 	, m_interpolate(true) 
+	, m_decomposedPoses(true)
+	, m_poseCache(true)
+	, m_doLOD(false)
+	, m_lodCamera(nullptr)
+	, m_lodFrame(0)
+	, m_numCachedPoses(0)
 {
 	// TODO: System owner should check if this is correct
 	registerComponent<AnimationComponent>(true, true, true);
@@ -74,92 +92,146 @@ void AnimationSystem<T>::update(float dt) {
 
 template <typename T>
 void AnimationSystem<T>::updateTransforms(const float dt) { 
-	for (auto& e : entities) {
+	m_stats = Stats();
+	m_numCachedPoses = 0;
+	m_lodFrame++;
+
+	for (size_t i = 0; i < entities.size(); i++) {
+		Entity* e = entities[i];
 		AnimationComponent* animationC = e->getComponent<AnimationComponent>();
 
-		if (!animationC->currentAnimation) {
-#if defined(_DEBUG)
-			SAIL_LOG_WARNING("AnimationComponent without animation set");
-#endif
+		unsigned int lod = 0;
+		if (m_doLOD && m_lodCamera && !animationC->is_camFollowingHead) {
+			const float distance = glm::distance(e->getComponent<TransformComponent>()->getTranslation(), m_lodCamera->getPosition());
+			while (lod < 2 && distance > LOD_DISTANCES[lod]) {
+				lod++;
+			}
+		}
+
+		// Entities at the same LOD take turns so that their updates are spread over the frames
+		animationC->lodSkippedTime += dt;
+		if ((m_lodFrame + i) % LOD_UPDATE_INTERVALS[lod] != 0) {
+			m_stats.skippedUpdates++;
 			continue;
 		}
+		updateTransforms(animationC, animationC->lodSkippedTime, lod);
+		animationC->lodSkippedTime = 0.0f;
+	}
+}
 
-		//transition update
-		if (animationC->currentTransition.to != nullptr) {
-			if (animationC->currentTransition.done) {
-				//transitions complete
-				if (animationC->currentTransition.transpiredTime >= animationC->currentTransition.transitionTime) {
-					animationC->currentAnimation = animationC->currentTransition.to;
-					animationC->animationTime = animationC->currentTransition.transpiredTime;
-					animationC->animationIndex = animationC->currentTransition.toIndex;
-					animationC->currentTransition.to = nullptr;
-					animationC->nextAnimation = nullptr;
-				}
-			} else {
-				if (animationC->currentTransition.transpiredTime == 0.f) {
-					if (animationC->currentTransition.waitForEnd) {
-						if (animationC->animationTime + dt * animationC->animationSpeed >= animationC->currentAnimation->getMaxAnimationTime()) {
-							animationC->nextAnimation = animationC->currentTransition.to;
-							animationC->currentTransition.transpiredTime += dt;
-							SAIL_LOG("Done with animation, begin transition");
-						}
-					} else {
+template <typename T>
+void AnimationSystem<T>::updateTransforms(AnimationComponent* animationC, const float dt, const unsigned int lod) {
+	if (!animationC->currentAnimation) {
+#if defined(_DEBUG)
+		SAIL_LOG_WARNING("AnimationComponent without animation set");
+#endif
+		return;
+	}
+
+	//transition update
+	if (animationC->currentTransition.to != nullptr) {
+		if (animationC->currentTransition.done) {
+			//transitions complete
+			if (animationC->currentTransition.transpiredTime >= animationC->currentTransition.transitionTime) {
+				animationC->currentAnimation = animationC->currentTransition.to;
+				animationC->animationTime = animationC->currentTransition.transpiredTime;
+				animationC->animationIndex = animationC->currentTransition.toIndex;
+				animationC->frameCursor = animationC->nextFrameCursor;
+				animationC->currentTransition.to = nullptr;
+				animationC->nextAnimation = nullptr;
+			}
+		} else {
+			if (animationC->currentTransition.transpiredTime == 0.f) {
+				if (animationC->currentTransition.waitForEnd) {
+					if (animationC->animationTime + dt * animationC->animationSpeed >= animationC->currentAnimation->getMaxAnimationTime()) {
 						animationC->nextAnimation = animationC->currentTransition.to;
 						animationC->currentTransition.transpiredTime += dt;
+						SAIL_LOG("Done with animation, begin transition");
 					}
-				} else if (animationC->currentTransition.transpiredTime >= animationC->currentTransition.transitionTime) {
-					// Transition done
-					animationC->currentTransition.done = true;
 				} else {
-					// Transition transpiring
+					animationC->nextAnimation = animationC->currentTransition.to;
 					animationC->currentTransition.transpiredTime += dt;
 				}
+			} else if (animationC->currentTransition.transpiredTime >= animationC->currentTransition.transitionTime) {
+				// Transition done
+				animationC->currentTransition.done = true;
+			} else {
+				// Transition transpiring
+				animationC->currentTransition.transpiredTime += dt;
 			}
 		}
+	}
 
-		if (animationC->updateDT) {
-			addTime(animationC, dt);
-		}
-		
-		const unsigned int frame00 = animationC->currentAnimation->getFrameAtTime(animationC->animationTime, Animation::BEHIND);
-		const unsigned int frame01 = animationC->currentAnimation->getFrameAtTime(animationC->animationTime, Animation::INFRONT); // TODO: make getNextFrame function.
-		const unsigned int frame10 = animationC->nextAnimation ? animationC->nextAnimation->getFrameAtTime(animationC->currentTransition.transpiredTime,
-																														   Animation::BEHIND) : 0;
-		const unsigned int frame11 = animationC->nextAnimation ? animationC->nextAnimation->getFrameAtTime(animationC->currentTransition.transpiredTime,
-																														   Animation::INFRONT) : 0;
-
-		const unsigned int transformSize = animationC->currentAnimation->getAnimationTransformSize(frame00);
-		if (transformSize != animationC->transformSize) {
-			Memory::SafeDeleteArr(animationC->transforms);
-			animationC->transforms = SAIL_NEW glm::mat4[animationC->currentAnimation->getAnimationTransformSize(unsigned int(0))];
+	if (animationC->updateDT) {
+		addTime(animationC, dt);
+	}
+
+	// Distant entities only play their current animation
+	Animation* nextAnimation = (lod == 0) ? animationC->nextAnimation : nullptr;
+	const bool interpolateFrames = m_interpolate && lod < LOD_NO_INTERPOLATION;
+
+	// Poses of a single animation are shared through the cache, the time is snapped to its steps so that entities at nearly the same time share them
+	const bool cachePose = m_poseCache && !nextAnimation && interpolateFrames && animationC->animationTime >= 0.0f;
+	const unsigned int cacheTime = cachePose ? static_cast<unsigned int>(animationC->animationTime / POSE_CACHE_STEP) : 0;
+	const float animationTime = cachePose ? cacheTime * POSE_CACHE_STEP : animationC->animationTime;
+	
+	const unsigned int frame00 = animationC->currentAnimation->getFrameAtTime(animationTime, Animation::BEHIND, &animationC->frameCursor);
+	const unsigned int frame01 = animationC->currentAnimation->getFrameAtTime(animationTime, Animation::INFRONT, &animationC->frameCursor); // TODO: make getNextFrame function.
+	const unsigned int frame10 = nextAnimation ? nextAnimation->getFrameAtTime(animationC->currentTransition.transpiredTime, Animation::BEHIND, &animationC->nextFrameCursor) : 0;
+	const unsigned int frame11 = nextAnimation ? nextAnimation->getFrameAtTime(animationC->currentTransition.transpiredTime, Animation::INFRONT, &animationC->nextFrameCursor) : 0;
+
+	// Only reallocated when the number of bones changes
+	const unsigned int transformSize = animationC->currentAnimation->getAnimationTransformSize(frame00);
+	if (transformSize != animationC->transformSize && transformSize > 0) {
+		Memory::SafeDeleteArr(animationC->transforms);
+		animationC->transforms = SAIL_NEW glm::mat4[transformSize];
+		animationC->transformSize = transformSize;
 
 #if defined(_DEBUG) && defined(SAIL_VERBOSELOGGING)
-			SAIL_LOG("AnimationSystem: Rebuilt transformarray");
+		SAIL_LOG("AnimationSystem: Rebuilt transformarray");
 #endif
-		}
-
-		const glm::mat4* transforms00 = animationC->currentAnimation->getAnimationTransform(frame00);
-		const glm::mat4* transforms01 = animationC->currentAnimation->getAnimationTransform(frame01);//frame01 > frame00 ? animationC->currentAnimation->getAnimationTransform(frame01) : nullptr;
-		const glm::mat4* transforms10 = animationC->nextAnimation ? animationC->nextAnimation->getAnimationTransform(frame10) : nullptr;
-		const glm::mat4* transforms11 = (animationC->nextAnimation && frame11 > frame10) ? animationC->nextAnimation->getAnimationTransform(frame11) : nullptr;
-
-		// Origin of root bone - "hips"
-		const glm::vec3 transOrig = glm::vec3(0.02f, 0.95f, -0.03f);
-		auto trans = glm::translate(transOrig) * glm::rotate(animationC->pitch, glm::vec3(1.f, 0.f, 0.f)) * glm::translate(-transOrig);
-
-		//INTERPOLATE
-		if (transforms00 && transforms01 && transforms10 && transforms11 && m_interpolate) {
-			const float frame00Time = animationC->currentAnimation->getTimeAtFrame(frame00);
-			const float frame01Time = animationC->currentAnimation->getTimeAtFrame(frame01);
-			const float frame10Time = animationC->nextAnimation->getTimeAtFrame(frame10);
-			const float frame11Time = animationC->nextAnimation->getTimeAtFrame(frame11);
-			// weight = time - time(0) / time(1) - time(0)
-
-			const float w0 = (animationC->animationTime - frame00Time) / (frame01Time - frame00Time);
-			const float w1 = (animationC->currentTransition.transpiredTime - frame10Time) / (frame11Time - frame10Time);
-			const float wt = animationC->currentTransition.transpiredTime / animationC->currentTransition.transitionTime;
-			animationC->animationW = wt;
+	}
 
+	const glm::mat4* transforms00 = animationC->currentAnimation->getAnimationTransform(frame00);
+	const glm::mat4* transforms01 = animationC->currentAnimation->getAnimationTransform(frame01);//frame01 > frame00 ? animationC->currentAnimation->getAnimationTransform(frame01) : nullptr;
+	const glm::mat4* transforms10 = nextAnimation ? nextAnimation->getAnimationTransform(frame10) : nullptr;
+	const glm::mat4* transforms11 = (nextAnimation && frame11 > frame10) ? nextAnimation->getAnimationTransform(frame11) : nullptr;
+
+	// Origin of root bone - "hips"
+	const glm::vec3 transOrig = glm::vec3(0.02f, 0.95f, -0.03f);
+	auto trans = glm::translate(transOrig) * glm::rotate(animationC->pitch, glm::vec3(1.f, 0.f, 0.f)) * glm::translate(-transOrig);
+
+	bool fromCache = false;
+
+	//INTERPOLATE
+	if (transforms00 && transforms01 && transforms10 && transforms11 && interpolateFrames) {
+		const float frame00Time = animationC->currentAnimation->getTimeAtFrame(frame00);
+		const float frame01Time = animationC->currentAnimation->getTimeAtFrame(frame01);
+		const float frame10Time = nextAnimation->getTimeAtFrame(frame10);
+		const float frame11Time = nextAnimation->getTimeAtFrame(frame11);
+		// weight = time - time(0) / time(1) - time(0)
+
+		const float w0 = (animationTime - frame00Time) / (frame01Time - frame00Time);
+		const float w1 = (animationC->currentTransition.transpiredTime - frame10Time) / (frame11Time - frame10Time);
+		const float wt = animationC->currentTransition.transpiredTime / animationC->currentTransition.transitionTime;
+		animationC->animationW = wt;
+
+		const AnimationPose* pose00 = animationC->currentAnimation->getPose(frame00);
+		const AnimationPose* pose01 = animationC->currentAnimation->getPose(frame01);
+		const AnimationPose* pose10 = nextAnimation->getPose(frame10);
+		const AnimationPose* pose11 = nextAnimation->getPose(frame11);
+
+		if (m_decomposedPoses && pose00 && pose01 && pose10 && pose11) {
+			AnimationPose::Blend(*pose00, *pose01, w0, m_blendPoses[0]);
+			AnimationPose::Blend(*pose10, *pose11, w1, m_blendPoses[1]);
+			AnimationPose::Blend(m_blendPoses[0], m_blendPoses[1], wt, m_blendPoses[2]);
+			m_blendPoses[2].toMatrices(animationC->transforms);
+
+			// Rotate the upper body in relation to camera pitch
+			for (unsigned int transformIndex = 1; transformIndex < std::min(transformSize, 31u); transformIndex++) {
+				animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
+			}
+		} else {
 			glm::mat4 m0 = glm::identity<glm::mat4>();
 			glm::mat4 m1 = glm::identity<glm::mat4>();
 
@@ -173,78 +245,104 @@ void AnimationSystem<T>::updateTransforms(const float dt) {
 					animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
 				}
 			}
-
 		}
-		else if (transforms00 && transforms10) {
-			const float wt = animationC->currentTransition.transpiredTime / animationC->currentTransition.transitionTime;
-			for (unsigned int transformIndex = 0; transformIndex < transformSize; transformIndex++) {
-				interpolate(animationC->transforms[transformIndex], transforms00[transformIndex], transforms10[transformIndex], wt);
-				animationC->transforms[transformIndex] = transforms00[transformIndex];
-
-				// Rotate the upper body in relation to camera pitch
-				if (transformIndex > 0 && transformIndex < 31) {
-					animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
-				}
+	}
+	else if (transforms00 && transforms10) {
+		// Holds the current frame until the next animation has two frames to interpolate between
+		for (unsigned int transformIndex = 0; transformIndex < transformSize; transformIndex++) {
+			animationC->transforms[transformIndex] = transforms00[transformIndex];
+
+			// Rotate the upper body in relation to camera pitch
+			if (transformIndex > 0 && transformIndex < 31) {
+				animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
 			}
 		}
-		else if (transforms00 && transforms01 && m_interpolate) {
+	}
+	else if (transforms00 && transforms01 && interpolateFrames) {
+		const CachedPose* cached = cachePose ? findCachedPose(animationC->currentAnimation, cacheTime) : nullptr;
+		if (cached && cached->transforms.size() == transformSize) {
+			std::copy(cached->transforms.begin(), cached->transforms.end(), animationC->transforms);
+			fromCache = true;
+		} else {
 			const float frame0Time = animationC->currentAnimation->getTimeAtFrame(frame00);
 			const float frame1Time = animationC->currentAnimation->getTimeAtFrame(frame01);
 			// weight = time - time(0) / time(1) - time(0)
 
-			const float w = (animationC->animationTime - frame0Time) / (frame1Time - frame0Time);
-			for (unsigned int transformIndex = 0; transformIndex < transformSize; transformIndex++) {
-				interpolate(animationC->transforms[transformIndex], transforms00[transformIndex], transforms01[transformIndex], w);
-				// Rotate the upper body in relation to camera pitch
-				if (transformIndex > 0 && transformIndex < 31) {
-					animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
+			const float w = (animationTime - frame0Time) / (frame1Time - frame0Time);
+
+			const AnimationPose* pose00 = animationC->currentAnimation->getPose(frame00);
+			const AnimationPose* pose01 = animationC->currentAnimation->getPose(frame01);
+
+			if (m_decomposedPoses && pose00 && pose01) {
+				AnimationPose::Blend(*pose00, *pose01, w, m_blendPoses[0]);
+				m_blendPoses[0].toMatrices(animationC->transforms);
+			} else {
+				for (unsigned int transformIndex = 0; transformIndex < transformSize; transformIndex++) {
+					interpolate(animationC->transforms[transformIndex], transforms00[transformIndex], transforms01[transformIndex], w);
 				}
 			}
-		} else if (transforms00) {
-			for (unsigned int transformIndex = 0; transformIndex < transformSize; transformIndex++) {
-				animationC->transforms[transformIndex] = transforms00[transformIndex];
 
-				// Rotate the upper body in relation to camera pitch
-				if (transformIndex > 0 && transformIndex < 31) {
-					animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
-				}
+			if (cachePose) {
+				addCachedPose(animationC->currentAnimation, cacheTime, animationC->transforms, transformSize);
 			}
 		}
 
-		animationC->hasUpdated = true;
-
-		if (animationC->leftHandEntity) {
-			glm::mat4 res = animationC->transforms[10] * animationC->leftHandPosition;
+		// Rotate the upper body in relation to camera pitch
+		for (unsigned int transformIndex = 1; transformIndex < std::min(transformSize, 31u); transformIndex++) {
+			animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
+		}
+	} else if (transforms00) {
+		for (unsigned int transformIndex = 0; transformIndex < transformSize; transformIndex++) {
+			animationC->transforms[transformIndex] = transforms00[transformIndex];
 
-			glm::vec3 pos, scale;
-			glm::quat rot;
-			glm::decompose(res, scale, rot, pos, glm::vec3(), glm::vec4());
+			// Rotate the upper body in relation to camera pitch
+			if (transformIndex > 0 && transformIndex < 31) {
+				animationC->transforms[transformIndex] = trans * animationC->transforms[transformIndex];
+			}
+		}
+	}
 
-			//KEEP THIS DO NOT REMOVE FUCK YOU
-			animationC->leftHandEntity->getComponent<TransformComponent>()->setRotations(glm::eulerAngles(rot));
-			animationC->leftHandEntity->getComponent<TransformComponent>()->setTranslation(pos);
+	if (transforms00) {
+		if (fromCache) {
+			m_stats.cachedPoses++;
+		} else {
+			m_stats.poseEvaluations++;
 		}
+	}
 
-		if (animationC->rightHandEntity) {
-			glm::mat4 res = animationC->transforms[22] * animationC->rightHandPosition;
+	animationC->hasUpdated = true;
 
-			glm::vec3 pos, scale;
-			glm::quat rot;
-			glm::decompose(res, scale, rot, pos, glm::vec3(), glm::vec4());
+	if (animationC->leftHandEntity) {
+		glm::mat4 res = animationC->transforms[10] * animationC->leftHandPosition;
 
-			animationC->rightHandEntity->getComponent<TransformComponent>()->setRotations(glm::eulerAngles(rot));
-			animationC->rightHandEntity->getComponent<TransformComponent>()->setTranslation(pos);
-		}
+		glm::vec3 pos, scale;
+		glm::quat rot;
+		glm::decompose(res, scale, rot, pos, glm::vec3(), glm::vec4());
 
-		if (animationC->is_camFollowingHead) {
-			glm::mat4 res = animationC->transforms[5] * animationC->headPositionMatrix;
+		//KEEP THIS DO NOT REMOVE FUCK YOU
+		animationC->leftHandEntity->getComponent<TransformComponent>()->setRotations(glm::eulerAngles(rot));
+		animationC->leftHandEntity->getComponent<TransformComponent>()->setTranslation(pos);
+	}
 
-			glm::vec3 pos, scale;
-			glm::quat rot;
-			glm::decompose(res, scale, rot, pos, glm::vec3(), glm::vec4());
+	if (animationC->rightHandEntity) {
+		glm::mat4 res = animationC->transforms[22] * animationC->rightHandPosition;
 
-			animationC->headPositionLocalCurrent = pos;
-		}
+		glm::vec3 pos, scale;
+		glm::quat rot;
+		glm::decompose(res, scale, rot, pos, glm::vec3(), glm::vec4());
+
+		animationC->rightHandEntity->getComponent<TransformComponent>()->setRotations(glm::eulerAngles(rot));
+		animationC->rightHandEntity->getComponent<TransformComponent>()->setTranslation(pos);
+	}
+
+	if (animationC->is_camFollowingHead) {
+		glm::mat4 res = animationC->transforms[5] * animationC->headPositionMatrix;
+
+		glm::vec3 pos, scale;
+		glm::quat rot;
+		glm::decompose(res, scale, rot, pos, glm::vec3(), glm::vec4());
+
+		animationC->headPositionLocalCurrent = pos;
 	}
 }
 
@@ -347,6 +445,12 @@ void AnimationSystem<T>::updateMeshGPU(ID3D12GraphicsCommandList4* cmdList) {
 
 template <typename T>
 void AnimationSystem<T>::updateMeshCPU() { 
+	constexpr unsigned int NR_OF_JOBS = 16;
+	constexpr unsigned int MIN_VERTICES_PER_JOB = 2048;
+
+	// Bones of every mesh are set up first, they are shared by all jobs skinning that mesh
+	unsigned int numMeshes = 0;
+	unsigned int numVertices = 0;
 	for (auto& e : entities) {
 		AnimationComponent* animationC = e->getComponent<AnimationComponent>();
 		ModelComponent* modelC = e->getComponent<ModelComponent>();
@@ -355,49 +459,87 @@ void AnimationSystem<T>::updateMeshCPU() {
 			continue;
 		}
 
-
 		Mesh* mesh = modelC->getModel()->getMesh(0);
 		const Mesh::Data* data = &mesh->getMeshData();
-		if (data->numVertices > 0) {
-			if (animationC->data.numVertices != data->numVertices) {
-				animationC->data.deepCopy(*data);
-			}
-			const Mesh::vec3* pos = data->positions;
-			const Mesh::vec3* norm = data->normals;
-			const Mesh::vec3* tangent = data->tangents;
-			const Mesh::vec3* bitangent = data->bitangents;
-			const Mesh::vec2* uv = data->texCoords;
-
-			AnimationStack::VertConnection* connections = animationC->getAnimationStack()->getConnections();
-			const unsigned int connectionSize = animationC->getAnimationStack()->getConnectionSize();
-
-			// CPU UPDATE
-			if (connections && animationC->transforms) {
-				glm::mat4 mat;
-				glm::mat4 matInv;
-
-				for (unsigned int connectionIndex = 0; connectionIndex < connectionSize; connectionIndex++) {
-					unsigned int count = connections[connectionIndex].count;
-					mat = glm::zero<glm::mat4>();
-					matInv = glm::zero<glm::mat4>();
-
-					float weightTotal = 0.0f;
-					for (unsigned int countIndex = 0; countIndex < count; countIndex++) {
-						mat += animationC->transforms[connections[connectionIndex].transform[countIndex]] * connections[connectionIndex].weight[countIndex];
-						weightTotal += connections[connectionIndex].weight[countIndex];
-					}
-					matInv = glm::inverseTranspose(mat);
+		if (data->numVertices == 0) {
+			continue;
+		}
+		if (animationC->data.numVertices != data->numVertices) {
+			animationC->data.deepCopy(*data);
+		}
 
-					animationC->data.positions[connectionIndex].vec = glm::vec3(mat * glm::vec4(pos[connectionIndex].vec, 1));
-					animationC->data.normals[connectionIndex].vec = glm::vec3(matInv * glm::vec4(norm[connectionIndex].vec, 0));
-					animationC->data.tangents[connectionIndex].vec = glm::vec3(matInv * glm::vec4(tangent[connectionIndex].vec, 0));
-					animationC->data.bitangents[connectionIndex].vec = glm::vec3(matInv * glm::vec4(bitangent[connectionIndex].vec, 0));
-					animationC->data.texCoords[connectionIndex].vec = uv[connectionIndex].vec;
-				}
-			}
+		AnimationStack* stack = animationC->getAnimationStack();
+		if (!stack->getConnections() || !animationC->transforms) {
+			continue;
+		}
+
+		if (numMeshes == m_skinnedMeshes.size()) {
+			m_skinnedMeshes.emplace_back();
 		}
+		SkinnedMesh& skinned = m_skinnedMeshes[numMeshes++];
+		skinned.skinning.setBones(animationC->transforms, animationC->transformSize);
+		skinned.connections = stack->getConnections();
+		skinned.tPose = data;
+		skinned.out = &animationC->data;
+		skinned.numVertices = std::min(stack->getConnectionSize(), data->numVertices);
+		numVertices += skinned.numVertices;
+	}
+
+	if (numVertices == 0) {
+		return;
+	}
+
+	// The vertices of all meshes are split evenly, the last part is skinned on this thread
+	const unsigned int numJobs = std::max(1u, std::min(NR_OF_JOBS, numVertices / MIN_VERTICES_PER_JOB));
+	const unsigned int verticesPerJob = (numVertices + numJobs - 1) / numJobs;
+	std::future<bool> jobs[NR_OF_JOBS];
+
+	for (unsigned int i = 0; i < numJobs - 1; i++) {
+		const unsigned int first = i * verticesPerJob;
+		jobs[i] = Application::getInstance()->pushJobToThreadPool([this, numMeshes, first, verticesPerJob](int id) {
+			skinVertices(numMeshes, first, first + verticesPerJob);
+			return true;
+		});
 	}
+	skinVertices(numMeshes, (numJobs - 1) * verticesPerJob, numVertices);
 
+	for (unsigned int i = 0; i < numJobs - 1; i++) { jobs[i].get(); }
+}
+
+template <typename T>
+void AnimationSystem<T>::skinVertices(const unsigned int numMeshes, const unsigned int first, const unsigned int last) const {
+	// first and last count the vertices of all meshes after each other
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < numMeshes && offset < last; i++) {
+		const SkinnedMesh& skinned = m_skinnedMeshes[i];
+		const unsigned int start = std::max(first, offset) - offset;
+		const unsigned int end = std::min(last, offset + skinned.numVertices) - offset;
+		if (start < end) {
+			skinned.skinning.skin(skinned.connections, *skinned.tPose, *skinned.out, start, end);
+		}
+		offset += skinned.numVertices;
+	}
+}
+
+template <typename T>
+const typename AnimationSystem<T>::CachedPose* AnimationSystem<T>::findCachedPose(const Animation* animation, const unsigned int time) const {
+	for (unsigned int i = 0; i < m_numCachedPoses; i++) {
+		if (m_cachedPoses[i].animation == animation && m_cachedPoses[i].time == time) {
+			return &m_cachedPoses[i];
+		}
+	}
+	return nullptr;
+}
+
+template <typename T>
+void AnimationSystem<T>::addCachedPose(const Animation* animation, const unsigned int time, const glm::mat4* transforms, const unsigned int transformSize) {
+	if (m_numCachedPoses == m_cachedPoses.size()) {
+		m_cachedPoses.emplace_back();
+	}
+	CachedPose& cached = m_cachedPoses[m_numCachedPoses++];
+	cached.animation = animation;
+	cached.time = time;
+	cached.transforms.assign(transforms, transforms + transformSize);
 }
 
 template <typename T>
@@ -439,6 +581,14 @@ unsigned int AnimationSystem<T>::getByteSize() const {
 	unsigned int size = BaseComponentSystem::getByteSize() + sizeof(*this);
 	size += sizeof(ComputeShaderDispatcher);
 	size += sizeof(InputLayout);
+	for (const SkinnedMesh& skinned : m_skinnedMeshes) {
+		size += skinned.skinning.getByteSize() - sizeof(CpuSkinning);
+	}
+	size += sizeof(SkinnedMesh) * static_cast<unsigned int>(m_skinnedMeshes.capacity());
+	for (const CachedPose& cached : m_cachedPoses) {
+		size += sizeof(glm::mat4) * static_cast<unsigned int>(cached.transforms.capacity());
+	}
+	size += sizeof(CachedPose) * static_cast<unsigned int>(m_cachedPoses.capacity());
 	return size;
 }
 #endif
@@ -498,6 +648,37 @@ void AnimationSystem<T>::setInterpolation(const bool interpolation) {
 	m_interpolate = interpolation;
 }
 
+template <typename T>
+void AnimationSystem<T>::setDecomposedPoses(const bool decomposed) {
+	m_decomposedPoses = decomposed;
+}
+
+template <typename T>
+const bool AnimationSystem<T>::getDecomposedPoses() {
+	return m_decomposedPoses;
+}
+
+template <typename T>
+void AnimationSystem<T>::setPoseCache(const bool cache) {
+	m_poseCache = cache;
+}
+
+template <typename T>
+const bool AnimationSystem<T>::getPoseCache() {
+	return m_poseCache;
+}
+
+template <typename T>
+void AnimationSystem<T>::setLOD(bool activated, Camera* camera) {
+	m_doLOD = activated;
+	m_lodCamera = camera;
+}
+
+template <typename T>
+const typename AnimationSystem<T>::Stats& AnimationSystem<T>::getStats() const {
+	return m_stats;
+}
+
 
 template class AnimationSystem<RenderInActiveGameComponent>;
 template class AnimationSystem<RenderInReplayComponent>;
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include "..//BaseComponentSystem.h"
 #include <d3d12.h>
 #include "Sail/api/ComputeShaderDispatcher.h"
+#include "Sail/graphics/geometry/Animation.h"
+#include "Sail/graphics/geometry/CpuSkinning.h"
+class Camera;
 class Model;
 class ModelComponent;
 class AnimationComponent;
@@ -19,9 +22,28 @@ public:
 	void toggleInterpolation();
 	const bool getInterpolation();
 	void setInterpolation(const bool interpolation);
+	// Blend the decomposed poses of the frames instead of decomposing the frame matrices every update
+	void setDecomposedPoses(const bool decomposed);
+	const bool getDecomposedPoses();
+	// Entities playing the same animation at the same time share one evaluated pose every update
+	void setPoseCache(const bool cache);
+	const bool getPoseCache();
+	// Entities far from the camera are updated less often and without cross-fades or interpolation
+	void setLOD(bool activated, Camera* camera);
+
+	struct Stats {
+		unsigned int poseEvaluations = 0;
+		unsigned int cachedPoses = 0;	// Poses copied from an entity playing the same animation at the same time
+		unsigned int skippedUpdates = 0;	// Entities not updated because of their LOD
+	};
+	// Counted since the start of the last updateTransforms(dt)
+	const Stats& getStats() const;
 
 	void updateTransforms(const float dt);
+	// Updates a single component, also used by the animation benchmark on components without an entity
+	void updateTransforms(AnimationComponent* animationC, const float dt, const unsigned int lod = 0);
 	void updateMeshGPU(ID3D12GraphicsCommandList4* cmdList);
+	// Skins the meshes of the entities without compute updates, the vertices of all of them are split over the thread pool
 	void updateMeshCPU();
 
 	const std::vector<Entity*>& getEntities() const;
@@ -37,7 +59,39 @@ private:
 	std::unique_ptr<InputLayout> m_inputLayout;
 	Shader* m_updateShader;
 	bool m_interpolate;
+	bool m_decomposedPoses;
+	// Intermediate poses of a blend, reused to avoid allocations
+	AnimationPose m_blendPoses[3];
+
+	bool m_poseCache;
+	bool m_doLOD;
+	Camera* m_lodCamera;
+	unsigned int m_lodFrame;
+	Stats m_stats;
+
+	// Poses evaluated during the current update, before the pitch of the entity is applied
+	// Only a handful of animations are played at once so they are searched linearly
+	struct CachedPose {
+		const Animation* animation;
+		unsigned int time;	// In POSE_CACHE_STEPs
+		std::vector<glm::mat4> transforms;
+	};
+	std::vector<CachedPose> m_cachedPoses;
+	unsigned int m_numCachedPoses;
+
+	// Meshes skinned by updateMeshCPU(), reused to avoid allocations
+	struct SkinnedMesh {
+		CpuSkinning skinning;
+		const AnimationStack::VertConnection* connections;
+		const Mesh::Data* tPose;
+		Mesh::Data* out;
+		unsigned int numVertices;
+	};
+	std::vector<SkinnedMesh> m_skinnedMeshes;
 	
+	void skinVertices(const unsigned int numMeshes, const unsigned int first, const unsigned int last) const;
+	const CachedPose* findCachedPose(const Animation* animation, const unsigned int time) const;
+	void addCachedPose(const Animation* animation, const unsigned int time, const glm::mat4* transforms, const unsigned int transformSize);
 	void addTime(AnimationComponent* e, const float time);
 	void interpolate(glm::mat4& res, const glm::mat4& mat1, const glm::mat4& mat2, const float w);
 };
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "pch.h"
+#include "SystemScheduler.h"
+#include "BaseComponentSystem.h"
+#include "Sail/Application.h"
+#include "Sail/utils/Utils.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace {
+	float msSince(const std::chrono::high_resolution_clock::time_point& start, const std::chrono::high_resolution_clock::time_point& now) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(now - start).count() / 1000.f;
+	}
+}
+
+SystemScheduler::SystemScheduler()
+	: m_serial(false)
+	, m_lastRunMs(0.f)
+	, m_lastSerialMs(0.f)
+{}
+
+SystemScheduler::~SystemScheduler() {}
+
+void SystemScheduler::addSystem(BaseComponentSystem* system, const std::string& name, unsigned int resourceReads, unsigned int resourceWrites) {
+	if (!system || findNode(system) >= 0) {
+		SAIL_LOG_WARNING("Tried to add " + name + " to the system scheduler more than once");
+		return;
+	}
+
+	Node node;
+	node.system = system;
+	node.resourceReads = resourceReads;
+	node.resourceWrites = resourceWrites;
+	m_nodes.push_back(node);
+
+	Timing timing;
+	timing.name = name;
+	m_timings.push_back(timing);
+}
+
+void SystemScheduler::addDependency(BaseComponentSystem* before, BaseComponentSystem* after) {
+	const int beforeIndex = findNode(before);
+	const int afterIndex = findNode(after);
+	if (beforeIndex < 0 || afterIndex < 0 || beforeIndex == afterIndex) {
+		SAIL_LOG_WARNING("Invalid system dependency, both systems have to be added to the scheduler first");
+		return;
+	}
+	m_explicitDependencies.emplace_back(beforeIndex, afterIndex);
+}
+
+void SystemScheduler::setActive(BaseComponentSystem* system, bool active) {
+	const int index = findNode(system);
+	if (index >= 0) {
+		m_nodes[index].active = active;
+	}
+}
+
+void SystemScheduler::run(float dt) {
+	m_runStart = std::chrono::high_resolution_clock::now();
+	for (auto& timing : m_timings) {
+		timing.ran = false;
+	}
+
+	if (m_serial) {
+		runSerial(dt);
+	} else if (!buildGraph()) {
+		SAIL_LOG_ERROR("System dependencies contain a cycle, running systems serially");
+		runSerial(dt);
+	} else {
+		runParallel(dt);
+	}
+
+	m_lastRunMs = msSince(m_runStart, std::chrono::high_resolution_clock::now());
+	m_lastSerialMs = 0.f;
+	for (auto& timing : m_timings) {
+		if (timing.ran) {
+			m_lastSerialMs += timing.lastMs;
+		}
+	}
+}
+
+void SystemScheduler::setSerial(bool serial) {
+	m_serial = serial;
+}
+
+bool SystemScheduler::isSerial() const {
+	return m_serial;
+}
+
+void SystemScheduler::clear() {
+	m_nodes.clear();
+	m_timings.clear();
+	m_explicitDependencies.clear();
+}
+
+const std::vector<SystemScheduler::Timing>& SystemScheduler::getTimings() const {
+	return m_timings;
+}
+
+float SystemScheduler::getLastRunMs() const {
+	return m_lastRunMs;
+}
+
+float SystemScheduler::getLastSerialMs() const {
+	return m_lastSerialMs;
+}
+
+std::string SystemScheduler::getTimingsString() const {
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << (m_serial ? "Serial" : "Parallel") << " run: " << m_lastRunMs << " ms (" << m_lastSerialMs << " ms spent in systems)\n";
+	for (auto& timing : m_timings) {
+		if (!timing.ran) {
+			ss << "  " << timing.name << ": inactive\n";
+			continue;
+		}
+		ss << "  " << timing.name << ": " << timing.lastMs << " ms (avg " << timing.averageMs << " ms), started at " << timing.startMs << " ms\n";
+	}
+	return ss.str();
+}
+
+int SystemScheduler::findNode(BaseComponentSystem* system) const {
+	for (size_t i = 0; i < m_nodes.size(); i++) {
+		if (m_nodes[i].system == system) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+bool SystemScheduler::conflicts(const Node& a, const Node& b) const {
+	const auto& aReads = a.system->getReadBitMask();
+	const auto& aWrites = a.system->getWriteBitMask();
+	const auto& bReads = b.system->getReadBitMask();
+	const auto& bWrites = b.system->getWriteBitMask();
+
+	if ((aWrites & (bReads | bWrites)).any() || (bWrites & aReads).any()) {
+		return true;
+	}
+	return (a.resourceWrites & (b.resourceReads | b.resourceWrites)) || (b.resourceWrites & a.resourceReads);
+}
+
+bool SystemScheduler::hasExplicitDependency(size_t before, size_t after) const {
+	for (auto& dependency : m_explicitDependencies) {
+		if (dependency.first == before && dependency.second == after) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SystemScheduler::buildGraph() {
+	for (auto& node : m_nodes) {
+		node.successors.clear();
+		node.numPredecessors = 0;
+	}
+
+	// Conflicting systems keep the order they were added in
+	for (size_t i = 0; i < m_nodes.size(); i++) {
+		if (!m_nodes[i].active) {
+			continue;
+		}
+		for (size_t j = i + 1; j < m_nodes.size(); j++) {
+			if (m_nodes[j].active && (conflicts(m_nodes[i], m_nodes[j]) || hasExplicitDependency(i, j))) {
+				m_nodes[i].successors.push_back(j);
+				m_nodes[j].numPredecessors++;
+			}
+		}
+	}
+
+	// Explicit dependencies are the only edges which can point to an earlier system
+	for (auto& dependency : m_explicitDependencies) {
+		if (dependency.first > dependency.second && m_nodes[dependency.first].active && m_nodes[dependency.second].active) {
+			m_nodes[dependency.first].successors.push_back(dependency.second);
+			m_nodes[dependency.second].numPredecessors++;
+		}
+	}
+
+	// Make sure that the graph can be completed
+	std::vector<unsigned int> predecessors(m_nodes.size());
+	std::vector<size_t> ready;
+	size_t numActive = 0;
+	for (size_t i = 0; i < m_nodes.size(); i++) {
+		predecessors[i] = m_nodes[i].numPredecessors;
+		if (m_nodes[i].active) {
+			numActive++;
+			if (predecessors[i] == 0) {
+				ready.push_back(i);
+			}
+		}
+	}
+	size_t numVisited = 0;
+	while (!ready.empty()) {
+		const size_t index = ready.back();
+		ready.pop_back();
+		numVisited++;
+		for (size_t successor : m_nodes[index].successors) {
+			if (--predecessors[successor] == 0) {
+				ready.push_back(successor);
+			}
+		}
+	}
+
+	return numVisited == numActive;
+}
+
+void SystemScheduler::runSerial(float dt) {
+	for (size_t i = 0; i < m_nodes.size(); i++) {
+		if (m_nodes[i].active) {
+			runNode(i, dt);
+		}
+	}
+}
+
+void SystemScheduler::runParallel(float dt) {
+	std::vector<unsigned int> predecessors(m_nodes.size());
+	std::vector<size_t> ready;
+	size_t numRemaining = 0;
+	for (size_t i = 0; i < m_nodes.size(); i++) {
+		predecessors[i] = m_nodes[i].numPredecessors;
+		if (m_nodes[i].active) {
+			numRemaining++;
+			if (predecessors[i] == 0) {
+				ready.push_back(i);
+			}
+		}
+	}
+
+	auto onFinished = [&](size_t index) {
+		numRemaining--;
+		for (size_t successor : m_nodes[index].successors) {
+			if (--predecessors[successor] == 0) {
+				ready.push_back(successor);
+			}
+		}
+	};
+
+	std::vector<size_t> finished;
+	while (numRemaining > 0) {
+		if (!ready.empty()) {
+			// Run one of the ready systems on this thread instead of idling while the pool works
+			// The rest are started in the order they were added to keep the start order stable
+			std::sort(ready.begin(), ready.end());
+			const size_t inlineIndex = ready.front();
+			for (size_t i = 1; i < ready.size(); i++) {
+				const size_t index = ready[i];
+				Application::getInstance()->pushJobToThreadPool([this, index, dt](int id) {
+					runNode(index, dt);
+					std::lock_guard<std::mutex> lock(m_finishedMutex);
+					m_finished.push_back(index);
+					m_finishedCondition.notify_one();
+				});
+			}
+			ready.clear();
+
+			runNode(inlineIndex, dt);
+			onFinished(inlineIndex);
+			continue;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_finishedMutex);
+			m_finishedCondition.wait(lock, [this] { return !m_finished.empty(); });
+			finished.swap(m_finished);
+		}
+		for (size_t index : finished) {
+			onFinished(index);
+		}
+		finished.clear();
+	}
+}
+
+void SystemScheduler::runNode(size_t index, float dt) {
+	const auto start = std::chrono::high_resolution_clock::now();
+	m_nodes[index].system->update(dt);
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	// Each timing is only touched by the thread running its system
+	Timing& timing = m_timings[index];
+	timing.lastMs = msSince(start, end);
+	timing.startMs = msSince(m_runStart, start);
+	timing.averageMs = timing.averageMs * 0.9f + timing.lastMs * 0.1f;
+	timing.ran = true;
+}
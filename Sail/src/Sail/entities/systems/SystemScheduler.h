@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../components/Component.h"
+
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BaseComponentSystem;
+
+/*
+	Runs a set of systems each tick, concurrently where it is safe to do so.
+
+	Systems are added in the order they would run in serially. Every tick a dependency graph is built where
+	a system has to wait for every earlier system that it conflicts with, two systems conflict if one of them
+	writes to a component type or resource that the other one reads from or writes to.
+	Component usage is taken from the read/write masks set up with BaseComponentSystem::registerComponent().
+	Resources cover state outside of the components which systems share, e.g. the queue of entities to destroy.
+
+	Explicit constraints can be added with addDependency() for orderings the masks can't express.
+	Systems without any path between them in the graph are run on the thread pool at the same time.
+
+	Serial mode runs the systems one after another in the order they were added, on the calling thread.
+	Since only non-conflicting systems are reordered in parallel mode, both modes should give the same results.
+
+	Systems run through the scheduler need to override update(float dt) in BaseComponentSystem.
+*/
+class SystemScheduler final {
+public:
+	enum Resource : unsigned int {
+		RESOURCE_NONE = 0,
+		RESOURCE_ENTITY_LIFETIME = 1 << 0,  // ECS::createEntity(), Entity::queueDestruction()
+		RESOURCE_NETWORK_EVENTS = 1 << 1,   // NWrapperSingleton::queueGameStateNetworkSenderEvent()
+		RESOURCE_GAME_EVENTS = 1 << 2,      // EventDispatcher::emit(), subscribers run on the emitting thread
+		RESOURCE_RENDERER = 1 << 3,         // Submissions to the render wrapper and the graphics API
+		RESOURCE_COLLISION_WORLD = 1 << 4,  // Octree queries and the bounding boxes they read
+	};
+
+	struct Timing {
+		std::string name;
+		float lastMs = 0.f;    // Time spent in update() the last tick
+		float averageMs = 0.f; // Exponential moving average of lastMs
+		float startMs = 0.f;   // When update() started the last tick, relative to the start of run()
+		bool ran = false;      // If the system was active the last tick
+	};
+
+public:
+	SystemScheduler();
+	~SystemScheduler();
+
+	/*
+		Adds a system to the schedule, after all previously added systems
+		resourceReads and resourceWrites are combinations of the Resource flags
+	*/
+	void addSystem(BaseComponentSystem* system, const std::string& name, unsigned int resourceReads = RESOURCE_NONE, unsigned int resourceWrites = RESOURCE_NONE);
+
+	/*
+		Forces 'after' to wait for 'before' to finish, regardless of their masks
+		Both systems have to have been added
+	*/
+	void addDependency(BaseComponentSystem* before, BaseComponentSystem* after);
+
+	/*
+		Inactive systems are left out of the graph until they are activated again
+		Note that explicit dependencies through an inactive system are not kept
+	*/
+	void setActive(BaseComponentSystem* system, bool active);
+
+	/*
+		Runs update(dt) on all active systems and returns once all of them are done
+	*/
+	void run(float dt);
+
+	void setSerial(bool serial);
+	bool isSerial() const;
+
+	void clear();
+
+	const std::vector<Timing>& getTimings() const;
+	// Total time spent in run() the last tick
+	float getLastRunMs() const;
+	// Sum of the systems' times the last tick, which is what run() would take serially
+	float getLastSerialMs() const;
+	std::string getTimingsString() const;
+
+private:
+	struct Node {
+		BaseComponentSystem* system = nullptr;
+		unsigned int resourceReads = RESOURCE_NONE;
+		unsigned int resourceWrites = RESOURCE_NONE;
+		bool active = true;
+
+		// Rebuilt every tick
+		std::vector<size_t> successors;
+		unsigned int numPredecessors = 0;
+	};
+
+	int findNode(BaseComponentSystem* system) const;
+	bool conflicts(const Node& a, const Node& b) const;
+	bool hasExplicitDependency(size_t before, size_t after) const;
+	// Returns false if the explicit dependencies form a cycle
+	bool buildGraph();
+
+	void runSerial(float dt);
+	void runParallel(float dt);
+	void runNode(size_t index, float dt);
+
+private:
+	std::vector<Node> m_nodes;
+	std::vector<Timing> m_timings;
+	std::vector<std::pair<size_t, size_t>> m_explicitDependencies;
+
+	bool m_serial;
+	float m_lastRunMs;
+	float m_lastSerialMs;
+	std::chrono::high_resolution_clock::time_point m_runStart;
+
+	// Finished systems reported back from the thread pool
+	std::mutex m_finishedMutex;
+	std::condition_variable m_finishedCondition;
+	std::vector<size_t> m_finished;
+};
@@ -9,8 +9,7 @@
 
 #include "Network/NWrapperSingleton.h"
 
-#include "cereal/archives/portable_binary.hpp"
-#include "gzip/compress.hpp"
+#include "Sail/netcode/PacketCompressor.h"
 
 
 HostSendToSpectatorSystem::HostSendToSpectatorSystem() {
@@ -30,8 +29,8 @@ void HostSendToSpectatorSystem::init(Netcode::PlayerID playerID) {
 
 // The messages this function creates must match the format of messages created by and received by NetworkSenderSystem and NetworkReceiverSystem
 void HostSendToSpectatorSystem::sendEntityCreationPackage(Netcode::PlayerID PlayerId) const {
-	std::ostringstream dataString(std::ios::binary);
-	Netcode::OutArchive ar(dataString);
+	std::vector<char> dataBuffer;
+	Netcode::OutArchive ar(dataBuffer);
 
 	// -+-+-+-+-+-+-+-+ Per-frame sends to per-frame receives via components -+-+-+-+-+-+-+-+ 
 	// Send our playerID so that we can ignore this packet when it gets back to us from the host
@@ -100,9 +99,8 @@ void HostSendToSpectatorSystem::sendEntityCreationPackage(Netcode::PlayerID Play
 
 
 	// -+-+-+-+-+-+-+-+ send the serialized archive over the network -+-+-+-+-+-+-+-+ 
-	std::string uncompressed = dataString.str();
-	const char* uncompressedPtr = uncompressed.data();
-	std::string compressed = gzip::compress(uncompressedPtr, uncompressed.size());
+	std::string compressed;
+	Netcode::PacketCompressor().compress(ar.data(), ar.size(), compressed);
 
 	NWrapperSingleton::getInstance().getNetworkWrapper()->sendSerializedDataToClient(compressed, PlayerId);
 }
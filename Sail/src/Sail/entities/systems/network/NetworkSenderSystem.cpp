@@ -8,20 +8,22 @@
 #include "Sail/entities/components/OnlineOwnerComponent.h"
 #include "Sail/entities/components/LocalOwnerComponent.h"
 #include "Sail/entities/components/SanityComponent.h"
+#include "Sail/entities/components/PlayerComponent.h"
+#include "Sail/entities/components/NetworkReceiverComponent.h"
+#include "Sail/entities/systems/Gameplay/LevelSystem/LevelSystem.h"
+#include "Sail/entities/ECS.h"
 #include "Sail/entities/Entity.h"
 
 #include "Network/NWrapperSingleton.h"
-#include "Sail/../../libraries/cereal/archives/portable_binary.hpp"
 
 #include "../src/Network/NWrapperSingleton.h"
 #include "Sail/utils/GameDataTracker.h"
 
+#include <chrono>
 #include <string>
 #include <vector>
 
 
-#include "Sail/../../libraries/gzip/compress.hpp"
-
 //#define _LOG_TO_FILE
 #if defined(DEVELOPMENT) && defined(_LOG_TO_FILE)
 #include <fstream>
@@ -34,6 +36,21 @@ NetworkSenderSystem::NetworkSenderSystem() : BaseComponentSystem() {
 	registerComponent<TransformComponent>(false, true, false);
 }
 
+namespace {
+	// Messages that are sent every tick and replaced by the next one, losing one of them only matters until the next arrives
+	bool IsPerTickState(Netcode::MessageType messageType) {
+		switch (messageType) {
+		case Netcode::MessageType::ANIMATION:
+		case Netcode::MessageType::CHANGE_ABSOLUTE_POS_AND_ROT:
+		case Netcode::MessageType::CHANGE_LOCAL_POSITION:
+		case Netcode::MessageType::CHANGE_LOCAL_ROTATION:
+			return true;
+		default:
+			return false;
+		}
+	}
+}
+
 NetworkSenderSystem::~NetworkSenderSystem() {
 	while (!m_eventQueue.empty()) {
 		NetworkSenderEvent* pEvent = m_eventQueue.front();
@@ -83,16 +100,20 @@ void NetworkSenderSystem::init(Netcode::PlayerID playerID, NetworkReceiverSystem
 	| ...                                            |
 	--------------------------------------------------
 
+  Every tick is split into packets with this structure. Per-tick state (transforms and animations) is sent over
+  the unreliable channel with nrOfEvents always 0, in as many packets as it takes for each to fit in one datagram.
+  Everything else is sent reliably in one packet. An entity with both kinds of messages is written to both.
 */
 void NetworkSenderSystem::update() {
 	// Binary data that will be sent over the network
-	std::ostringstream osToOthers(std::ios::binary);
-	Netcode::OutArchive sendToOthers(osToOthers);
+	Netcode::OutArchive sendToOthers(m_toOthersBuffer);
+	// The state entities are split into packets once they have all been written
+	Netcode::OutArchive stateEntities(m_stateEntitiesBuffer);
+	m_stateEntityEnds.clear();
 
 	// Binary data that will be sent to our own receiver system so that the network event handling
 	// code doesn't need to be duplicated.
-	std::ostringstream osToSelf(std::ios::binary);
-	Netcode::OutArchive sendToSelf(osToSelf);
+	Netcode::OutArchive sendToSelf(m_toSelfBuffer);
 
 	// -+-+-+-+-+-+-+-+ Per-frame sends to per-frame receives via components -+-+-+-+-+-+-+-+ 
 	// Send our playerID so that we can ignore this packet when it gets back to us from the host
@@ -100,16 +121,18 @@ void NetworkSenderSystem::update() {
 	sendToSelf(Netcode::MESSAGE_FROM_SELF_ID);
 
 
-	// See how many SenderComponents have information to send
-	size_t nonEmptySenderComponents = 0;
+	// Every client generates the same map so positions are quantized within the same bounds everywhere
+	m_snapshotEncoder.setBounds(Netcode::TransformSnapshot::Bounds::FromLevel());
+
+	// See how many SenderComponents have information to send reliably
+	size_t reliableSenderComponents = 0;
 	for (auto e : entities) {
-		if (!e->getComponent<NetworkSenderComponent>()->m_dataTypes.empty()) {
-			nonEmptySenderComponents++;
-		}
+		const std::vector<Netcode::MessageType>& dataTypes = e->getComponent<NetworkSenderComponent>()->m_dataTypes;
+		reliableSenderComponents += std::any_of(dataTypes.begin(), dataTypes.end(), [](Netcode::MessageType messageType) { return !IsPerTickState(messageType); });
 	}
 
 	// Write nrOfEntities
-	sendToOthers(nonEmptySenderComponents);
+	sendToOthers(reliableSenderComponents);
 	sendToSelf(size_t{ 0 }); // SenderComponent messages should not be sent to ourself
 
 	for (auto e : entities) {
@@ -122,19 +145,32 @@ void NetworkSenderSystem::update() {
 
 		// Create a copy of the message types that are currently in the sender component so that we can make changes to 
 		// the sender component without corrupting the packet that we're writing right now.
-		const std::vector<Netcode::MessageType> messages = nsc->m_dataTypes;
-
-		sendToOthers(nsc->m_id);         // ComponentID    
-		sendToOthers(nsc->m_entityType); // Entity type
-		sendToOthers(messages.size());   // NrOfMessages
+		// The transform messages are merged into a single TRANSFORM_SNAPSHOT in their place.
+		std::vector<Netcode::MessageType>& messages = m_messages;
+		std::vector<Netcode::MessageType>& stateMessages = m_stateMessages;
+		messages.clear();
+		stateMessages.clear();
+		std::uint8_t transformFields = 0;
+		for (const Netcode::MessageType messageType : nsc->m_dataTypes) {
+			std::uint8_t field = 0;
+			switch (messageType) {
+			case Netcode::MessageType::CHANGE_ABSOLUTE_POS_AND_ROT: field = Netcode::TransformSnapshot::POSITION | Netcode::TransformSnapshot::QUAT_ROTATION; break;
+			case Netcode::MessageType::CHANGE_LOCAL_POSITION:       field = Netcode::TransformSnapshot::POSITION; break;
+			case Netcode::MessageType::CHANGE_LOCAL_ROTATION:       field = Netcode::TransformSnapshot::EULER_ROTATION; break;
+			default: (IsPerTickState(messageType) ? stateMessages : messages).push_back(messageType); continue;
+			}
+			if (!transformFields) {
+				stateMessages.push_back(Netcode::MessageType::TRANSFORM_SNAPSHOT);
+			}
+			transformFields |= field;
+		}
 
-		// Per type of data
-		for (auto& messageType : messages) {
-			sendToOthers(messageType);          // Current MessageType
-#if defined(DEVELOPMENT) && defined(_LOG_TO_FILE)
-			out << "SenderComp: " << Netcode::MessageNames[(int)(messageType) - 1] << "\n";
-#endif
-			writeMessageToArchive(messageType, e, sendToOthers); // Add to archive depending on the message
+		if (!messages.empty()) {
+			writeEntityToArchive(messages, transformFields, e, sendToOthers);
+		}
+		if (!stateMessages.empty()) {
+			writeEntityToArchive(stateMessages, transformFields, e, stateEntities);
+			m_stateEntityEnds.push_back(stateEntities.size());
 		}
 	}
 
@@ -159,48 +195,183 @@ void NetworkSenderSystem::update() {
 	m_nrOfEventsToSendToSelf = 0;
 
 
+	if (sendToOthers.hasOverflowed() || stateEntities.hasOverflowed() || sendToSelf.hasOverflowed()) {
+		SAIL_LOG_ERROR("Network packet is larger than the maximum packet size, it will be cut off");
+	}
+
 	// -+-+-+-+-+-+-+-+ compress and send the serialized archive over the network -+-+-+-+-+-+-+-+ 
-	std::string uncompOthers    = osToOthers.str();
-	const char* uncompOthersPtr = uncompOthers.data();
-	std::string compOthers      = gzip::compress(uncompOthersPtr, uncompOthers.size());
+	std::string& compOthers = m_compressedToOthers;
+	m_compressor.compress(sendToOthers.data(), sendToOthers.size(), compOthers);
+	const size_t numStatePackets = compressStatePackets(stateEntities.data());
 
 	if (NWrapperSingleton::getInstance().isHost()) {
 		//Host's message is included here
+		std::scoped_lock lock(m_forwardBufferLock);
 		m_HOSTONLY_dataToForward.push(compOthers);
+		for (size_t i = 0; i < numStatePackets; i++) {
+			m_HOSTONLY_unreliableToForward.push(m_compressedStates[i]);
+		}
 		MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
 		if (mrs) {
 			if (mrs->status == 1) {
-				mrs->recordPackages(m_HOSTONLY_dataToForward);
+				mrs->recordPackages(m_HOSTONLY_dataToForward, m_HOSTONLY_unreliableToForward);
 			}
 		}
 
 		// Host doesn't get their messages sent back to them so we need to send them to the killCamReceiverSystem from here
 		m_killCamSystem->handleIncomingData(compOthers);
+		for (size_t i = 0; i < numStatePackets; i++) {
+			m_killCamSystem->handleIncomingData(m_compressedStates[i]);
+		}
 	} else {
 		NWrapperSingleton::getInstance().getNetworkWrapper()->sendSerializedDataToHost(compOthers);
+		for (size_t i = 0; i < numStatePackets; i++) {
+			NWrapperSingleton::getInstance().getNetworkWrapper()->sendUnreliableSerializedDataToHost(m_compressedStates[i]);
+		}
 	}
 
 
 	// -+-+-+-+-+-+-+-+ compress and send Events directly to our own ReceiverSystem -+-+-+-+-+-+-+-+ 
-	std::string uncompSelf    = osToSelf.str();
-	const char* uncompSelfPtr = uncompSelf.data();
-	std::string compSelf      = gzip::compress(uncompSelfPtr, uncompSelf.size());
+	m_compressor.compress(sendToSelf.data(), sendToSelf.size(), m_compressedToSelf);
 
-	m_receiverSystem->pushDataToBuffer(compSelf);
+	m_receiverSystem->pushDataToBuffer(m_compressedToSelf);
 
 	// -+-+-+-+-+-+-+-+ Host forwards all messages to all clients -+-+-+-+-+-+-+-+ 
 	std::scoped_lock lock(m_forwardBufferLock);
-	// The host forwards all the incoming messages they have to all the clients
+	// The host forwards all the incoming messages they have to all the clients, a replay's host forwards the replayed ones
+	MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
+	const bool forward = NWrapperSingleton::getInstance().isHost() || (mrs && mrs->status == 2);
 	while (!m_HOSTONLY_dataToForward.empty()) {
 		std::string& dataFromClient = m_HOSTONLY_dataToForward.front();
 
 		// This if statement shouldn't be needed since m_dataToForwardToClients will be empty unless you're the host
-		MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
-		if (NWrapperSingleton::getInstance().isHost() || (mrs && mrs->status == 2)) {
+		if (forward) {
 			NWrapperSingleton::getInstance().getNetworkWrapper()->sendSerializedDataAllClients(dataFromClient);
 		}
 		m_HOSTONLY_dataToForward.pop();
 	}
+	if (forward) {
+		forwardUnreliableData();
+	}
+	m_HOSTONLY_unreliableToForward = std::queue<std::string>();
+}
+
+size_t NetworkSenderSystem::compressStatePackets(const char* stateEntities) {
+	// The endianness byte, senderID, nrOfEntities and nrOfEvents
+	static constexpr size_t HEADER_SIZE = sizeof(std::uint8_t) + sizeof(Netcode::PlayerID) + 2 * sizeof(size_t);
+	// NWrapper adds the message letter, and packets that don't compress get the codec byte on top of their size
+	static constexpr size_t MAX_PACKET_SIZE = Network::MAX_UNRELIABLE_MESSAGE_SIZE - 2;
+
+	size_t numPackets = 0;
+	size_t first = 0;
+	size_t begin = sizeof(std::uint8_t); // The entities start after the endianness byte
+	while (first < m_stateEntityEnds.size()) {
+		// An entity that doesn't fit on its own gets a packet of its own, which the Network sends reliably instead
+		size_t last = first + 1;
+		while (last < m_stateEntityEnds.size() && HEADER_SIZE + m_stateEntityEnds[last] - begin <= MAX_PACKET_SIZE) {
+			last++;
+		}
+		const size_t end = m_stateEntityEnds[last - 1];
+
+		Netcode::OutArchive ar(m_stateToOthersBuffer);
+		ar(m_playerID);
+		ar(last - first);
+		ar.writeRaw(stateEntities + begin, end - begin);
+		ar(size_t{ 0 }); // Events have to arrive so they are never sent unreliably
+
+		if (m_compressedStates.size() == numPackets) {
+			m_compressedStates.emplace_back();
+		}
+		m_compressor.compress(ar.data(), ar.size(), m_compressedStates[numPackets++]);
+
+		first = last;
+		begin = end;
+	}
+	return numPackets;
+}
+
+void NetworkSenderSystem::forwardUnreliableData() {
+	if (m_HOSTONLY_unreliableToForward.empty()) {
+		return;
+	}
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	NWrapper* wrapper = NWrapperSingleton::getInstance().getNetworkWrapper();
+	const size_t numClients = NWrapperSingleton::getInstance().getPlayers().size() - 1;
+	if (m_interestManagement) {
+		updateInterestFilter();
+	}
+
+	while (!m_HOSTONLY_unreliableToForward.empty()) {
+		const std::string& packet = m_HOSTONLY_unreliableToForward.front();
+
+		// Packets that can't be split are sent to everyone, as they are without interest management
+		if (m_interestManagement &&
+			m_compressor.decompress(packet.data(), packet.size(), m_forwardDecompressed) &&
+			m_interestFilter.filter(m_forwardDecompressed.data(), m_forwardDecompressed.size(), m_filteredPackets)) {
+			for (size_t i = 0; i < m_filteredPackets.size(); i++) {
+				if (m_filteredPackets[i].empty()) {
+					continue;
+				}
+				m_compressor.compress(m_filteredPackets[i].data(), m_filteredPackets[i].size(), m_compressedFiltered);
+				wrapper->sendUnreliableSerializedDataToClient(m_compressedFiltered, m_interestFilter.getViewer(i));
+				m_forwardStats.bytesSent += m_compressedFiltered.size();
+			}
+		} else {
+			wrapper->sendUnreliableSerializedDataAllClients(packet);
+			m_forwardStats.bytesSent += packet.size() * numClients;
+		}
+		m_HOSTONLY_unreliableToForward.pop();
+	}
+
+	m_forwardStats.ticks++;
+	m_forwardStats.milliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Places every player and host owned entity, and adds every client as a viewer
+void NetworkSenderSystem::updateInterestFilter() {
+	m_interestFilter.clear();
+
+	NWrapperSingleton& nw = NWrapperSingleton::getInstance();
+	LevelSystem* level = ECS::Instance()->getSystem<LevelSystem>();
+	auto place = [&](Entity* e, Netcode::ComponentID id) {
+		TransformComponent* transform = e->getComponent<TransformComponent>();
+		if (!transform) {
+			return;
+		}
+		const glm::vec3& position = transform->getTranslation();
+		const int room = (level && level->tileArr) ? level->getRoomIDFromWorldPos(position.x, position.z) : -1;
+		const Netcode::PlayerID owner = Netcode::getComponentOwner(id);
+
+		if (e->hasComponent<PlayerComponent>()) {
+			const Player* player = nw.getPlayer(owner);
+			m_interestFilter.setPlayer(owner, position, room, player ? player->team : -1);
+		} else if (owner >= Netcode::NONE_PLAYER_ID_START) {
+			m_interestFilter.setEntity(id, position, room);
+		}
+	};
+
+	// Everything owned by the host, then everything the host has received from the clients
+	for (Entity* e : entities) {
+		place(e, e->getComponent<NetworkSenderComponent>()->m_id);
+	}
+	for (Entity* e : m_receiverSystem->getEntities()) {
+		if (NetworkReceiverComponent* nrc = e->getComponent<NetworkReceiverComponent>()) {
+			place(e, nrc->m_id);
+		}
+	}
+
+	for (const Player& player : nw.getPlayers()) {
+		if (player.id != m_playerID) {
+			m_interestFilter.addViewer(player.id, player.team);
+		}
+	}
+}
+
+void NetworkSenderSystem::removeEntity(Entity* entity) {
+	// The last sent values would otherwise pile up for every entity that was ever sent during the match
+	m_snapshotEncoder.erase(entity->getComponent<NetworkSenderComponent>()->m_id);
+	BaseComponentSystem::removeEntity(entity);
 }
 
 void NetworkSenderSystem::queueEvent(NetworkSenderEvent* event) {
@@ -230,8 +401,43 @@ void NetworkSenderSystem::pushDataToBuffer(const std::string& data) {
 	m_HOSTONLY_dataToForward.push(data);
 }
 
-void NetworkSenderSystem::setDataBuffer(const std::queue<std::string>& data) {
+// ONLY DO FOR THE HOST
+// Same as pushDataToBuffer() but the data is forwarded over the unreliable channel
+void NetworkSenderSystem::pushUnreliableDataToBuffer(const std::string& data) {
+	std::lock_guard<std::mutex> lock(m_forwardBufferLock);
+	m_HOSTONLY_unreliableToForward.push(data);
+}
+
+void NetworkSenderSystem::setInterestManagement(bool enabled) {
+	m_interestManagement = enabled;
+	resetForwardStats();
+}
+
+bool NetworkSenderSystem::isInterestManagementEnabled() const {
+	return m_interestManagement;
+}
+
+Netcode::InterestFilter& NetworkSenderSystem::getInterestFilter() {
+	return m_interestFilter;
+}
+
+const NetworkSenderSystem::ForwardStats& NetworkSenderSystem::getForwardStats() const {
+	return m_forwardStats;
+}
+
+void NetworkSenderSystem::resetForwardStats() {
+	m_forwardStats = ForwardStats();
+	m_interestFilter.resetStats();
+}
+
+const Netcode::SnapshotEncoder::Stats& NetworkSenderSystem::getSnapshotStats() const {
+	return m_snapshotEncoder.getStats();
+}
+
+void NetworkSenderSystem::setDataBuffer(const std::queue<std::string>& data, const std::queue<std::string>& unreliableData) {
+	std::lock_guard<std::mutex> lock(m_forwardBufferLock);
 	m_HOSTONLY_dataToForward = data;
+	m_HOSTONLY_unreliableToForward = unreliableData;
 }
 
 #ifdef DEVELOPMENT
@@ -243,6 +449,22 @@ unsigned int NetworkSenderSystem::getByteSize() const {
 	if (queueSize) {
 		size += queueSize * m_HOSTONLY_dataToForward.front().capacity() * sizeof(unsigned char);		// Approximate string length
 	}
+	const size_t unreliableQueueSize = m_HOSTONLY_unreliableToForward.size();
+	size += unreliableQueueSize * sizeof(std::string);
+	if (unreliableQueueSize) {
+		size += unreliableQueueSize * m_HOSTONLY_unreliableToForward.front().capacity() * sizeof(unsigned char);		// Approximate string length
+	}
+	size += m_toOthersBuffer.capacity() + m_stateEntitiesBuffer.capacity() + m_stateToOthersBuffer.capacity() + m_toSelfBuffer.capacity();
+	size += m_compressedToOthers.capacity() + m_compressedToSelf.capacity() + m_stateEntityEnds.capacity() * sizeof(size_t);
+	for (const std::string& packet : m_compressedStates) {
+		size += sizeof(std::string) + packet.capacity();
+	}
+	size += (m_messages.capacity() + m_stateMessages.capacity()) * sizeof(Netcode::MessageType) + m_snapshotEncoder.getByteSize() - sizeof(m_snapshotEncoder);
+	size += m_interestFilter.getByteSize() - sizeof(m_interestFilter);
+	size += m_forwardDecompressed.capacity() + m_compressedFiltered.capacity() + m_filteredPackets.capacity() * sizeof(std::vector<char>);
+	for (const std::vector<char>& packet : m_filteredPackets) {
+		size += packet.capacity();
+	}
 	return size;
 }
 #endif
@@ -250,8 +472,7 @@ unsigned int NetworkSenderSystem::getByteSize() const {
 // TODO: Test this to see if it's actually needed or not
 void NetworkSenderSystem::stop() {
 	// Loop through networked entities and serialize their data.
-	std::ostringstream osToOthers(std::ios::binary);
-	Netcode::OutArchive sendToOthers(osToOthers);
+	Netcode::OutArchive sendToOthers(m_toOthersBuffer);
 
 	sendToOthers(m_playerID);
 	sendToOthers(size_t{0}); // Write nrOfEntities
@@ -272,14 +493,38 @@ void NetworkSenderSystem::stop() {
 
 
 	if (ended) {
-		// send the serialized archive over the network
-		std::string binaryData = osToOthers.str();
+		// compress and send the serialized archive over the network, receivers expect every packet to be compressed
+		std::string& binaryData = m_compressedToOthers;
+		m_compressor.compress(sendToOthers.data(), sendToOthers.size(), binaryData);
 		if (NWrapperSingleton::getInstance().isHost()) {
 			NWrapperSingleton::getInstance().getNetworkWrapper()->sendSerializedDataAllClients(binaryData);
 		} else {
 			NWrapperSingleton::getInstance().getNetworkWrapper()->sendSerializedDataToHost(binaryData);
 		}
 	}
+
+	m_snapshotEncoder.reset();
+}
+
+void NetworkSenderSystem::writeEntityToArchive(const std::vector<Netcode::MessageType>& messages, std::uint8_t transformFields, Entity* e, Netcode::OutArchive& ar) {
+	NetworkSenderComponent* nsc = e->getComponent<NetworkSenderComponent>();
+
+	ar(nsc->m_id);         // ComponentID    
+	ar(nsc->m_entityType); // Entity type
+	ar(messages.size());   // NrOfMessages
+
+	// Per type of data
+	for (auto& messageType : messages) {
+		ar(messageType);          // Current MessageType
+#if defined(DEVELOPMENT) && defined(_LOG_TO_FILE)
+		out << "SenderComp: " << Netcode::MessageNames[(int)(messageType) - 1] << "\n";
+#endif
+		if (messageType == Netcode::MessageType::TRANSFORM_SNAPSHOT) {
+			writeTransformSnapshot(transformFields, e, ar);
+		} else {
+			writeMessageToArchive(messageType, e, ar); // Add to archive depending on the message
+		}
+	}
 }
 
 void NetworkSenderSystem::writeMessageToArchive(const Netcode::MessageType& messageType, Entity* e, Netcode::OutArchive& ar) {
@@ -296,34 +541,7 @@ void NetworkSenderSystem::writeMessageToArchive(const Netcode::MessageType& mess
 		ar(e->getComponent<AnimationComponent>()->pitch);
 	}
 	break; 
-	case Netcode::MessageType::CHANGE_ABSOLUTE_POS_AND_ROT:
-	{
-		glm::vec3 scale;
-		glm::quat rotation;
-		glm::vec3 translation;
-		glm::vec3 skew;
-		glm::vec4 perspective;
-
-		TransformComponent* t = e->getComponent<TransformComponent>();
-
-		glm::decompose(t->getMatrixWithUpdate(), scale, rotation, translation, skew, perspective);
-
-		ArchiveHelpers::saveVec3(ar, translation);
-		ArchiveHelpers::saveQuat(ar, rotation);
-	}
-	break;
-	case Netcode::MessageType::CHANGE_LOCAL_POSITION:
-	{
-		TransformComponent* t = e->getComponent<TransformComponent>();
-		ArchiveHelpers::saveVec3(ar, t->getTranslation());
-	}
-	break;
-	case Netcode::MessageType::CHANGE_LOCAL_ROTATION:
-	{
-		TransformComponent* t = e->getComponent<TransformComponent>();
-		ArchiveHelpers::saveVec3(ar, t->getRotations());
-	}
-	break;
+	// CHANGE_ABSOLUTE_POS_AND_ROT, CHANGE_LOCAL_POSITION and CHANGE_LOCAL_ROTATION are sent by writeTransformSnapshot()
 	case Netcode::MessageType::DESTROY_ENTITY:
 	{
 		e->getComponent<NetworkSenderComponent>()->removeAllMessageTypes();
@@ -382,6 +600,24 @@ void NetworkSenderSystem::writeMessageToArchive(const Netcode::MessageType& mess
 	}
 }
 
+void NetworkSenderSystem::writeTransformSnapshot(std::uint8_t fields, Entity* e, Netcode::OutArchive& ar) {
+	TransformComponent* t = e->getComponent<TransformComponent>();
+	Netcode::TransformSnapshot::Transform transform;
+
+	if (fields & Netcode::TransformSnapshot::QUAT_ROTATION) {
+		// The world matrix without any scale, entities are never skewed so there's no need to run a full glm::decompose
+		const glm::mat4& matrix = t->getMatrixWithUpdate();
+		const glm::mat3 rotation(glm::normalize(glm::vec3(matrix[0])), glm::normalize(glm::vec3(matrix[1])), glm::normalize(glm::vec3(matrix[2])));
+		transform.position = glm::vec3(matrix[3]);
+		transform.rotation = glm::quat_cast(rotation);
+	} else {
+		transform.position = t->getTranslation();
+	}
+	transform.euler = t->getRotations();
+
+	m_snapshotEncoder.write(e->getComponent<NetworkSenderComponent>()->m_id, fields, transform, ar);
+}
+
 void NetworkSenderSystem::writeEventToArchive(NetworkSenderEvent* event, Netcode::OutArchive& ar) {
 	ar(event->type); // Send the event-type
 
@@ -527,14 +763,8 @@ void NetworkSenderSystem::writeEventToArchive(NetworkSenderEvent* event, Netcode
 	case Netcode::MessageType::SUBMIT_WATER_POINTS:
 	{
 		Netcode::MessageSubmitWaterPoints* data = static_cast<Netcode::MessageSubmitWaterPoints*>(event->data);
-		
-		size_t nrOfPoints = data->points.size();
-
-		ar(nrOfPoints); // Tell the receiver how many points they should receive
 
-		for (size_t i = 0; i < nrOfPoints; i++) {
-			ArchiveHelpers::saveVec3(ar, data->points[i]); // Send all points to the receiver
-		}
+		data->cells.write(ar);
 	}
 	break;
 	case Netcode::MessageType::SPAWN_PROJECTILE:
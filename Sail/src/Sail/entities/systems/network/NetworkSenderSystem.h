@@ -1,11 +1,13 @@
 #pragma once
 
 #include "../BaseComponentSystem.h"
-#include "Sail/../../libraries/cereal/archives/portable_binary.hpp"
 #include "Sail/netcode/NetworkedStructs.h"
 
 #include "Sail/netcode/ArchiveTypes.h"
 #include "Sail/netcode/NetcodeTypes.h"
+#include "Sail/netcode/InterestFilter.h"
+#include "Sail/netcode/PacketCompressor.h"
+#include "Sail/netcode/TransformSnapshot.h"
 
 
 
@@ -23,12 +25,31 @@ public:
 
 	void update();
 	virtual void stop() override;
+	void removeEntity(Entity* entity) override;
 
 	void init(Netcode::PlayerID playerID, NetworkReceiverSystem* receiverSystem, KillCamReceiverSystem* killCamSystem);
 	
 	void queueEvent(NetworkSenderEvent* event);
 	void pushDataToBuffer(const std::string& data);
-	void setDataBuffer(const std::queue<std::string>& data);
+	void pushUnreliableDataToBuffer(const std::string& data);
+	// The packets of a replay tick, forwarded to the spectators over the same channels as they were sent in the match
+	void setDataBuffer(const std::queue<std::string>& data, const std::queue<std::string>& unreliableData);
+
+	// Host only, split the forwarded per-tick state per client by what is relevant to them instead of sending everything to everyone
+	void setInterestManagement(bool enabled);
+	bool isInterestManagementEnabled() const;
+	Netcode::InterestFilter& getInterestFilter();
+
+	// Host cost of forwarding the per-tick state, to compare interest management with forwarding everything
+	struct ForwardStats {
+		unsigned int ticks = 0;
+		float milliseconds = 0.f;
+		size_t bytesSent = 0;
+	};
+	const ForwardStats& getForwardStats() const;
+	void resetForwardStats();
+	// Size of the transforms this player has sent during the match
+	const Netcode::SnapshotEncoder::Stats& getSnapshotStats() const;
 
 #ifdef DEVELOPMENT
 	unsigned int getByteSize() const override;
@@ -38,8 +59,14 @@ public:
 #endif
 
 private:
+	void writeEntityToArchive(const std::vector<Netcode::MessageType>& messages, std::uint8_t transformFields, Entity* e, Netcode::OutArchive& ar);
 	void writeMessageToArchive(const Netcode::MessageType& messageType, Entity* e, Netcode::OutArchive& ar);
+	void writeTransformSnapshot(std::uint8_t fields, Entity* e, Netcode::OutArchive& ar);
+	// Splits the per-tick state entities into packets that fit in one datagram each, returns how many of m_compressedStates were written
+	size_t compressStatePackets(const char* stateEntities);
 	void writeEventToArchive(NetworkSenderEvent* event, Netcode::OutArchive& ar);
+	void forwardUnreliableData();
+	void updateInterestFilter();
 	
 private:
 	Netcode::PlayerID m_playerID;
@@ -62,7 +89,33 @@ private:
 	 *                         `-> Client3(NRS)
 	 **/
 	std::queue<std::string> m_HOSTONLY_dataToForward;
+	// Per-tick state, forwarded over the unreliable channel
+	std::queue<std::string> m_HOSTONLY_unreliableToForward;
 	std::mutex m_forwardBufferLock;
 
 	std::mutex m_queueMutex;
+
+	// Reused every tick so that serializing and compressing packets doesn't allocate once they have grown to the largest packet size
+	std::vector<char> m_toOthersBuffer;
+	std::vector<char> m_stateEntitiesBuffer;
+	std::vector<size_t> m_stateEntityEnds;
+	std::vector<char> m_stateToOthersBuffer;
+	std::vector<char> m_toSelfBuffer;
+	std::string m_compressedToOthers;
+	std::vector<std::string> m_compressedStates;
+	std::string m_compressedToSelf;
+	Netcode::PacketCompressor m_compressor;
+	std::vector<Netcode::MessageType> m_messages;
+	std::vector<Netcode::MessageType> m_stateMessages;
+
+	// Last transforms that were sent for every entity, only the fields that changed lately are sent
+	Netcode::SnapshotEncoder m_snapshotEncoder;
+
+	// Off unless turned on with the console, entities that aren't relevant to a client only move on their keyframes for it
+	bool m_interestManagement = false;
+	Netcode::InterestFilter m_interestFilter;
+	std::vector<char> m_forwardDecompressed;
+	std::vector<std::vector<char>> m_filteredPackets;
+	std::string m_compressedFiltered;
+	ForwardStats m_forwardStats;
 };
@@ -33,7 +33,10 @@ static std::ofstream out("LogFiles/KillCamReceiverSystem.cpp.log");
 
 
 // TODO: register more components
-KillCamReceiverSystem::KillCamReceiverSystem() : ReceiverBase() {
+KillCamReceiverSystem::KillCamReceiverSystem()
+	: ReceiverBase()
+	, m_replayData(REPLAY_BUFFER_BYTES, REPLAY_BUFFER_PACKETS, REPLAY_BUFFER_TICKS, REPLAY_BUFFER_SIZE, REPLAY_BUFFER_MAX_BYTES, REPLAY_BUFFER_MAX_PACKETS)
+{
 	registerComponent<ReplayReceiverComponent>(true, false, false);
 
 	EventDispatcher::Instance().subscribe(Event::Type::TOGGLE_SLOW_MOTION, this);
@@ -77,8 +80,8 @@ void KillCamReceiverSystem::stop() {
 	for (std::vector<Netcode::ComponentID>& data : m_notHoldingTorches) {
 		data.clear();
 	}
+	m_myKillCamData.reset();
 	m_replayData.clear();
-	m_myKillCamData.clear();
 
 	m_hasInitialized     = false;
 	m_isPlaying         = false;
@@ -115,8 +118,8 @@ void KillCamReceiverSystem::initEntities() {
 bool KillCamReceiverSystem::startKillCam() {
 	const Netcode::PlayerID killerID = Netcode::getComponentOwner(m_killingProjectileID);
 
-	// Copy the past few seconds to data that we'll read from for our own killcam
-	m_myKillCamData = m_replayData;
+	// Hold on to the past few seconds so that we can read them for our own killcam, nothing is copied
+	m_myKillCamData = m_replayData.snapshot();
 
 
 	for (auto e : entities) {
@@ -129,7 +132,7 @@ bool KillCamReceiverSystem::startKillCam() {
 			}
 
 			// Put torches where they were at that point in time
-			for (Netcode::ComponentID& notHolding : m_notHoldingTorches[m_myKillCamData.readIndex]) {
+			for (Netcode::ComponentID& notHolding : m_notHoldingTorches[m_myKillCamData.getFirstTick() % REPLAY_BUFFER_SIZE]) {
 				if (compID == notHolding) {
 					setCandleState(compID, false);
 				}
@@ -180,7 +183,7 @@ void KillCamReceiverSystem::init(Netcode::PlayerID player, Camera* cam) {
 }
 
 void KillCamReceiverSystem::handleIncomingData(const std::string& data) {
-	m_replayData.savePacket(data);
+	m_replayData.push(data.data(), data.size());
 }
 
 
@@ -191,11 +194,10 @@ void KillCamReceiverSystem::prepareUpdate() {
 	}
 }
 
-// Increments the indexes in the ring buffer once per tick and clears the next write-index
+// Starts the next tick in the ring buffer
 void KillCamReceiverSystem::update(float dt) {
-	m_replayData.prepareWrite();
-	m_replayData.prepareRead();
-	m_notHoldingTorches[m_replayData.writeIndex].clear();
+	m_replayData.beginTick();
+	m_notHoldingTorches[m_replayData.getTick() % REPLAY_BUFFER_SIZE].clear();
 }
 
 void KillCamReceiverSystem::updatePerFrame(float dt, float alpha) {
@@ -244,12 +246,13 @@ void KillCamReceiverSystem::updatePerFrame(float dt, float alpha) {
 
 // Should only be called when the killcam is active
 void KillCamReceiverSystem::processReplayData(float dt) {
-	m_myKillCamData.prepareRead();
-	processData(dt, m_myKillCamData.getTickData(), false);
+	if (m_myKillCamData.nextTick()) {
+		processData(dt, m_myKillCamData, false);
+	}
 
 	// If we've reached the end of the killcam we should end it
-	if (m_myKillCamData.readIndex == m_myKillCamData.writeIndex) {
-		m_myKillCamData.clear();
+	if (m_myKillCamData.isFinished()) {
+		m_myKillCamData.reset();
 		m_isPlaying = false;
 
 		EventDispatcher::Instance().emit(StopKillCamEvent(m_isFinalKillCam));
@@ -258,16 +261,11 @@ void KillCamReceiverSystem::processReplayData(float dt) {
 
 
 #ifdef DEVELOPMENT
-// NOTE: does not track the size of m_myKillCamData but that will only be used when the killcam is being played
+// m_myKillCamData is read from the same buffer so it doesn't use any memory of its own
 unsigned int KillCamReceiverSystem::getByteSize() const {
 	unsigned int size = BaseComponentSystem::getByteSize() + sizeof(*this);
+	size += static_cast<unsigned int>(m_replayData.getByteSize() - sizeof(m_replayData));
 	for (int i = 0; i < REPLAY_BUFFER_SIZE; i++) {
-		const auto& queue = m_replayData.netcodeData[i];
-		const size_t queueSize = queue.size();
-		size += queueSize * sizeof(std::string);								// string structure size
-		if (queueSize) {
-			size += queueSize * queue.front().capacity() * sizeof(unsigned char);	// approximate string character length
-		}
 		size += (m_notHoldingTorches[i].size() * sizeof(unsigned int));
 	}
 	return size;
@@ -296,7 +294,7 @@ bool KillCamReceiverSystem::onEvent(const Event& event) {
 	};
 
 	auto onTorchNotHeld = [&](const TorchNotHeldEvent& e) {
-		m_notHoldingTorches[m_replayData.writeIndex].push_back(e.netCompID);
+		m_notHoldingTorches[m_replayData.getTick() % REPLAY_BUFFER_SIZE].push_back(e.netCompID);
 	};
 
 	switch (event.type) {
@@ -506,7 +504,7 @@ void KillCamReceiverSystem::updateProjectile(const Netcode::ComponentID id, cons
 
 // If I requested the projectile it has a local owner
 void KillCamReceiverSystem::spawnProjectile(const ProjectileInfo& info) {
-	auto e = ECS::Instance()->createEntity("projectile");
+	auto e = EntityFactory::CreateReplayProjectileEntity();
 	instantAddEntity(e.get());
 
 	EntityFactory::ProjectileArguments args{};
@@ -527,7 +525,7 @@ void KillCamReceiverSystem::spawnProjectile(const ProjectileInfo& info) {
 }
 
 // Killcam doesn't accurately show the water on the map and just shows what it looks like in the active game
-void KillCamReceiverSystem::submitWaterPoint(const glm::vec3& point) {}
+void KillCamReceiverSystem::submitWaterCells(const Netcode::WaterCells& cells) {}
 
 // kill player when water hits it
 void KillCamReceiverSystem::waterHitPlayer(const Netcode::ComponentID id, const Netcode::ComponentID killerID) {}
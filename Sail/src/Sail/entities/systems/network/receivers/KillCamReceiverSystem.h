@@ -22,6 +22,15 @@ public:
 	static constexpr size_t REPLAY_BUFFER_SIZE = TICKRATE * KILLCAM_DURATION;
 	static constexpr size_t SLOW_MO_MULTIPLIER = 20;
 
+	// Memory allocated up front for the saved packets. A killcam keeps its packets while new ones are saved, which is
+	// up to SLOW_MO_MULTIPLIER times the killcam's length if it's all watched in slow motion. The ring grows up to the
+	// MAX sizes if they don't fit and shrinks back once the killcam is over, a killcam that's held longer than that expires.
+	static constexpr size_t REPLAY_BUFFER_BYTES       = 4 * 1024 * 1024;
+	static constexpr size_t REPLAY_BUFFER_TICKS       = REPLAY_BUFFER_SIZE * (1 + SLOW_MO_MULTIPLIER);
+	static constexpr size_t REPLAY_BUFFER_PACKETS     = REPLAY_BUFFER_TICKS * 16;
+	static constexpr size_t REPLAY_BUFFER_MAX_BYTES   = REPLAY_BUFFER_BYTES * 4;
+	static constexpr size_t REPLAY_BUFFER_MAX_PACKETS = REPLAY_BUFFER_PACKETS * 4;
+
 public:
 	KillCamReceiverSystem();
 	virtual ~KillCamReceiverSystem();
@@ -77,7 +86,7 @@ private:
 	void updateSanity    (const Netcode::ComponentID id, const float sanity)                         override;
 	void updateProjectile(const Netcode::ComponentID id, const glm::vec3& pos, const glm::vec3& vel) override;
 	void spawnProjectile (const ProjectileInfo& info)                                                override;
-	void submitWaterPoint(const glm::vec3& point)                                                    override;
+	void submitWaterCells(const Netcode::WaterCells& cells)                                          override;
 	void waterHitPlayer  (const Netcode::ComponentID id, const Netcode::ComponentID killerID)        override;
 	void setCenter(const Netcode::ComponentID compID, const glm::vec3 offset)                        override;
 
@@ -109,44 +118,12 @@ private:
 
 
 private:
-	struct NetcodeDataRingBuffer {
-		std::array<std::queue<std::string>, REPLAY_BUFFER_SIZE> netcodeData;
-		size_t writeIndex = 0;
-		size_t readIndex = 1;
-
-		void clear() {
-			for (std::queue<std::string>& data : netcodeData) { data = std::queue<std::string>(); }
-			writeIndex = 0;
-			readIndex = 1;
-		}
-
-		void prepareWrite() {
-			writeIndex = ++writeIndex % REPLAY_BUFFER_SIZE;
-			netcodeData[writeIndex] = std::queue<std::string>();
-		}
-
-		void prepareRead() { 
-			readIndex  = ++readIndex % REPLAY_BUFFER_SIZE;
-		}
-
-		void savePacket(const std::string& data) {
-			netcodeData[writeIndex].push(data);
-		}
-
-		std::queue<std::string>& getTickData() {
-			return netcodeData[readIndex];
-		}
-	};
-
-
 	// All the messages that have been sent/received over the network in the past few seconds
-	// Will be used like a ring buffer
-	NetcodeDataRingBuffer m_replayData;
+	Netcode::PacketRing m_replayData;
 	std::array<std::vector<Netcode::ComponentID>, REPLAY_BUFFER_SIZE> m_notHoldingTorches;
 
-	// Copies the current state of m_replayData so that we can keep recording to m_replayData and play our killcam at
-	// the same time
-	NetcodeDataRingBuffer m_myKillCamData;	
+	// The past few seconds of m_replayData at the time our killcam started, read while m_replayData keeps recording
+	Netcode::PacketRing::Snapshot m_myKillCamData;
 
 	bool m_hasInitialized = false;
 	bool m_isPlaying      = false;
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "MatchRecordSystem.h"
 #include "Network/NWrapperSingleton.h"
+#include <cstring>
 #include <filesystem>
 static int temp_replay_counter = 0;
 
@@ -28,24 +29,29 @@ void MatchRecordSystem::initRecording() {
 	}
 	status = 1;
 	std::string path = std::string(REPLAY_TEMP_PATH) + "/LastSessionGame#" + std::to_string(temp_replay_counter++) + REPLAY_EXTENSION;
-	recorded = std::ofstream(path, std::ofstream::binary);
 
+	// The players and settings, read back in initReplay()
+	std::string metadata;
 	const std::list<Player>& players = NWrapperSingleton::getInstance().getPlayers();
 	unsigned len;
 	unsigned np = (unsigned)players.size();
-	recorded.write((char*)&np, sizeof(np));
+	metadata.append((char*)&np, sizeof(np));
 	for (auto p : players) {
 		len = (unsigned)p.name.length() + 1;
-		recorded.write((char*)&p.id, 1);
-		recorded.write((char*)&p.team, 1);
-		recorded.write((char*)&len, sizeof(len));
-		recorded.write(p.name.c_str(), len);
+		metadata.append((char*)&p.id, 1);
+		metadata.append((char*)&p.team, 1);
+		metadata.append((char*)&len, sizeof(len));
+		metadata.append(p.name.c_str(), len);
 	}
 
 	std::string settings = Application::getInstance()->getSettings().serialize(Application::getInstance()->getSettings().gameSettingsStatic, Application::getInstance()->getSettings().gameSettingsDynamic);
 	len = (unsigned)settings.length();
-	recorded.write((char*)&len, sizeof(len));
-	recorded.write((char*)&settings[0], len);
+	metadata.append((char*)&len, sizeof(len));
+	metadata.append(settings);
+
+	if (!recorded.open(path, metadata)) {
+		SAIL_LOG_WARNING("Could not record the game to " + path);
+	}
 }
 
 bool MatchRecordSystem::initReplay(std::string replayName) {	
@@ -56,26 +62,51 @@ bool MatchRecordSystem::initReplay(std::string replayName) {
 		replay.close();
 	}
 	status = 2;
-	replay = std::ifstream(replayName, std::ofstream::binary);
+	m_replayTick = 0;
+	m_seekTarget = 0;
+	m_restoreKeyframe = false;
+	m_restartPending = false;
+
+	if (Netcode::IsLegacyReplay(replayName)) {
+		const std::string converted = std::string(REPLAY_TEMP_PATH) + "/Converted#" + std::to_string(temp_replay_counter++) + REPLAY_EXTENSION;
+		if (!Netcode::ConvertLegacyReplay(replayName, converted)) {
+			SAIL_LOG_WARNING("Could not convert old replay: " + replayName);
+			return false;
+		}
+		replayName = converted;
+	}
 
-	if (!replay.is_open()) {
+	if (!replay.open(replayName)) {
 		return false;
 	}
 
-	unsigned np;
-	unsigned strLen;
+	size_t metadataSize = 0;
+	const char* metadata = replay.getMetadata(metadataSize);
+	const char* metadataEnd = metadata + metadataSize;
+	auto read = [&](void* dst, size_t size) {
+		if (size > (size_t)(metadataEnd - metadata)) {
+			return false;
+		}
+		std::memcpy(dst, metadata, size);
+		metadata += size;
+		return true;
+	};
+
+	unsigned np = 0;
+	unsigned strLen = 0;
 	std::string settings;
 
 	NWrapperSingleton::getInstance().resetPlayerList();
 
-	replay.read((char*)&np, sizeof(np));
-	for (int i = 0; i < np; i++) {
+	read(&np, sizeof(np));
+	for (unsigned i = 0; i < np; i++) {
 		Player p;
-		replay.read((char*)&p.id, 1);
-		replay.read((char*)&p.team, 1);
-		replay.read((char*)&strLen, sizeof(strLen));
-		p.name.resize(strLen);
-		replay.read(&p.name[0], strLen);
+		read(&p.id, 1);
+		read(&p.team, 1);
+		strLen = 0;
+		read(&strLen, sizeof(strLen));
+		p.name.resize(std::min<size_t>(strLen, metadataEnd - metadata));
+		read(&p.name[0], p.name.size());
 
 		NWrapperSingleton::getInstance().playerJoined(p);
 		NWrapperSingleton::getInstance().getPlayer(p.id)->lastStateStatus.status = -1; //inform that this is not a real player
@@ -86,9 +117,10 @@ bool MatchRecordSystem::initReplay(std::string replayName) {
 	myPlayer.team = -1;
 	NWrapperSingleton::getInstance().playerJoined(myPlayer);
 
-	replay.read((char*)& strLen, sizeof(strLen));
-	settings.resize(strLen);
-	replay.read(&settings[0], strLen);
+	strLen = 0;
+	read(&strLen, sizeof(strLen));
+	settings.resize(std::min<size_t>(strLen, metadataEnd - metadata));
+	read(&settings[0], settings.size());
 
 	Application::getInstance()->getSettings().deSerialize(settings, Application::getInstance()->getSettings().gameSettingsStatic, Application::getInstance()->getSettings().gameSettingsDynamic);
 	return true;
@@ -102,31 +134,81 @@ bool MatchRecordSystem::endReplay() {
 	return true;
 }
 
-void MatchRecordSystem::recordPackages(std::queue<std::string> data) {
-	unsigned np = data.size();
-	recorded.write((char*)& np, sizeof(np));
+void MatchRecordSystem::recordPackages(std::queue<std::string> reliable, std::queue<std::string> unreliable) {
+	for (std::queue<std::string>* data : { &reliable, &unreliable }) {
+		const bool mightBeState = (data == &unreliable);
+		while (!data->empty()) {
+			recorded.addPacket(data->front().data(), data->front().size(), mightBeState);
+			data->pop();
+		}
+	}
+	recorded.endTick();
+}
 
-	for (size_t i = 0; i < np; i++) {
-		unsigned pl = (unsigned)data.front().length();
-		recorded.write((char*)& pl, sizeof(pl));
-		recorded.write((char*)&data.front()[0], pl);
-		data.pop();
+void MatchRecordSystem::replayPackages(std::queue<std::string>& data, std::queue<std::string>& state) {
+	if (!replay.isOpen() || m_restartPending || m_replayTick >= replay.getNumTicks()) {
+		return;
 	}
+
+	if (m_seekTarget > m_replayTick) {
+		// The keyframe has the whole world at its tick, none of the ticks before it are read
+		size_t keyframeTick = 0;
+		if (m_restoreKeyframe && replay.readKeyframe(m_seekTarget, keyframeTick, m_packets)) {
+			pushPackets(data, state);
+			m_replayTick = keyframeTick + 1;
+		}
+		for (; m_replayTick < m_seekTarget; m_replayTick++) {
+			replay.readTick(m_replayTick, m_packets);
+			pushPackets(data, state);
+		}
+		m_seekTarget = 0;
+		m_restoreKeyframe = false;
+	}
+
+	replay.readTick(m_replayTick++, m_packets);
+	pushPackets(data, state);
 }
 
-void MatchRecordSystem::replayPackages(std::queue<std::string>& data) {
-	unsigned np;
-	replay.read((char*)&np, sizeof(np));
-	for (size_t i = 0; i < np; i++) {
-		if (replay.eof()) {
-			return;
+bool MatchRecordSystem::seek(size_t tick) {
+	if (status != 2 || !replay.isOpen() || replay.getNumTicks() == 0) {
+		return false;
+	}
+	m_seekTarget = std::min(tick, replay.getNumTicks() - 1);
+
+	// Restoring a keyframe on top of the current world would add its water, deaths and power-ups a second time
+	size_t keyframeTick = 0;
+	const bool keyframeAhead = replay.findKeyframe(m_seekTarget, keyframeTick) && keyframeTick >= m_replayTick;
+	if (m_seekTarget < m_replayTick || keyframeAhead) {
+		m_replayTick = 0;
+		m_restoreKeyframe = true;
+		m_restartPending = true;
+	}
+	return true;
+}
+
+bool MatchRecordSystem::isRestartPending() const {
+	return m_restartPending;
+}
+
+void MatchRecordSystem::onMatchRestarted() {
+	m_restartPending = false;
+}
+
+size_t MatchRecordSystem::getReplayTick() const {
+	return m_replayTick;
+}
+
+size_t MatchRecordSystem::getNumReplayTicks() const {
+	return replay.getNumTicks();
+}
+
+void MatchRecordSystem::pushPackets(std::queue<std::string>& data, std::queue<std::string>& state) const {
+	for (const Netcode::ReplayReader::Packet& packet : m_packets) {
+		if (!packet.state) {
+			data.emplace(packet.data, packet.size);
+		} else {
+			state.emplace(packet.data, packet.size);
 		}
-		unsigned pl;
-		std::string package;
-		replay.read((char*)&pl, sizeof(pl));
-		package.resize(pl);
-		replay.read(&package[0], pl);
-		data.push(package);
 	}
 }
 
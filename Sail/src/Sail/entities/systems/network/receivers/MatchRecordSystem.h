@@ -1,7 +1,8 @@
 #pragma once
+#include "Sail/netcode/ReplayFile.h"
 #include <fstream>
 #include <chrono>
-#include <ctime>    
+#include <ctime>
 
 constexpr char REPLAY_PATH[] = "replays";
 constexpr char REPLAY_TEMP_PATH[] = "replays/temp";
@@ -10,20 +11,42 @@ constexpr char REPLAY_EXTENSION[] = ".SPLASH";
 
 class MatchRecordSystem {
 public:
-	MatchRecordSystem(); 
+	MatchRecordSystem();
 	~MatchRecordSystem();
 
 	void initRecording();
+	// Replays in the old format are converted to a temporary file first
 	bool initReplay(std::string replayName);
 	bool endReplay();
 
 	int status = 0;
 
-	void recordPackages(std::queue<std::string> data);
-	void replayPackages(std::queue<std::string>& data);
+	// Both kinds of packets are recorded together. Only unreliable packets are checked for per-tick state, which can
+	// be skipped when seeking and is given back separately so that it can be forwarded unreliably again.
+	void recordPackages(std::queue<std::string> reliable, std::queue<std::string> unreliable);
+	void replayPackages(std::queue<std::string>& data, std::queue<std::string>& state);
+
+	// Makes the next replayPackages() catch up to the tick. Keyframes are restored on a new world, so seeking back or
+	// past a keyframe starts the replay over from the last keyframe at or before the tick: the match has to be
+	// restarted on the host and every spectator first, while isRestartPending() nothing is replayed.
+	bool seek(size_t tick);
+	bool isRestartPending() const;
+	// Called when the match that was waiting for the restart is gone
+	void onMatchRestarted();
+	size_t getReplayTick() const;
+	size_t getNumReplayTicks() const;
 
 	static void CleanOldReplays();
 private:
-	std::ofstream recorded;
-	std::ifstream replay;
-};
\ No newline at end of file
+	void pushPackets(std::queue<std::string>& data, std::queue<std::string>& state) const;
+
+private:
+	Netcode::ReplayWriter recorded;
+	Netcode::ReplayReader replay;
+
+	size_t m_replayTick = 0;
+	size_t m_seekTarget = 0;
+	bool m_restoreKeyframe = false;
+	bool m_restartPending = false;
+	std::vector<Netcode::ReplayReader::Packet> m_packets;
+};
@@ -65,8 +65,13 @@ void NetworkReceiverSystem::update(float dt) {
 			while (!m_incomingDataBuffer.empty()) {
 				m_incomingDataBuffer.pop();
 			}
-			mrs->replayPackages(m_incomingDataBuffer);
-			m_netSendSysPtr->setDataBuffer(m_incomingDataBuffer);
+			mrs->replayPackages(m_incomingDataBuffer, m_replayedStateBuffer);
+			m_netSendSysPtr->setDataBuffer(m_incomingDataBuffer, m_replayedStateBuffer);
+			// Like in the match the state can arrive after the events, whichever channel it came from
+			while (!m_replayedStateBuffer.empty()) {
+				m_incomingDataBuffer.push(std::move(m_replayedStateBuffer.front()));
+				m_replayedStateBuffer.pop();
+			}
 		}
 	}
 	processData(dt, m_incomingDataBuffer);
@@ -248,7 +253,7 @@ void NetworkReceiverSystem::updateProjectile(const Netcode::ComponentID id, cons
 void NetworkReceiverSystem::spawnProjectile(const ProjectileInfo& info) {
 	const bool wasRequestedByMe = (Netcode::getComponentOwner(info.ownerID) == m_playerID);
 
-	auto e = ECS::Instance()->createEntity("projectile");
+	auto e = EntityFactory::CreateProjectileEntity();
 	instantAddEntity(e.get());
 
 	EntityFactory::ProjectileArguments args{};
@@ -270,9 +275,8 @@ void NetworkReceiverSystem::spawnProjectile(const ProjectileInfo& info) {
 	EntityFactory::CreateProjectile(e, args);
 }
 
-void NetworkReceiverSystem::submitWaterPoint(const glm::vec3& point) {
-	// Place water point at intersection position
-	Application::getInstance()->getRenderWrapper()->getCurrentRenderer()->submitWaterPoint(point);
+void NetworkReceiverSystem::submitWaterCells(const Netcode::WaterCells& cells) {
+	Application::getInstance()->getRenderWrapper()->getCurrentRenderer()->submitWaterCells(cells);
 }
 
 
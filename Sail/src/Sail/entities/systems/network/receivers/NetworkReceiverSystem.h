@@ -19,6 +19,8 @@ public:
 
 	void init(Netcode::PlayerID player, NetworkSenderSystem* NSS);
 	void pushDataToBuffer(const std::string& data);
+	// Per-tick state from the unreliable channel, the packets are read the same way as reliable ones
+	virtual void handleIncomingUnreliableData(const std::string& data) { pushDataToBuffer(data); }
 
 	void update(float dt) override;
 
@@ -48,7 +50,7 @@ protected:
 	void updateSanity    (const Netcode::ComponentID id, const float sanity)                         override;
 	void updateProjectile(const Netcode::ComponentID id, const glm::vec3& pos, const glm::vec3& vel) override;
 	void spawnProjectile (const ProjectileInfo& info)                                                override;
-	void submitWaterPoint(const glm::vec3& point)                                                    override;
+	void submitWaterCells(const Netcode::WaterCells& cells)                                          override;
 	void waterHitPlayer  (const Netcode::ComponentID id, const Netcode::ComponentID projectileID)    override;
 	virtual void spawnPowerup(const int type, const glm::vec3& pos, const Netcode::ComponentID compID, const Netcode::ComponentID parentCompID) override;
 	virtual void destroyPowerup(const Netcode::ComponentID compID, const Netcode::ComponentID playerId) override;
@@ -84,5 +86,7 @@ protected:
 
 	// FIFO container of serialized data-strings to decode
 	std::queue<std::string> m_incomingDataBuffer;
+	// The state packets of the replay tick, forwarded unreliably and then decoded after m_incomingDataBuffer
+	std::queue<std::string> m_replayedStateBuffer;
 	std::mutex m_bufferLock;
 };
@@ -27,6 +27,11 @@ void NetworkReceiverSystemHost::handleIncomingData(const std::string& data) {
 	m_netSendSysPtr->pushDataToBuffer(data);
 }
 
+void NetworkReceiverSystemHost::handleIncomingUnreliableData(const std::string& data) {
+	pushDataToBuffer(data);
+	m_netSendSysPtr->pushUnreliableDataToBuffer(data);
+}
+
 void NetworkReceiverSystemHost::stop() {
 	m_startEndGameTimer = false;
 	m_finalKillCamOver = true;
@@ -8,6 +8,7 @@ public:
 	virtual ~NetworkReceiverSystemHost();
 
 	void handleIncomingData(const std::string& data) override;
+	void handleIncomingUnreliableData(const std::string& data) override;
 	virtual void stop() override;
 
 #ifdef DEVELOPMENT
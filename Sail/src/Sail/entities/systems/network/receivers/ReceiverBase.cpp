@@ -14,7 +14,6 @@
 #include "Sail/entities/Entity.h"
 #include "Sail/utils/Utils.h"
 
-#include "Sail/../../libraries/gzip/decompress.hpp"
 
 // DO NOT IMPLEMENT ANY BEHAVIOR, EMIT EVENTS, OR IN ANY WAY CHANGE STATE IN RECEIVERBASE
 // This class is just used to call functions in the classes that inherit from it
@@ -46,6 +45,30 @@ void ReceiverBase::setGameState(GameState* gameState) { m_gameStatePtr = gameSta
 const std::vector<Entity*>& ReceiverBase::getEntities() const { return entities; }
 
 
+void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bool ignoreFromSelf) {
+	// The packets are moved out of the queue and read where they are
+	m_queuedPackets.clear();
+	m_packets.clear();
+	while (!data.empty()) {
+		m_queuedPackets.push_back(std::move(data.front()));
+		data.pop();
+	}
+	for (const std::string& packet : m_queuedPackets) {
+		m_packets.push_back({ packet.data(), packet.size() });
+	}
+	processPackets(dt, ignoreFromSelf);
+}
+
+// Same as above for the packets of the snapshot's current tick, which are read straight from the ring they were saved in
+void ReceiverBase::processData(float dt, const Netcode::PacketRing::Snapshot& tick, const bool ignoreFromSelf) {
+	m_packets.clear();
+	for (size_t i = 0; i < tick.getNumPackets(); i++) {
+		m_packets.push_back(tick.getPacket(i));
+	}
+	processPackets(dt, ignoreFromSelf);
+}
+
+
 /*
   The parsing of messages needs to match how the NetworkSenderSystem constructs them so
   any changes made here needs to be made there as well!
@@ -80,7 +103,7 @@ const std::vector<Entity*>& ReceiverBase::getEntities() const { return entities;
 	| ...                                            |
 	--------------------------------------------------
 */
-void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bool ignoreFromSelf) {
+void ReceiverBase::processPackets(float dt, const bool ignoreFromSelf) {
 	// TODO: Remove a bunch of stuff from here
 	size_t nrOfSenderComponents    = 0;
 	size_t nrOfMessagesInComponent = 0;
@@ -95,21 +118,26 @@ void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bo
 	glm::vec3 vector;
 	glm::quat quaternion;
 	float lowPassFrequency = -1.f;
+	Netcode::SnapshotDecoder::Result snapshot;
 
+	// Has to match the bounds the senders quantized the positions in
+	m_snapshotDecoder.setBounds(Netcode::TransformSnapshot::Bounds::FromLevel());
 
 	// Process all messages in the buffer
-	while (!data.empty()) {
-		const char* compressedPtr = data.front().data();
-		std::string decompressedData = gzip::decompress(compressedPtr, data.front().size());
+	for (const Netcode::PacketRing::Packet& packet : m_packets) {
+		if (!m_decompressor.decompress(packet.data, packet.size, m_decompressedData)) {
+			SAIL_LOG_ERROR("Received a network packet that couldn't be decompressed");
+			continue;
+		}
 
-		std::istringstream is(decompressedData);
-		Netcode::InArchive ar(is);
+		// Reads straight from the decompressed bytes, which are reused for the next packet
+		Netcode::InArchive ar(m_decompressedData.data(), m_decompressedData.size());
 
 		ar(senderID);
 
 		// If the packet was originally sent over the network from ourself 
 		// then don't process it and go to the next packet
-		if (ignoreFromSelf && senderID == m_playerID) { data.pop(); continue; }
+		if (ignoreFromSelf && senderID == m_playerID) { continue; }
 
 		// If the message was sent internally to ourself then correct the senderID
 		MatchRecordSystem* mrs = NWrapperSingleton::getInstance().recordSystem;
@@ -146,6 +174,7 @@ void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bo
 					setAnimation(compID, info);
 				}
 				break;
+				// The NetworkSenderSystem sends these as TRANSFORM_SNAPSHOT, they're still read so that older replays can be watched
 				case Netcode::MessageType::CHANGE_ABSOLUTE_POS_AND_ROT:
 				{
 					ArchiveHelpers::loadVec3(ar, vector);
@@ -195,6 +224,21 @@ void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bo
 					shootEnd(compID, lowPassFrequency);
 				}
 				break;
+				case Netcode::MessageType::TRANSFORM_SNAPSHOT:
+				{
+					m_snapshotDecoder.read(ar, snapshot);
+
+					if (snapshot.hasPosition) {
+						setLocalPosition(compID, snapshot.transform.position);
+					}
+					if (snapshot.hasEuler) {
+						setLocalRotation(compID, snapshot.transform.euler);
+					}
+					if (snapshot.hasQuat) {
+						setLocalRotation(compID, snapshot.transform.rotation);
+					}
+				}
+				break;
 				case Netcode::MessageType::UPDATE_PROJECTILE_ONCE:
 				{
 					glm::vec3 velocity;
@@ -391,13 +435,8 @@ void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bo
 			break;
 			case Netcode::MessageType::SUBMIT_WATER_POINTS:
 			{
-				size_t nrOfPoints = 0;
-
-				ar(nrOfPoints);
-
-				for (size_t nPoint = 0; nPoint < nrOfPoints; nPoint++) {
-					ArchiveHelpers::loadVec3(ar, vector);
-					submitWaterPoint(vector);
+				if (m_waterCells.read(ar)) {
+					submitWaterCells(m_waterCells);
 				}
 			}
 			break;
@@ -478,7 +517,9 @@ void ReceiverBase::processData(float dt, std::queue<std::string>& data, const bo
 			}
 		}
 
-		data.pop();
+		if (ar.hasFailed()) {
+			SAIL_LOG_ERROR("Received a network packet that was shorter than its content");
+		}
 	}
 
 	// End game timer 
@@ -3,6 +3,9 @@
 
 #include "../../BaseComponentSystem.h"
 #include "Sail/netcode/NetworkedStructs.h"
+#include "Sail/netcode/PacketCompressor.h"
+#include "Sail/netcode/PacketRing.h"
+#include "Sail/netcode/TransformSnapshot.h"
 
 #include "glm/gtc/quaternion.hpp"
 
@@ -21,6 +24,7 @@ public: // Functions
 	const std::vector<Entity*>& getEntities() const;
 
 	void processData(float dt, std::queue<std::string>& data, const bool ignoreFromSelf = true);
+	void processData(float dt, const Netcode::PacketRing::Snapshot& tick, const bool ignoreFromSelf = true);
 
 	virtual void update(float dt) = 0;
 	virtual void handleIncomingData(const std::string& data) = 0;
@@ -78,6 +82,8 @@ protected:
 
 protected: // Functions
 	void initBase(Netcode::PlayerID playerID);
+	// Reads the packets in m_packets
+	void processPackets(float dt, const bool ignoreFromSelf);
 
 	virtual void destroyEntity   (const Netcode::ComponentID entityID)                                       = 0;
 	virtual void enableSprinklers()                                                                          = 0;
@@ -97,7 +103,7 @@ protected: // Functions
 	virtual void updateProjectile(const Netcode::ComponentID id, const glm::vec3& pos, const glm::vec3& vel) = 0;
 	virtual void updateSanity    (const Netcode::ComponentID id, const float sanity)                         = 0;
 	virtual void spawnProjectile (const ProjectileInfo& info)                                                = 0;
-	virtual void submitWaterPoint(const glm::vec3& point)                                                    = 0;
+	virtual void submitWaterCells(const Netcode::WaterCells& cells)                                          = 0;
 	virtual void waterHitPlayer  (const Netcode::ComponentID id, const Netcode::ComponentID projectileID)    = 0;
 	virtual void spawnPowerup(const int type, const glm::vec3& pos, const Netcode::ComponentID compID, const Netcode::ComponentID parentCompID) {};
 	virtual void destroyPowerup(const Netcode::ComponentID compID, const Netcode::ComponentID playerId) {};
@@ -137,4 +143,16 @@ protected:
 	Entity* m_playerEntity;
 
 	GameState* m_gameStatePtr;
+
+	// Reads TRANSFORM_SNAPSHOT messages, which only contain the fields that changed lately
+	Netcode::SnapshotDecoder m_snapshotDecoder;
+
+private:
+	// Reused for every packet so that reading them doesn't allocate
+	Netcode::PacketCompressor m_decompressor;
+	std::vector<char> m_decompressedData;
+	// The packets processData() is reading, and the ones it took from a queue
+	std::vector<Netcode::PacketRing::Packet> m_packets;
+	std::vector<std::string> m_queuedPackets;
+	Netcode::WaterCells m_waterCells;
 };
@@ -8,6 +8,7 @@
 #include "..//..//components/RenderInActiveGameComponent.h"
 #include "..//..//components/RenderInReplayComponent.h"
 #include "..//..//Physics/Intersection.h"
+#include "..//..//ECS.h"
 
 #include "Sail/Application.h"
 
@@ -20,6 +21,8 @@ CollisionSystem<T>::CollisionSystem() {
 	registerComponent<RagdollComponent>(false, true, false);
 	registerComponent<T>(true, false, false);
 
+	iteratesArchetypes = true;
+
 	m_octree = nullptr;
 }
 
@@ -33,64 +36,66 @@ void CollisionSystem<T>::provideOctree(Octree* octree) {
 }
 
 template <typename T>
-void CollisionSystem<T>::update(float dt) {
-	constexpr size_t NR_OF_JOBS = 16;
-	constexpr size_t LAST_JOB = NR_OF_JOBS - 1;
-	const size_t entitiesPerJob = entities.size() / NR_OF_JOBS;
-	std::future<bool> jobs[NR_OF_JOBS];
+Octree* CollisionSystem<T>::getOctree() const {
+	return m_octree;
+}
 
+template <typename T>
+typename CollisionSystem<T>::QueryScratch& CollisionSystem<T>::GetQueryScratch() {
+	thread_local QueryScratch scratch;
+	return scratch;
+}
+
+template <typename T>
+void CollisionSystem<T>::update(float dt) {
+	const PackedView packed = ECS::Instance()->view<MovementComponent, TransformComponent, CollisionComponent, BoundingBoxComponent, T>();
 
 	// prepare matrixes and bounding boxes
 	for (auto e : entities) {
 		e->getComponent<TransformComponent>()->prepareMatrix();
 		e->getComponent<BoundingBoxComponent>()->getBoundingBox()->prepareCorners();
 	}
+	packed.each([](Entity* e, MovementComponent&, TransformComponent& transform, CollisionComponent&, BoundingBoxComponent& boundingBox, T&) {
+		transform.prepareMatrix();
+		boundingBox.getBoundingBox()->prepareCorners();
+	});
 
 	// ======================== Collision Update ======================================
-
-	// Start executing jobs
-	for (size_t i = 0; i < NR_OF_JOBS - 1; ++i) {
-		jobs[i] = Application::getInstance()->pushJobToThreadPool([=](int id) {
-			return collisionUpdatePart(dt, i * entitiesPerJob, i * entitiesPerJob + entitiesPerJob);
-			});
-	}
-	jobs[LAST_JOB] = Application::getInstance()->pushJobToThreadPool([=](int id) {
-		return collisionUpdatePart(dt, LAST_JOB * entitiesPerJob, entities.size());
-		});
-
-	// Wait for jobs to finish executing
-	for (size_t i = 0; i < NR_OF_JOBS; ++i) { jobs[i].get(); }
-
+	runJobs(packed, [=](Entity* e) { collisionUpdateEntity(e, dt); });
 
 	// ======================== Surface from collisions ======================================
-
-	// Start executing jobs
-	for (size_t i = 0; i < NR_OF_JOBS - 1; ++i) {
-		jobs[i] = Application::getInstance()->pushJobToThreadPool([=](int id) {
-			return surfaceFromCollisionPart(dt, i * entitiesPerJob, i * entitiesPerJob + entitiesPerJob);
-			});
-	}
-	jobs[LAST_JOB] = Application::getInstance()->pushJobToThreadPool([=](int id) {
-		return surfaceFromCollisionPart(dt, LAST_JOB * entitiesPerJob, entities.size());
-		});
-
-	// Wait for jobs to finish executing
-	for (size_t i = 0; i < NR_OF_JOBS; ++i) { jobs[i].get(); }
-
+	runJobs(packed, [=](Entity* e) { surfaceFromCollisionEntity(e); });
 
 	// ======================== Ray cast collisions ======================================
 	// Technically not thread safe but we presume that fast travelling objects (basically water) 
 	// will not collide with other fast travelling objects
+	runJobs(packed, [=](Entity* e) { rayCastCollisionEntity(e, dt); });
+}
+
+template <typename T>
+template <typename Func>
+void CollisionSystem<T>::runJobs(const PackedView& packed, Func&& updateEntity) {
+	constexpr size_t NR_OF_JOBS = 16;
+	constexpr size_t LAST_JOB = NR_OF_JOBS - 1;
+	const size_t entitiesPerJob = entities.size() / NR_OF_JOBS;
+	const size_t chunksPerJob = (packed.getNumChunks() + LAST_JOB) / NR_OF_JOBS;
+	std::future<bool> jobs[NR_OF_JOBS];
 
 	// Start executing jobs
-	for (size_t i = 0; i < NR_OF_JOBS - 1; ++i) {
-		jobs[i] = Application::getInstance()->pushJobToThreadPool([=](int id) {
-			return rayCastCollisionPart(dt, i * entitiesPerJob, i * entitiesPerJob + entitiesPerJob);
+	for (size_t i = 0; i < NR_OF_JOBS; ++i) {
+		const size_t start = i * entitiesPerJob;
+		const size_t end = (i == LAST_JOB) ? entities.size() : start + entitiesPerJob;
+
+		jobs[i] = Application::getInstance()->pushJobToThreadPool([&, i, start, end](int id) {
+			for (size_t j = start; j < end; ++j) {
+				updateEntity(entities[j]);
+			}
+			packed.eachInChunks(i * chunksPerJob, (i + 1) * chunksPerJob, [&](Entity* e, auto&...) {
+				updateEntity(e);
 			});
-	}
-	jobs[LAST_JOB] = Application::getInstance()->pushJobToThreadPool([=](int id) {
-		return rayCastCollisionPart(dt, LAST_JOB * entitiesPerJob, entities.size());
+			return true;
 		});
+	}
 
 	// Wait for jobs to finish executing
 	for (size_t i = 0; i < NR_OF_JOBS; ++i) { jobs[i].get(); }
@@ -104,92 +109,76 @@ unsigned int CollisionSystem<T>::getByteSize() const {
 #endif
 
 template <typename T>
-bool CollisionSystem<T>::collisionUpdatePart(float dt, size_t start, size_t end) {
-	for (size_t i = start; i < end; ++i) {
-		Entity* e = entities[i];
-
-		CollisionComponent* collision = e->getComponent<CollisionComponent>();
-		BoundingBoxComponent* boundingBox = e->getComponent<BoundingBoxComponent>();
-
-		collision->collisions.clear();
+void CollisionSystem<T>::collisionUpdateEntity(Entity* e, float dt) {
+	CollisionComponent* collision = e->getComponent<CollisionComponent>();
+	BoundingBoxComponent* boundingBox = e->getComponent<BoundingBoxComponent>();
 
-		if (collision->padding < 0.0f) {
-			glm::vec3 halfSize = boundingBox->getBoundingBox()->getHalfSize();
-			collision->padding = glm::min(glm::min(halfSize.x, halfSize.y), halfSize.z);
-		}
+	collision->collisions.clear();
 
-		collisionUpdate(e, dt);
+	if (collision->padding < 0.0f) {
+		glm::vec3 halfSize = boundingBox->getBoundingBox()->getHalfSize();
+		collision->padding = glm::min(glm::min(halfSize.x, halfSize.y), halfSize.z);
 	}
 
-	return true;
+	collisionUpdate(e, dt);
 }
 
 template <typename T>
-bool CollisionSystem<T>::surfaceFromCollisionPart(float dt, size_t start, size_t end) {
-	for (size_t i = start; i < end; ++i) {
-		Entity* e = entities[i];
-
-		CollisionComponent* collision = e->getComponent<CollisionComponent>();
+void CollisionSystem<T>::surfaceFromCollisionEntity(Entity* e) {
+	CollisionComponent* collision = e->getComponent<CollisionComponent>();
 
-		if (m_octree) {
-			if (!e->hasComponent<RagdollComponent>()) {
-				surfaceFromCollision(e, e->getComponent<BoundingBoxComponent>()->getBoundingBox(), collision->collisions);
-			}
-			else {
-				surfaceFromRagdollCollision(e, collision->collisions);
-			}
+	if (m_octree) {
+		if (!e->hasComponent<RagdollComponent>()) {
+			surfaceFromCollision(e, e->getComponent<BoundingBoxComponent>()->getBoundingBox(), collision->collisions);
+		}
+		else {
+			surfaceFromRagdollCollision(e, collision->collisions);
 		}
 	}
-	return true;
 }
 
 template <typename T>
-bool CollisionSystem<T>::rayCastCollisionPart(float dt, size_t start, size_t end) {
-	for (size_t i = start; i < end; ++i) {
-		Entity* e = entities[i];
-
-		MovementComponent* movement = e->getComponent<MovementComponent>();
-		BoundingBox* boundingBox = e->getComponent<BoundingBoxComponent>()->getBoundingBox();
-		TransformComponent* transComp = e->getComponent<TransformComponent>();
-
-		float updateableDt = dt;
-
-		if (m_octree) {
-			if (!e->hasComponent<RagdollComponent>()) {
-				if (rayCastCheck(e, boundingBox, movement->velocity, updateableDt)) {
-					//Object is moving fast, ray cast for collisions
-					rayCastUpdate(e, boundingBox, updateableDt);
-					movement->oldVelocity = movement->velocity;
-				}
-			}
-			else {
-				RagdollComponent* ragdollComp = e->getComponent<RagdollComponent>();
-				bool rayCastingNeeded = false;
+void CollisionSystem<T>::rayCastCollisionEntity(Entity* e, float dt) {
+	MovementComponent* movement = e->getComponent<MovementComponent>();
+	BoundingBox* boundingBox = e->getComponent<BoundingBoxComponent>()->getBoundingBox();
 
-				for (size_t j = 0; j < ragdollComp->contactPoints.size(); j++) {
-					if (rayCastCheck(e, &ragdollComp->contactPoints[j].boundingBox, movement->velocity, dt)) {
-						rayCastingNeeded = true;
-						break;
-					}
-				}
+	float updateableDt = dt;
 
-				if (rayCastingNeeded) {
-					//Object is moving fast, ray cast for collisions
-					rayCastRagdollUpdate(e, updateableDt);
-					movement->oldVelocity = movement->velocity;
+	if (m_octree) {
+		if (!e->hasComponent<RagdollComponent>()) {
+			if (rayCastCheck(e, boundingBox, movement->velocity, updateableDt)) {
+				//Object is moving fast, ray cast for collisions
+				rayCastUpdate(e, boundingBox, updateableDt);
+				movement->oldVelocity = movement->velocity;
+			}
+		}
+		else {
+			RagdollComponent* ragdollComp = e->getComponent<RagdollComponent>();
+			bool rayCastingNeeded = false;
+
+			for (size_t j = 0; j < ragdollComp->contactPoints.size(); j++) {
+				if (rayCastCheck(e, &ragdollComp->contactPoints[j].boundingBox, movement->velocity, dt)) {
+					rayCastingNeeded = true;
+					break;
 				}
 			}
+
+			if (rayCastingNeeded) {
+				//Object is moving fast, ray cast for collisions
+				rayCastRagdollUpdate(e, updateableDt);
+				movement->oldVelocity = movement->velocity;
+			}
 		}
-		movement->updateableDt = updateableDt;
 	}
-	return true;
+	movement->updateableDt = updateableDt;
 }
 
 template <typename T>
 void CollisionSystem<T>::collisionUpdate(Entity* e, const float dt) {
 	//Update collision data
 	CollisionComponent* collision = e->getComponent<CollisionComponent>();
-	std::vector<Octree::CollisionInfo> collisions;
+	std::vector<Octree::CollisionInfo>& collisions = GetQueryScratch().collisions;
+	collisions.clear();
 
 	if (!e->hasComponent<RagdollComponent>()) {
 		m_octree->getCollisions(e, e->getComponent<BoundingBoxComponent>()->getBoundingBox(), &collisions, collision->doSimpleCollisions);
@@ -221,9 +210,11 @@ const bool CollisionSystem<T>::handleCollisions(Entity* e, std::vector<Octree::C
 	const size_t collisionCount = collisions.size();
 
 	if (collisionCount > 0) {
-		std::vector<int> groundIndices;
+		std::vector<int>& groundIndices = GetQueryScratch().groundIndices;
+		groundIndices.clear();
 		glm::vec3 sumVec(0.0f);
-		std::vector<Octree::CollisionInfo> trueCollisions;
+		std::vector<Octree::CollisionInfo>& trueCollisions = GetQueryScratch().trueCollisions;
+		trueCollisions.clear();
 
 		//Gather info
 		gatherCollisionInformation(e, boundingBox, collisions, trueCollisions, sumVec, groundIndices, dt);
@@ -253,15 +244,17 @@ const bool CollisionSystem<T>::handleRagdollCollisions(Entity* e, std::vector<Oc
 	bool collisionFound = false;
 	collision->onGround = false;
 
-	std::vector<glm::vec3> movementDiffs;
+	std::vector<glm::vec3>& movementDiffs = GetQueryScratch().movementDiffs;
+	movementDiffs.clear();
 
 	for (size_t i = 0; i < ragdollComp->contactPoints.size(); i++) {
 		//----Avoid spinning into things----
 		glm::vec3 globalCenterOfMass = transComp->getMatrixWithUpdate() * glm::vec4(ragdollComp->localCenterOfMass, 1.0f);
 		glm::vec3 offsetVector = transComp->getMatrixWithUpdate() * glm::vec4(ragdollComp->contactPoints[i].localOffSet, 1.0f) - glm::vec4(globalCenterOfMass, 1.0f);
 		if (glm::length2(offsetVector) > 0.f) {
-			Octree::RayIntersectionInfo tempInfo;
-			m_octree->getRayIntersection(globalCenterOfMass, glm::normalize(offsetVector), &tempInfo, e, 0.0f, collision->doSimpleCollisions);
+			Octree::RayIntersectionInfo& tempInfo = GetQueryScratch().ragdollSpinInfo;
+			tempInfo.clear();
+			m_octree->getClosestRayIntersection(globalCenterOfMass, glm::normalize(offsetVector), &tempInfo, e, 0.0f, collision->doSimpleCollisions);
 
 			if (tempInfo.closestHit >= 0.0f && tempInfo.closestHit < glm::length(offsetVector)) {
 				glm::vec3 translation = (tempInfo.closestHit - glm::length(offsetVector)) * 1.1f * glm::normalize(offsetVector);
@@ -273,9 +266,11 @@ const bool CollisionSystem<T>::handleRagdollCollisions(Entity* e, std::vector<Oc
 		}
 		//----------------------------------
 
-		std::vector<int> groundIndices;
+		std::vector<int>& groundIndices = GetQueryScratch().groundIndices;
+		groundIndices.clear();
 		glm::vec3 sumVec(0.0f);
-		std::vector<Octree::CollisionInfo> trueCollisions;
+		std::vector<Octree::CollisionInfo>& trueCollisions = GetQueryScratch().trueCollisions;
+		trueCollisions.clear();
 
 		//Gather info
 		gatherCollisionInformation(e, &ragdollComp->contactPoints[i].boundingBox, collisions, trueCollisions, sumVec, groundIndices, dt);
@@ -348,12 +343,12 @@ void CollisionSystem<T>::gatherCollisionInformation(Entity* e, const BoundingBox
 			glm::vec3 intersectionAxis;
 			float intersectionDepth;
 
-			if (collisionInfo_i.shape->getIntersectionDepthAndAxis(boundingBox, &intersectionAxis, &intersectionDepth)) {
+			if (collisionInfo_i.shape.getIntersectionDepthAndAxis(boundingBox, &intersectionAxis, &intersectionDepth)) {
 				collisionInfo_i.intersectionAxis = intersectionAxis;
 
 				sumVec += collisionInfo_i.intersectionAxis;
 
-				collisionInfo_i.intersectionPosition = collisionInfo_i.shape->getIntersectionPosition(boundingBox);
+				collisionInfo_i.intersectionPosition = collisionInfo_i.shape.getIntersectionPosition(boundingBox);
 
 				//Add collision to current collisions for collisionComponent
 				collision->collisions.push_back(collisionInfo_i);
@@ -451,7 +446,10 @@ void CollisionSystem<T>::rayCastUpdate(Entity* e, BoundingBox* boundingBox, floa
 	const float velocityAmp = glm::length(movement->velocity) * dt;
 
 	//Ray cast to find upcoming collisions, use padding for "swept sphere"
-	Octree::RayIntersectionInfo intersectionInfo;
+	//The recursive call below reuses the same buffer, intersectionInfo is not used after it
+	//Every hit is needed, not just the closest one, since handleCollisions() resolves all contacts at corners and seams
+	Octree::RayIntersectionInfo& intersectionInfo = GetQueryScratch().rayCastInfo;
+	intersectionInfo.clear();
 	m_octree->getRayIntersection(boundingBox->getPosition(), glm::normalize(movement->velocity), &intersectionInfo, e, collision->padding, collision->doSimpleCollisions);
 
 	float closestHit = intersectionInfo.closestHit + 0.01f; //Force small forwards movement to avoid getting stuck in infinite loops
@@ -487,11 +485,13 @@ void CollisionSystem<T>::rayCastRagdollUpdate(Entity* e, float& dt) {
 
 	float closestHit = 9999999.0f;
 
-	std::vector<Octree::CollisionInfo> collisions;
+	std::vector<Octree::CollisionInfo>& collisions = GetQueryScratch().rayCastCollisions;
+	collisions.clear();
 
 	for (size_t i = 0; i < ragdollComp->contactPoints.size(); i++) {
 		//Ray cast to find upcoming collisions, use padding for "swept sphere"
-		Octree::RayIntersectionInfo intersectionInfo;
+		Octree::RayIntersectionInfo& intersectionInfo = GetQueryScratch().rayCastInfo;
+		intersectionInfo.clear();
 		float padding = glm::min(glm::min(ragdollComp->contactPoints[i].boundingBox.getHalfSize().x, ragdollComp->contactPoints[i].boundingBox.getHalfSize().y), ragdollComp->contactPoints[i].boundingBox.getHalfSize().z);
 		m_octree->getRayIntersection(ragdollComp->contactPoints[i].boundingBox.getPosition(), glm::normalize(movement->velocity), &intersectionInfo, e, padding, collision->doSimpleCollisions);
 		if (intersectionInfo.closestHit >= 0.f) {
@@ -539,7 +539,7 @@ glm::vec3 CollisionSystem<T>::surfaceFromCollision(Entity* e, BoundingBox* bound
 		float depth;
 		glm::vec3 axis;
 
-		if (collisionInfo_i.shape->getIntersectionDepthAndAxis(boundingBox, &axis, &depth)) {
+		if (collisionInfo_i.shape.getIntersectionDepthAndAxis(boundingBox, &axis, &depth)) {
 			boundingBox->setPosition(boundingBox->getPosition() + axis * (depth - 0.0001f));
 			distance += axis * (depth - 0.0001f);
 		}
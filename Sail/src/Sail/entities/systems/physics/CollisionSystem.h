@@ -2,6 +2,12 @@
 #include "..//BaseComponentSystem.h"
 #include "..//..//Physics/Octree.h"
 #include "..//..//Physics/BoundingBox.h"
+#include "..//..//ArchetypeView.h"
+
+class MovementComponent;
+class TransformComponent;
+class CollisionComponent;
+class BoundingBoxComponent;
 
 template <typename T>
 class CollisionSystem final : public BaseComponentSystem {
@@ -10,6 +16,7 @@ public:
 	~CollisionSystem();
 	
 	void provideOctree(Octree* octree);
+	Octree* getOctree() const;
 	void update(float dt);
 
 #ifdef DEVELOPMENT
@@ -17,9 +24,28 @@ public:
 #endif
 
 private:
-	bool collisionUpdatePart(float dt, size_t start, size_t end);
-	bool surfaceFromCollisionPart(float dt, size_t start, size_t end);
-	bool rayCastCollisionPart(float dt, size_t start, size_t end);
+	typedef ArchetypeView<MovementComponent, TransformComponent, CollisionComponent, BoundingBoxComponent, T> PackedView;
+
+	// Buffers reused by every query on a thread, they only allocate while growing to the largest size needed so far
+	// Each function which fills a buffer uses its own so that nested calls don't overwrite each other
+	struct QueryScratch {
+		std::vector<Octree::CollisionInfo> collisions;
+		std::vector<Octree::CollisionInfo> rayCastCollisions;
+		std::vector<Octree::CollisionInfo> trueCollisions;
+		std::vector<int> groundIndices;
+		std::vector<glm::vec3> movementDiffs;
+		Octree::RayIntersectionInfo rayCastInfo;
+		Octree::RayIntersectionInfo ragdollSpinInfo;
+	};
+	static QueryScratch& GetQueryScratch();
+
+	// Splits both the entity list and the packed entities' chunks over the thread pool
+	template <typename Func>
+	void runJobs(const PackedView& packed, Func&& updateEntity);
+
+	void collisionUpdateEntity(Entity* e, float dt);
+	void surfaceFromCollisionEntity(Entity* e);
+	void rayCastCollisionEntity(Entity* e, float dt);
 	
 	const bool rayCastCheck(Entity* e, const BoundingBox* boundingBox, const glm::vec3& velocity, const float& dt) const;
 	void rayCastUpdate(Entity* e, BoundingBox* boundingBox, float& dt);
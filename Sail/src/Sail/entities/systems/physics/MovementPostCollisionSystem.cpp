@@ -5,7 +5,7 @@
 #include "..//..//components/CollisionSpheresComponent.h"
 #include "..//..//components/RenderInActiveGameComponent.h"
 #include "..//..//components/RenderInReplayComponent.h"
-#include "..//..//Entity.h"
+#include "..//..//ECS.h"
 #include "Sail/utils/GameDataTracker.h"
 
 template <typename T>
@@ -14,44 +14,53 @@ MovementPostCollisionSystem<T>::MovementPostCollisionSystem() {
 	registerComponent<MovementComponent>(true, true, true);
 	registerComponent<CollisionSpheresComponent>(false, true, true);
 	registerComponent<T>(true, false, false);
+
+	iteratesArchetypes = true;
 }
 
 
 template <typename T>
 void MovementPostCollisionSystem<T>::update(float dt) {
 	for (auto& e : entities) {
-		TransformComponent* transform = e->getComponent<TransformComponent>();
-		MovementComponent* movement = e->getComponent<MovementComponent>();
+		updateEntity(e, *e->getComponent<TransformComponent>(), *e->getComponent<MovementComponent>(), dt);
+	}
 
-		// Apply air drag
-		float saveY = movement->velocity.y;
-		movement->velocity.y = 0;
-		float vel = glm::length(movement->velocity);
+	ECS::Instance()->view<TransformComponent, MovementComponent, T>().each(
+		[&](Entity* e, TransformComponent& transform, MovementComponent& movement, T&) {
+			updateEntity(e, transform, movement, dt);
+		});
+}
 
-		if (vel > 0.0f) {
-			vel = glm::max(vel - movement->airDrag * dt, 0.0f);
-			movement->velocity = glm::normalize(movement->velocity) * vel;
-		}
-		movement->velocity.y = saveY;
-
-		// Update position with velocities after CollisionSystem has potentially altered them
-		glm::vec3 translation = (movement->oldVelocity + movement->velocity) * (0.5f * movement->updateableDt);
-		if (translation != glm::vec3(0.0f)) {
-			transform->translate(translation);
-			if (e->getName() == "MyPlayer") {
-				GameDataTracker::getInstance().logDistanceWalked(translation);
-			}
-		}
-		movement->oldMovement = translation;
+template <typename T>
+void MovementPostCollisionSystem<T>::updateEntity(Entity* e, TransformComponent& transform, MovementComponent& movement, float dt) {
+	// Apply air drag
+	float saveY = movement.velocity.y;
+	movement.velocity.y = 0;
+	float vel = glm::length(movement.velocity);
 
-		movement->oldVelocity = movement->velocity;
+	if (vel > 0.0f) {
+		vel = glm::max(vel - movement.airDrag * dt, 0.0f);
+		movement.velocity = glm::normalize(movement.velocity) * vel;
+	}
+	movement.velocity.y = saveY;
 
-		// Dumb thing for now, will hopefully be done cleaner in the future
-		if (CollisionSpheresComponent * csc = e->getComponent<CollisionSpheresComponent>()) {
-			csc->spheres[0].position = transform->getTranslation() + glm::vec3(0, 1, 0) * csc->spheres[0].radius;
-			csc->spheres[1].position = transform->getTranslation() + glm::vec3(0, 1, 0) * (0.9f * 2.0f - csc->spheres[1].radius);
+	// Update position with velocities after CollisionSystem has potentially altered them
+	glm::vec3 translation = (movement.oldVelocity + movement.velocity) * (0.5f * movement.updateableDt);
+	if (translation != glm::vec3(0.0f)) {
+		transform.translate(translation);
+		if (e->getName() == "MyPlayer") {
+			GameDataTracker::getInstance().logDistanceWalked(translation);
 		}
 	}
+	movement.oldMovement = translation;
+
+	movement.oldVelocity = movement.velocity;
+
+	// Dumb thing for now, will hopefully be done cleaner in the future
+	if (CollisionSpheresComponent * csc = e->getComponent<CollisionSpheresComponent>()) {
+		csc->spheres[0].position = transform.getTranslation() + glm::vec3(0, 1, 0) * csc->spheres[0].radius;
+		csc->spheres[1].position = transform.getTranslation() + glm::vec3(0, 1, 0) * (0.9f * 2.0f - csc->spheres[1].radius);
+	}
 }
 
 
@@ -1,6 +1,9 @@
 #pragma once
 #include "..//BaseComponentSystem.h"
 
+class TransformComponent;
+class MovementComponent;
+
 template <typename T>
 class MovementPostCollisionSystem final : public BaseComponentSystem {
 public:
@@ -9,5 +12,5 @@ public:
 
 	void update(float dt);
 private:
-
+	void updateEntity(Entity* e, TransformComponent& transform, MovementComponent& movement, float dt);
 };
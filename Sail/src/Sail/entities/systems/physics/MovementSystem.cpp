@@ -5,7 +5,7 @@
 #include "Sail/entities/components/RagdollComponent.h"
 #include "Sail/entities/components/RenderInActiveGameComponent.h"
 #include "Sail/entities/components/RenderInReplayComponent.h"
-#include "Sail/entities/Entity.h"
+#include "Sail/entities/ECS.h"
 
 
 template <typename T>
@@ -14,31 +14,38 @@ MovementSystem<T>::MovementSystem() {
 	registerComponent<MovementComponent>(true, true, true);
 	registerComponent<RagdollComponent>(false, true, false);
 	registerComponent<T>(true, false, false);
+
+	iteratesArchetypes = true;
 }
 
 template <typename T>
 void MovementSystem<T>::update(float dt) {
 	for (auto& e : entities) {
+		updateEntity(*e->getComponent<TransformComponent>(), *e->getComponent<MovementComponent>(), dt);
+	}
 
-		TransformComponent* transform = e->getComponent<TransformComponent>();
-		MovementComponent* movement = e->getComponent<MovementComponent>();
+	ECS::Instance()->view<TransformComponent, MovementComponent, T>().each(
+		[&](Entity* e, TransformComponent& transform, MovementComponent& movement, T&) {
+			updateEntity(transform, movement, dt);
+		});
+}
 
-		// Update velocity
-		movement->velocity += (movement->constantAcceleration + movement->accelerationToAdd) * dt;
+template <typename T>
+void MovementSystem<T>::updateEntity(TransformComponent& transform, MovementComponent& movement, float dt) {
+	// Update velocity
+	movement.velocity += (movement.constantAcceleration + movement.accelerationToAdd) * dt;
 
-		// Reset additional acceleration
-		movement->accelerationToAdd = glm::vec3(0.0f);
-		
-		// Rotation
-		if (movement->rotation != glm::vec3(0.0f)) {
-			transform->rotate(movement->rotation * dt);
-		}
+	// Reset additional acceleration
+	movement.accelerationToAdd = glm::vec3(0.0f);
 
-		// Set initial value which might be changed in CollisionSystem
-		movement->updateableDt = dt;
+	// Rotation
+	if (movement.rotation != glm::vec3(0.0f)) {
+		transform.rotate(movement.rotation * dt);
 	}
-}
 
+	// Set initial value which might be changed in CollisionSystem
+	movement.updateableDt = dt;
+}
 
 template class MovementSystem<RenderInActiveGameComponent>;
 template class MovementSystem<RenderInReplayComponent>;
@@ -1,6 +1,9 @@
 #pragma once
 #include "..//BaseComponentSystem.h"
 
+class TransformComponent;
+class MovementComponent;
+
 template <typename T>
 class MovementSystem final : public BaseComponentSystem {
 public:
@@ -8,4 +11,7 @@ public:
 	~MovementSystem() = default;
 
 	void update(float dt);
+
+private:
+	void updateEntity(TransformComponent& transform, MovementComponent& movement, float dt);
 };
\ No newline at end of file
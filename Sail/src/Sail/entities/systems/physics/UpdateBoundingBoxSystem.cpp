@@ -1,6 +1,6 @@
 #include "pch.h"
 #include "UpdateBoundingBoxSystem.h"
-#include "Sail/entities/Entity.h"
+#include "Sail/entities/ECS.h"
 #include "Sail/entities/components/TransformComponent.h"
 #include "Sail/entities/components/BoundingBoxComponent.h"
 #include "Sail/entities/components/ModelComponent.h"
@@ -13,6 +13,8 @@ UpdateBoundingBoxSystem::UpdateBoundingBoxSystem() : BaseComponentSystem() {
 	registerComponent<TransformComponent>(true, true, true);
 	registerComponent<ModelComponent>(false, true, true);
 	registerComponent<RagdollComponent>(false, true, true);
+
+	iteratesArchetypes = true;
 }
 
 UpdateBoundingBoxSystem::~UpdateBoundingBoxSystem() {
@@ -99,20 +101,26 @@ bool UpdateBoundingBoxSystem::addEntity(Entity* entity) {
 
 void UpdateBoundingBoxSystem::update(float dt) {
 	for (auto& e : entities) {
-		TransformComponent* transform = e->getComponent<TransformComponent>();
-		if (transform) {
-			int change = transform->getChange();
-			if (change > 1 && !e->getComponent<BoundingBoxComponent>()->isStatic) {
-				recalculateBoundingBoxFully(e);
-			} 
-			else if (change > 0) {
-				recalculateBoundingBoxPosition(e);
-			}
+		updateEntity(e, *e->getComponent<TransformComponent>(), *e->getComponent<BoundingBoxComponent>());
+	}
 
-			if (e->hasComponent<RagdollComponent>()) {
-				recalculateBoundingBoxFully(e);
-				updateRagdollBoundingBoxes(e);
-			}
-		}
+	ECS::Instance()->view<BoundingBoxComponent, TransformComponent>().each(
+		[&](Entity* e, BoundingBoxComponent& boundingBox, TransformComponent& transform) {
+			updateEntity(e, transform, boundingBox);
+		});
+}
+
+void UpdateBoundingBoxSystem::updateEntity(Entity* e, TransformComponent& transform, BoundingBoxComponent& boundingBox) {
+	int change = transform.getChange();
+	if (change > 1 && !boundingBox.isStatic) {
+		recalculateBoundingBoxFully(e);
+	} 
+	else if (change > 0) {
+		recalculateBoundingBoxPosition(e);
+	}
+
+	if (e->hasComponent<RagdollComponent>()) {
+		recalculateBoundingBoxFully(e);
+		updateRagdollBoundingBoxes(e);
 	}
 }
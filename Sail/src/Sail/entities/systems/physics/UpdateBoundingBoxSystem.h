@@ -1,6 +1,9 @@
 #pragma once
 #include "..//BaseComponentSystem.h"
 
+class TransformComponent;
+class BoundingBoxComponent;
+
 class UpdateBoundingBoxSystem final : public BaseComponentSystem
 {
 public:
@@ -12,6 +15,7 @@ public:
 	void update(float dt) override;
 
 private:
+	void updateEntity(Entity* e, TransformComponent& transform, BoundingBoxComponent& boundingBox);
 	void checkDistances(glm::vec3& minVec, glm::vec3& maxVec, const glm::vec3& testVec);
 	void recalculateBoundingBoxFully(Entity* e);
 	void recalculateBoundingBoxPosition(Entity* e);
@@ -4,6 +4,7 @@
 #include "Sail/entities/Entity.h"
 #include "Sail/entities/components/TransformComponent.h"
 #include "Sail/entities/components/RenderInActiveGameComponent.h"
+#include "Sail/Application.h"
 
 PrepareUpdateSystem::PrepareUpdateSystem() {
 	// TODO: System owner should check if this is correct
@@ -27,3 +28,39 @@ void PrepareUpdateSystem::update() {
 	}
 }
 
+void PrepareUpdateSystem::updateHierarchies() {
+	constexpr size_t NR_OF_JOBS = 16;
+	constexpr size_t MIN_ROOTS_PER_JOB = 64;
+
+	m_roots.clear();
+	for (auto e : entities) {
+		TransformComponent* transform = e->getComponent<TransformComponent>();
+		if (transform->isHierarchyRoot()) {
+			m_roots.push_back(transform);
+		}
+	}
+
+	// Hierarchies don't share any transforms so they can be updated in any order
+	const size_t numJobs = std::min(NR_OF_JOBS, m_roots.size() / MIN_ROOTS_PER_JOB);
+	if (numJobs < 2) {
+		for (TransformComponent* root : m_roots) {
+			root->updateHierarchy();
+		}
+		return;
+	}
+
+	const size_t rootsPerJob = (m_roots.size() + numJobs - 1) / numJobs;
+	std::future<bool> jobs[NR_OF_JOBS];
+	for (size_t i = 0; i < numJobs; i++) {
+		const size_t start = i * rootsPerJob;
+		const size_t end = std::min(start + rootsPerJob, m_roots.size());
+		jobs[i] = Application::getInstance()->pushJobToThreadPool([this, start, end](int id) {
+			for (size_t j = start; j < end; j++) {
+				m_roots[j]->updateHierarchy();
+			}
+			return true;
+		});
+	}
+	for (size_t i = 0; i < numJobs; i++) { jobs[i].get(); }
+}
+
@@ -1,6 +1,8 @@
 #pragma once
 #include "..//BaseComponentSystem.h"
 
+class TransformComponent;
+
 // Used to prepare all transform components at the beginning of each CPU update
 class PrepareUpdateSystem : public BaseComponentSystem {
 public:
@@ -8,4 +10,9 @@ public:
 	~PrepareUpdateSystem();
 	void fixedUpdate();
 	void update();
+	// Updates the world matrices of every transform hierarchy once the entities have moved, hierarchies are split over the thread pool when there are many of them
+	void updateHierarchies();
+
+private:
+	std::vector<TransformComponent*> m_roots;
 };
\ No newline at end of file
@@ -1,5 +1,166 @@
 #include "pch.h"
 #include "Animation.h"
+#include "..//..//Physics/SimdFloat.h"
+
+#pragma region POSE
+
+namespace {
+	// Coefficients of the weight correction in AnimationPose::Blend(), polynomials in the cosine of the angle between the rotations
+	constexpr float SLERP_A[] = { 1.0904f, -3.2452f, 3.55645f, -1.43519f };
+	constexpr float SLERP_B[] = { 0.848013f, -1.06021f, 0.215638f };
+}
+
+AnimationPose::AnimationPose() :
+	m_boneCount(0),
+	m_stride(0) {
+}
+void AnimationPose::resize(const unsigned int boneCount) {
+	m_boneCount = boneCount;
+	m_stride = (boneCount + 3) & ~3u;
+	// Padding is an identity transform so that it blends like any other bone
+	m_data.assign(COMPONENT_COUNT * m_stride / 4, Lanes{});
+	std::fill_n(getMutableComponent(RW), m_stride, 1.0f);
+	std::fill_n(getMutableComponent(SX), m_stride * 3, 1.0f);
+}
+void AnimationPose::setTransform(const unsigned int bone, const glm::mat4& transform) {
+	glm::vec3 pos, scale, skew;
+	glm::vec4 perspective;
+	glm::quat rot;
+	glm::decompose(transform, scale, rot, pos, skew, perspective);
+
+	const float values[COMPONENT_COUNT] = { pos.x, pos.y, pos.z, rot.x, rot.y, rot.z, rot.w, scale.x, scale.y, scale.z };
+	for (unsigned int component = 0; component < COMPONENT_COUNT; component++) {
+		getMutableComponent(Component(component))[bone] = values[component];
+	}
+}
+const unsigned int AnimationPose::getBoneCount() const {
+	return m_boneCount;
+}
+const float* AnimationPose::getComponent(const Component component) const {
+	return reinterpret_cast<const float*>(m_data.data()) + component * m_stride;
+}
+float* AnimationPose::getMutableComponent(const Component component) {
+	return reinterpret_cast<float*>(m_data.data()) + component * m_stride;
+}
+
+void AnimationPose::Blend(const AnimationPose& a, const AnimationPose& b, const float w, AnimationPose& res) {
+	if (res.m_boneCount != a.m_boneCount) {
+		res.resize(a.m_boneCount);
+	}
+	const unsigned int stride = std::min(a.m_stride, b.m_stride);
+	const Component lerpComponents[] = { TX, TY, TZ, SX, SY, SZ };
+
+	const float* ax = a.getComponent(RX);
+	const float* ay = a.getComponent(RY);
+	const float* az = a.getComponent(RZ);
+	const float* aw = a.getComponent(RW);
+	const float* bx = b.getComponent(RX);
+	const float* by = b.getComponent(RY);
+	const float* bz = b.getComponent(RZ);
+	const float* bw = b.getComponent(RW);
+	float* rx = res.getMutableComponent(RX);
+	float* ry = res.getMutableComponent(RY);
+	float* rz = res.getMutableComponent(RZ);
+	float* rw = res.getMutableComponent(RW);
+
+	/*
+		Rotations are normalized lerps instead of slerps, with the weight bent by a polynomial fitted to the angle between
+		the rotations so that the result stays within a small fraction of a degree of glm::slerp
+	*/
+#ifdef SAIL_SIMD_SSE2
+	using F = Simd::Float4;
+	const F linearWeight = F::Set(w);
+	const F weightOffset = F::Set(w * (w - 0.5f) * (w - 1.0f));
+	const F weightOffsetSq = F::Set((w - 0.5f) * (w - 0.5f));
+
+	for (const Component component : lerpComponents) {
+		const float* ca = a.getComponent(component);
+		const float* cb = b.getComponent(component);
+		float* cr = res.getMutableComponent(component);
+		for (unsigned int i = 0; i < stride; i += F::WIDTH) {
+			const F va = F::Load(ca + i);
+			(va + (F::Load(cb + i) - va) * linearWeight).store(cr + i);
+		}
+	}
+
+	for (unsigned int i = 0; i < stride; i += F::WIDTH) {
+		const F qax = F::Load(ax + i), qay = F::Load(ay + i), qaz = F::Load(az + i), qaw = F::Load(aw + i);
+		F qbx = F::Load(bx + i), qby = F::Load(by + i), qbz = F::Load(bz + i), qbw = F::Load(bw + i);
+
+		// Take the short way around
+		const F cosTheta = qax * qbx + qay * qby + qaz * qbz + qaw * qbw;
+		const F flip = cosTheta < F::Zero();
+		qbx = F::Select(flip, -qbx, qbx);
+		qby = F::Select(flip, -qby, qby);
+		qbz = F::Select(flip, -qbz, qbz);
+		qbw = F::Select(flip, -qbw, qbw);
+
+		const F d = F::Abs(cosTheta);
+		const F k = F::Set(SLERP_A[0]) + d * (F::Set(SLERP_A[1]) + d * (F::Set(SLERP_A[2]) + d * F::Set(SLERP_A[3])));
+		const F l = F::Set(SLERP_B[0]) + d * (F::Set(SLERP_B[1]) + d * F::Set(SLERP_B[2]));
+		const F weight = weightOffset * (k * weightOffsetSq + l) + linearWeight;
+
+		const F qx = qax + (qbx - qax) * weight;
+		const F qy = qay + (qby - qay) * weight;
+		const F qz = qaz + (qbz - qaz) * weight;
+		const F qw = qaw + (qbw - qaw) * weight;
+		const F invLength = F::Set(1.0f) / F::Sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+		(qx * invLength).store(rx + i);
+		(qy * invLength).store(ry + i);
+		(qz * invLength).store(rz + i);
+		(qw * invLength).store(rw + i);
+	}
+#else
+	for (const Component component : lerpComponents) {
+		const float* ca = a.getComponent(component);
+		const float* cb = b.getComponent(component);
+		float* cr = res.getMutableComponent(component);
+		for (unsigned int i = 0; i < stride; i++) {
+			cr[i] = ca[i] + (cb[i] - ca[i]) * w;
+		}
+	}
+
+	for (unsigned int i = 0; i < stride; i++) {
+		const float cosTheta = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+		const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+
+		const float d = std::abs(cosTheta);
+		const float k = SLERP_A[0] + d * (SLERP_A[1] + d * (SLERP_A[2] + d * SLERP_A[3]));
+		const float l = SLERP_B[0] + d * (SLERP_B[1] + d * SLERP_B[2]);
+		const float weight = w * (w - 0.5f) * (w - 1.0f) * (k * (w - 0.5f) * (w - 0.5f) + l) + w;
+
+		const glm::quat q(aw[i] + (bw[i] * sign - aw[i]) * weight, ax[i] + (bx[i] * sign - ax[i]) * weight, ay[i] + (by[i] * sign - ay[i]) * weight, az[i] + (bz[i] * sign - az[i]) * weight);
+		const glm::quat n = q * (1.0f / std::sqrt(glm::dot(q, q)));
+		rx[i] = n.x;
+		ry[i] = n.y;
+		rz[i] = n.z;
+		rw[i] = n.w;
+	}
+#endif
+}
+
+void AnimationPose::toMatrices(glm::mat4* transforms) const {
+	const float* t[3] = { getComponent(TX), getComponent(TY), getComponent(TZ) };
+	const float* r[4] = { getComponent(RX), getComponent(RY), getComponent(RZ), getComponent(RW) };
+	const float* s[3] = { getComponent(SX), getComponent(SY), getComponent(SZ) };
+	for (unsigned int bone = 0; bone < m_boneCount; bone++) {
+		const glm::mat3 rotation = glm::toMat3(glm::quat(r[3][bone], r[0][bone], r[1][bone], r[2][bone]));
+		const glm::vec3 scale(s[0][bone], s[1][bone], s[2][bone]);
+
+		// Scaling the rows of the rotation is the same as translate * scale * rotate
+		glm::mat4& res = transforms[bone];
+		res[0] = glm::vec4(rotation[0] * scale, 0.0f);
+		res[1] = glm::vec4(rotation[1] * scale, 0.0f);
+		res[2] = glm::vec4(rotation[2] * scale, 0.0f);
+		res[3] = glm::vec4(t[0][bone], t[1][bone], t[2][bone], 1.0f);
+	}
+}
+
+unsigned int AnimationPose::getByteSize() const {
+	return sizeof(*this) + sizeof(Lanes) * (unsigned int)m_data.capacity();
+}
+
+#pragma endregion
 
 #pragma region FRAME
 
@@ -56,6 +217,7 @@ unsigned int Animation::Frame::getByteSize() const {
 Animation::Animation() :
 	m_maxFrame(0) ,
 	m_maxFrameTime(0),
+	m_sortedTimes(true),
 	m_name("")
 {
 
@@ -64,8 +226,8 @@ Animation::Animation(const std::string& name) : Animation() {
 	m_name = name;
 }
 Animation::~Animation() {
-	for (unsigned int frame = 0; frame <= m_maxFrame; frame++) {
-		Memory::SafeDelete(m_frames[frame]);
+	for (Animation::Frame*& frame : m_frames) {
+		Memory::SafeDelete(frame);
 	}
 }
 const float Animation::getMaxAnimationTime() {
@@ -106,47 +268,35 @@ const float Animation::getTimeAtFrame(const unsigned int frame) {
 	}
 	return 0.0f;
 }
-const unsigned int Animation::getFrameAtTime(float time, const FindType type) {
+const unsigned int Animation::getFrameAtTime(float time, const FindType type, unsigned int* cursor) {
 	time = fmodf(time, getMaxAnimationTime());
 
-	float leastDiff = 50000;
-	unsigned int closestFrame = m_maxFrame;
-	/* find closest frame */
-	for (unsigned int frame = 0; frame < m_maxFrame; frame++) {
-		float diff = fabsf(m_frameTimes[frame] - time);
-		if (diff < leastDiff) {
-			leastDiff = diff;
-			closestFrame = frame;
-		} else {
-			continue;
-		}
-	}
-
-	if (closestFrame != m_maxFrame) {
-		switch (type) {
-		case BEHIND:
-			if (closestFrame == 0) {
-				return m_maxFrame - 1;
-			} else {
-				return closestFrame - 1;
-			}
-			break;
-		case INFRONT:
-			if (closestFrame == m_maxFrame - 1) {
-				return 0;
-			} else {
-				return closestFrame + 1;
-			}
-			break;
-		default:
-			return closestFrame;
-			break;
-		}
-	} else {
+	if (m_maxFrame == 0 || std::isnan(time)) {
 		// Couldn't find a frame for some reason?
 		SAIL_LOG_WARNING("Animation::getFrameAtTime: Couldn't find a proper frame.");
 		return 0;
 	}
+
+	const unsigned int closestFrame = findClosestFrame(time, cursor);
+	switch (type) {
+	case BEHIND:
+		if (closestFrame == 0) {
+			return m_maxFrame - 1;
+		} else {
+			return closestFrame - 1;
+		}
+		break;
+	case INFRONT:
+		if (closestFrame == m_maxFrame - 1) {
+			return 0;
+		} else {
+			return closestFrame + 1;
+		}
+		break;
+	default:
+		return closestFrame;
+		break;
+	}
 }
 
 void Animation::addFrame(const unsigned int frame, const float time, Animation::Frame* data) {
@@ -157,10 +307,43 @@ void Animation::addFrame(const unsigned int frame, const float time, Animation::
 		m_maxFrame = frame;
 	}
 
+	if (frame >= m_frames.size()) {
+		m_frames.resize(frame + 1, nullptr);
+		m_frameTimes.resize(frame + 1, 0.0f);
+	}
 	m_frames[frame] = data;
 	m_frameTimes[frame] = time;
 }
 
+void Animation::build() {
+	m_sortedTimes = std::is_sorted(m_frameTimes.begin(), m_frameTimes.begin() + std::min<size_t>(m_maxFrame, m_frameTimes.size()));
+	if (!m_sortedTimes) {
+		SAIL_LOG_WARNING("Animation " + m_name + " has frames that are not in time order, frame lookups will be slow");
+	}
+
+	m_poses.clear();
+	m_poses.resize(m_maxFrame + 1);
+	for (unsigned int frame = 0; frame < m_frames.size(); frame++) {
+		Animation::Frame* data = m_frames[frame];
+		if (!data || !data->getTransformList()) {
+			continue;
+		}
+		const unsigned int boneCount = data->getTransformListSize();
+		const glm::mat4* transforms = data->getTransformList();
+		m_poses[frame].resize(boneCount);
+		for (unsigned int bone = 0; bone < boneCount; bone++) {
+			m_poses[frame].setTransform(bone, transforms[bone]);
+		}
+	}
+}
+
+const AnimationPose* Animation::getPose(const unsigned int frame) const {
+	if (frame < m_poses.size() && m_poses[frame].getBoneCount() > 0) {
+		return &m_poses[frame];
+	}
+	return nullptr;
+}
+
 void Animation::setName(const std::string& name) {
 	m_name = name;
 }
@@ -174,19 +357,25 @@ unsigned int Animation::getByteSize() const {
 
 	size += m_name.capacity() * sizeof(unsigned char);
 	
-	size += sizeof(std::pair<unsigned int, float>) * m_frameTimes.size();
+	size += sizeof(float) * (unsigned int)m_frameTimes.capacity();
 
-	size += sizeof(std::pair<unsigned int, Animation::Frame*>) * m_frames.size();
+	size += sizeof(Animation::Frame*) * (unsigned int)m_frames.capacity();
 
-	for (auto& [key, val] : m_frames) {
-		size += val->getByteSize();
+	for (auto* frame : m_frames) {
+		if (frame) {
+			size += frame->getByteSize();
+		}
+	}
+
+	for (auto& pose : m_poses) {
+		size += pose.getByteSize();
 	}
 
 	return size;
 }
 
 inline const bool Animation::exists(const unsigned int frame) {
-	if (m_frames.find(frame) == m_frames.end()) {
+	if (frame >= m_frames.size() || !m_frames[frame]) {
 		#if defined(_DEBUG) && defined(SAIL_VERBOSELOGGING)
 			SAIL_LOG_WARNING("Trying to access frame(" + std::to_string(frame) + ") which does not exist, maxFrame(" + std::to_string(m_maxFrame) + ").");
 		#endif
@@ -195,6 +384,50 @@ inline const bool Animation::exists(const unsigned int frame) {
 	return true;
 }
 
+const unsigned int Animation::findClosestFrame(const float time, unsigned int* cursor) {
+	// The last frame is only where the animation ends, the closest frame is one of the others
+	const unsigned int count = std::min<unsigned int>(m_maxFrame, (unsigned int)m_frameTimes.size());
+	const float* times = m_frameTimes.data();
+
+	unsigned int closestFrame = 0;
+	if (!m_sortedTimes) {
+		float leastDiff = fabsf(times[0] - time);
+		for (unsigned int frame = 1; frame < count; frame++) {
+			const float diff = fabsf(times[frame] - time);
+			if (diff < leastDiff) {
+				leastDiff = diff;
+				closestFrame = frame;
+			}
+		}
+	} else {
+		// Last frame at or before time, the time has usually not moved past the frame after the previous lookup
+		auto isAtOrBefore = [&](const unsigned int frame) {
+			return times[frame] <= time && (frame + 1 >= count || time < times[frame + 1]);
+		};
+		const unsigned int hint = cursor ? std::min(*cursor, count - 1) : 0;
+		unsigned int frame;
+		if (isAtOrBefore(hint)) {
+			frame = hint;
+		} else if (hint + 1 < count && isAtOrBefore(hint + 1)) {
+			frame = hint + 1;
+		} else {
+			frame = (unsigned int)(std::upper_bound(times, times + count, time) - times);
+			frame = (frame > 0) ? frame - 1 : 0;
+		}
+
+		// Ties go to the earlier frame
+		closestFrame = frame;
+		if (frame + 1 < count && fabsf(times[frame + 1] - time) < fabsf(times[frame] - time)) {
+			closestFrame = frame + 1;
+		}
+	}
+
+	if (cursor) {
+		*cursor = closestFrame;
+	}
+	return closestFrame;
+}
+
 #pragma endregion
 
 #pragma region VERTCONNECTION
@@ -270,6 +503,9 @@ void AnimationStack::reSizeConnections(const unsigned int vertCount) {
 
 }
 void AnimationStack::addAnimation(const std::string& animationName, Animation* animation) {
+	// Every loader adds the animation once all of its frames have been added
+	animation->build();
+
 	if (m_stack.find(animationName) == m_stack.end()) {
 		m_names[(unsigned int)m_stack.size()] = animationName;
 		m_indexes[animationName] = (unsigned int)m_stack.size();
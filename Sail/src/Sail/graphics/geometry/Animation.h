@@ -3,6 +3,45 @@
 #include <map>
 #define SAIL_BONES_PER_VERTEX 5
 
+/*
+	Translation, rotation and scale of every bone in a pose, one array per component
+	The arrays are padded to a multiple of four bones so that all bones can be blended in the same loop
+*/
+class AnimationPose {
+public:
+	enum Component {
+		TX, TY, TZ,
+		RX, RY, RZ, RW,
+		SX, SY, SZ,
+		COMPONENT_COUNT
+	};
+
+	AnimationPose();
+	void resize(const unsigned int boneCount);
+	// Decomposes the transform the same way AnimationSystem used to do every frame
+	void setTransform(const unsigned int bone, const glm::mat4& transform);
+	const unsigned int getBoneCount() const;
+	const float* getComponent(const Component component) const;
+
+	// Lerps translation and scale and nlerps rotation, res may not be a or b
+	static void Blend(const AnimationPose& a, const AnimationPose& b, const float w, AnimationPose& res);
+	// translate * scale * rotate of every bone
+	void toMatrices(glm::mat4* transforms) const;
+
+	unsigned int getByteSize() const;
+private:
+	float* getMutableComponent(const Component component);
+
+	// Four bones of a component, keeps every component aligned for SIMD loads
+	struct alignas(16) Lanes {
+		float bones[4];
+	};
+
+	unsigned int m_boneCount;
+	unsigned int m_stride;
+	std::vector<Lanes> m_data;
+};
+
 class Animation {
 public:
 	class Frame {
@@ -41,8 +80,15 @@ public:
 	const unsigned int getAnimationTransformSize(const float time);
 	const unsigned int getAnimationTransformSize(const unsigned int frame);
 	const float getTimeAtFrame(const unsigned int frame);
-	const unsigned int getFrameAtTime(float time, const FindType type = BEHIND);
+	/*
+		Frame times are searched with a binary search, cursor is optional and remembers the closest frame between calls
+		so that lookups at or just after the previous time don't have to search at all
+	*/
+	const unsigned int getFrameAtTime(float time, const FindType type = BEHIND, unsigned int* cursor = nullptr);
 	void addFrame(const unsigned int frame, const float time, Animation::Frame* data);
+	// Decomposes all frames into poses and checks the frame times, done by AnimationStack::addAnimation() once the frames have been added
+	void build();
+	const AnimationPose* getPose(const unsigned int frame) const;
 
 	void setName(const std::string& name);
 	const std::string& getName();
@@ -56,9 +102,13 @@ private:
 	unsigned int m_maxFrame;
 
 	inline const bool exists(const unsigned int frame);
+	const unsigned int findClosestFrame(const float time, unsigned int* cursor);
 
-	std::map<unsigned int, float> m_frameTimes;
-	std::map<unsigned int, Animation::Frame*> m_frames;
+	// Indexed by frame
+	std::vector<float> m_frameTimes;
+	std::vector<Animation::Frame*> m_frames;
+	std::vector<AnimationPose> m_poses;
+	bool m_sortedTimes;
 };
 
 
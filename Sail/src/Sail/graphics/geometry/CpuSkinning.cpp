@@ -0,0 +1,91 @@
+#include "pch.h"
+#include "CpuSkinning.h"
+#include "..//..//Physics/SimdFloat.h"
+
+namespace {
+#ifdef SAIL_SIMD_SSE2
+	inline Simd::Float4 Transform(const Simd::Float4* columns, const glm::vec3& v) {
+		return columns[0] * Simd::Float4::Set(v.x) + columns[1] * Simd::Float4::Set(v.y) + columns[2] * Simd::Float4::Set(v.z);
+	}
+
+	inline void Store(const Simd::Float4 v, glm::vec3& out) {
+		alignas(16) float f[4];
+		v.store(f);
+		out = glm::vec3(f[0], f[1], f[2]);
+	}
+#endif
+}
+
+void CpuSkinning::setBones(const glm::mat4* transforms, const unsigned int count) {
+	m_bones.resize(count);
+	for (unsigned int i = 0; i < count; i++) {
+		const glm::mat3 normal = glm::inverseTranspose(glm::mat3(transforms[i]));
+		Bone& bone = m_bones[i];
+		for (unsigned int column = 0; column < 4; column++) {
+			for (unsigned int row = 0; row < 4; row++) {
+				bone.position[column][row] = transforms[i][column][row];
+			}
+		}
+		for (unsigned int column = 0; column < 3; column++) {
+			for (unsigned int row = 0; row < 3; row++) {
+				bone.normal[column][row] = normal[column][row];
+			}
+			bone.normal[column][3] = 0.0f;
+		}
+	}
+}
+
+const unsigned int CpuSkinning::getBoneCount() const {
+	return static_cast<unsigned int>(m_bones.size());
+}
+
+void CpuSkinning::skin(const AnimationStack::VertConnection* connections, const Mesh::Data& tPose, Mesh::Data& out, const unsigned int start, const unsigned int end) const {
+	const Bone* bones = m_bones.data();
+
+	for (unsigned int vertex = start; vertex < end; vertex++) {
+		const AnimationStack::VertConnection& connection = connections[vertex];
+
+#ifdef SAIL_SIMD_SSE2
+		Simd::Float4 position[4] = { Simd::Float4::Zero(), Simd::Float4::Zero(), Simd::Float4::Zero(), Simd::Float4::Zero() };
+		Simd::Float4 normal[3] = { Simd::Float4::Zero(), Simd::Float4::Zero(), Simd::Float4::Zero() };
+		for (unsigned int i = 0; i < connection.count; i++) {
+			const Bone& bone = bones[connection.transform[i]];
+			const Simd::Float4 weight = Simd::Float4::Set(connection.weight[i]);
+			for (unsigned int column = 0; column < 4; column++) {
+				position[column] = position[column] + Simd::Float4::Load(bone.position[column]) * weight;
+			}
+			for (unsigned int column = 0; column < 3; column++) {
+				normal[column] = normal[column] + Simd::Float4::Load(bone.normal[column]) * weight;
+			}
+		}
+
+		Store(Transform(position, tPose.positions[vertex].vec) + position[3], out.positions[vertex].vec);
+		Store(Transform(normal, tPose.normals[vertex].vec), out.normals[vertex].vec);
+		Store(Transform(normal, tPose.tangents[vertex].vec), out.tangents[vertex].vec);
+		Store(Transform(normal, tPose.bitangents[vertex].vec), out.bitangents[vertex].vec);
+#else
+		glm::mat4 position = glm::zero<glm::mat4>();
+		glm::mat3 normal = glm::zero<glm::mat3>();
+		for (unsigned int i = 0; i < connection.count; i++) {
+			const Bone& bone = bones[connection.transform[i]];
+			const float weight = connection.weight[i];
+			for (unsigned int column = 0; column < 4; column++) {
+				position[column] += glm::make_vec4(bone.position[column]) * weight;
+			}
+			for (unsigned int column = 0; column < 3; column++) {
+				normal[column] += glm::make_vec3(bone.normal[column]) * weight;
+			}
+		}
+
+		out.positions[vertex].vec = glm::vec3(position * glm::vec4(tPose.positions[vertex].vec, 1.0f));
+		out.normals[vertex].vec = normal * tPose.normals[vertex].vec;
+		out.tangents[vertex].vec = normal * tPose.tangents[vertex].vec;
+		out.bitangents[vertex].vec = normal * tPose.bitangents[vertex].vec;
+#endif
+		out.texCoords[vertex].vec = tPose.texCoords[vertex].vec;
+	}
+}
+
+const unsigned int CpuSkinning::getByteSize() const {
+	return sizeof(*this) + sizeof(Bone) * static_cast<unsigned int>(m_bones.capacity());
+}
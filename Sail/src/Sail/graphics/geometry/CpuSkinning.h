@@ -0,0 +1,30 @@
+#pragma once
+#include "Animation.h"
+#include "Sail/api/Mesh.h"
+
+/*
+	Skins mesh vertices on the CPU, the same way AnimationUpdateComputeShader does on the GPU
+	The normal matrix of every bone is computed once in setBones() and blended with the vertex weights,
+	instead of blending the bone matrices and inverting the result for every vertex
+
+	skin() only reads the bones and writes the vertices in [start, end), so a mesh can be split over several threads
+*/
+class CpuSkinning {
+public:
+	// Has to be called before the vertices are skinned whenever the transforms change
+	void setBones(const glm::mat4* transforms, const unsigned int count);
+	const unsigned int getBoneCount() const;
+
+	// Writes positions, normals, tangents, bitangents and texture coordinates of the vertices in [start, end) to out
+	void skin(const AnimationStack::VertConnection* connections, const Mesh::Data& tPose, Mesh::Data& out, const unsigned int start, const unsigned int end) const;
+
+	const unsigned int getByteSize() const;
+
+private:
+	// Columns of the bone matrix and of the upper 3x3 of its inverse transpose
+	struct alignas(16) Bone {
+		float position[4][4];
+		float normal[3][4];
+	};
+	std::vector<Bone> m_bones;
+};
@@ -11,6 +11,8 @@ Transform::Transform(const glm::vec3& translation, Transform* parent)
 
 Transform::Transform(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale, Transform* parent)
 	: m_parent(parent)
+	, m_root(this)
+	, m_hierarchyIndex(0)
 {
 	m_data.m_current.m_translation = translation;
 	m_data.m_current.m_rotation = rotation;
@@ -36,7 +38,7 @@ Transform::Transform(const glm::vec3& translation, const glm::vec3& rotation, co
 	m_hasChanged = 2;
 
 	if (m_parent)
-		m_parent->addChild(this);
+		attachTo(m_parent);
 }
 
 Transform::~Transform() {
@@ -45,25 +47,49 @@ Transform::~Transform() {
 }
 
 void Transform::setParent(Transform* parent) {
-	if (m_parent) {
-		m_parent->removeChild(this);
-	}
 	m_parent = parent;
-	parent->addChild(this);
+	attachTo(parent);
 	m_parentUpdated = true;
 	treeNeedsUpdating();
 }
 
 void Transform::removeParent() {
 	if (m_parent) {
-		m_parent->removeChild(this);
+		std::vector<HierarchyNode> subtree = detachSubtree();
 		m_parent = nullptr;
+		if (subtree.size() > 1) {
+			m_hierarchy = std::move(subtree);
+			rebuildHierarchy();
+		}
 	}
 	m_matNeedsUpdate = true;
 	m_hasChanged = 3; // TODO: test
 	treeNeedsUpdating();
 }
 
+void Transform::updateHierarchy() {
+	prepareMatrix();
+
+	// Parents come before their children so their matrices are always up to date when the children need them
+	for (size_t i = 1; i < m_hierarchy.size(); i++) {
+		const HierarchyNode& node = m_hierarchy[i];
+		Transform* transform = node.transform;
+		const bool localUpdated = transform->m_matNeedsUpdate;
+		if (localUpdated) {
+			transform->updateLocalMatrix();
+			transform->m_matNeedsUpdate = false;
+		}
+		if (localUpdated || transform->m_parentUpdated) {
+			transform->m_transformMatrix = m_hierarchy[node.parent].transform->m_transformMatrix * transform->m_localTransformMatrix;
+			transform->m_parentUpdated = false;
+		}
+	}
+}
+
+bool Transform::isHierarchyRoot() const {
+	return !m_parent && !m_hierarchy.empty();
+}
+
 // NOTE: Has to be done at the beginning of each update
 // Call from PrepareUpdateSystem and nowhere else!
 void Transform::prepareFixedUpdate() {
@@ -304,11 +330,9 @@ glm::mat4 Transform::getRenderMatrix(float alpha) {
 		// if the data has changed between updates then the matrix will be interpolated every frame
 		updateLocalRenderMatrix(alpha);
 
-		updateRenderMatrix(alpha); // if it has then interpolate
-		if (m_parentRenderUpdated || !m_parent) {
-			updateRenderMatrix(alpha);
-			m_parentRenderUpdated = false;
-		}
+		// Evaluates the parent's render matrix, only once per call
+		updateRenderMatrix(alpha);
+		m_parentRenderUpdated = false;
 	}
 
 	return m_renderMatrix;
@@ -359,35 +383,81 @@ void Transform::treeNeedsUpdating() {
 	if (m_parent) {
 		m_hasChanged = m_parent->getChange() | m_hasChanged;
 	}
-	for (Transform* child : m_children) {
-		child->treeNeedsUpdating();
+
+	// The descendants directly follow this transform and come after their parents, so one pass reaches all of them
+	const std::vector<HierarchyNode>& hierarchy = m_root->m_hierarchy;
+	if (hierarchy.empty()) {
+		return;
+	}
+	for (unsigned int i = m_hierarchyIndex + 1; i < hierarchy[m_hierarchyIndex].end; i++) {
+		Transform* transform = hierarchy[i].transform;
+		transform->m_parentUpdated = true;
+		transform->m_parentRenderUpdated = true;
+		transform->m_hasChanged |= hierarchy[hierarchy[i].parent].transform->m_hasChanged;
 	}
 }
 
-void Transform::addChild(Transform* transform) {
-	for (Transform* t : m_children) {
-		if (t == transform) {
-			return;
+void Transform::attachTo(Transform* parent) {
+	std::vector<HierarchyNode> subtree = detachSubtree();
+
+	Transform* root = parent->m_root;
+	if (root->m_hierarchy.empty()) {
+		root->m_hierarchy.push_back({ root, 0, 1 });
+	}
+	// Last in the parent's subtree, the indices are fixed by rebuildHierarchy()
+	const unsigned int end = root->m_hierarchy[parent->m_hierarchyIndex].end;
+	root->m_hierarchy.insert(root->m_hierarchy.begin() + end, subtree.begin(), subtree.end());
+	root->rebuildHierarchy();
+}
+
+std::vector<Transform::HierarchyNode> Transform::detachSubtree() {
+	std::vector<HierarchyNode> subtree;
+	if (m_root == this) {
+		subtree = std::move(m_hierarchy);
+		m_hierarchy.clear();
+		if (subtree.empty()) {
+			subtree.push_back({ this, 0, 1 });
 		}
+		return subtree;
 	}
-	m_children.push_back(transform);
+
+	Transform* root = m_root;
+	auto first = root->m_hierarchy.begin() + m_hierarchyIndex;
+	auto last = root->m_hierarchy.begin() + root->m_hierarchy[m_hierarchyIndex].end;
+	subtree.assign(first, last);
+	root->m_hierarchy.erase(first, last);
+	if (root->m_hierarchy.size() > 1) {
+		root->rebuildHierarchy();
+	} else {
+		root->m_hierarchy.clear();
+	}
+
+	m_root = this;
+	m_hierarchyIndex = 0;
+	return subtree;
 }
 
-void Transform::removeChild(Transform* Transform) {
-	for (int i = 0; i < m_children.size(); i++) {
-		if (m_children[i] == Transform) {
-			m_children[i] = m_children.back();
-			m_children.pop_back();
-			break;
-		}
+void Transform::rebuildHierarchy() {
+	const unsigned int size = static_cast<unsigned int>(m_hierarchy.size());
+	for (unsigned int i = 0; i < size; i++) {
+		HierarchyNode& node = m_hierarchy[i];
+		node.transform->m_root = this;
+		node.transform->m_hierarchyIndex = i;
+		// Parents come first so their index has already been set
+		node.parent = (i == 0) ? 0 : node.transform->m_parent->m_hierarchyIndex;
+		node.end = i + 1;
+	}
+	for (unsigned int i = size; i-- > 1;) {
+		HierarchyNode& parent = m_hierarchy[m_hierarchy[i].parent];
+		parent.end = std::max(parent.end, m_hierarchy[i].end);
 	}
 }
 
 void Transform::removeChildren() {
-	for (auto child : m_children) {
-		child->removeParent();
+	// The first node after the root is always one of its children
+	while (m_root == this && m_hierarchy.size() > 1) {
+		m_hierarchy[1].transform->removeParent();
 	}
-	m_children.clear();
 }
 
 void Transform::clampRotation() {
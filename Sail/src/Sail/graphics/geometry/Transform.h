@@ -37,6 +37,12 @@ public:
 	void setParent(Transform* parent);
 	void removeParent();
 
+	// Updates the matrices of this transform and all of its descendants in one pass over the hierarchy, parents before children
+	// Only does anything on roots, the other transforms are updated by their root
+	void updateHierarchy();
+	// True for transforms without a parent that have children
+	bool isHierarchyRoot() const;
+
 	void prepareFixedUpdate();
 	void prepareUpdate();
 	TransformSnapshot getCurrentTransformState() const;
@@ -121,7 +127,19 @@ private:
 
 	Transform* m_parent = nullptr;
 
-	std::vector<Transform*> m_children;
+	/*
+		Transforms with a parent or children are stored in a flat array owned by the root of their hierarchy.
+		Every transform comes after its parent and is directly followed by all of its descendants,
+		so the subtree of a transform is the range [index, end) of the array.
+	*/
+	struct HierarchyNode {
+		Transform* transform;
+		unsigned int parent;	// Index of the parent, the root is its own parent
+		unsigned int end;		// One past the last descendant
+	};
+	std::vector<HierarchyNode> m_hierarchy; // Empty unless this is the root of a hierarchy
+	Transform* m_root;
+	unsigned int m_hierarchyIndex;
 private:
 	void updateLocalMatrix();
 	void updateMatrix();
@@ -132,8 +150,12 @@ private:
 	void updateForward();
 
 	void treeNeedsUpdating();
-	void addChild(Transform* transform);
-	void removeChild(Transform* transform);
+	// Moves this transform and its descendants into the hierarchy of parent's root
+	void attachTo(Transform* parent);
+	// Removes this transform and its descendants from the hierarchy they are in, in hierarchy order
+	std::vector<HierarchyNode> detachSubtree();
+	// Sets the indices of all nodes from the order of the array and the parents of the transforms
+	void rebuildHierarchy();
 	void removeChildren();
 	void clampRotation();
 	void clampRotation(float& axis);
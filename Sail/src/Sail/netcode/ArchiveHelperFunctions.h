@@ -2,7 +2,6 @@
 
 #include "glm/vec3.hpp"
 #include "ArchiveTypes.h"
-#include "Sail/../../libraries/cereal/types/vector.hpp"
 
 
 /*
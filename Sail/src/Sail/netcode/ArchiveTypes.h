@@ -1,7 +1,7 @@
 #pragma once
-#include "Sail/../../libraries/cereal/archives/portable_binary.hpp"
+#include "ByteArchive.h"
 
 namespace Netcode {
-	typedef cereal::PortableBinaryOutputArchive OutArchive; // Writes data to archive
-	typedef cereal::PortableBinaryInputArchive  InArchive;  // Loads data from archive
-}
\ No newline at end of file
+	typedef ByteOutArchive OutArchive; // Writes data to archive
+	typedef ByteInArchive  InArchive;  // Loads data from archive
+}
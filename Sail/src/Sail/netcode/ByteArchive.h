@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*
+  Archives that serialize straight into/out of a byte buffer without any streams or allocations.
+
+  They produce the same bytes as cereal's PortableBinary archives which were used before:
+  a single endianness byte (1 = little endian) followed by every value's bytes in little endian order,
+  enums are written as their underlying type and sizes as size_t.
+  Every platform the game runs on is little endian so values are copied as they are.
+*/
+namespace Netcode {
+
+	class ByteOutArchive {
+	public:
+		// Packets larger than this are never expected, writing past it marks the archive as overflowed
+		static const size_t DEFAULT_MAX_SIZE = 1024 * 1024;
+
+		// Writes from the start of buffer, which is only resized when a packet doesn't fit in it.
+		// Keep the buffer between packets so that it doesn't need to allocate once it has grown to the largest packet size.
+		ByteOutArchive(std::vector<char>& buffer, size_t maxSize = DEFAULT_MAX_SIZE)
+			: m_buffer(buffer)
+			, m_size(0)
+			, m_maxSize(maxSize)
+			, m_overflowed(false)
+		{
+			write(std::uint8_t{ 1 });
+		}
+
+		template<typename... Ts>
+		void operator()(const Ts&... values) {
+			(write(values), ...);
+		}
+
+		// Copies bytes as they are, for passing on parts of a packet that was read with a ByteInArchive
+		void writeRaw(const char* src, size_t size) {
+			writeBytes(src, size);
+		}
+
+		const char* data() const { return m_buffer.data(); }
+		size_t size() const { return m_size; }
+		bool hasOverflowed() const { return m_overflowed; }
+
+	private:
+		template<typename T>
+		void write(const T& value) {
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only arithmetic types and enums can be written to an archive");
+			writeBytes(&value, sizeof(T));
+		}
+
+		void writeBytes(const void* src, size_t size) {
+			if (m_size + size > m_buffer.size()) {
+				if (m_size + size > m_maxSize) {
+					m_overflowed = true;
+					return;
+				}
+				m_buffer.resize(std::min(m_maxSize, std::max(m_size + size, m_buffer.size() * 2)));
+			}
+			std::memcpy(m_buffer.data() + m_size, src, size);
+			m_size += size;
+		}
+
+	private:
+		std::vector<char>& m_buffer;
+		size_t m_size;
+		size_t m_maxSize;
+		bool m_overflowed;
+	};
+
+	class ByteInArchive {
+	public:
+		// Reads directly from data, which has to outlive the archive
+		ByteInArchive(const char* data, size_t size)
+			: m_data(data)
+			, m_size(size)
+			, m_position(0)
+			, m_failed(false)
+		{
+			std::uint8_t littleEndian = 0;
+			read(littleEndian);
+			if (littleEndian != 1) {
+				m_failed = true;
+			}
+		}
+
+		template<typename... Ts>
+		void operator()(Ts&... values) {
+			(read(values), ...);
+		}
+
+		// True if the data was too short or not written by a ByteOutArchive, everything read after that is zero
+		bool hasFailed() const { return m_failed; }
+		size_t getRemainingSize() const { return m_size - m_position; }
+		// Offset from the start of the data, including the endianness byte
+		size_t getPosition() const { return m_position; }
+		// Moves past bytes without reading them, for going straight to a part of a packet whose position is known
+		void skip(size_t size) {
+			if (m_failed || m_size - m_position < size) {
+				m_failed = true;
+				return;
+			}
+			m_position += size;
+		}
+
+	private:
+		template<typename T>
+		void read(T& value) {
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only arithmetic types and enums can be read from an archive");
+			if (m_failed || m_size - m_position < sizeof(T)) {
+				m_failed = true;
+				std::memset(&value, 0, sizeof(T));
+				return;
+			}
+			std::memcpy(&value, m_data + m_position, sizeof(T));
+			m_position += sizeof(T);
+		}
+
+	private:
+		const char* m_data;
+		size_t m_size;
+		size_t m_position;
+		bool m_failed;
+	};
+
+}
@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "DeflateCodec.h"
+#include "Sail/utils/Utils.h"
+
+#ifndef ZLIB_CONST
+#define ZLIB_CONST
+#endif
+#include <zlib.h>
+
+namespace {
+	// Same settings as gzip::compress so that the output doesn't change
+	constexpr int GZIP_WINDOW_BITS = 15 + 16;
+	// Detects both gzip and zlib headers, same as gzip::decompress
+	constexpr int AUTO_WINDOW_BITS = 15 + 32;
+	constexpr int MEM_LEVEL = 8;
+}
+
+Netcode::DeflateCodec::DeflateCodec()
+	: m_deflate(nullptr)
+	, m_inflate(nullptr)
+{}
+
+Netcode::DeflateCodec::~DeflateCodec() {
+	if (m_deflate) {
+		deflateEnd(m_deflate);
+		delete m_deflate;
+	}
+	if (m_inflate) {
+		inflateEnd(m_inflate);
+		delete m_inflate;
+	}
+}
+
+void Netcode::DeflateCodec::compress(const char* data, size_t size, std::string& out) {
+	if (!m_deflate) {
+		m_deflate = SAIL_NEW z_stream();
+		if (deflateInit2(m_deflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+			SAIL_LOG_ERROR("Failed to initialize packet compression");
+		}
+	}
+
+	deflateReset(m_deflate);
+	m_deflate->next_in = reinterpret_cast<z_const Bytef*>(data);
+	m_deflate->avail_in = static_cast<unsigned int>(size);
+
+	// Use all of the capacity the string already has before growing it
+	const size_t start = out.size();
+	out.resize(std::max(out.capacity(), start + static_cast<size_t>(deflateBound(m_deflate, static_cast<uLong>(size)))));
+	size_t compressedSize = start;
+	while (true) {
+		m_deflate->next_out = reinterpret_cast<Bytef*>(&out[0] + compressedSize);
+		m_deflate->avail_out = static_cast<unsigned int>(out.size() - compressedSize);
+		const int ret = deflate(m_deflate, Z_FINISH);
+		compressedSize = out.size() - m_deflate->avail_out;
+		if (ret == Z_STREAM_END) {
+			break;
+		}
+		out.resize(out.size() * 2);
+	}
+	out.resize(compressedSize);
+}
+
+bool Netcode::DeflateCodec::decompress(const char* data, size_t size, std::vector<char>& out) {
+	if (!m_inflate) {
+		m_inflate = SAIL_NEW z_stream();
+		if (inflateInit2(m_inflate, AUTO_WINDOW_BITS) != Z_OK) {
+			SAIL_LOG_ERROR("Failed to initialize packet decompression");
+		}
+	}
+
+	inflateReset(m_inflate);
+	m_inflate->next_in = reinterpret_cast<z_const Bytef*>(data);
+	m_inflate->avail_in = static_cast<unsigned int>(size);
+
+	// Use all of the capacity the buffer already has, it's only grown when a packet doesn't fit
+	out.resize(out.capacity() > 0 ? out.capacity() : size * 2);
+	size_t decompressedSize = 0;
+	while (true) {
+		m_inflate->next_out = reinterpret_cast<Bytef*>(out.data() + decompressedSize);
+		m_inflate->avail_out = static_cast<unsigned int>(out.size() - decompressedSize);
+		const int ret = inflate(m_inflate, Z_FINISH);
+		decompressedSize = out.size() - m_inflate->avail_out;
+		if (ret == Z_STREAM_END) {
+			break;
+		}
+		// Z_BUF_ERROR only means that more output space is needed as long as there is input left
+		if ((ret != Z_OK && ret != Z_BUF_ERROR) || (m_inflate->avail_out != 0 && m_inflate->avail_in == 0)) {
+			out.resize(0);
+			return false;
+		}
+		out.resize(out.size() * 2);
+	}
+	out.resize(decompressedSize);
+	return true;
+}
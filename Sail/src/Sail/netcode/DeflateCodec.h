@@ -0,0 +1,30 @@
+#pragma once
+
+#include "PacketCodec.h"
+
+typedef struct z_stream_s z_stream;
+
+namespace Netcode {
+	/*
+	  Gzip compression with zlib streams that are kept between packets.
+	  gzip::compress/decompress set up a new stream, which allocates a few hundred KB, and a new output string for every packet,
+	  this resets the same streams and writes into buffers owned by the caller which keep their capacity.
+	  The output is identical to gzip::compress and anything gzip::decompress can read can be decompressed.
+
+	  The streams are only created once they are used since most packets use other codecs.
+	*/
+	class DeflateCodec : public PacketCodec {
+	public:
+		DeflateCodec();
+		~DeflateCodec();
+		DeflateCodec(const DeflateCodec&) = delete;
+		DeflateCodec& operator=(const DeflateCodec&) = delete;
+
+		void compress(const char* data, size_t size, std::string& out) override;
+		bool decompress(const char* data, size_t size, std::vector<char>& out) override;
+
+	private:
+		z_stream* m_deflate;
+		z_stream* m_inflate;
+	};
+}
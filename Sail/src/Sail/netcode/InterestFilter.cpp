@@ -0,0 +1,213 @@
+#include "pch.h"
+#include "InterestFilter.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+
+namespace Netcode {
+	void InterestFilter::setSettings(const Settings& settings) {
+		m_settings = settings;
+	}
+
+	const InterestFilter::Settings& InterestFilter::getSettings() const {
+		return m_settings;
+	}
+
+	void InterestFilter::clear() {
+		// A player who left doesn't have anything, in case the ID is given to someone else
+		for (auto it = m_relevantEntities.begin(); it != m_relevantEntities.end();) {
+			const PlayerID id = it->first;
+			const bool isViewer = std::any_of(m_viewers.begin(), m_viewers.end(), [id](const Viewer& viewer) { return viewer.id == id; });
+			it = isViewer ? std::next(it) : m_relevantEntities.erase(it);
+		}
+
+		m_tick++;
+		for (auto it = m_snapshots.begin(); it != m_snapshots.end();) {
+			if (m_tick - it->second.lastTick <= FORGET_AFTER_TICKS) {
+				++it;
+				continue;
+			}
+			for (auto& [viewer, relevant] : m_relevantEntities) {
+				relevant.erase(it->first);
+			}
+			it = m_snapshots.erase(it);
+		}
+
+		m_viewers.clear();
+		m_players.clear();
+		m_entities.clear();
+	}
+
+	void InterestFilter::setPlayer(PlayerID id, const glm::vec3& position, int room, char team) {
+		m_players[id] = { position, room, team };
+	}
+
+	void InterestFilter::setEntity(ComponentID id, const glm::vec3& position, int room) {
+		m_entities[id] = { position, room, -1 };
+	}
+
+	void InterestFilter::addViewer(PlayerID id, char team) {
+		Viewer viewer = { id, team, false, { glm::vec3(0.f), -1, team } };
+		auto it = m_players.find(id);
+		if (it != m_players.end()) {
+			viewer.hasPosition = true;
+			viewer.location = it->second;
+		}
+		m_viewers.push_back(viewer);
+	}
+
+	PlayerID InterestFilter::getViewer(size_t index) const {
+		return m_viewers[index].id;
+	}
+
+	bool InterestFilter::filter(const char* data, size_t size, std::vector<std::vector<char>>& out) {
+		if (!m_packet.parse(data, size)) {
+			return false;
+		}
+		const std::vector<StatePacket::Entity>& entities = m_packet.getEntities();
+		const std::vector<StatePacket::Message>& messages = m_packet.getMessages();
+		const PlayerID sender = m_packet.getSender();
+
+		// The latest fields of every entity, for the viewers it becomes relevant to
+		InArchive snapshotAr(data, size);
+		for (const StatePacket::Entity& entity : entities) {
+			for (size_t m = entity.firstMessage; m < entity.firstMessage + entity.numMessages; m++) {
+				if (messages[m].type != MessageType::TRANSFORM_SNAPSHOT) {
+					continue;
+				}
+				snapshotAr.skip(messages[m].begin + sizeof(MessageType) - snapshotAr.getPosition());
+				Snapshot& snapshot = m_snapshots[entity.id];
+				TransformSnapshot::Merge(snapshotAr, snapshot.latest);
+				snapshot.lastTick = m_tick;
+			}
+		}
+
+		out.resize(m_viewers.size());
+		for (size_t v = 0; v < m_viewers.size(); v++) {
+			const Viewer& viewer = m_viewers[v];
+			out[v].clear();
+			// Clients ignore the packets they sent themselves
+			if (viewer.id == sender) {
+				continue;
+			}
+
+			// Which messages to keep, entities without any are left out
+			std::unordered_map<ComponentID, std::uint8_t>& relevantEntities = m_relevantEntities[viewer.id];
+			m_keptMessages.clear();
+			size_t numEntities = 0;
+			for (const StatePacket::Entity& entity : entities) {
+				const bool relevant = isRelevant(entity, viewer);
+				if (relevant) {
+					relevantEntities.try_emplace(entity.id, static_cast<std::uint8_t>(TransformSnapshot::REDUNDANCY));
+				} else {
+					relevantEntities.erase(entity.id);
+				}
+				const size_t kept = m_keptMessages.size();
+				for (size_t m = entity.firstMessage; m < entity.firstMessage + entity.numMessages; m++) {
+					if (relevant || (messages[m].type == MessageType::TRANSFORM_SNAPSHOT && TransformSnapshot::IsKeyframe(entity.id, messages[m].sequence))) {
+						m_keptMessages.push_back(m);
+					}
+				}
+				numEntities += (m_keptMessages.size() > kept);
+			}
+
+			m_stats.entitiesIn += entities.size();
+			m_stats.entitiesOut += numEntities;
+			m_stats.bytesIn += size;
+			if (numEntities == 0) {
+				continue;
+			}
+
+			// Same layout as the packet that was read, see NetworkSenderSystem::update()
+			OutArchive ar(out[v]);
+			ar(sender);
+			ar(numEntities);
+			size_t k = 0;
+			for (const StatePacket::Entity& entity : entities) {
+				size_t numKept = 0;
+				while (k + numKept < m_keptMessages.size() && m_keptMessages[k + numKept] < entity.firstMessage + entity.numMessages) {
+					numKept++;
+				}
+				if (numKept == 0) {
+					continue;
+				}
+
+				ar(entity.id);
+				ar(entity.type);
+				ar(numKept);
+				auto relevant = relevantEntities.find(entity.id);
+				for (size_t i = 0; i < numKept; i++) {
+					const StatePacket::Message& message = messages[m_keptMessages[k + i]];
+					// Just became relevant, the fields that changed before that may not be in the snapshot
+					if (message.type == MessageType::TRANSFORM_SNAPSHOT && relevant != relevantEntities.end() && relevant->second > 0) {
+						ar(message.type);
+						TransformSnapshot::WriteLatest(m_snapshots[entity.id].latest, ar);
+						relevant->second--;
+						continue;
+					}
+					ar.writeRaw(data + message.begin, message.end - message.begin);
+				}
+				k += numKept;
+			}
+			ar(size_t{ 0 }); // nrOfEvents
+
+			out[v].resize(ar.size());
+			m_stats.bytesOut += ar.size();
+		}
+		m_stats.packets++;
+		return true;
+	}
+
+	const InterestFilter::Stats& InterestFilter::getStats() const {
+		return m_stats;
+	}
+
+	void InterestFilter::resetStats() {
+		m_stats = Stats();
+	}
+
+	size_t InterestFilter::getByteSize() const {
+		size_t size = sizeof(*this);
+		size += m_viewers.capacity() * sizeof(Viewer);
+		size += m_players.size() * (sizeof(PlayerID) + sizeof(Location) + 2 * sizeof(void*));
+		size += m_entities.size() * (sizeof(ComponentID) + sizeof(Location) + 2 * sizeof(void*));
+		size += m_packet.getByteSize() - sizeof(m_packet);
+		size += m_keptMessages.capacity() * sizeof(size_t);
+		size += m_snapshots.size() * (sizeof(ComponentID) + sizeof(Snapshot) + 2 * sizeof(void*));
+		for (const auto& [viewer, relevant] : m_relevantEntities) {
+			size += sizeof(PlayerID) + sizeof(relevant) + 2 * sizeof(void*);
+			size += relevant.size() * (sizeof(ComponentID) + sizeof(std::uint8_t) + 2 * sizeof(void*));
+		}
+		return size;
+	}
+
+	bool InterestFilter::isRelevant(const StatePacket::Entity& entity, const Viewer& viewer) const {
+		if (!viewer.hasPosition) {
+			return true;
+		}
+
+		const Location* location = nullptr;
+		const PlayerID owner = getComponentOwner(entity.id);
+		if (owner < NONE_PLAYER_ID_START) {
+			auto it = m_players.find(owner);
+			location = (it != m_players.end()) ? &it->second : nullptr;
+		} else {
+			auto it = m_entities.find(entity.id);
+			location = (it != m_entities.end()) ? &it->second : nullptr;
+		}
+		// Nothing is known about where it is, so it could be anywhere
+		if (!location) {
+			return true;
+		}
+
+		if (m_settings.teammates && viewer.team != -1 && location->team == viewer.team) {
+			return true;
+		}
+		if (m_settings.sameRoom && viewer.location.room > 0 && location->room == viewer.location.room) {
+			return true;
+		}
+		const glm::vec3 difference = location->position - viewer.location.position;
+		return glm::dot(difference, difference) <= m_settings.distance * m_settings.distance;
+	}
+}
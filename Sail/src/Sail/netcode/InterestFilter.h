@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ArchiveTypes.h"
+#include "NetworkedStructs.h"
+#include "StatePacket.h"
+#include "TransformSnapshot.h"
+
+#include <glm/vec3.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+/*
+  Host side interest management for the per-tick state packets that are forwarded to the clients.
+
+  Instead of forwarding every state packet to every client, the host splits it into one packet per client with only
+  the entities that are relevant to that client: entities close to the client's player, in the same room as it or
+  owned by one of its teammates. Clients without a player (spectators and dead players) get everything.
+  Entities owned by a player count as being where the player is, other entities need their position set.
+
+  Only the keyframes of the other entities are forwarded, which is every TransformSnapshot::KEYFRAME_INTERVAL ticks,
+  and their animations are left out. Snapshots never depend on the ones before them, so the packets are split by
+  copying bytes. The exception is an entity that becomes relevant to a viewer: the fields that changed while it wasn't
+  relevant may not be in its next snapshots, so the viewer gets the latest value of every field of it instead, in its
+  next TransformSnapshot::REDUNDANCY snapshots.
+
+  Only packets with TRANSFORM_SNAPSHOT and ANIMATION messages and no events can be split, which is what
+  NetworkSenderSystem sends over the unreliable channel. filter() fails for anything else.
+*/
+namespace Netcode {
+	class InterestFilter {
+	public:
+		struct Settings {
+			float distance = 30.f;  // Everything within this distance of a viewer is relevant to it
+			bool sameRoom = true;   // Everything in the same room as a viewer is relevant to it, corridors don't count
+			bool teammates = true;  // Everything owned by a viewer's teammates is relevant to it
+		};
+
+		// Totals since the last resetStats(), summed over all viewers
+		struct Stats {
+			size_t packets = 0;
+			size_t entitiesIn = 0;
+			size_t entitiesOut = 0;
+			size_t bytesIn = 0;
+			size_t bytesOut = 0;
+		};
+
+		void setSettings(const Settings& settings);
+		const Settings& getSettings() const;
+
+		// Forgets the viewers and positions, called every tick before they are set again.
+		// What was relevant to each viewer is kept until the viewer isn't added any more
+		void clear();
+		// room is from LevelSystem::getRoomIDFromWorldPos() where 0 is a corridor, team is -1 for no team
+		void setPlayer(PlayerID id, const glm::vec3& position, int room, char team);
+		void setEntity(ComponentID id, const glm::vec3& position, int room);
+		// A client that packets are split for, placed where its player is if setPlayer() has been called for it
+		void addViewer(PlayerID id, char team);
+		PlayerID getViewer(size_t index) const;
+
+		/*
+		  Splits a decompressed state packet into one packet per viewer, out[i] is the packet for the i:th viewer that was added.
+		  out[i] is left empty when nothing in the packet is relevant to the viewer, or when the viewer sent it.
+		  Returns false if the packet couldn't be split, it should be forwarded to everyone as it is then.
+		*/
+		bool filter(const char* data, size_t size, std::vector<std::vector<char>>& out);
+
+		const Stats& getStats() const;
+		void resetStats();
+
+		size_t getByteSize() const;
+
+	private:
+		struct Location {
+			glm::vec3 position;
+			int room;
+			char team;
+		};
+
+		struct Viewer {
+			PlayerID id;
+			char team;
+			bool hasPosition; // Viewers without a player, spectators and dead players, get everything
+			Location location;
+		};
+
+		struct Snapshot {
+			TransformSnapshot::Latest latest;
+			size_t lastTick; // The last tick it was in a packet, entities that are gone stop sending snapshots
+		};
+
+		bool isRelevant(const StatePacket::Entity& entity, const Viewer& viewer) const;
+
+	private:
+		// Entities that haven't sent a snapshot in this many ticks are forgotten
+		static constexpr size_t FORGET_AFTER_TICKS = 60;
+
+		Settings m_settings;
+		std::vector<Viewer> m_viewers;
+		std::unordered_map<PlayerID, Location> m_players;
+		std::unordered_map<ComponentID, Location> m_entities;
+
+		size_t m_tick = 0;
+		std::unordered_map<ComponentID, Snapshot> m_snapshots;
+		// The entities that were relevant to each viewer the last time they were in a packet,
+		// and how many more of their snapshots should be sent with every field
+		std::unordered_map<PlayerID, std::unordered_map<ComponentID, std::uint8_t>> m_relevantEntities;
+
+		// Reused for every packet
+		StatePacket m_packet;
+		std::vector<size_t> m_keptMessages;
+
+		Stats m_stats;
+	};
+}
@@ -0,0 +1,327 @@
+#include "pch.h"
+#include "KeyframeEvents.h"
+#include "TransformSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	constexpr size_t COMPONENT_ID_SIZE = sizeof(Netcode::ComponentID);
+	constexpr size_t PLAYER_ID_SIZE = sizeof(Netcode::PlayerID);
+	constexpr size_t VEC3_SIZE = 3 * sizeof(float);
+	// Per player and for the whole match, see NetworkSenderSystem::writeEventToArchive()
+	constexpr size_t PLAYER_STATS_SIZE = PLAYER_ID_SIZE + 5 * sizeof(int);
+	constexpr size_t MATCH_STATS_SIZE = 2 * sizeof(int) + sizeof(float) + 3 * PLAYER_ID_SIZE;
+	// A water message never gets much larger than this
+	constexpr size_t MAX_WATER_CELLS_PER_MESSAGE = 1024;
+
+	// Size of the data after the MessageType of the messages that always have the same size, has to match what
+	// NetworkSenderSystem writes. Returns false for the messages whose size depends on what's in them.
+	bool FixedSize(Netcode::MessageType type, size_t& size) {
+		switch (type) {
+		case Netcode::MessageType::ANIMATION:                   size = sizeof(unsigned int) + 2 * sizeof(float); return true;
+		case Netcode::MessageType::CANDLE_HELD_STATE:           size = COMPONENT_ID_SIZE + sizeof(bool); return true;
+		case Netcode::MessageType::CHANGE_ABSOLUTE_POS_AND_ROT: size = VEC3_SIZE + 4 * sizeof(float); return true;
+		case Netcode::MessageType::CHANGE_LOCAL_POSITION:       size = VEC3_SIZE; return true;
+		case Netcode::MessageType::CHANGE_LOCAL_ROTATION:       size = VEC3_SIZE; return true;
+		case Netcode::MessageType::DESTROY_ENTITY:              size = 0; return true;
+		case Netcode::MessageType::DESTROY_POWER_UP:            size = 2 * COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::ENABLE_SPRINKLERS:           size = 0; return true;
+		case Netcode::MessageType::EXTINGUISH_CANDLE:           size = COMPONENT_ID_SIZE + PLAYER_ID_SIZE; return true;
+		case Netcode::MessageType::HIT_BY_SPRINKLER:            size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::IGNITE_CANDLE:               size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::MATCH_ENDED:                 size = 0; return true;
+		case Netcode::MessageType::PLAYER_DIED:                 size = 2 * COMPONENT_ID_SIZE + sizeof(bool); return true;
+		case Netcode::MessageType::PLAYER_JUMPED:               size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::PLAYER_LANDED:               size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::PREPARE_ENDSCREEN:           size = 2 * sizeof(int) + sizeof(float); return true;
+		case Netcode::MessageType::RUNNING_METAL_START:         size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::RUNNING_TILE_START:          size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::RUNNING_WATER_METAL_START:   size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::RUNNING_WATER_TILE_START:    size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::RUNNING_STOP_SOUND:          size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::SET_CANDLE_HEALTH:           size = COMPONENT_ID_SIZE + sizeof(float); return true;
+		case Netcode::MessageType::SET_CENTER:                  size = COMPONENT_ID_SIZE + VEC3_SIZE; return true;
+		case Netcode::MessageType::SHOOT_START:                 size = sizeof(float); return true;
+		case Netcode::MessageType::SHOOT_LOOP:                  size = sizeof(float); return true;
+		case Netcode::MessageType::SHOOT_END:                   size = sizeof(float); return true;
+		case Netcode::MessageType::SPAWN_POWER_UP:              size = sizeof(int) + VEC3_SIZE + 2 * COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::SPAWN_PROJECTILE:            size = 2 * VEC3_SIZE + 2 * COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::START_THROWING:              size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::STOP_THROWING:               size = COMPONENT_ID_SIZE; return true;
+		case Netcode::MessageType::UPDATE_PROJECTILE_ONCE:      size = 2 * VEC3_SIZE; return true;
+		case Netcode::MessageType::UPDATE_SANITY:               size = sizeof(float); return true;
+		case Netcode::MessageType::WATER_HIT_PLAYER:            size = 2 * COMPONENT_ID_SIZE; return true;
+		default:                                                return false;
+		}
+	}
+
+	template<typename T>
+	T Load(const char* data) {
+		T value;
+		std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+}
+
+namespace Netcode {
+	bool KeyframeEvents::read(const char* data, size_t size) {
+		InArchive ar(data, size);
+		PlayerID sender = 0;
+		size_t numComponents = 0;
+		ar(sender);
+		ar(numComponents);
+		// Every component and event takes more than one byte, anything larger is a broken packet
+		if (numComponents > size) {
+			return false;
+		}
+
+		for (size_t i = 0; i < numComponents; i++) {
+			ComponentID id = 0;
+			EntityType type = EntityType::INVALID_ENTITY;
+			size_t numMessages = 0;
+			ar(id);
+			ar(type);
+			ar(numMessages);
+			if (numMessages > size) {
+				return false;
+			}
+			for (size_t j = 0; j < numMessages; j++) {
+				if (!readComponentMessage(ar, data, id, type)) {
+					return false;
+				}
+			}
+		}
+
+		size_t numEvents = 0;
+		ar(numEvents);
+		if (numEvents > size) {
+			return false;
+		}
+		for (size_t i = 0; i < numEvents; i++) {
+			if (!readEvent(ar, data)) {
+				return false;
+			}
+		}
+		return !ar.hasFailed();
+	}
+
+	void KeyframeEvents::clear() {
+		m_sanity.clear();
+		m_heldStates.clear();
+		m_centers.clear();
+		m_healths.clear();
+		m_unlit.clear();
+		m_powerUps.clear();
+		m_waterHits.clear();
+		m_sprinklersEnabled = false;
+		m_lastingEvents.clear();
+		m_numLastingEvents = 0;
+	}
+
+	void KeyframeEvents::writePackets(std::vector<char>& buffer, size_t maxPacketSize, const std::function<void(const OutArchive&)>& onPacket) const {
+		// Sent by the host in the match, the sender is only used to tell who a broken packet came from
+		constexpr PlayerID SENDER = 0;
+
+		// The sanity of the players goes in the sender components, as it does every tick in the match
+		auto sanity = m_sanity.begin();
+		while (sanity != m_sanity.end()) {
+			auto last = sanity;
+			size_t size = 0;
+			size_t numComponents = 0;
+			for (; last != m_sanity.end() && size < maxPacketSize; ++last) {
+				size += sizeof(ComponentID) + sizeof(EntityType) + sizeof(size_t) + last->second.message.size();
+				numComponents++;
+			}
+
+			OutArchive ar(buffer);
+			ar(SENDER);
+			ar(numComponents);
+			for (; sanity != last; ++sanity) {
+				ar(sanity->first);
+				ar(sanity->second.type);
+				ar(size_t{ 1 });
+				ar.writeRaw(sanity->second.message.data(), sanity->second.message.size());
+			}
+			ar(size_t{ 0 }); // nrOfEvents
+			onPacket(ar);
+		}
+
+		// The events, in the order they have to be applied in: the candles before the deaths that take them away
+		std::vector<char> events;
+		size_t numEvents = 0;
+		auto flush = [&](bool last) {
+			if (numEvents == 0 || (!last && events.size() < maxPacketSize)) {
+				return;
+			}
+			OutArchive ar(buffer);
+			ar(SENDER);
+			ar(size_t{ 0 }); // nrOfSenderComponents
+			ar(numEvents);
+			ar.writeRaw(events.data(), events.size());
+			onPacket(ar);
+			events.clear();
+			numEvents = 0;
+		};
+		auto add = [&](const std::vector<char>& message) {
+			events.insert(events.end(), message.begin(), message.end());
+			numEvents++;
+			flush(false);
+		};
+
+		for (const auto* messages : { &m_heldStates, &m_centers, &m_healths, &m_unlit, &m_powerUps }) {
+			for (const auto& [id, message] : *messages) {
+				add(message);
+			}
+		}
+		if (m_sprinklersEnabled) {
+			add({ static_cast<char>(MessageType::ENABLE_SPRINKLERS) });
+		}
+
+		// Cells with more hits than fit in one message are added to again by the next one
+		std::map<std::uint32_t, unsigned int> waterHits = m_waterHits;
+		std::vector<char> water;
+		WaterCells cells;
+		while (!waterHits.empty()) {
+			cells.clear();
+			size_t numCells = 0;
+			for (auto it = waterHits.begin(); it != waterHits.end() && numCells < MAX_WATER_CELLS_PER_MESSAGE; numCells++) {
+				const unsigned int hits = std::min(it->second, 255u);
+				cells.addCell(it->first, hits);
+				it->second -= hits;
+				it = (it->second == 0) ? waterHits.erase(it) : std::next(it);
+			}
+
+			OutArchive ar(water);
+			ar(MessageType::SUBMIT_WATER_POINTS);
+			cells.write(ar);
+			// Without the endianness byte the archive starts with
+			add(std::vector<char>(ar.data() + sizeof(std::uint8_t), ar.data() + ar.size()));
+		}
+
+		if (m_numLastingEvents > 0) {
+			events.insert(events.end(), m_lastingEvents.begin(), m_lastingEvents.end());
+			numEvents += m_numLastingEvents;
+		}
+		flush(true);
+	}
+
+	size_t KeyframeEvents::getByteSize() const {
+		size_t size = sizeof(*this) + m_lastingEvents.capacity() + m_waterCells.getByteSize();
+		size += m_waterHits.size() * (sizeof(std::uint32_t) + sizeof(unsigned int));
+		for (const auto& [id, sanity] : m_sanity) {
+			size += sizeof(id) + sizeof(sanity) + sanity.message.capacity();
+		}
+		for (const auto* messages : { &m_heldStates, &m_centers, &m_healths, &m_unlit, &m_powerUps }) {
+			for (const auto& [id, message] : *messages) {
+				size += sizeof(id) + sizeof(message) + message.capacity();
+			}
+		}
+		return size;
+	}
+
+	bool KeyframeEvents::readComponentMessage(InArchive& ar, const char* data, ComponentID id, EntityType type) {
+		const size_t begin = ar.getPosition();
+		MessageType messageType;
+		ar(messageType);
+
+		size_t size = 0;
+		if (messageType == MessageType::TRANSFORM_SNAPSHOT) {
+			// The per-tick state is kept by the ReplayWriter from the state packets
+			TransformSnapshot::Skip(ar);
+		} else if (FixedSize(messageType, size)) {
+			ar.skip(size);
+		} else {
+			return false;
+		}
+		if (ar.hasFailed()) {
+			return false;
+		}
+
+		if (messageType == MessageType::UPDATE_SANITY) {
+			ComponentMessage& sanity = m_sanity[id];
+			sanity.type = type;
+			sanity.message.assign(data + begin, data + ar.getPosition());
+		}
+		return true;
+	}
+
+	bool KeyframeEvents::readEvent(InArchive& ar, const char* data) {
+		const size_t begin = ar.getPosition();
+		MessageType messageType;
+		ar(messageType);
+
+		size_t size = 0;
+		if (messageType == MessageType::SUBMIT_WATER_POINTS) {
+			if (!m_waterCells.read(ar)) {
+				return false;
+			}
+			for (const WaterCells::Cell& cell : m_waterCells.getCells()) {
+				m_waterHits[cell.index] += cell.hits;
+			}
+			return true;
+		} else if (messageType == MessageType::ENDGAME_STATS) {
+			size_t numPlayers = 0;
+			ar(numPlayers);
+			if (numPlayers > ar.getRemainingSize()) {
+				return false;
+			}
+			ar.skip(numPlayers * PLAYER_STATS_SIZE + MATCH_STATS_SIZE);
+		} else if (FixedSize(messageType, size)) {
+			ar.skip(size);
+		} else {
+			return false;
+		}
+		if (ar.hasFailed()) {
+			return false;
+		}
+
+		// Every event starts with its MessageType and most of them with the entity they are about
+		const char* message = data + begin;
+		const char* end = data + ar.getPosition();
+		const ComponentID id = (end - message >= static_cast<std::ptrdiff_t>(sizeof(MessageType) + sizeof(ComponentID))) ? Load<ComponentID>(message + sizeof(MessageType)) : 0;
+
+		switch (messageType) {
+		case MessageType::CANDLE_HELD_STATE:
+			// Candles are held at the start of a match
+			if (Load<bool>(message + sizeof(MessageType) + sizeof(ComponentID))) {
+				m_heldStates.erase(id);
+			} else {
+				m_heldStates[id].assign(message, end);
+			}
+			break;
+		case MessageType::DESTROY_POWER_UP:
+			m_powerUps.erase(id);
+			break;
+		case MessageType::ENABLE_SPRINKLERS:
+			m_sprinklersEnabled = true;
+			break;
+		case MessageType::ENDGAME_STATS:
+		case MessageType::MATCH_ENDED:
+		case MessageType::PLAYER_DIED:
+			m_lastingEvents.insert(m_lastingEvents.end(), message, end);
+			m_numLastingEvents++;
+			break;
+		case MessageType::EXTINGUISH_CANDLE:
+			m_unlit[id].assign(message, end);
+			break;
+		case MessageType::IGNITE_CANDLE:
+			m_unlit.erase(id);
+			break;
+		case MessageType::SET_CANDLE_HEALTH:
+			m_healths[id].assign(message, end);
+			break;
+		case MessageType::SET_CENTER:
+			m_centers[id].assign(message, end);
+			break;
+		case MessageType::SPAWN_POWER_UP:
+			// The power-up's ID comes after its type and position
+			m_powerUps[Load<ComponentID>(message + sizeof(MessageType) + sizeof(int) + VEC3_SIZE)].assign(message, end);
+			break;
+		default:
+			// Sounds and effects, and the hits that the host has already turned into health
+			break;
+		}
+		return true;
+	}
+}
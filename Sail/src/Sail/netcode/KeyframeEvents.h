@@ -0,0 +1,64 @@
+#pragma once
+
+#include "NetworkedStructs.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace Netcode {
+	/*
+	  Keeps what the events of a match have built up so far, so that a replay keyframe can rebuild the world of a new
+	  match without the ticks before it: the latest health, lit and held state and center of every candle, the sanity
+	  of every player, the power-ups that are lying around, whether the sprinklers are on, all water that has been shot,
+	  every death in the order they happened and the end of the match.
+
+	  Events that only play a sound or an effect are left out, and so are projectiles that are in the air and power-ups
+	  that have been picked up, since they only last a few seconds and can't be given their remaining time by a message.
+	  Everything a projectile hits is in the events it causes.
+
+	  The messages are kept in the layout NetworkSenderSystem writes them in, so that they can be copied into keyframe
+	  packets as they are. Water is the only exception, its hits are added up per water cell.
+	*/
+	class KeyframeEvents {
+	public:
+		// Reads the sender component messages and events of a decompressed packet.
+		// Returns false if the packet couldn't be read to the end, the messages before that are still kept.
+		bool read(const char* data, size_t size);
+		void clear();
+
+		// Writes packets with the messages that rebuild the state into buffer, in the same layout as the packets they
+		// were read from, and calls onPacket with each of them. Each packet is about maxPacketSize or smaller.
+		void writePackets(std::vector<char>& buffer, size_t maxPacketSize, const std::function<void(const OutArchive&)>& onPacket) const;
+
+		size_t getByteSize() const;
+
+	private:
+		// A sender component message that is kept until it's replaced
+		struct ComponentMessage {
+			EntityType type = EntityType::INVALID_ENTITY;
+			std::vector<char> message;
+		};
+
+		bool readComponentMessage(InArchive& ar, const char* data, ComponentID id, EntityType type);
+		bool readEvent(InArchive& ar, const char* data);
+
+	private:
+		// Latest UPDATE_SANITY of every player
+		std::map<ComponentID, ComponentMessage> m_sanity;
+		// Latest event per entity, sorted so that the same recording always gives the same keyframes
+		std::map<ComponentID, std::vector<char>> m_heldStates; // CANDLE_HELD_STATE, only while the candle is put down
+		std::map<ComponentID, std::vector<char>> m_centers;    // SET_CENTER
+		std::map<ComponentID, std::vector<char>> m_healths;    // SET_CANDLE_HEALTH
+		std::map<ComponentID, std::vector<char>> m_unlit;      // EXTINGUISH_CANDLE, until the candle is ignited again
+		std::map<ComponentID, std::vector<char>> m_powerUps;   // SPAWN_POWER_UP, until the power-up is picked up
+		// Hits per water cell, since the start of the match
+		std::map<std::uint32_t, unsigned int> m_waterHits;
+		WaterCells m_waterCells;
+		bool m_sprinklersEnabled = false;
+		// PLAYER_DIED, MATCH_ENDED and ENDGAME_STATS in the order they were read
+		std::vector<char> m_lastingEvents;
+		size_t m_numLastingEvents = 0;
+	};
+}
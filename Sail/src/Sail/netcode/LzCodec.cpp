@@ -0,0 +1,244 @@
+#include "pch.h"
+#include "LzCodec.h"
+#include "ByteArchive.h"
+#include "PacketDictionary.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	constexpr size_t MIN_MATCH = 4;
+	constexpr size_t LAST_LITERALS = 5;  // The last bytes are always literals, same as LZ4
+	constexpr size_t MATCH_FIND_LIMIT = 12; // No match starts within the last bytes, same as LZ4
+	constexpr size_t MAX_OFFSET = 65535;
+	constexpr unsigned int HASH_LOG = 12;
+	constexpr unsigned int SKIP_TRIGGER = 6;   // Look for matches less often the longer it has been since the last one
+	constexpr size_t MAX_PACKET_SIZE = Netcode::ByteOutArchive::DEFAULT_MAX_SIZE;
+
+	std::uint32_t Read32(const char* p) {
+		std::uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	std::uint32_t Hash(std::uint32_t sequence) {
+		return (sequence * 2654435761u) >> (32 - HASH_LOG);
+	}
+
+	// Lengths of 15 and above continue in the following bytes, 255 at a time
+	std::uint8_t* WriteLength(std::uint8_t* op, size_t length) {
+		length -= 15;
+		while (length >= 255) {
+			*op++ = 255;
+			length -= 255;
+		}
+		*op++ = static_cast<std::uint8_t>(length);
+		return op;
+	}
+
+	bool ReadLength(const std::uint8_t*& ip, const std::uint8_t* end, size_t& length) {
+		std::uint8_t b;
+		do {
+			if (ip >= end) {
+				return false;
+			}
+			b = *ip++;
+			length += b;
+		} while (b == 255);
+		return true;
+	}
+
+	std::uint8_t* WriteLiterals(std::uint8_t* op, std::uint8_t*& token, const char* literals, size_t numLiterals) {
+		token = op++;
+		if (numLiterals >= 15) {
+			*token = 15 << 4;
+			op = WriteLength(op, numLiterals);
+		} else {
+			*token = static_cast<std::uint8_t>(numLiterals << 4);
+		}
+		std::memcpy(op, literals, numLiterals);
+		return op + numLiterals;
+	}
+
+	std::uint8_t* WriteMatch(std::uint8_t* op, std::uint8_t* token, size_t offset, size_t length) {
+		*op++ = static_cast<std::uint8_t>(offset & 0xFF);
+		*op++ = static_cast<std::uint8_t>(offset >> 8);
+		length -= MIN_MATCH;
+		if (length >= 15) {
+			*token |= 15;
+			return WriteLength(op, length);
+		}
+		*token |= static_cast<std::uint8_t>(length);
+		return op;
+	}
+}
+
+Netcode::LzCodec::LzCodec(const PacketDictionary* dictionary)
+	: m_dictionary(nullptr)
+	, m_dictionarySize(0)
+	, m_table(size_t{ 1 } << HASH_LOG)
+{
+	if (dictionary && !dictionary->empty()) {
+		// Offsets can't reach further back than MAX_OFFSET so only the end of larger dictionaries could be used anyway
+		m_dictionarySize = std::min(dictionary->size(), MAX_OFFSET);
+		m_dictionary = dictionary->data() + dictionary->size() - m_dictionarySize;
+		m_window.assign(m_dictionary, m_dictionary + m_dictionarySize);
+
+		m_dictionaryTable.resize(m_table.size(), 0);
+		for (size_t i = 0; i + MIN_MATCH <= m_dictionarySize; i++) {
+			m_dictionaryTable[Hash(Read32(m_dictionary + i))] = static_cast<std::uint32_t>(i + 1);
+		}
+	}
+}
+
+void Netcode::LzCodec::compress(const char* data, size_t size, std::string& out) {
+	const size_t headerStart = out.size();
+	const std::uint32_t uncompressedSize = static_cast<std::uint32_t>(size);
+	// Worst case is a single run of literals
+	out.resize(headerStart + sizeof(uncompressedSize) + size + size / 255 + 16);
+	std::memcpy(&out[headerStart], &uncompressedSize, sizeof(uncompressedSize));
+	std::uint8_t* const opStart = reinterpret_cast<std::uint8_t*>(&out[headerStart + sizeof(uncompressedSize)]);
+	std::uint8_t* op = opStart;
+
+	// Positions are relative to base, the packet starts at start
+	const char* base = data;
+	size_t start = 0;
+	if (m_dictionarySize) {
+		m_window.resize(m_dictionarySize + size);
+		std::memcpy(m_window.data() + m_dictionarySize, data, size);
+		base = m_window.data();
+		start = m_dictionarySize;
+		std::copy(m_dictionaryTable.begin(), m_dictionaryTable.end(), m_table.begin());
+	} else {
+		std::fill(m_table.begin(), m_table.end(), 0);
+	}
+
+	const size_t end = start + size;
+	size_t anchor = start;
+	if (size > MATCH_FIND_LIMIT) {
+		const size_t matchLimit = end - LAST_LITERALS;
+		const size_t findLimit = end - MATCH_FIND_LIMIT;
+		size_t ip = start;
+
+		while (ip < findLimit) {
+			const std::uint32_t sequence = Read32(base + ip);
+			const std::uint32_t hash = Hash(sequence);
+			const size_t candidate = m_table[hash];
+			m_table[hash] = static_cast<std::uint32_t>(ip + 1);
+
+			if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || Read32(base + candidate - 1) != sequence) {
+				ip += 1 + ((ip - anchor) >> SKIP_TRIGGER);
+				continue;
+			}
+
+			// Extend the match backwards over the literals and forwards as far as it goes
+			size_t match = candidate - 1;
+			while (ip > anchor && match > 0 && base[ip - 1] == base[match - 1]) {
+				ip--;
+				match--;
+			}
+			size_t length = MIN_MATCH;
+			while (ip + length < matchLimit && base[ip + length] == base[match + length]) {
+				length++;
+			}
+
+			std::uint8_t* token;
+			op = WriteLiterals(op, token, base + anchor, ip - anchor);
+			op = WriteMatch(op, token, ip - match, length);
+
+			ip += length;
+			anchor = ip;
+			if (ip < findLimit) {
+				m_table[Hash(Read32(base + ip - 2))] = static_cast<std::uint32_t>(ip - 2 + 1);
+			}
+		}
+	}
+
+	// The last sequence only has literals
+	std::uint8_t* token;
+	op = WriteLiterals(op, token, base + anchor, end - anchor);
+
+	out.resize(headerStart + sizeof(uncompressedSize) + (op - opStart));
+}
+
+bool Netcode::LzCodec::decompress(const char* data, size_t size, std::vector<char>& out) {
+	std::uint32_t uncompressedSize = 0;
+	if (size < sizeof(uncompressedSize)) {
+		return false;
+	}
+	std::memcpy(&uncompressedSize, data, sizeof(uncompressedSize));
+	if (uncompressedSize > MAX_PACKET_SIZE) {
+		return false;
+	}
+
+	out.resize(uncompressedSize);
+	char* const dst = out.data();
+	size_t op = 0;
+	const std::uint8_t* ip = reinterpret_cast<const std::uint8_t*>(data) + sizeof(uncompressedSize);
+	const std::uint8_t* const end = reinterpret_cast<const std::uint8_t*>(data) + size;
+
+	// Every read is checked since the data comes straight from the network
+	while (true) {
+		if (ip >= end) {
+			return false;
+		}
+		const std::uint8_t token = *ip++;
+
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15 && !ReadLength(ip, end, numLiterals)) {
+			return false;
+		}
+		if (numLiterals > static_cast<size_t>(end - ip) || numLiterals > uncompressedSize - op) {
+			return false;
+		}
+		std::memcpy(dst + op, ip, numLiterals);
+		ip += numLiterals;
+		op += numLiterals;
+
+		if (ip == end) {
+			break;
+		}
+
+		if (end - ip < 2) {
+			return false;
+		}
+		const size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(ip, end, length)) {
+			return false;
+		}
+		length += MIN_MATCH;
+		if (offset == 0 || length > uncompressedSize - op) {
+			return false;
+		}
+
+		// The start of the match can be in the dictionary
+		if (offset > op) {
+			const size_t fromEndOfDictionary = offset - op;
+			if (fromEndOfDictionary > m_dictionarySize) {
+				return false;
+			}
+			const size_t count = std::min(fromEndOfDictionary, length);
+			std::memcpy(dst + op, m_dictionary + m_dictionarySize - fromEndOfDictionary, count);
+			op += count;
+			length -= count;
+			if (length == 0) {
+				continue;
+			}
+		}
+
+		// Overlapping matches repeat the bytes just written
+		const char* src = dst + op - offset;
+		if (offset >= length) {
+			std::memcpy(dst + op, src, length);
+		} else {
+			for (size_t i = 0; i < length; i++) {
+				dst[op + i] = src[i];
+			}
+		}
+		op += length;
+	}
+
+	return op == uncompressedSize;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "PacketCodec.h"
+
+namespace Netcode {
+	class PacketDictionary;
+
+	/*
+	  Fast LZ77 compression in the LZ4 block format: a greedy match finder with a single hash table and no entropy coding,
+	  so both compression and decompression are a lot cheaper than deflate for a somewhat worse ratio.
+
+	  With a dictionary the packet is compressed as if it came right after the dictionary, so matches can point into it.
+	  Tick packets are small and look a lot like each other, which makes a dictionary trained on recorded packets
+	  make up for most of the difference in ratio. Both sides have to use the same dictionary.
+
+	  Logical structure of the compressed data:
+		--------------------------------------------------
+		| uint32_t        uncompressedSize               |
+		| LZ4 sequences...                               |
+		--------------------------------------------------
+	*/
+	class LzCodec : public PacketCodec {
+	public:
+		// The dictionary has to outlive the codec
+		LzCodec(const PacketDictionary* dictionary = nullptr);
+
+		void compress(const char* data, size_t size, std::string& out) override;
+		bool decompress(const char* data, size_t size, std::vector<char>& out) override;
+
+	private:
+		const char* m_dictionary;
+		size_t m_dictionarySize;
+
+		// The dictionary followed by the packet that is being compressed
+		std::vector<char> m_window;
+		// Positions + 1 of the last four bytes with each hash, 0 if there aren't any
+		std::vector<std::uint32_t> m_table;
+		// m_table after only the dictionary has been added, copied to m_table before every packet
+		std::vector<std::uint32_t> m_dictionaryTable;
+	};
+}
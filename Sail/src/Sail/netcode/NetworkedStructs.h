@@ -1,6 +1,7 @@
 #pragma once
 #include "ArchiveHelperFunctions.h"
 #include "NetcodeTypes.h"
+#include "WaterCells.h"
 
 #include <atomic>
 
@@ -129,6 +130,7 @@ namespace Netcode {
 		SPAWN_POWER_UP,
 		DESTROY_POWER_UP,
 		SET_CENTER,
+		TRANSFORM_SNAPSHOT,         // Quantized position and rotation without the unchanged fields, see TransformSnapshot.h
 		EMPTY,
 		COUNT
 	}; 
@@ -166,7 +168,10 @@ namespace Netcode {
 		"ENABLE_SPRINKLERS",
 		"START_THROWING",
 		"STOP_THROWING",
+		"SPAWN_POWER_UP",
+		"DESTROY_POWER_UP",
 		"SET_CENTER",
+		"TRANSFORM_SNAPSHOT",
 		"EMPTY",
 		"COUNT"
 	};
@@ -267,12 +272,13 @@ namespace Netcode {
 		Netcode::ComponentID ownerPlayerComponentID;
 	};
 
+	// The water hits of a tick, see WaterCells for how they are sent
 	class MessageSubmitWaterPoints : public MessageData {
 	public:
-		MessageSubmitWaterPoints(std::vector<glm::vec3> _points) : points(_points) {}
+		MessageSubmitWaterPoints(WaterCells _cells) : cells(std::move(_cells)) {}
 		virtual ~MessageSubmitWaterPoints() {}
 
-		std::vector<glm::vec3> points;
+		WaterCells cells;
 	};
 
 	class MessageWaterHitPlayer : public MessageData {
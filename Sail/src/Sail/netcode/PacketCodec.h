@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Netcode {
+	// The first byte of every compressed packet, tells the receiver which codec to decompress it with
+	enum class PacketCodecType : std::uint8_t {
+		NONE          = 0,    // Stored as it is, used for packets that are too small to gain anything from compression
+		LZ            = 1,    // LzCodec
+		LZ_DICTIONARY = 2,    // LzCodec with the PacketDictionary, followed by the ID of the dictionary
+		DEFLATE       = 0x1f, // DeflateCodec, gzip streams always start with 0x1f so the packets from before there were tags can still be read
+	};
+
+	/*
+	  A compression algorithm for network packets, see PacketCompressor for how they are picked.
+	  Implementations may keep state between packets and are not thread safe.
+	*/
+	class PacketCodec {
+	public:
+		virtual ~PacketCodec() {}
+
+		// Appends the compressed data to out
+		virtual void compress(const char* data, size_t size, std::string& out) = 0;
+		// Replaces the content of out, returns false if the data isn't valid
+		virtual bool decompress(const char* data, size_t size, std::vector<char>& out) = 0;
+	};
+}
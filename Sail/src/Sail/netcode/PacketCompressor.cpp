@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "PacketCompressor.h"
+#include "Sail/utils/Utils.h"
+
+#include <cstring>
+
+Netcode::PacketCompressor::PacketCompressor(PacketCodecType codec, size_t threshold, const PacketDictionary& dictionary)
+	: m_codec(codec)
+	, m_threshold(threshold)
+	, m_dictionary(dictionary)
+	, m_lz()
+	, m_lzDictionary(&dictionary)
+{
+	if (m_codec == PacketCodecType::LZ_DICTIONARY && m_dictionary.empty()) {
+		m_codec = PacketCodecType::LZ;
+	}
+}
+
+void Netcode::PacketCompressor::compress(const char* data, size_t size, std::string& out) {
+	out.clear();
+	const PacketCodecType codec = (size < m_threshold) ? PacketCodecType::NONE : m_codec;
+
+	switch (codec) {
+	case PacketCodecType::DEFLATE:
+		// The gzip header doubles as the tag
+		m_deflate.compress(data, size, out);
+		return;
+	case PacketCodecType::LZ:
+		out.push_back(static_cast<char>(codec));
+		m_lz.compress(data, size, out);
+		break;
+	case PacketCodecType::LZ_DICTIONARY:
+	{
+		const std::uint32_t id = m_dictionary.getID();
+		out.push_back(static_cast<char>(codec));
+		out.append(reinterpret_cast<const char*>(&id), sizeof(id));
+		m_lzDictionary.compress(data, size, out);
+	}
+	break;
+	default:
+		break;
+	}
+
+	// Data that doesn't compress is sent as it is instead
+	if (out.empty() || out.size() > size + 1) {
+		out.clear();
+		out.push_back(static_cast<char>(PacketCodecType::NONE));
+		out.append(data, size);
+	}
+}
+
+bool Netcode::PacketCompressor::decompress(const char* data, size_t size, std::vector<char>& out) {
+	if (size == 0) {
+		out.resize(0);
+		return false;
+	}
+
+	switch (static_cast<PacketCodecType>(data[0])) {
+	case PacketCodecType::NONE:
+		out.assign(data + 1, data + size);
+		return true;
+	case PacketCodecType::LZ:
+		return m_lz.decompress(data + 1, size - 1, out);
+	case PacketCodecType::LZ_DICTIONARY:
+	{
+		std::uint32_t id = 0;
+		if (size < 1 + sizeof(id)) {
+			return false;
+		}
+		std::memcpy(&id, data + 1, sizeof(id));
+		if (id != m_dictionary.getID()) {
+			SAIL_LOG_ERROR("Received a packet compressed with another packet dictionary, make sure that " + std::string(PacketDictionary::DEFAULT_PATH) + " is the same for all players");
+			return false;
+		}
+		return m_lzDictionary.decompress(data + 1 + sizeof(id), size - 1 - sizeof(id), out);
+	}
+	case PacketCodecType::DEFLATE:
+		return m_deflate.decompress(data, size, out);
+	default:
+		out.resize(0);
+		return false;
+	}
+}
+
+Netcode::PacketCodecType Netcode::PacketCompressor::getCodec() const {
+	return m_codec;
+}
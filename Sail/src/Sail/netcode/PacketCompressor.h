@@ -0,0 +1,44 @@
+#pragma once
+
+#include "DeflateCodec.h"
+#include "LzCodec.h"
+#include "PacketDictionary.h"
+
+namespace Netcode {
+	/*
+	  Compresses packets with one of the PacketCodecs and decompresses packets from any of them.
+	  Every packet starts with the PacketCodecType it was compressed with, so the sender can pick the codec without the
+	  receivers having to know about it. Packets smaller than the threshold aren't worth compressing and are stored as they are.
+
+	  The default is the LZ codec without a dictionary. Packets that use a dictionary carry its ID and can only be read by
+	  players who have the same dictionary, so LZ_DICTIONARY is only used by the compression benchmark until a trained
+	  dictionary is shipped with the game.
+
+	  Not thread safe, use one per thread.
+	*/
+	class PacketCompressor {
+	public:
+		static constexpr size_t DEFAULT_THRESHOLD = 64;
+
+		// The dictionary has to outlive the compressor
+		PacketCompressor(PacketCodecType codec = PacketCodecType::LZ, size_t threshold = DEFAULT_THRESHOLD, const PacketDictionary& dictionary = PacketDictionary::GetDefault());
+		PacketCompressor(const PacketCompressor&) = delete;
+		PacketCompressor& operator=(const PacketCompressor&) = delete;
+
+		// Replaces the content of out
+		void compress(const char* data, size_t size, std::string& out);
+		// Replaces the content of out, returns false if the data isn't a valid packet
+		bool decompress(const char* data, size_t size, std::vector<char>& out);
+
+		PacketCodecType getCodec() const;
+
+	private:
+		PacketCodecType m_codec;
+		size_t m_threshold;
+		const PacketDictionary& m_dictionary;
+
+		DeflateCodec m_deflate;
+		LzCodec m_lz;
+		LzCodec m_lzDictionary;
+	};
+}
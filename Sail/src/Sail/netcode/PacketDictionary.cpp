@@ -0,0 +1,175 @@
+#include "pch.h"
+#include "PacketDictionary.h"
+#include "PacketCompressor.h"
+#include "ReplayFile.h"
+#include "Sail/entities/systems/network/receivers/MatchRecordSystem.h"
+#include "Sail/utils/Utils.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+	constexpr size_t SEQUENCE_SIZE = 8;
+	constexpr size_t SEGMENT_SIZE = 64;
+	constexpr unsigned int FREQUENCY_LOG = 20;
+
+	size_t HashSequence(const char* p) {
+		std::uint64_t sequence;
+		std::memcpy(&sequence, p, sizeof(sequence));
+		return static_cast<size_t>((sequence * 0xCF1BBCDCB7A56463ull) >> (64 - FREQUENCY_LOG));
+	}
+}
+
+const Netcode::PacketDictionary& Netcode::PacketDictionary::GetDefault() {
+	static const PacketDictionary dictionary = [] {
+		PacketDictionary d;
+		if (!d.load(DEFAULT_PATH)) {
+			SAIL_LOG("No packet dictionary found at " + std::string(DEFAULT_PATH) + ", packets will be compressed without one");
+		}
+		return d;
+	}();
+	return dictionary;
+}
+
+Netcode::PacketDictionary Netcode::PacketDictionary::Train(const std::vector<std::string>& samples, size_t maxSize) {
+	PacketDictionary dictionary;
+
+	// Segments can span several packets, it doesn't matter since it's only the sequences in them that count
+	std::string all;
+	size_t totalSize = 0;
+	for (const std::string& sample : samples) {
+		totalSize += sample.size();
+	}
+	all.reserve(totalSize);
+	for (const std::string& sample : samples) {
+		all += sample;
+	}
+	if (all.size() < SEGMENT_SIZE || maxSize < SEGMENT_SIZE) {
+		return dictionary;
+	}
+
+	// How many times each sequence appears in all of the samples, sequences with the same hash are counted together
+	std::vector<std::uint32_t> frequencies(size_t{ 1 } << FREQUENCY_LOG, 0);
+	for (size_t i = 0; i + SEQUENCE_SIZE <= all.size(); i++) {
+		frequencies[HashSequence(&all[i])]++;
+	}
+
+	const size_t numSegments = maxSize / SEGMENT_SIZE;
+	const size_t sequencesPerSegment = SEGMENT_SIZE - SEQUENCE_SIZE + 1;
+	const size_t epochSize = std::max(all.size() / numSegments, SEGMENT_SIZE);
+
+	dictionary.m_data.reserve(numSegments * SEGMENT_SIZE);
+	for (size_t epochStart = 0; epochStart + SEGMENT_SIZE <= all.size(); epochStart += epochSize) {
+		const size_t epochEnd = std::min(epochStart + epochSize, all.size());
+		if (epochEnd - epochStart < SEGMENT_SIZE || dictionary.m_data.size() + SEGMENT_SIZE > maxSize) {
+			break;
+		}
+
+		// Slide the segment over the epoch and keep the one with the highest score
+		std::uint64_t score = 0;
+		for (size_t i = 0; i < sequencesPerSegment; i++) {
+			score += frequencies[HashSequence(&all[epochStart + i])];
+		}
+		std::uint64_t bestScore = score;
+		size_t bestStart = epochStart;
+		for (size_t start = epochStart + 1; start + SEGMENT_SIZE <= epochEnd; start++) {
+			score += frequencies[HashSequence(&all[start + sequencesPerSegment - 1])];
+			score -= frequencies[HashSequence(&all[start - 1])];
+			if (score > bestScore) {
+				bestScore = score;
+				bestStart = start;
+			}
+		}
+		if (bestScore == 0) {
+			continue;
+		}
+
+		dictionary.m_data.insert(dictionary.m_data.end(), all.begin() + bestStart, all.begin() + bestStart + SEGMENT_SIZE);
+		for (size_t i = 0; i < sequencesPerSegment; i++) {
+			frequencies[HashSequence(&all[bestStart + i])] = 0;
+		}
+	}
+
+	dictionary.updateID();
+	return dictionary;
+}
+
+std::vector<std::string> Netcode::PacketDictionary::LoadReplayPackets(const std::string& directory) {
+	std::vector<std::string> recorded;
+	std::error_code err;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory, err)) {
+		if (entry.path().extension() == REPLAY_EXTENSION && !Netcode::ReadReplayPackets(entry.path().string(), recorded)) {
+			SAIL_LOG_WARNING("Could not read the packets of replay: " + entry.path().string());
+		}
+	}
+	if (err.value() != 0) {
+		SAIL_LOG_WARNING(err.message());
+	}
+
+	// Replays store the packets the way they were sent
+	std::vector<std::string> packets;
+	packets.reserve(recorded.size());
+	PacketCompressor decompressor;
+	std::vector<char> decompressed;
+	for (const std::string& packet : recorded) {
+		if (decompressor.decompress(packet.data(), packet.size(), decompressed)) {
+			packets.emplace_back(decompressed.data(), decompressed.size());
+		}
+	}
+	return packets;
+}
+
+bool Netcode::PacketDictionary::load(const std::string& path) {
+	std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+	m_data.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(m_data.data(), m_data.size());
+	updateID();
+	return file.good();
+}
+
+bool Netcode::PacketDictionary::save(const std::string& path) const {
+	std::error_code err;
+	const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	if (!directory.empty()) {
+		std::filesystem::create_directories(directory, err);
+	}
+	std::ofstream file(path, std::ofstream::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(m_data.data(), m_data.size());
+	return file.good();
+}
+
+const char* Netcode::PacketDictionary::data() const {
+	return m_data.data();
+}
+
+size_t Netcode::PacketDictionary::size() const {
+	return m_data.size();
+}
+
+bool Netcode::PacketDictionary::empty() const {
+	return m_data.empty();
+}
+
+std::uint32_t Netcode::PacketDictionary::getID() const {
+	return m_id;
+}
+
+// FNV-1a of the content, so that dictionaries that aren't the same can be told apart. 0 is kept for no dictionary
+void Netcode::PacketDictionary::updateID() {
+	if (m_data.empty()) {
+		m_id = 0;
+		return;
+	}
+	m_id = 2166136261u;
+	for (const char c : m_data) {
+		m_id = (m_id ^ static_cast<std::uint8_t>(c)) * 16777619u;
+	}
+}
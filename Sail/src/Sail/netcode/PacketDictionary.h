@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Netcode {
+	/*
+	  Bytes that commonly appear in tick packets, used by LzCodec so that even the first occurrence of something in a packet
+	  can be compressed. Trained offline on the packets of recorded replays, every player needs the same dictionary which
+	  is why the ID of it is sent with the packets that use it. None is shipped with the game yet, see PacketCompressor.
+	*/
+	class PacketDictionary {
+	public:
+		static constexpr const char* DEFAULT_PATH = "res/network/packets.dict";
+		static constexpr size_t DEFAULT_SIZE = 16 * 1024;
+
+		// Loaded from DEFAULT_PATH the first time it is used, empty if there is no dictionary
+		static const PacketDictionary& GetDefault();
+
+		/*
+		  Picks the segments of the samples which contain the most common 8 byte sequences, in the same way as the
+		  FastCover algorithm used by zstd: the samples are split into one part per segment and the segment with the
+		  highest score is picked from each part. Sequences that have already been added stop counting towards the score.
+		*/
+		static PacketDictionary Train(const std::vector<std::string>& samples, size_t maxSize = DEFAULT_SIZE);
+
+		// All packets in the replays (.SPLASH files) in the directory and its subdirectories, decompressed
+		static std::vector<std::string> LoadReplayPackets(const std::string& directory);
+
+		bool load(const std::string& path);
+		bool save(const std::string& path) const;
+
+		const char* data() const;
+		size_t size() const;
+		bool empty() const;
+		std::uint32_t getID() const;
+
+	private:
+		void updateID();
+
+	private:
+		std::vector<char> m_data;
+		std::uint32_t m_id = 0;
+	};
+}
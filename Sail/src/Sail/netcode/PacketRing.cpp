@@ -0,0 +1,312 @@
+#include "pch.h"
+#include "PacketRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace Netcode {
+	PacketRing::Snapshot::Snapshot(PacketRing* ring, size_t pin)
+		: m_ring(ring)
+		, m_pin(pin)
+	{
+		m_ring->addRef(m_pin);
+	}
+
+	PacketRing::Snapshot::Snapshot(const Snapshot& other)
+		: m_ring(other.m_ring)
+		, m_pin(other.m_pin)
+	{
+		if (m_ring) {
+			m_ring->addRef(m_pin);
+		}
+	}
+
+	PacketRing::Snapshot::Snapshot(Snapshot&& other) noexcept
+		: m_ring(other.m_ring)
+		, m_pin(other.m_pin)
+	{
+		other.m_ring = nullptr;
+	}
+
+	PacketRing::Snapshot& PacketRing::Snapshot::operator=(Snapshot other) {
+		std::swap(m_ring, other.m_ring);
+		std::swap(m_pin, other.m_pin);
+		return *this;
+	}
+
+	PacketRing::Snapshot::~Snapshot() {
+		reset();
+	}
+
+	bool PacketRing::Snapshot::nextTick() {
+		if (!m_ring) {
+			return false;
+		}
+
+		Pin& pin = m_ring->m_pins[m_pin];
+		if (pin.expired) {
+			return false;
+		}
+		if (!pin.started) {
+			pin.started = true;
+		} else if (pin.cursor < pin.endTick) {
+			pin.cursor++;
+		} else {
+			return false;
+		}
+		return pin.cursor <= pin.endTick;
+	}
+
+	bool PacketRing::Snapshot::isFinished() const {
+		if (!m_ring) {
+			return true;
+		}
+
+		const Pin& pin = m_ring->m_pins[m_pin];
+		return pin.expired || (pin.started ? pin.cursor >= pin.endTick : pin.firstTick > pin.endTick);
+	}
+
+	bool PacketRing::Snapshot::isValid() const {
+		return m_ring && !m_ring->m_pins[m_pin].expired;
+	}
+
+	size_t PacketRing::Snapshot::getFirstTick() const {
+		return m_ring ? m_ring->m_pins[m_pin].firstTick : 0;
+	}
+
+	size_t PacketRing::Snapshot::getTick() const {
+		return m_ring ? m_ring->m_pins[m_pin].cursor : 0;
+	}
+
+	size_t PacketRing::Snapshot::getNumPackets() const {
+		if (!isValid() || !m_ring->m_pins[m_pin].started) {
+			return 0;
+		}
+
+		const Pin& pin = m_ring->m_pins[m_pin];
+		const size_t first = m_ring->m_ticks[pin.cursor % m_ring->m_ticks.size()].firstPacket;
+		const size_t end = (pin.cursor == pin.endTick) ? pin.endPacket : m_ring->getPacketEnd(pin.cursor);
+		return end - first;
+	}
+
+	PacketRing::Packet PacketRing::Snapshot::getPacket(size_t index) const {
+		const Pin& pin = m_ring->m_pins[m_pin];
+		const size_t first = m_ring->m_ticks[pin.cursor % m_ring->m_ticks.size()].firstPacket;
+		const PacketEntry& entry = m_ring->m_packets[(first + index) % m_ring->m_packets.size()];
+		return { &m_ring->m_buffer[entry.begin % m_ring->m_buffer.size()], entry.size };
+	}
+
+	void PacketRing::Snapshot::reset() {
+		if (m_ring) {
+			m_ring->release(m_pin);
+			m_ring = nullptr;
+		}
+	}
+
+
+	PacketRing::PacketRing(size_t byteCapacity, size_t packetCapacity, size_t tickCapacity, size_t windowTicks,
+		size_t maxByteCapacity, size_t maxPacketCapacity)
+		: m_windowTicks(std::max<size_t>(windowTicks, 1))
+		, m_initialBytes(std::max<size_t>(byteCapacity, 1))
+		, m_initialPackets(std::max<size_t>(packetCapacity, 1))
+		, m_maxBytes(std::max(maxByteCapacity, m_initialBytes))
+		, m_maxPackets(std::max(maxPacketCapacity, m_initialPackets))
+	{
+		m_buffer.resize(m_initialBytes);
+		m_packets.resize(m_initialPackets);
+		// The window and the tick after it always fit
+		m_ticks.resize(std::max(tickCapacity, m_windowTicks + 1));
+		m_ticks[0].firstPacket = 0;
+	}
+
+	void PacketRing::beginTick() {
+		while (m_tick + 2 - getOldestTick() > m_ticks.size()) {
+			dropOldestTick();
+		}
+
+		m_tick++;
+		m_ticks[m_tick % m_ticks.size()].firstPacket = m_packetsWritten;
+		if (m_tick + 1 > m_windowTicks) {
+			m_windowStart = std::max(m_windowStart, m_tick + 1 - m_windowTicks);
+		}
+
+		// Whatever was grown for the snapshots is given back once they are done, if the window fits comfortably
+		if (!isPinned()) {
+			if (m_buffer.size() > m_initialBytes && getUsedBytes() <= m_initialBytes / 2) {
+				resizeBuffer(m_initialBytes);
+			}
+			if (m_packets.size() > m_initialPackets && m_packetsWritten - getOldestPacket() <= m_initialPackets / 2) {
+				resizePackets(m_initialPackets);
+			}
+		}
+	}
+
+	void PacketRing::push(const char* data, size_t size) {
+		while (m_packetsWritten - getOldestPacket() >= m_packets.size()) {
+			if (m_packets.size() < m_maxPackets) {
+				resizePackets(std::min(m_packets.size() * 2, m_maxPackets));
+			} else if (!dropOldestTick()) {
+				resizePackets(m_packets.size() * 2);
+			}
+		}
+
+		// Packets never wrap, the space left at the end is skipped instead
+		size_t begin = 0;
+		while (true) {
+			const size_t capacity = m_buffer.size();
+			begin = m_bytesWritten;
+			if (begin % capacity + size > capacity) {
+				begin += capacity - begin % capacity;
+			}
+
+			// Nothing that is kept may be overlapped
+			const size_t oldestPacket = getOldestPacket();
+			const size_t oldestByte = (oldestPacket < m_packetsWritten) ? m_packets[oldestPacket % m_packets.size()].begin : m_bytesWritten;
+			const bool bytesFull = oldestByte < m_bytesWritten && begin + size - oldestByte > capacity;
+			if (size <= capacity && !bytesFull) {
+				break;
+			}
+
+			const size_t needed = getUsedBytes() + size;
+			if (capacity < m_maxBytes && needed <= m_maxBytes) {
+				resizeBuffer(std::max(std::min(capacity * 2, m_maxBytes), needed));
+			} else if (!dropOldestTick()) {
+				resizeBuffer(std::max(capacity * 2, needed));
+			}
+		}
+
+		std::memcpy(&m_buffer[begin % m_buffer.size()], data, size);
+		m_packets[m_packetsWritten % m_packets.size()] = { begin, size };
+		m_packetsWritten++;
+		m_bytesWritten = begin + size;
+	}
+
+	PacketRing::Snapshot PacketRing::snapshot() {
+		for (size_t i = 0; i < m_pins.size(); i++) {
+			Pin& pin = m_pins[i];
+			if (pin.refs > 0) {
+				continue;
+			}
+
+			pin.expired = false;
+			pin.started = false;
+			pin.firstTick = m_windowStart;
+			pin.cursor = m_windowStart;
+			pin.endTick = m_tick;
+			pin.endPacket = m_packetsWritten;
+			return Snapshot(this, i);
+		}
+		// All MAX_SNAPSHOTS are in use
+		return Snapshot();
+	}
+
+	void PacketRing::clear() {
+		for (Pin& pin : m_pins) {
+			if (pin.refs > 0) {
+				pin.expired = true;
+			}
+		}
+		m_bytesWritten = 0;
+		m_packetsWritten = 0;
+		m_tick = 0;
+		m_windowStart = 0;
+		m_ticks[0].firstPacket = 0;
+	}
+
+	size_t PacketRing::getTick() const {
+		return m_tick;
+	}
+
+	size_t PacketRing::getUsedBytes() const {
+		const size_t oldestPacket = getOldestPacket();
+		return (oldestPacket < m_packetsWritten) ? m_bytesWritten - m_packets[oldestPacket % m_packets.size()].begin : 0;
+	}
+
+	size_t PacketRing::getByteSize() const {
+		size_t size = sizeof(*this);
+		size += m_buffer.capacity() * sizeof(char);
+		size += m_packets.capacity() * sizeof(PacketEntry);
+		size += m_ticks.capacity() * sizeof(Tick);
+		return size;
+	}
+
+	size_t PacketRing::getOldestTick() const {
+		size_t oldest = m_windowStart;
+		for (const Pin& pin : m_pins) {
+			if (pin.refs > 0 && !pin.expired) {
+				oldest = std::min(oldest, pin.cursor);
+			}
+		}
+		return oldest;
+	}
+
+	size_t PacketRing::getOldestPacket() const {
+		const size_t oldestTick = getOldestTick();
+		return (oldestTick <= m_tick) ? m_ticks[oldestTick % m_ticks.size()].firstPacket : m_packetsWritten;
+	}
+
+	size_t PacketRing::getPacketEnd(size_t tick) const {
+		return (tick == m_tick) ? m_packetsWritten : m_ticks[(tick + 1) % m_ticks.size()].firstPacket;
+	}
+
+	bool PacketRing::isPinned() const {
+		for (const Pin& pin : m_pins) {
+			if (pin.refs > 0 && !pin.expired) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void PacketRing::resizeBuffer(size_t capacity) {
+		const size_t oldestPacket = getOldestPacket();
+		std::vector<char> buffer(capacity);
+
+		// The kept packets are moved to the start of the new buffer, positions keep counting up from a multiple of its size
+		const size_t base = (m_bytesWritten / buffer.size() + 1) * buffer.size();
+		size_t offset = 0;
+		for (size_t i = oldestPacket; i < m_packetsWritten; i++) {
+			PacketEntry& entry = m_packets[i % m_packets.size()];
+			std::memcpy(&buffer[offset], &m_buffer[entry.begin % m_buffer.size()], entry.size);
+			entry.begin = base + offset;
+			offset += entry.size;
+		}
+		m_buffer.swap(buffer);
+		m_bytesWritten = base + offset;
+	}
+
+	void PacketRing::resizePackets(size_t capacity) {
+		const size_t oldestPacket = getOldestPacket();
+		std::vector<PacketEntry> packets(capacity);
+		for (size_t i = oldestPacket; i < m_packetsWritten; i++) {
+			packets[i % packets.size()] = m_packets[i % m_packets.size()];
+		}
+		m_packets.swap(packets);
+	}
+
+	bool PacketRing::dropOldestTick() {
+		const size_t oldestTick = getOldestTick();
+		if (oldestTick >= m_tick) {
+			return false;
+		}
+
+		for (Pin& pin : m_pins) {
+			if (pin.refs > 0 && !pin.expired && pin.cursor == oldestTick) {
+				pin.expired = true;
+			}
+		}
+		if (m_windowStart == oldestTick) {
+			m_windowStart++;
+		}
+		return true;
+	}
+
+	void PacketRing::addRef(size_t pin) {
+		m_pins[pin].refs++;
+	}
+
+	void PacketRing::release(size_t pin) {
+		m_pins[pin].refs--;
+	}
+}
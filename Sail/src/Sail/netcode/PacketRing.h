@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+namespace Netcode {
+	/*
+	  The packets received during the last few ticks, kept in one contiguous byte buffer so that they can be replayed
+	  in the killcam.
+
+	  Packets are copied into the buffer as they arrive and never wrap around its end, a packet that doesn't fit before
+	  the end starts at the beginning instead. A table of packet positions and a table of the first packet of every tick
+	  tell where each tick's packets are. Everything is allocated in the constructor and only reallocated if it's too small.
+
+	  snapshot() hands out the ticks in the window without copying anything. The snapshot keeps its ticks in the buffer
+	  until they have been read, while new ticks keep being written after them. Snapshots are refcounted, copies of a
+	  snapshot share the same read position.
+	  Ticks that are in the window or still needed by a snapshot aren't overwritten while there is room. If a new packet
+	  doesn't fit, the buffer or packet table doubles in size up to its maximum and the kept ticks are moved over. Past
+	  that, and when the tick table is full, the oldest tick is given up instead: the snapshots still reading it expire
+	  and the window gets shorter. The current tick is always kept whole, even if it's larger than the maximum.
+	  Once no snapshot holds on to anything, the buffer and packet table shrink back to their initial sizes.
+
+	  Not thread safe.
+	*/
+	class PacketRing {
+	public:
+		static constexpr size_t MAX_SNAPSHOTS = 4;
+
+		struct Packet {
+			const char* data;
+			size_t size;
+		};
+
+		class Snapshot {
+		public:
+			Snapshot() = default;
+			Snapshot(const Snapshot& other);
+			Snapshot(Snapshot&& other) noexcept;
+			Snapshot& operator=(Snapshot other);
+			~Snapshot();
+
+			// Moves on to the first tick the first time it's called and to the next tick after that.
+			// Returns false once all ticks have been read or if they were overwritten.
+			bool nextTick();
+			// True after the last tick has been moved to, or if there is nothing more to read
+			bool isFinished() const;
+			bool isValid() const;
+
+			// The tick the snapshot starts at and the tick that nextTick() moved to, as counted by PacketRing::getTick()
+			size_t getFirstTick() const;
+			size_t getTick() const;
+
+			// The packets of the current tick, pointers into the ring that stay valid until nextTick() is called again
+			size_t getNumPackets() const;
+			Packet getPacket(size_t index) const;
+
+			// Stops holding on to the ticks
+			void reset();
+
+		private:
+			friend class PacketRing;
+			Snapshot(PacketRing* ring, size_t pin);
+
+			PacketRing* m_ring = nullptr;
+			size_t m_pin = 0;
+		};
+
+		/*
+		  byteCapacity is the initial size of all packets that are kept, packetCapacity the number of them, and
+		  maxByteCapacity and maxPacketCapacity how large they may grow while snapshots are held.
+		  tickCapacity is the number of ticks including the ones kept by snapshots, which the ring never grows past.
+		  windowTicks is the number of ticks snapshot() covers, the current one included.
+		  Snapshots must not outlive the ring.
+		*/
+		PacketRing(size_t byteCapacity, size_t packetCapacity, size_t tickCapacity, size_t windowTicks,
+			size_t maxByteCapacity, size_t maxPacketCapacity);
+		PacketRing(const PacketRing&) = delete;
+		PacketRing& operator=(const PacketRing&) = delete;
+
+		// Starts the next tick, packets pushed from now on belong to it
+		void beginTick();
+		// Copies a packet into the current tick
+		void push(const char* data, size_t size);
+		// The ticks in the window up to and including the packets pushed so far this tick
+		Snapshot snapshot();
+		// Forgets all packets and expires all snapshots
+		void clear();
+
+		size_t getTick() const;
+		// Bytes used by the packets that are kept right now
+		size_t getUsedBytes() const;
+		// Allocated size, which only changes while the ring has grown
+		size_t getByteSize() const;
+
+	private:
+		// The packets of a tick are [firstPacket, firstPacket of the next tick)
+		struct Tick {
+			size_t firstPacket;
+		};
+		// begin counts bytes since the start, the position in the buffer is begin modulo the capacity
+		struct PacketEntry {
+			size_t begin;
+			size_t size;
+		};
+		struct Pin {
+			unsigned int refs = 0;
+			bool expired = false;
+			bool started = false;
+			size_t firstTick = 0;
+			size_t cursor = 0;    // Ticks before this have been read and can be overwritten
+			size_t endTick = 0;   // Last tick in the snapshot
+			size_t endPacket = 0; // Packets of endTick that were pushed after the snapshot was taken are left out
+		};
+
+		size_t getOldestTick() const;
+		size_t getOldestPacket() const;
+		size_t getPacketEnd(size_t tick) const;
+		bool isPinned() const;
+		// Reallocate the buffer or packet table, keeping everything from the oldest tick on
+		void resizeBuffer(size_t capacity);
+		void resizePackets(size_t capacity);
+		// Stops keeping the oldest tick and expires the snapshots that still need it.
+		// Returns false if only the current tick is kept.
+		bool dropOldestTick();
+
+		void addRef(size_t pin);
+		void release(size_t pin);
+
+	private:
+		std::vector<char> m_buffer;
+		std::vector<PacketEntry> m_packets;
+		std::vector<Tick> m_ticks;
+		std::array<Pin, MAX_SNAPSHOTS> m_pins;
+		size_t m_windowTicks;
+		size_t m_initialBytes;
+		size_t m_initialPackets;
+		size_t m_maxBytes;
+		size_t m_maxPackets;
+
+		// Counted since the start, indices into the tables are these modulo their sizes
+		size_t m_bytesWritten = 0;
+		size_t m_packetsWritten = 0;
+		size_t m_tick = 0;
+		size_t m_windowStart = 0;
+	};
+}
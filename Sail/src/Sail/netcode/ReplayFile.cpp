@@ -0,0 +1,547 @@
+#include "pch.h"
+#include "ReplayFile.h"
+#include "TransformSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	// Entities that haven't been in a state packet for this long have been destroyed or stopped sending
+	constexpr size_t STALE_TICKS = 2 * Netcode::TransformSnapshot::KEYFRAME_INTERVAL;
+	// Snapshots are only kept since the entity's last snapshot keyframe, this many means that one was missed
+	constexpr size_t MAX_KEYFRAME_SNAPSHOTS = 4 * Netcode::TransformSnapshot::KEYFRAME_INTERVAL;
+	// Nothing in the metadata is anywhere near this large, larger lengths are from a broken file
+	constexpr std::uint32_t MAX_METADATA_LENGTH = 1024 * 1024;
+
+	template<typename T>
+	void Write(std::ofstream& file, const T& value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	bool Read(std::ifstream& file, T& value) {
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	template<typename T>
+	T Load(const char* data) {
+		T value;
+		std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+
+	// The players and settings at the start of old replays, same layout as MatchRecordSystem::initRecording() writes
+	bool ReadLegacyMetadata(std::ifstream& file, std::string& metadata) {
+		std::uint32_t numPlayers = 0;
+		std::uint32_t length = 0;
+		if (!Read(file, numPlayers) || numPlayers > MAX_METADATA_LENGTH) {
+			return false;
+		}
+		metadata.append(reinterpret_cast<const char*>(&numPlayers), sizeof(numPlayers));
+
+		for (std::uint32_t i = 0; i < numPlayers; i++) {
+			char idAndTeam[2];
+			if (!file.read(idAndTeam, sizeof(idAndTeam)) || !Read(file, length) || length > MAX_METADATA_LENGTH) {
+				return false;
+			}
+			std::string name(length, '\0');
+			if (!file.read(&name[0], length)) {
+				return false;
+			}
+			metadata.append(idAndTeam, sizeof(idAndTeam));
+			metadata.append(reinterpret_cast<const char*>(&length), sizeof(length));
+			metadata.append(name);
+		}
+
+		if (!Read(file, length) || length > MAX_METADATA_LENGTH) {
+			return false;
+		}
+		std::string settings(length, '\0');
+		if (!file.read(&settings[0], length)) {
+			return false;
+		}
+		metadata.append(reinterpret_cast<const char*>(&length), sizeof(length));
+		metadata.append(settings);
+		return true;
+	}
+}
+
+namespace Netcode {
+	ReplayWriter::ReplayWriter() {
+	}
+
+	ReplayWriter::~ReplayWriter() {
+		close();
+	}
+
+	bool ReplayWriter::open(const std::string& path, const std::string& metadata, unsigned int keyframeInterval) {
+		close();
+
+		m_file = std::ofstream(path, std::ofstream::binary);
+		if (!m_file.is_open()) {
+			return false;
+		}
+
+		m_header = {};
+		std::copy(ReplayFile::MAGIC, ReplayFile::MAGIC + sizeof(ReplayFile::MAGIC), m_header.magic);
+		m_header.version = ReplayFile::VERSION;
+		m_header.keyframeInterval = std::max(keyframeInterval, 1u);
+		m_header.metadataOffset = sizeof(ReplayFile::Header);
+		m_header.metadataSize = metadata.size();
+		// Written again with the indices when the file is closed
+		Write(m_file, m_header);
+		m_file.write(metadata.data(), metadata.size());
+		m_offset = m_header.metadataOffset + m_header.metadataSize;
+
+		m_ticks.clear();
+		m_keyframes.clear();
+		m_keyframeEntities.clear();
+		m_keyframeEvents.clear();
+		m_tick = 0;
+		m_tickPackets.clear();
+		m_tickNumPackets = 0;
+		return m_file.good();
+	}
+
+	void ReplayWriter::addPacket(const char* data, size_t size, bool mightBeState) {
+		if (!isOpen()) {
+			return;
+		}
+
+		// Everything that isn't per-tick state can have events in it
+		const bool decompressed = m_compressor.decompress(data, size, m_decompressed);
+		const bool state = decompressed && mightBeState && readStatePacket();
+		if (decompressed && !state) {
+			m_keyframeEvents.read(m_decompressed.data(), m_decompressed.size());
+		}
+		appendPacket(m_tickPackets, data, size, state ? ReplayFile::STATE : 0);
+		m_tickNumPackets++;
+	}
+
+	void ReplayWriter::endTick() {
+		if (!isOpen()) {
+			return;
+		}
+
+		m_ticks.push_back({ m_offset, static_cast<std::uint32_t>(m_tick), m_tickNumPackets });
+		writeRecord(ReplayFile::TICK, m_tickPackets, m_tickNumPackets);
+		m_tickPackets.clear();
+		m_tickNumPackets = 0;
+
+		if (m_tick > 0 && m_tick % m_header.keyframeInterval == 0) {
+			writeKeyframe();
+		}
+		m_tick++;
+	}
+
+	bool ReplayWriter::close() {
+		if (!isOpen()) {
+			return false;
+		}
+		if (m_tickNumPackets > 0) {
+			endTick();
+		}
+
+		m_header.numTicks = static_cast<std::uint32_t>(m_ticks.size());
+		m_header.numKeyframes = static_cast<std::uint32_t>(m_keyframes.size());
+		m_header.tickIndexOffset = m_offset;
+		m_header.keyframeIndexOffset = m_offset + m_ticks.size() * sizeof(ReplayFile::IndexEntry);
+		m_file.write(reinterpret_cast<const char*>(m_ticks.data()), m_ticks.size() * sizeof(ReplayFile::IndexEntry));
+		m_file.write(reinterpret_cast<const char*>(m_keyframes.data()), m_keyframes.size() * sizeof(ReplayFile::IndexEntry));
+		m_file.seekp(0);
+		Write(m_file, m_header);
+
+		const bool success = m_file.good();
+		m_file.close();
+		m_keyframeEntities.clear();
+		m_keyframeEvents.clear();
+		return success;
+	}
+
+	bool ReplayWriter::isOpen() const {
+		return m_file.is_open();
+	}
+
+	bool ReplayWriter::readStatePacket() {
+		if (!m_statePacket.parse(m_decompressed.data(), m_decompressed.size())) {
+			return false;
+		}
+
+		const std::vector<StatePacket::Message>& messages = m_statePacket.getMessages();
+		for (const StatePacket::Entity& entity : m_statePacket.getEntities()) {
+			KeyframeEntity& keyframe = m_keyframeEntities[entity.id];
+			keyframe.sender = m_statePacket.getSender();
+			keyframe.type = entity.type;
+			keyframe.lastTick = m_tick;
+
+			for (size_t i = entity.firstMessage; i < entity.firstMessage + entity.numMessages; i++) {
+				const StatePacket::Message& message = messages[i];
+				const char* begin = m_decompressed.data() + message.begin;
+				const char* end = m_decompressed.data() + message.end;
+
+				if (message.type == MessageType::ANIMATION) {
+					keyframe.animation.assign(begin, end);
+				} else if (TransformSnapshot::IsKeyframe(entity.id, message.sequence) || (keyframe.numSnapshots == 0 && message.standalone)) {
+					// The snapshots before it aren't needed to decode the ones after it
+					keyframe.snapshots.assign(begin, end);
+					keyframe.numSnapshots = 1;
+				} else if (keyframe.numSnapshots > 0 && keyframe.numSnapshots < MAX_KEYFRAME_SNAPSHOTS) {
+					keyframe.snapshots.insert(keyframe.snapshots.end(), begin, end);
+					keyframe.numSnapshots++;
+				} else {
+					// Wait for the next snapshot keyframe
+					keyframe.snapshots.clear();
+					keyframe.numSnapshots = 0;
+				}
+			}
+		}
+		return true;
+	}
+
+	void ReplayWriter::writeKeyframe() {
+		std::vector<PlayerID> senders;
+		for (auto it = m_keyframeEntities.begin(); it != m_keyframeEntities.end();) {
+			if (m_tick - it->second.lastTick > STALE_TICKS) {
+				it = m_keyframeEntities.erase(it);
+			} else {
+				senders.push_back(it->second.sender);
+				++it;
+			}
+		}
+		std::sort(senders.begin(), senders.end());
+		senders.erase(std::unique(senders.begin(), senders.end()), senders.end());
+
+		// One or more packets per sender with the same layout as the state packets, see NetworkSenderSystem::update()
+		m_keyframePackets.clear();
+		std::uint32_t numPackets = 0;
+		std::vector<std::pair<ComponentID, const KeyframeEntity*>> entities;
+		for (PlayerID sender : senders) {
+			auto it = m_keyframeEntities.begin();
+			while (it != m_keyframeEntities.end()) {
+				entities.clear();
+				size_t size = 0;
+				for (; it != m_keyframeEntities.end() && size < KEYFRAME_PACKET_SIZE; ++it) {
+					const KeyframeEntity& keyframe = it->second;
+					if (keyframe.sender == sender && (keyframe.numSnapshots > 0 || !keyframe.animation.empty())) {
+						entities.emplace_back(it->first, &keyframe);
+						size += keyframe.snapshots.size() + keyframe.animation.size();
+					}
+				}
+				if (entities.empty()) {
+					continue;
+				}
+
+				OutArchive ar(m_keyframePacket);
+				ar(sender);
+				ar(entities.size());
+				for (const auto& [id, keyframe] : entities) {
+					ar(id);
+					ar(keyframe->type);
+					ar(keyframe->numSnapshots + (keyframe->animation.empty() ? 0 : 1));
+					ar.writeRaw(keyframe->snapshots.data(), keyframe->snapshots.size());
+					ar.writeRaw(keyframe->animation.data(), keyframe->animation.size());
+				}
+				ar(size_t{ 0 }); // nrOfEvents
+
+				m_compressor.compress(ar.data(), ar.size(), m_compressed);
+				appendPacket(m_keyframePackets, m_compressed.data(), m_compressed.size(), ReplayFile::STATE);
+				numPackets++;
+			}
+		}
+
+		// Then everything that the events have built up, which isn't per-tick state
+		m_keyframeEvents.writePackets(m_keyframePacket, KEYFRAME_PACKET_SIZE, [&](const OutArchive& ar) {
+			m_compressor.compress(ar.data(), ar.size(), m_compressed);
+			appendPacket(m_keyframePackets, m_compressed.data(), m_compressed.size(), 0);
+			numPackets++;
+		});
+
+		m_keyframes.push_back({ m_offset, static_cast<std::uint32_t>(m_tick), numPackets });
+		writeRecord(ReplayFile::KEYFRAME, m_keyframePackets, numPackets);
+	}
+
+	void ReplayWriter::writeRecord(ReplayFile::RecordType type, const std::vector<char>& packets, std::uint32_t numPackets) {
+		Write(m_file, type);
+		Write(m_file, static_cast<std::uint32_t>(m_tick));
+		Write(m_file, numPackets);
+		m_file.write(packets.data(), packets.size());
+		m_offset += ReplayFile::RECORD_HEADER_SIZE + packets.size();
+	}
+
+	void ReplayWriter::appendPacket(std::vector<char>& packets, const char* data, size_t size, std::uint8_t flags) {
+		const std::uint32_t packetSize = static_cast<std::uint32_t>(size);
+		const char* sizeBytes = reinterpret_cast<const char*>(&packetSize);
+		packets.insert(packets.end(), sizeBytes, sizeBytes + sizeof(packetSize));
+		packets.push_back(static_cast<char>(flags));
+		packets.insert(packets.end(), data, data + size);
+	}
+
+
+	ReplayReader::~ReplayReader() {
+		close();
+	}
+
+	bool ReplayReader::open(const std::string& path) {
+		close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		m_fileHandle = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || static_cast<size_t>(size.QuadPart) < sizeof(ReplayFile::Header)) {
+			close();
+			return false;
+		}
+		m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_mapping) {
+			close();
+			return false;
+		}
+		m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!m_data) {
+			close();
+			return false;
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		m_header = Load<ReplayFile::Header>(m_data);
+		const bool valid = std::equal(ReplayFile::MAGIC, ReplayFile::MAGIC + sizeof(ReplayFile::MAGIC), m_header.magic)
+			&& (m_header.version == ReplayFile::VERSION || m_header.version == ReplayFile::STATE_KEYFRAMES_VERSION)
+			&& m_header.metadataOffset + m_header.metadataSize <= m_size;
+		// The indices are only written when the recording is closed
+		if (!valid || !(m_header.tickIndexOffset ? readIndex() : scanRecords())) {
+			close();
+			return false;
+		}
+		// A new match can't be started from keyframes without the events
+		if (m_header.version == ReplayFile::STATE_KEYFRAMES_VERSION) {
+			m_keyframes.clear();
+		}
+		return true;
+	}
+
+	void ReplayReader::close() {
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping) {
+			CloseHandle(m_mapping);
+		}
+		if (m_fileHandle) {
+			CloseHandle(m_fileHandle);
+		}
+		m_fileHandle = nullptr;
+		m_mapping = nullptr;
+		m_data = nullptr;
+		m_size = 0;
+
+		m_header = {};
+		m_ticks.clear();
+		m_keyframes.clear();
+	}
+
+	bool ReplayReader::isOpen() const {
+		return m_data != nullptr;
+	}
+
+	const char* ReplayReader::getMetadata(size_t& size) const {
+		size = static_cast<size_t>(m_header.metadataSize);
+		return m_data + m_header.metadataOffset;
+	}
+
+	size_t ReplayReader::getNumTicks() const {
+		return m_ticks.size();
+	}
+
+	size_t ReplayReader::getNumKeyframes() const {
+		return m_keyframes.size();
+	}
+
+	unsigned int ReplayReader::getKeyframeInterval() const {
+		return m_header.keyframeInterval;
+	}
+
+	bool ReplayReader::readTick(size_t tick, std::vector<Packet>& out) const {
+		out.clear();
+		return tick < m_ticks.size() && readRecord(m_ticks[tick], out);
+	}
+
+	bool ReplayReader::findKeyframe(size_t tick, size_t& keyframeTick) const {
+		const ReplayFile::IndexEntry* entry = findKeyframeEntry(tick);
+		if (!entry) {
+			return false;
+		}
+		keyframeTick = entry->tick;
+		return true;
+	}
+
+	bool ReplayReader::readKeyframe(size_t tick, size_t& keyframeTick, std::vector<Packet>& out) const {
+		out.clear();
+		const ReplayFile::IndexEntry* entry = findKeyframeEntry(tick);
+		if (!entry) {
+			return false;
+		}
+		keyframeTick = entry->tick;
+		return readRecord(*entry, out);
+	}
+
+	size_t ReplayReader::getByteSize() const {
+		return sizeof(*this) + (m_ticks.capacity() + m_keyframes.capacity()) * sizeof(ReplayFile::IndexEntry);
+	}
+
+	bool ReplayReader::readIndex() {
+		const size_t entrySize = sizeof(ReplayFile::IndexEntry);
+		if (m_header.tickIndexOffset + m_header.numTicks * entrySize > m_size || m_header.keyframeIndexOffset + m_header.numKeyframes * entrySize > m_size) {
+			return false;
+		}
+
+		m_ticks.resize(m_header.numTicks);
+		m_keyframes.resize(m_header.numKeyframes);
+		std::memcpy(m_ticks.data(), m_data + m_header.tickIndexOffset, m_ticks.size() * entrySize);
+		std::memcpy(m_keyframes.data(), m_data + m_header.keyframeIndexOffset, m_keyframes.size() * entrySize);
+		return true;
+	}
+
+	bool ReplayReader::scanRecords() {
+		size_t offset = static_cast<size_t>(m_header.metadataOffset + m_header.metadataSize);
+		while (offset + ReplayFile::RECORD_HEADER_SIZE <= m_size) {
+			ReplayFile::IndexEntry entry;
+			const std::uint8_t type = Load<std::uint8_t>(m_data + offset);
+			entry.offset = offset;
+			entry.tick = Load<std::uint32_t>(m_data + offset + sizeof(std::uint8_t));
+			entry.numPackets = Load<std::uint32_t>(m_data + offset + sizeof(std::uint8_t) + sizeof(std::uint32_t));
+
+			// The last record is cut off if the game stopped while it was being written
+			size_t position = offset + ReplayFile::RECORD_HEADER_SIZE;
+			for (std::uint32_t i = 0; i < entry.numPackets && position <= m_size; i++) {
+				if (position + ReplayFile::PACKET_HEADER_SIZE > m_size) {
+					position = m_size + 1;
+					break;
+				}
+				position += ReplayFile::PACKET_HEADER_SIZE + Load<std::uint32_t>(m_data + position);
+			}
+			if (position > m_size) {
+				break;
+			}
+
+			if (type == ReplayFile::KEYFRAME) {
+				m_keyframes.push_back(entry);
+			} else {
+				m_ticks.push_back(entry);
+			}
+			offset = position;
+		}
+		return true;
+	}
+
+	const ReplayFile::IndexEntry* ReplayReader::findKeyframeEntry(size_t tick) const {
+		auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), tick, [](size_t t, const ReplayFile::IndexEntry& entry) {
+			return t < entry.tick;
+		});
+		return (it == m_keyframes.begin()) ? nullptr : &*std::prev(it);
+	}
+
+	bool ReplayReader::readRecord(const ReplayFile::IndexEntry& entry, std::vector<Packet>& out) const {
+		size_t position = static_cast<size_t>(entry.offset) + ReplayFile::RECORD_HEADER_SIZE;
+		for (std::uint32_t i = 0; i < entry.numPackets; i++) {
+			if (position + ReplayFile::PACKET_HEADER_SIZE > m_size) {
+				return false;
+			}
+			const size_t size = Load<std::uint32_t>(m_data + position);
+			const std::uint8_t flags = Load<std::uint8_t>(m_data + position + sizeof(std::uint32_t));
+			position += ReplayFile::PACKET_HEADER_SIZE;
+			if (position + size > m_size) {
+				return false;
+			}
+			out.push_back({ m_data + position, size, (flags & ReplayFile::STATE) != 0 });
+			position += size;
+		}
+		return true;
+	}
+
+
+	bool IsLegacyReplay(const std::string& path) {
+		std::ifstream file(path, std::ifstream::binary);
+		char magic[sizeof(ReplayFile::MAGIC)];
+		if (!file.read(magic, sizeof(magic))) {
+			return false;
+		}
+		return !std::equal(ReplayFile::MAGIC, ReplayFile::MAGIC + sizeof(ReplayFile::MAGIC), magic);
+	}
+
+	bool ConvertLegacyReplay(const std::string& from, const std::string& to, unsigned int keyframeInterval) {
+		std::ifstream file(from, std::ifstream::binary);
+		std::string metadata;
+		if (!file.is_open() || !ReadLegacyMetadata(file, metadata)) {
+			return false;
+		}
+
+		ReplayWriter writer;
+		if (!writer.open(to, metadata, keyframeInterval)) {
+			return false;
+		}
+
+		// The packets of every tick, the last tick is cut off if the game stopped while it was being written
+		std::uint32_t numPackets = 0;
+		std::string packet;
+		while (Read(file, numPackets)) {
+			for (std::uint32_t i = 0; i < numPackets; i++) {
+				std::uint32_t size = 0;
+				if (!Read(file, size)) {
+					return writer.close();
+				}
+				packet.resize(size);
+				if (!file.read(&packet[0], size)) {
+					return writer.close();
+				}
+				// Old replays don't know which packets were sent as state
+				writer.addPacket(packet.data(), packet.size(), true);
+			}
+			writer.endTick();
+		}
+		return writer.close();
+	}
+
+	bool ReadReplayPackets(const std::string& path, std::vector<std::string>& packets) {
+		if (!IsLegacyReplay(path)) {
+			ReplayReader reader;
+			if (!reader.open(path)) {
+				return false;
+			}
+
+			std::vector<ReplayReader::Packet> tickPackets;
+			for (size_t tick = 0; tick < reader.getNumTicks(); tick++) {
+				reader.readTick(tick, tickPackets);
+				for (const ReplayReader::Packet& packet : tickPackets) {
+					packets.emplace_back(packet.data, packet.size);
+				}
+			}
+			return true;
+		}
+
+		std::ifstream file(path, std::ifstream::binary);
+		std::string metadata;
+		if (!file.is_open() || !ReadLegacyMetadata(file, metadata)) {
+			return false;
+		}
+
+		std::uint32_t numPackets = 0;
+		while (Read(file, numPackets)) {
+			for (std::uint32_t i = 0; i < numPackets; i++) {
+				std::uint32_t size = 0;
+				if (!Read(file, size)) {
+					return true;
+				}
+				std::string packet(size, '\0');
+				if (!file.read(&packet[0], size)) {
+					return true;
+				}
+				packets.push_back(std::move(packet));
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "KeyframeEvents.h"
+#include "PacketCompressor.h"
+#include "StatePacket.h"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+  Replay files with a tick index and periodic keyframes, so that playback can jump to any tick, back or forward,
+  without going through every tick before it. The reader memory maps the file, playing it back doesn't read from
+  the file every tick.
+
+  The packets are stored as they were received, compressed. State packets are marked so that they can be given back
+  separately and forwarded unreliably again. A keyframe has the whole world at its tick, so that a new match can be
+  started from it without reading any tick before it: the transform snapshots of every entity since its last snapshot
+  keyframe and its last animation, and what the events have built up so far, see KeyframeEvents. Seeking, back or
+  forward, restores the last keyframe at or before the tick on a new match and replays only the ticks after it.
+  Keyframes are packets in the same format as the ones they replace, one or more per sender for the state and the
+  events after them.
+
+  Logical structure of a replay file:
+	--------------------------------------------------
+	| Header                                         |
+	| char            metadata[metadataSize]         |  Players and settings, see MatchRecordSystem
+	| Record          records[]                      |  One per tick and one per keyframe, in the order they were written
+	|     uint8_t         RecordType                 |
+	|     uint32_t        tick                       |
+	|     uint32_t        nrOfPackets                |
+	|         uint32_t        size                   |
+	|         uint8_t         PacketFlags            |
+	|         char            data[size]             |
+	| IndexEntry      ticks[numTicks]                |
+	| IndexEntry      keyframes[numKeyframes]        |
+	--------------------------------------------------
+  The indices and the header's counts are written when the recording is closed. The records are enough to read a
+  replay whose recording was never closed, the reader finds them by going through the whole file.
+
+  Replays recorded before this format have no header, they are the metadata followed by the packets of every tick
+  and can be converted with ConvertLegacyReplay(). The keyframes of version 1 only have the state, they are ignored
+  and those replays are always played from their start.
+*/
+namespace Netcode {
+	namespace ReplayFile {
+		static constexpr char MAGIC[4] = { 'S', 'R', 'P', 'L' };
+		static constexpr std::uint32_t VERSION = 2;
+		// Before the keyframes had the events in them
+		static constexpr std::uint32_t STATE_KEYFRAMES_VERSION = 1;
+
+		enum RecordType : std::uint8_t {
+			TICK     = 0,
+			KEYFRAME = 1,
+		};
+
+		enum PacketFlags : std::uint8_t {
+			STATE = 1 << 0, // Per-tick state, sent unreliably
+		};
+
+		struct Header {
+			char magic[4];
+			std::uint32_t version;
+			std::uint32_t keyframeInterval;
+			std::uint32_t numTicks;      // 0 if the recording wasn't closed
+			std::uint32_t numKeyframes;
+			std::uint32_t reserved;
+			std::uint64_t metadataOffset;
+			std::uint64_t metadataSize;
+			std::uint64_t tickIndexOffset;
+			std::uint64_t keyframeIndexOffset;
+		};
+
+		struct IndexEntry {
+			std::uint64_t offset; // Of the record
+			std::uint32_t tick;
+			std::uint32_t numPackets;
+		};
+
+		static constexpr size_t RECORD_HEADER_SIZE = sizeof(std::uint8_t) + 2 * sizeof(std::uint32_t);
+		static constexpr size_t PACKET_HEADER_SIZE = sizeof(std::uint32_t) + sizeof(std::uint8_t);
+	}
+
+	class ReplayWriter {
+	public:
+		static constexpr unsigned int DEFAULT_KEYFRAME_INTERVAL = 128;
+		// Keyframes are split into packets of about this size before they are compressed
+		static constexpr size_t KEYFRAME_PACKET_SIZE = 4096;
+
+		ReplayWriter();
+		ReplayWriter(const ReplayWriter&) = delete;
+		ReplayWriter& operator=(const ReplayWriter&) = delete;
+		~ReplayWriter();
+
+		bool open(const std::string& path, const std::string& metadata, unsigned int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+		// Adds a compressed packet to the current tick and reads what the keyframes need from it.
+		// mightBeState only saves trying to read the packets that are known not to be state packets as one.
+		void addPacket(const char* data, size_t size, bool mightBeState);
+		// Writes the current tick and a keyframe after it if it's time for one
+		void endTick();
+		// Writes the indices, the file can't be written to after this
+		bool close();
+		bool isOpen() const;
+
+	private:
+		// The snapshots and animation of an entity that are needed to know where it is
+		struct KeyframeEntity {
+			PlayerID sender = 0;
+			EntityType type = EntityType::INVALID_ENTITY;
+			size_t lastTick = 0;
+			size_t numSnapshots = 0;
+			std::vector<char> snapshots;
+			std::vector<char> animation;
+		};
+
+		// Reads the packet in m_decompressed
+		bool readStatePacket();
+		void writeKeyframe();
+		void writeRecord(ReplayFile::RecordType type, const std::vector<char>& packets, std::uint32_t numPackets);
+		void appendPacket(std::vector<char>& packets, const char* data, size_t size, std::uint8_t flags);
+
+	private:
+		std::ofstream m_file;
+		std::uint64_t m_offset = 0;
+		ReplayFile::Header m_header = {};
+		std::vector<ReplayFile::IndexEntry> m_ticks;
+		std::vector<ReplayFile::IndexEntry> m_keyframes;
+
+		size_t m_tick = 0;
+		std::vector<char> m_tickPackets;
+		std::uint32_t m_tickNumPackets = 0;
+
+		// Keyframes, sorted so that the same recording always gives the same file
+		std::map<ComponentID, KeyframeEntity> m_keyframeEntities;
+		KeyframeEvents m_keyframeEvents;
+		PacketCompressor m_compressor;
+		StatePacket m_statePacket;
+		std::vector<char> m_decompressed;
+		std::vector<char> m_keyframePacket;
+		std::vector<char> m_keyframePackets;
+		std::string m_compressed;
+	};
+
+	class ReplayReader {
+	public:
+		struct Packet {
+			const char* data; // Points into the mapped file and stays valid until the reader is closed
+			size_t size;
+			bool state;
+		};
+
+		ReplayReader() = default;
+		ReplayReader(const ReplayReader&) = delete;
+		ReplayReader& operator=(const ReplayReader&) = delete;
+		~ReplayReader();
+
+		// Fails for replays in the old format, see IsLegacyReplay()
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const;
+
+		const char* getMetadata(size_t& size) const;
+		size_t getNumTicks() const;
+		size_t getNumKeyframes() const;
+		unsigned int getKeyframeInterval() const;
+
+		// Replaces the content of out with the packets of the tick
+		bool readTick(size_t tick, std::vector<Packet>& out) const;
+		// Finds the last keyframe at or before the tick, false if there is none
+		bool findKeyframe(size_t tick, size_t& keyframeTick) const;
+		// Replaces the content of out with the packets of the last keyframe at or before the tick, false if there is none
+		bool readKeyframe(size_t tick, size_t& keyframeTick, std::vector<Packet>& out) const;
+
+		size_t getByteSize() const;
+
+	private:
+		bool readIndex();
+		bool scanRecords();
+		bool readRecord(const ReplayFile::IndexEntry& entry, std::vector<Packet>& out) const;
+		const ReplayFile::IndexEntry* findKeyframeEntry(size_t tick) const;
+
+	private:
+		void* m_fileHandle = nullptr;
+		void* m_mapping = nullptr;
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+
+		ReplayFile::Header m_header = {};
+		std::vector<ReplayFile::IndexEntry> m_ticks;
+		std::vector<ReplayFile::IndexEntry> m_keyframes;
+	};
+
+	// Old replays are the metadata followed by the packets of every tick, without a header
+	bool IsLegacyReplay(const std::string& path);
+	// Writes an old replay in the current format, with keyframes
+	bool ConvertLegacyReplay(const std::string& from, const std::string& to, unsigned int keyframeInterval = ReplayWriter::DEFAULT_KEYFRAME_INTERVAL);
+	// Appends all packets in a replay of either format to packets, as they were recorded
+	bool ReadReplayPackets(const std::string& path, std::vector<std::string>& packets);
+}
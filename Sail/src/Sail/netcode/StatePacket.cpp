@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "StatePacket.h"
+#include "TransformSnapshot.h"
+
+namespace Netcode {
+	bool StatePacket::parse(const char* data, size_t size) {
+		m_entities.clear();
+		m_messages.clear();
+
+		InArchive ar(data, size);
+		size_t numEntities = 0;
+		ar(m_sender);
+		ar(numEntities);
+		// Every entity takes more than one byte, anything larger is a broken packet
+		if (numEntities > size) {
+			return false;
+		}
+
+		for (size_t i = 0; i < numEntities; i++) {
+			Entity entity;
+			size_t numMessages = 0;
+			ar(entity.id);
+			ar(entity.type);
+			ar(numMessages);
+			if (numMessages > size) {
+				return false;
+			}
+			entity.firstMessage = m_messages.size();
+			entity.numMessages = numMessages;
+
+			for (size_t j = 0; j < numMessages; j++) {
+				Message message;
+				message.begin = ar.getPosition();
+				message.standalone = false;
+				message.sequence = 0;
+				ar(message.type);
+
+				// Has to match what NetworkSenderSystem writes for these messages
+				switch (message.type) {
+				case MessageType::ANIMATION:
+				{
+					unsigned int index;
+					float time;
+					float pitch;
+					ar(index);
+					ar(time);
+					ar(pitch);
+				}
+				break;
+				case MessageType::TRANSFORM_SNAPSHOT:
+					if (ar.getRemainingSize() > 0) {
+						message.sequence = static_cast<std::uint8_t>(data[ar.getPosition()]);
+					}
+					message.standalone = TransformSnapshot::Skip(ar);
+					break;
+				default:
+					return false;
+				}
+				message.end = ar.getPosition();
+				m_messages.push_back(message);
+			}
+			m_entities.push_back(entity);
+		}
+
+		// Packets with events are sent reliably
+		size_t numEvents = 0;
+		ar(numEvents);
+		return numEvents == 0 && !ar.hasFailed();
+	}
+
+	PlayerID StatePacket::getSender() const {
+		return m_sender;
+	}
+
+	const std::vector<StatePacket::Entity>& StatePacket::getEntities() const {
+		return m_entities;
+	}
+
+	const std::vector<StatePacket::Message>& StatePacket::getMessages() const {
+		return m_messages;
+	}
+
+	size_t StatePacket::getByteSize() const {
+		return sizeof(*this) + m_entities.capacity() * sizeof(Entity) + m_messages.capacity() * sizeof(Message);
+	}
+}
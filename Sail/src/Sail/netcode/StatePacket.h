@@ -0,0 +1,48 @@
+#pragma once
+
+#include "NetworkedStructs.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Netcode {
+	/*
+	  Reads the layout of a decompressed per-tick state packet without decoding its messages: which entities are in it
+	  and where in the packet each of their messages are, so that the messages can be copied into other packets as they are.
+
+	  Only packets with TRANSFORM_SNAPSHOT and ANIMATION messages and no events can be parsed, which is what
+	  NetworkSenderSystem sends over the unreliable channel.
+	*/
+	class StatePacket {
+	public:
+		// Byte range of a message in the packet, including its MessageType
+		struct Message {
+			MessageType type;
+			size_t begin;
+			size_t end;
+			bool standalone;       // A snapshot with any fields, snapshots never need the ones before them to be decoded
+			std::uint8_t sequence; // Of snapshots
+		};
+
+		struct Entity {
+			ComponentID id;
+			EntityType type;
+			size_t firstMessage;
+			size_t numMessages;
+		};
+
+		// Returns false if the packet isn't a state packet, the entities and messages are reused for every packet
+		bool parse(const char* data, size_t size);
+
+		PlayerID getSender() const;
+		const std::vector<Entity>& getEntities() const;
+		const std::vector<Message>& getMessages() const;
+
+		size_t getByteSize() const;
+
+	private:
+		PlayerID m_sender = 0;
+		std::vector<Entity> m_entities;
+		std::vector<Message> m_messages;
+	};
+}
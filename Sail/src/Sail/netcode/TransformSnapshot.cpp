@@ -0,0 +1,347 @@
+#include "pch.h"
+#include "TransformSnapshot.h"
+#include "NetworkedStructs.h"
+
+#include "Sail/entities/ECS.h"
+#include "Sail/entities/systems/Gameplay/LevelSystem/LevelSystem.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// 2 bits per axis in the modes of a snapshot, either all axes of a field are sent or none of them
+	enum Mode : std::uint16_t {
+		UNCHANGED = 0,
+		FULL      = 2, // uint16_t quantized value, or the packed quaternion
+		RAW       = 3, // float, only for positions outside of the bounds
+	};
+	static constexpr unsigned int POSITION_SHIFT = 0;
+	static constexpr unsigned int EULER_SHIFT    = 6;
+	static constexpr unsigned int QUAT_SHIFT     = 12;
+
+	static constexpr float QUAT_RANGE = 0.70710678f; // The three smallest components of a unit quaternion are within +-1/sqrt(2)
+	static constexpr float QUAT_STEPS = 1023.f;      // 10 bits each
+
+	Mode GetMode(std::uint16_t modes, unsigned int shift, unsigned int index) {
+		return static_cast<Mode>((modes >> (shift + index * 2)) & 3);
+	}
+
+	void SetMode(std::uint16_t& modes, unsigned int shift, unsigned int index, Mode mode) {
+		modes |= static_cast<std::uint16_t>(mode << (shift + index * 2));
+	}
+
+	bool InBounds(float v, float min, float max) {
+		return v >= min && v <= max;
+	}
+
+	std::uint16_t QuantizePosition(float v, float min, float max) {
+		const float t = std::clamp((v - min) / (max - min), 0.f, 1.f);
+		return static_cast<std::uint16_t>(std::lround(t * 65535.f));
+	}
+
+	float DequantizePosition(std::uint16_t q, float min, float max) {
+		return min + (static_cast<float>(q) / 65535.f) * (max - min);
+	}
+
+	// Wraps around, just like Transform keeps its euler angles within [0, 2pi)
+	std::uint16_t QuantizeAngle(float angle) {
+		float t = angle / glm::two_pi<float>();
+		t -= std::floor(t);
+		return static_cast<std::uint16_t>(std::lround(t * 65536.f) & 0xFFFF);
+	}
+
+	float DequantizeAngle(std::uint16_t q) {
+		return (static_cast<float>(q) / 65536.f) * glm::two_pi<float>();
+	}
+
+	// A field is sent if it changed in the last REDUNDANCY snapshots, and always in keyframes
+	bool SendField(bool changed, bool keyframe, std::uint8_t& repeats) {
+		if (changed) {
+			repeats = Netcode::TransformSnapshot::REDUNDANCY;
+		}
+		if (repeats > 0) {
+			repeats--;
+			return true;
+		}
+		return keyframe;
+	}
+
+	// Fields whose modes are 0 are left out, position is used for FULL axes and rawPosition for RAW ones
+	void WriteFields(std::uint8_t sequence, std::uint16_t modes, const std::uint16_t* position, const float* rawPosition,
+		const std::uint16_t* euler, std::uint32_t quat, Netcode::OutArchive& ar) {
+		ar(sequence);
+		ar(modes);
+		for (unsigned int i = 0; i < 3; i++) {
+			switch (GetMode(modes, POSITION_SHIFT, i)) {
+			case FULL: ar(position[i]); break;
+			case RAW:  ar(rawPosition[i]); break;
+			default: break;
+			}
+		}
+		for (unsigned int i = 0; i < 3; i++) {
+			if (GetMode(modes, EULER_SHIFT, i) == FULL) {
+				ar(euler[i]);
+			}
+		}
+		if (GetMode(modes, QUAT_SHIFT, 0) == FULL) {
+			ar(quat);
+		}
+	}
+}
+
+namespace Netcode {
+	namespace TransformSnapshot {
+		Bounds Bounds::FromLevel() {
+			Bounds bounds;
+			LevelSystem* level = ECS::Instance()->getSystem<LevelSystem>();
+			if (!level) {
+				return bounds;
+			}
+
+			// Tiles are centered on multiples of tileSize, leave a tile of margin around the map
+			const float margin = static_cast<float>(level->tileSize);
+			bounds.min = glm::vec3(-margin, -10.f, -margin);
+			bounds.max = glm::vec3(level->xsize * level->tileSize + margin, 30.f, level->ysize * level->tileSize + margin);
+			return bounds;
+		}
+
+		bool Skip(InArchive& ar) {
+			std::uint8_t sequence = 0;
+			std::uint16_t modes = 0;
+			ar(sequence);
+			ar(modes);
+
+			for (unsigned int shift : { POSITION_SHIFT, EULER_SHIFT }) {
+				for (unsigned int i = 0; i < 3; i++) {
+					std::uint16_t quantized;
+					float raw;
+					switch (GetMode(modes, shift, i)) {
+					case FULL: ar(quantized); break;
+					case RAW:  ar(raw); break;
+					default: break;
+					}
+				}
+			}
+			if (GetMode(modes, QUAT_SHIFT, 0) == FULL) {
+				std::uint32_t quat;
+				ar(quat);
+			}
+			return modes != 0;
+		}
+
+		bool IsKeyframe(ComponentID id, std::uint8_t sequence) {
+			// Staggered so that the keyframes of all entities aren't sent in the same packet
+			return ((sequence + id) % KEYFRAME_INTERVAL) == 0;
+		}
+
+		std::uint32_t PackQuat(const glm::quat& rotation) {
+			const glm::quat q = glm::normalize(rotation);
+
+			unsigned int largest = 0;
+			for (unsigned int i = 1; i < 4; i++) {
+				if (std::abs(q[i]) > std::abs(q[largest])) {
+					largest = i;
+				}
+			}
+			// q and -q are the same rotation, flip it so that the left out component is positive
+			const float sign = (q[largest] < 0.f) ? -1.f : 1.f;
+
+			std::uint32_t packed = largest;
+			for (unsigned int i = 0; i < 4; i++) {
+				if (i == largest) {
+					continue;
+				}
+				const float t = std::clamp((sign * q[i] / QUAT_RANGE + 1.f) * 0.5f, 0.f, 1.f);
+				packed = (packed << 10) | static_cast<std::uint32_t>(std::lround(t * QUAT_STEPS));
+			}
+			return packed;
+		}
+
+		glm::quat UnpackQuat(std::uint32_t packed) {
+			const unsigned int largest = packed >> 30;
+
+			glm::quat q;
+			float sumOfSquares = 0.f;
+			unsigned int shift = 20;
+			for (unsigned int i = 0; i < 4; i++) {
+				if (i == largest) {
+					continue;
+				}
+				const float t = static_cast<float>((packed >> shift) & 0x3FF) / QUAT_STEPS;
+				q[i] = (t * 2.f - 1.f) * QUAT_RANGE;
+				sumOfSquares += q[i] * q[i];
+				shift -= 10;
+			}
+			q[largest] = std::sqrt(std::max(0.f, 1.f - sumOfSquares));
+			return glm::normalize(q);
+		}
+
+		void Merge(InArchive& ar, Latest& latest) {
+			std::uint16_t modes = 0;
+			ar(latest.sequence);
+			ar(modes);
+
+			for (unsigned int i = 0; i < 3; i++) {
+				switch (GetMode(modes, POSITION_SHIFT, i)) {
+				case FULL: ar(latest.position[i]); break;
+				case RAW:  ar(latest.rawPosition[i]); break;
+				default: break;
+				}
+			}
+			for (unsigned int i = 0; i < 3; i++) {
+				if (GetMode(modes, EULER_SHIFT, i) == FULL) {
+					ar(latest.euler[i]);
+				}
+			}
+			if (GetMode(modes, QUAT_SHIFT, 0) == FULL) {
+				ar(latest.quat);
+			}
+
+			// All axes of a field are sent or none of them, so the modes are replaced one field at a time
+			for (unsigned int shift : { POSITION_SHIFT, EULER_SHIFT, QUAT_SHIFT }) {
+				const std::uint16_t mask = static_cast<std::uint16_t>(((shift == QUAT_SHIFT) ? 0x3 : 0x3F) << shift);
+				if (modes & mask) {
+					latest.modes = static_cast<std::uint16_t>((latest.modes & ~mask) | (modes & mask));
+				}
+			}
+		}
+
+		void WriteLatest(const Latest& latest, OutArchive& ar) {
+			WriteFields(latest.sequence, latest.modes, latest.position, latest.rawPosition, latest.euler, latest.quat, ar);
+		}
+	}
+
+
+	void SnapshotEncoder::setBounds(const TransformSnapshot::Bounds& bounds) {
+		m_bounds = bounds;
+	}
+
+	void SnapshotEncoder::write(ComponentID id, std::uint8_t fields, const TransformSnapshot::Transform& transform, OutArchive& ar) {
+		const size_t start = ar.size();
+		auto [it, inserted] = m_lastSent.try_emplace(id);
+		TransformSnapshot::LastSent& lastSent = it->second;
+
+		lastSent.sequence = inserted ? 0 : static_cast<std::uint8_t>(lastSent.sequence + 1);
+		const bool keyframe = inserted || TransformSnapshot::IsKeyframe(id, lastSent.sequence);
+
+		std::uint16_t modes = 0;
+		if (fields & TransformSnapshot::POSITION) {
+			// Positions outside of the bounds are clamped when quantized, so they always count as changed
+			bool changed = !lastSent.hasPosition;
+			bool inBounds[3];
+			for (unsigned int i = 0; i < 3; i++) {
+				const std::uint16_t q = QuantizePosition(transform.position[i], m_bounds.min[i], m_bounds.max[i]);
+				inBounds[i] = InBounds(transform.position[i], m_bounds.min[i], m_bounds.max[i]);
+				changed |= (q != lastSent.position[i]) || !inBounds[i];
+				lastSent.position[i] = q;
+			}
+			lastSent.hasPosition = true;
+			if (SendField(changed, keyframe, lastSent.positionRepeats)) {
+				for (unsigned int i = 0; i < 3; i++) {
+					SetMode(modes, POSITION_SHIFT, i, inBounds[i] ? FULL : RAW);
+				}
+			}
+		}
+		if (fields & TransformSnapshot::EULER_ROTATION) {
+			bool changed = !lastSent.hasEuler;
+			for (unsigned int i = 0; i < 3; i++) {
+				const std::uint16_t q = QuantizeAngle(transform.euler[i]);
+				changed |= (q != lastSent.euler[i]);
+				lastSent.euler[i] = q;
+			}
+			lastSent.hasEuler = true;
+			if (SendField(changed, keyframe, lastSent.eulerRepeats)) {
+				for (unsigned int i = 0; i < 3; i++) {
+					SetMode(modes, EULER_SHIFT, i, FULL);
+				}
+			}
+		}
+		if (fields & TransformSnapshot::QUAT_ROTATION) {
+			const std::uint32_t q = TransformSnapshot::PackQuat(transform.rotation);
+			const bool changed = !lastSent.hasQuat || q != lastSent.quat;
+			lastSent.quat = q;
+			lastSent.hasQuat = true;
+			if (SendField(changed, keyframe, lastSent.quatRepeats)) {
+				SetMode(modes, QUAT_SHIFT, 0, FULL);
+			}
+		}
+
+		WriteFields(lastSent.sequence, modes, lastSent.position, &transform.position.x, lastSent.euler, lastSent.quat, ar);
+
+		// The message type is written by the caller
+		constexpr size_t VEC3_MESSAGE = sizeof(MessageType) + 3 * sizeof(float);
+		m_stats.snapshots++;
+		m_stats.bytes += sizeof(MessageType) + ar.size() - start;
+		if (fields & TransformSnapshot::QUAT_ROTATION) {
+			m_stats.unquantizedBytes += VEC3_MESSAGE + 4 * sizeof(float);
+		} else if (fields & TransformSnapshot::POSITION) {
+			m_stats.unquantizedBytes += VEC3_MESSAGE;
+		}
+		if (fields & TransformSnapshot::EULER_ROTATION) {
+			m_stats.unquantizedBytes += VEC3_MESSAGE;
+		}
+	}
+
+	void SnapshotEncoder::erase(ComponentID id) {
+		m_lastSent.erase(id);
+	}
+
+	void SnapshotEncoder::reset() {
+		m_lastSent.clear();
+		m_stats = Stats();
+	}
+
+	const SnapshotEncoder::Stats& SnapshotEncoder::getStats() const {
+		return m_stats;
+	}
+
+	size_t SnapshotEncoder::getByteSize() const {
+		return sizeof(*this) + m_lastSent.size() * (sizeof(ComponentID) + sizeof(TransformSnapshot::LastSent) + 2 * sizeof(void*));
+	}
+
+
+	void SnapshotDecoder::setBounds(const TransformSnapshot::Bounds& bounds) {
+		m_bounds = bounds;
+	}
+
+	void SnapshotDecoder::read(InArchive& ar, Result& out) {
+		// The sequence number is only needed to find the keyframes, see ReplayWriter and InterestFilter
+		std::uint8_t sequence = 0;
+		std::uint16_t modes = 0;
+		ar(sequence);
+		ar(modes);
+
+		// Position
+		out.hasPosition = (GetMode(modes, POSITION_SHIFT, 0) != UNCHANGED);
+		for (unsigned int i = 0; i < 3; i++) {
+			const Mode mode = GetMode(modes, POSITION_SHIFT, i);
+			if (mode == FULL) {
+				std::uint16_t quantized = 0;
+				ar(quantized);
+				out.transform.position[i] = DequantizePosition(quantized, m_bounds.min[i], m_bounds.max[i]);
+			} else if (mode == RAW) {
+				ar(out.transform.position[i]);
+			}
+		}
+
+		// Euler rotation
+		out.hasEuler = (GetMode(modes, EULER_SHIFT, 0) == FULL);
+		for (unsigned int i = 0; i < 3; i++) {
+			if (GetMode(modes, EULER_SHIFT, i) == FULL) {
+				std::uint16_t quantized = 0;
+				ar(quantized);
+				out.transform.euler[i] = DequantizeAngle(quantized);
+			}
+		}
+
+		// Quaternion rotation
+		out.hasQuat = (GetMode(modes, QUAT_SHIFT, 0) == FULL);
+		if (out.hasQuat) {
+			std::uint32_t packed = 0;
+			ar(packed);
+			out.transform.rotation = TransformSnapshot::UnpackQuat(packed);
+		}
+	}
+}
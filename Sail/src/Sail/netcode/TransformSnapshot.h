@@ -0,0 +1,153 @@
+#pragma once
+
+#include "ArchiveTypes.h"
+#include "NetcodeTypes.h"
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+/*
+  Quantized transforms that leave out the fields which haven't changed, sent as one TRANSFORM_SNAPSHOT message per
+  entity instead of CHANGE_LOCAL_POSITION, CHANGE_LOCAL_ROTATION and CHANGE_ABSOLUTE_POS_AND_ROT.
+
+  Positions are quantized to 16 bits per axis within the map bounds from the LevelSystem and euler rotations to
+  16 bits per axis over a full turn, positions outside of the map are sent as floats. Quaternion rotations are sent
+  with the smallest three encoding in 32 bits.
+
+  Snapshots are sent over the unreliable channel where any of them may be lost, and nothing is acknowledged since the
+  host forwards the clients' packets to everyone as they are. So a snapshot never depends on the ones before it:
+  a field is either left out or sent in full, and a field that changed is sent in the next REDUNDANCY snapshots so that
+  it takes that many lost datagrams in a row to miss the change. Every entity also sends a keyframe with all of its
+  fields every KEYFRAME_INTERVAL snapshots, which is how the killcam and players who start spectating in the middle of
+  the stream get the fields that haven't changed in a while.
+
+  Logical structure of a snapshot:
+	--------------------------------------------------
+	| uint8_t         sequence                       |
+	| uint16_t        modes (2 bits per axis)        |
+	|     position.x/y/z   uint16_t or float         |
+	|     euler.x/y/z      uint16_t                  |
+	|     quaternion       uint32_t                  |
+	--------------------------------------------------
+*/
+namespace Netcode {
+	namespace TransformSnapshot {
+		static constexpr unsigned int KEYFRAME_INTERVAL = 16; // Has to divide 256 so that the sequence number can wrap around
+		static constexpr unsigned int REDUNDANCY = 3;         // Snapshots in a row that a changed field is sent in
+
+		// The transform fields an entity sends
+		enum Fields : std::uint8_t {
+			POSITION       = 1 << 0,
+			EULER_ROTATION = 1 << 1,
+			QUAT_ROTATION  = 1 << 2,
+		};
+
+		// Space that positions are quantized in, everything outside of it is sent as floats
+		struct Bounds {
+			glm::vec3 min = glm::vec3(0.f);
+			glm::vec3 max = glm::vec3(1.f);
+
+			// The area covered by the current map, the same on every client since they all generate the same map
+			static Bounds FromLevel();
+		};
+
+		// Reads past a snapshot without decoding it, returns true if it has any fields
+		bool Skip(InArchive& ar);
+		// Snapshots with this sequence number have every field in full, the keyframes of different entities are staggered
+		bool IsKeyframe(ComponentID id, std::uint8_t sequence);
+
+		// Smallest three encoding: the index of the largest component and the other three in 10 bits each
+		std::uint32_t PackQuat(const glm::quat& q);
+		glm::quat UnpackQuat(std::uint32_t packed);
+
+		// The last values sent for an entity
+		struct LastSent {
+			std::uint8_t sequence = 0;
+			bool hasPosition = false;
+			bool hasEuler = false;
+			bool hasQuat = false;
+			std::uint16_t position[3] = {};
+			std::uint16_t euler[3] = {};
+			std::uint32_t quat = 0;
+			// How many more snapshots repeat the last change of each field
+			std::uint8_t positionRepeats = 0;
+			std::uint8_t eulerRepeats = 0;
+			std::uint8_t quatRepeats = 0;
+		};
+
+		struct Transform {
+			glm::vec3 position = glm::vec3(0.f);
+			glm::vec3 euler = glm::vec3(0.f);
+			glm::quat rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
+		};
+
+		// The last value of every field that has been read for an entity, as it was encoded
+		struct Latest {
+			std::uint8_t sequence = 0;
+			std::uint16_t modes = 0;
+			std::uint16_t position[3] = {};
+			float rawPosition[3] = {};
+			std::uint16_t euler[3] = {};
+			std::uint32_t quat = 0;
+		};
+		// Reads a snapshot into latest, fields that aren't in the snapshot keep their last value
+		void Merge(InArchive& ar, Latest& latest);
+		// Writes a snapshot with every field in latest, without having to decode and encode it again
+		void WriteLatest(const Latest& latest, OutArchive& ar);
+	}
+
+	/*
+	  Writes snapshots and keeps the last values sent for every entity that has been written.
+	  Owned by the NetworkSenderSystem.
+	*/
+	class SnapshotEncoder {
+	public:
+		// Has to be set to the same bounds as the decoders use before writing
+		void setBounds(const TransformSnapshot::Bounds& bounds);
+		// fields is a combination of TransformSnapshot::Fields
+		void write(ComponentID id, std::uint8_t fields, const TransformSnapshot::Transform& transform, OutArchive& ar);
+		// Forget what was sent for a destroyed entity
+		void erase(ComponentID id);
+		void reset();
+
+		// Bytes written compared to sending the same fields as CHANGE_LOCAL_POSITION, CHANGE_LOCAL_ROTATION and
+		// CHANGE_ABSOLUTE_POS_AND_ROT messages, message types included and before the packets are compressed
+		struct Stats {
+			size_t snapshots = 0;
+			size_t bytes = 0;
+			size_t unquantizedBytes = 0;
+		};
+		const Stats& getStats() const;
+
+		size_t getByteSize() const;
+
+	private:
+		TransformSnapshot::Bounds m_bounds;
+		Stats m_stats;
+		std::unordered_map<ComponentID, TransformSnapshot::LastSent> m_lastSent;
+	};
+
+	/*
+	  Reads snapshots written by a SnapshotEncoder. Snapshots don't depend on each other so it keeps nothing per entity.
+	  Owned by the receiver systems.
+	*/
+	class SnapshotDecoder {
+	public:
+		// The fields that were sent in the last snapshot that was read
+		struct Result {
+			bool hasPosition = false;
+			bool hasEuler = false;
+			bool hasQuat = false;
+			TransformSnapshot::Transform transform;
+		};
+
+		void setBounds(const TransformSnapshot::Bounds& bounds);
+		void read(InArchive& ar, Result& out);
+
+	private:
+		TransformSnapshot::Bounds m_bounds;
+	};
+}
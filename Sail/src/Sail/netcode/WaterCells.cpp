@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "WaterCells.h"
+#include "Sail/Application.h"
+
+#include <algorithm>
+
+namespace {
+	// Water appearance setting, cells per meter along each axis
+	constexpr float VOXEL_CELLS_PER_WORLD_UNIT = 5.f;
+	constexpr int VOXELS_Y = 37;
+	constexpr float MAP_HEIGHT = 0.8f;
+	// No map has anywhere near this many cells, anything larger is a broken message
+	constexpr std::uint32_t MAX_CELLS = 1 << 20;
+
+	void WriteVarint(Netcode::OutArchive& ar, std::uint32_t value) {
+		while (value >= 0x80) {
+			ar(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		ar(static_cast<std::uint8_t>(value));
+	}
+
+	std::uint32_t ReadVarint(Netcode::InArchive& ar) {
+		std::uint32_t value = 0;
+		for (unsigned int shift = 0; shift < 32; shift += 7) {
+			std::uint8_t byte = 0;
+			ar(byte);
+			value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) {
+				break;
+			}
+		}
+		return value;
+	}
+}
+
+namespace Netcode {
+	WaterCells::Grid WaterCells::Grid::FromSettings() {
+		auto& mapSettings = Application::getInstance()->getSettings().gameSettingsDynamic["map"];
+		const float tileSize = static_cast<float>(mapSettings["tileSize"].value);
+
+		Grid grid;
+		grid.mapSize = glm::vec3(mapSettings["sizeX"].value, MAP_HEIGHT, mapSettings["sizeY"].value) * tileSize;
+		grid.mapStart = -glm::vec3(tileSize / 2.0f, 0.f, tileSize / 2.0f);
+		grid.size.x = static_cast<int>(glm::floor(grid.mapSize.x * VOXEL_CELLS_PER_WORLD_UNIT / QUARTERS_PER_VOXEL));
+		grid.size.y = VOXELS_Y;
+		grid.size.z = static_cast<int>(glm::floor(grid.mapSize.z * VOXEL_CELLS_PER_WORLD_UNIT));
+		return grid;
+	}
+
+	bool WaterCells::Grid::toCell(const glm::vec3& position, std::uint32_t& cell) const {
+		const glm::vec3 floatInd = ((position - mapStart) / mapSize) * glm::vec3(size);
+		const glm::ivec3 ind = glm::floor(floatInd);
+		if (glm::any(glm::lessThan(ind, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(ind, size))) {
+			return false;
+		}
+
+		const std::uint32_t quarter = static_cast<std::uint32_t>(glm::floor(floatInd.x * QUARTERS_PER_VOXEL)) % QUARTERS_PER_VOXEL;
+		const std::uint32_t voxel = ind.x + size.x * (ind.y + size.y * ind.z);
+		cell = voxel * QUARTERS_PER_VOXEL + quarter;
+		return true;
+	}
+
+	std::uint32_t WaterCells::Grid::getNumVoxels() const {
+		return static_cast<std::uint32_t>(size.x * size.y * size.z);
+	}
+
+	void WaterCells::setGrid(const Grid& grid) {
+		m_grid = grid;
+	}
+
+	const WaterCells::Grid& WaterCells::getGrid() const {
+		return m_grid;
+	}
+
+	void WaterCells::add(const glm::vec3& position) {
+		std::uint32_t cell;
+		if (m_grid.toCell(position, cell)) {
+			m_hits.push_back(cell);
+		}
+	}
+
+	void WaterCells::addCell(std::uint32_t cell, unsigned int hits) {
+		m_hits.insert(m_hits.end(), std::min(hits, 255u), cell);
+	}
+
+	void WaterCells::clear() {
+		m_hits.clear();
+		m_cells.clear();
+	}
+
+	bool WaterCells::empty() const {
+		return m_hits.empty() && m_cells.empty();
+	}
+
+	const std::vector<WaterCells::Cell>& WaterCells::getCells() const {
+		coalesce();
+		return m_cells;
+	}
+
+	void WaterCells::write(OutArchive& ar) const {
+		coalesce();
+
+		WriteVarint(ar, static_cast<std::uint32_t>(m_cells.size()));
+		std::uint32_t previous = 0;
+		for (const Cell& cell : m_cells) {
+			WriteVarint(ar, ((cell.index - previous) << 1) | (cell.hits > 1 ? 1 : 0));
+			if (cell.hits > 1) {
+				ar(cell.hits);
+			}
+			previous = cell.index;
+		}
+	}
+
+	bool WaterCells::read(InArchive& ar) {
+		clear();
+
+		const std::uint32_t numCells = ReadVarint(ar);
+		if (numCells > MAX_CELLS || numCells > ar.getRemainingSize()) {
+			return false;
+		}
+
+		m_cells.reserve(numCells);
+		std::uint32_t previous = 0;
+		for (std::uint32_t i = 0; i < numCells; i++) {
+			const std::uint32_t delta = ReadVarint(ar);
+			Cell cell;
+			cell.index = previous + (delta >> 1);
+			cell.hits = 1;
+			if (delta & 1) {
+				ar(cell.hits);
+			}
+			m_cells.push_back(cell);
+			previous = cell.index;
+		}
+		return !ar.hasFailed();
+	}
+
+	size_t WaterCells::getByteSize() const {
+		return sizeof(*this) + m_hits.capacity() * sizeof(std::uint32_t) + m_cells.capacity() * sizeof(Cell);
+	}
+
+	void WaterCells::coalesce() const {
+		if (m_hits.empty()) {
+			return;
+		}
+
+		// Cells that were already coalesced are added back as hits
+		for (const Cell& cell : m_cells) {
+			m_hits.insert(m_hits.end(), cell.hits, cell.index);
+		}
+		m_cells.clear();
+
+		std::sort(m_hits.begin(), m_hits.end());
+		for (std::uint32_t index : m_hits) {
+			if (!m_cells.empty() && m_cells.back().index == index) {
+				m_cells.back().hits = static_cast<std::uint8_t>(std::min(m_cells.back().hits + 1, 255));
+			} else {
+				m_cells.push_back({ index, 1 });
+			}
+		}
+		m_hits.clear();
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ArchiveTypes.h"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/*
+  Water hits quantized to the cells of the water voxel grid and coalesced, so that a tick's worth of hits can be sent
+  as one SUBMIT_WATER_POINTS message and added to the grid in one pass by the renderer.
+
+  The grid is the one DXRBase keeps the water in: every voxel is split into four quarters along x, and a cell is a
+  quarter of a voxel. Hits are collected unsorted and sorted into unique cells with a hit count when they are read.
+
+  Logical structure of a SUBMIT_WATER_POINTS message:
+	--------------------------------------------------
+	| varint          nrOfCells                      |
+	|     varint          (index - previous index) << 1 | (hits > 1)
+	|     uint8_t         hits (only if more than 1) |
+	--------------------------------------------------
+  Cells are written in increasing order, so the index deltas are small when hits are close to each other.
+*/
+namespace Netcode {
+	class WaterCells {
+	public:
+		static constexpr unsigned int QUARTERS_PER_VOXEL = 4;
+
+		struct Cell {
+			std::uint32_t index; // voxel * QUARTERS_PER_VOXEL + quarter
+			std::uint8_t hits;
+		};
+
+		// The water voxel grid of the current map, has to be the same on everyone's machine
+		struct Grid {
+			glm::vec3 mapStart = glm::vec3(0.f);
+			glm::vec3 mapSize = glm::vec3(1.f);
+			glm::ivec3 size = glm::ivec3(1); // In voxels
+
+			// Same map settings that DXRBase::rebuildWater() builds the water from
+			static Grid FromSettings();
+
+			// Returns false for positions outside of the grid
+			bool toCell(const glm::vec3& position, std::uint32_t& cell) const;
+			std::uint32_t getNumVoxels() const;
+		};
+
+		void setGrid(const Grid& grid);
+		const Grid& getGrid() const;
+
+		// Positions outside of the grid are ignored
+		void add(const glm::vec3& position);
+		void addCell(std::uint32_t cell, unsigned int hits = 1);
+		void clear();
+		bool empty() const;
+
+		// Unique cells sorted by index
+		const std::vector<Cell>& getCells() const;
+
+		void write(OutArchive& ar) const;
+		// Replaces the cells, returns false if the message is broken
+		bool read(InArchive& ar);
+
+		size_t getByteSize() const;
+
+	private:
+		void coalesce() const;
+
+	private:
+		Grid m_grid;
+		// Hits are appended here and sorted into m_cells the next time the cells are read
+		mutable std::vector<std::uint32_t> m_hits;
+		mutable std::vector<Cell> m_cells;
+	};
+}
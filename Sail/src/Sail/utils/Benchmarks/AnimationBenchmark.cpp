@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "AnimationBenchmark.h"
+#include "Sail/entities/components/AnimationComponent.h"
+#include "Sail/entities/components/RenderInActiveGameComponent.h"
+#include "Sail/entities/systems/Graphics/AnimationSystem.h"
+
+#include <iomanip>
+
+namespace {
+	constexpr float BENCHMARK_DT = 1.f / 64.f;
+	// Players change animation this often, every player at a different tick
+	constexpr unsigned int TICKS_PER_ANIMATION = 40;
+
+	std::vector<std::unique_ptr<AnimationComponent>> CreatePlayers(AnimationStack& stack, unsigned int numPlayers) {
+		std::vector<std::unique_ptr<AnimationComponent>> players;
+		players.reserve(numPlayers);
+		for (unsigned int i = 0; i < numPlayers; i++) {
+			players.push_back(std::make_unique<AnimationComponent>(&stack));
+			players.back()->setAnimation(stack.getAnimationName(i % stack.getAnimationCount()));
+			players.back()->animationTime = i * 0.1f;
+			players.back()->pitch = 0.3f;
+		}
+		return players;
+	}
+
+	void ChangeAnimations(std::vector<std::unique_ptr<AnimationComponent>>& players, unsigned int tick, unsigned int animationCount) {
+		for (unsigned int i = 0; i < players.size(); i++) {
+			if ((tick + i) % TICKS_PER_ANIMATION == 0) {
+				players[i]->setAnimation((players[i]->animationIndex + 1) % animationCount, false);
+			}
+		}
+	}
+
+	float MsSince(const std::chrono::high_resolution_clock::time_point& start) {
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+std::string Benchmarks::RunAnimationBlend(AnimationSystem<RenderInActiveGameComponent>& system, AnimationStack& stack, unsigned int numPlayers, unsigned int numTicks) {
+	const unsigned int animationCount = stack.getAnimationCount();
+	if (animationCount == 0) {
+		return "Error: the animation stack has no animations";
+	}
+
+	// Both sets of players get the same animation changes, so they should end up in the same poses
+	std::vector<std::unique_ptr<AnimationComponent>> matrixPlayers = CreatePlayers(stack, numPlayers);
+	std::vector<std::unique_ptr<AnimationComponent>> posePlayers = CreatePlayers(stack, numPlayers);
+
+	// Every player has to evaluate its own pose, otherwise the pose players would copy the poses of the matrix players
+	const bool wasDecomposed = system.getDecomposedPoses();
+	const bool wasCached = system.getPoseCache();
+	system.setPoseCache(false);
+	float matrixMs = 0.f;
+	float poseMs = 0.f;
+	float maxDifference = 0.f;
+	unsigned int numCrossFades = 0;
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		ChangeAnimations(matrixPlayers, tick, animationCount);
+		ChangeAnimations(posePlayers, tick, animationCount);
+
+		system.setDecomposedPoses(false);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (auto& player : matrixPlayers) {
+			system.updateTransforms(player.get(), BENCHMARK_DT);
+		}
+		matrixMs += MsSince(start);
+
+		system.setDecomposedPoses(true);
+		start = std::chrono::high_resolution_clock::now();
+		for (auto& player : posePlayers) {
+			system.updateTransforms(player.get(), BENCHMARK_DT);
+		}
+		poseMs += MsSince(start);
+
+		for (unsigned int i = 0; i < numPlayers; i++) {
+			numCrossFades += posePlayers[i]->nextAnimation ? 1 : 0;
+			for (unsigned int bone = 0; bone < posePlayers[i]->transformSize; bone++) {
+				for (unsigned int column = 0; column < 4; column++) {
+					const glm::vec4 difference = glm::abs(matrixPlayers[i]->transforms[bone][column] - posePlayers[i]->transforms[bone][column]);
+					maxDifference = std::max({ maxDifference, difference.x, difference.y, difference.z, difference.w });
+				}
+			}
+		}
+	}
+	system.setDecomposedPoses(wasDecomposed);
+	system.setPoseCache(wasCached);
+
+	const float ticks = static_cast<float>(std::max(numTicks, 1u));
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(4);
+	ss << "Animation blend, " << numPlayers << " players, " << numTicks << " ticks, " << 100.f * numCrossFades / std::max(numPlayers * numTicks, 1u) << "% of the updates cross-faded\n";
+	ss << "  matrices: " << matrixMs / ticks << "ms/tick\n";
+	ss << "  poses:    " << poseMs / ticks << "ms/tick (" << matrixMs / std::max(poseMs, 0.0001f) << "x)\n";
+	ss << "  largest difference in a bone matrix " << maxDifference << "\n";
+	return ss.str();
+}
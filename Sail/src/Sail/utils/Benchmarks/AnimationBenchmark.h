@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+class AnimationStack;
+class RenderInActiveGameComponent;
+template <typename T>
+class AnimationSystem;
+
+namespace Benchmarks {
+	/*
+		Updates the bone transforms of numPlayers animated players for numTicks ticks with AnimationSystem::updateTransforms()
+		once blending the frame matrices, which are decomposed every update, and once blending the poses decomposed when the stack was loaded
+		The players change animation every now and then so that cross-fades are included
+		The components are not attached to entities, only the transforms are updated
+		Returns the average time per tick of both and the largest difference between the bone matrices they gave
+	*/
+	std::string RunAnimationBlend(AnimationSystem<RenderInActiveGameComponent>& system, AnimationStack& stack, unsigned int numPlayers, unsigned int numTicks);
+}
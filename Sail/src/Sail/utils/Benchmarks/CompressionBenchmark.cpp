@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "CompressionBenchmark.h"
+#include "Sail/netcode/PacketCompressor.h"
+
+#include <iomanip>
+
+namespace {
+	float UsSince(const std::chrono::high_resolution_clock::time_point& start) {
+		return std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+std::string Benchmarks::RunPacketCompression(const std::vector<std::string>& packets) {
+	if (packets.size() < 2) {
+		return "Packet compression: not enough packets, record a match to get a replay to benchmark with\n";
+	}
+
+	const size_t half = packets.size() / 2;
+	const std::vector<std::string> trainingPackets(packets.begin(), packets.begin() + half);
+	const std::vector<std::string> testPackets(packets.begin() + half, packets.end());
+
+	auto start = std::chrono::high_resolution_clock::now();
+	const Netcode::PacketDictionary dictionary = Netcode::PacketDictionary::Train(trainingPackets);
+	const float trainingMs = UsSince(start) / 1000.f;
+
+	size_t uncompressedSize = 0;
+	for (const std::string& packet : testPackets) {
+		uncompressedSize += packet.size();
+	}
+
+	struct Codec {
+		const char* name;
+		Netcode::PacketCodecType type;
+		size_t threshold;
+	};
+	const Codec codecs[] = {
+		{ "gzip",                  Netcode::PacketCodecType::DEFLATE,       0 },
+		{ "gzip + threshold",      Netcode::PacketCodecType::DEFLATE,       Netcode::PacketCompressor::DEFAULT_THRESHOLD },
+		{ "lz + threshold",        Netcode::PacketCodecType::LZ,            Netcode::PacketCompressor::DEFAULT_THRESHOLD },
+		{ "lz + dict + threshold", Netcode::PacketCodecType::LZ_DICTIONARY, Netcode::PacketCompressor::DEFAULT_THRESHOLD },
+	};
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(2);
+	ss << "Packet compression, " << testPackets.size() << " packets of " << uncompressedSize / testPackets.size() << " bytes on average, "
+		<< "dictionary of " << dictionary.size() << " bytes trained on " << trainingPackets.size() << " packets in " << trainingMs << "ms\n";
+
+	std::string compressed;
+	std::vector<char> decompressed;
+	for (const Codec& codec : codecs) {
+		Netcode::PacketCompressor compressor(codec.type, codec.threshold, dictionary);
+
+		float compressUs = 0.f;
+		float decompressUs = 0.f;
+		size_t compressedSize = 0;
+		size_t numMismatches = 0;
+		for (const std::string& packet : testPackets) {
+			start = std::chrono::high_resolution_clock::now();
+			compressor.compress(packet.data(), packet.size(), compressed);
+			compressUs += UsSince(start);
+			compressedSize += compressed.size();
+
+			start = std::chrono::high_resolution_clock::now();
+			const bool succeeded = compressor.decompress(compressed.data(), compressed.size(), decompressed);
+			decompressUs += UsSince(start);
+
+			if (!succeeded || decompressed.size() != packet.size() || !std::equal(decompressed.begin(), decompressed.end(), packet.begin())) {
+				numMismatches++;
+			}
+		}
+
+		const float numPackets = static_cast<float>(testPackets.size());
+		ss << "  " << std::left << std::setw(22) << codec.name << std::right
+			<< " ratio " << static_cast<float>(uncompressedSize) / std::max(compressedSize, size_t{ 1 })
+			<< ", " << compressedSize / testPackets.size() << " bytes"
+			<< ", compress " << compressUs / numPackets << "us, decompress " << decompressUs / numPackets << "us per packet";
+		ss << (numMismatches ? ", " + std::to_string(numMismatches) + " packets differ" : "") << "\n";
+	}
+	return ss.str();
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Benchmarks {
+	/*
+		Compresses and decompresses uncompressed tick packets with every packet codec
+		The first half of the packets is used to train a dictionary which is then used on the second half
+		Returns the compression ratio, the average time per packet and the number of packets that didn't come back the same for each codec
+	*/
+	std::string RunPacketCompression(const std::vector<std::string>& packets);
+}
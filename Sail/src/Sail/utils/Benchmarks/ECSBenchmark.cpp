@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "ECSBenchmark.h"
+#include "Sail/entities/ECS.h"
+#include "Sail/entities/components/TransformComponent.h"
+#include "Sail/entities/components/MovementComponent.h"
+
+namespace {
+	constexpr float BENCHMARK_DT = 1.f / 64.f;
+
+	void TickMovement(TransformComponent& transform, MovementComponent& movement) {
+		movement.velocity += (movement.constantAcceleration + movement.accelerationToAdd) * BENCHMARK_DT;
+		movement.accelerationToAdd = glm::vec3(0.0f);
+		transform.translate(movement.velocity * BENCHMARK_DT);
+		movement.oldVelocity = movement.velocity;
+	}
+
+	void InitComponents(Entity* e, std::mt19937& gen) {
+		std::uniform_real_distribution<float> dist(-10.f, 10.f);
+		e->addComponent<TransformComponent>(glm::vec3(dist(gen), dist(gen), dist(gen)));
+		MovementComponent* movement = e->addComponent<MovementComponent>();
+		movement->velocity = glm::vec3(dist(gen), dist(gen), dist(gen));
+		movement->constantAcceleration = glm::vec3(0.f, -9.8f, 0.f);
+	}
+}
+
+std::string Benchmarks::RunECSStorage(unsigned int numEntities, unsigned int numTicks) {
+	ECS* ecs = ECS::Instance();
+	std::mt19937 gen(1337);
+
+	std::vector<Entity::SPtr> heapEntities;
+	std::vector<Entity::SPtr> packedEntities;
+	std::vector<Entity*> heapList;
+	// Other allocations happen between component creations in the game, keep some around to avoid an unrealistically tidy heap
+	std::vector<std::unique_ptr<char[]>> heapNoise;
+
+	heapEntities.reserve(numEntities);
+	packedEntities.reserve(numEntities);
+	heapList.reserve(numEntities);
+	heapNoise.reserve(numEntities);
+
+	for (unsigned int i = 0; i < numEntities; i++) {
+		heapEntities.push_back(ecs->createEntity("BenchmarkHeap"));
+		InitComponents(heapEntities.back().get(), gen);
+		heapList.push_back(heapEntities.back().get());
+		heapNoise.emplace_back(SAIL_NEW char[64 + (gen() % 256)]);
+
+		packedEntities.push_back(ecs->createPackedEntity<TransformComponent, MovementComponent>("BenchmarkPacked"));
+		InitComponents(packedEntities.back().get(), gen);
+	}
+	// Makes the packed entities visible to views, same as the EntityAdderSystem does each frame
+	ecs->addAllQueuedEntities();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		for (Entity* e : heapList) {
+			TickMovement(*e->getComponent<TransformComponent>(), *e->getComponent<MovementComponent>());
+		}
+	}
+	const float heapTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		ecs->view<TransformComponent, MovementComponent>().each([](Entity* e, TransformComponent& transform, MovementComponent& movement) {
+			TickMovement(transform, movement);
+		});
+	}
+	const float packedTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	for (auto& e : heapEntities) {
+		ecs->destroyEntity(e);
+	}
+	for (auto& e : packedEntities) {
+		ecs->destroyEntity(e);
+	}
+
+	const float ticks = static_cast<float>(std::max(numTicks, 1u));
+	return "ECS storage, " + std::to_string(numEntities) + " entities, " + std::to_string(numTicks) + " ticks: heap "
+		+ std::to_string(heapTime / ticks) + "ms/tick, packed " + std::to_string(packedTime / ticks) + "ms/tick ("
+		+ std::to_string(heapTime / std::max(packedTime, 0.0001f)) + "x)";
+}
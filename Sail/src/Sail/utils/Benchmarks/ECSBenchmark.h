@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+/*
+	Headless benchmarks which can be run from the console in development builds
+	None of them require a window or a renderer, only the systems/data structures they measure
+*/
+namespace Benchmarks {
+	/*
+		Ticks a movement update on numEntities heap stored entities and on numEntities packed entities (see Archetype.h)
+		The entities are destroyed before returning
+		Returns a summary of the average time per tick for both storage types
+	*/
+	std::string RunECSStorage(unsigned int numEntities, unsigned int numTicks);
+}
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "IntersectionBenchmark.h"
+#include "..//..//Physics/Octree.h"
+#include "..//..//Physics/Intersection.h"
+
+#include <iomanip>
+
+namespace {
+	constexpr float RAY_PADDING = 0.1f;
+	const glm::vec3 BOX_HALF_SIZE(0.35f, 0.9f, 0.35f);
+
+	struct Query {
+		glm::vec3 position;
+		glm::vec3 direction;
+	};
+
+	float MsSince(const std::chrono::high_resolution_clock::time_point& start) {
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+std::string Benchmarks::RunIntersection(const Octree* octree, unsigned int numQueries) {
+	std::vector<TrianglePacket> packets;
+	octree->getTrianglePackets(&packets);
+
+	// The scalar functions get their triangles as separate vectors, same as in the octree before the batched tests
+	std::vector<glm::vec3> positions;
+	for (const TrianglePacket& triangles : packets) {
+		for (unsigned int lane = 0; lane < triangles.count; lane++) {
+			positions.push_back(triangles.getVertex(lane, 0));
+			positions.push_back(triangles.getVertex(lane, 1));
+			positions.push_back(triangles.getVertex(lane, 2));
+		}
+	}
+	const size_t numTriangles = positions.size() / 3;
+	if (numTriangles == 0 || numQueries == 0) {
+		return "No triangles to test against, load a map first";
+	}
+
+	// Queries start close to the level geometry in random directions
+	std::mt19937 gen(1337);
+	std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+	std::uniform_int_distribution<size_t> vertex(0, positions.size() - 1);
+	std::vector<Query> queries(numQueries);
+	for (Query& query : queries) {
+		query.position = positions[vertex(gen)] + glm::vec3(offset(gen), offset(gen), offset(gen));
+		query.direction = glm::normalize(glm::vec3(offset(gen), offset(gen), offset(gen)) + glm::vec3(0.0001f));
+	}
+
+	// Scalar reference
+	std::vector<float> referenceDistances(numQueries * numTriangles);
+	std::vector<unsigned char> referenceHits(numQueries * numTriangles);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int q = 0; q < numQueries; q++) {
+		for (size_t t = 0; t < numTriangles; t++) {
+			referenceDistances[q * numTriangles + t] = Intersection::RayWithPaddedTriangle(queries[q].position, queries[q].direction, positions[t * 3], positions[t * 3 + 1], positions[t * 3 + 2], RAY_PADDING);
+		}
+	}
+	const float scalarRayMs = MsSince(start);
+	start = std::chrono::high_resolution_clock::now();
+	for (unsigned int q = 0; q < numQueries; q++) {
+		for (size_t t = 0; t < numTriangles; t++) {
+			referenceHits[q * numTriangles + t] = Intersection::AabbWithTriangle(queries[q].position, BOX_HALF_SIZE, positions[t * 3], positions[t * 3 + 1], positions[t * 3 + 2]);
+		}
+	}
+	const float scalarAabbMs = MsSince(start);
+
+	const float numTests = static_cast<float>(numQueries * numTriangles);
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(2);
+	ss << "Intersection tests, " << numTriangles << " triangles in " << packets.size() << " packets, " << numQueries << " queries\n";
+	ss << "  single triangle: ray " << scalarRayMs * 1000000.f / numTests << "ns, aabb " << scalarAabbMs * 1000000.f / numTests << "ns per triangle\n";
+
+	const Intersection::SimdLevel previousLevel = Intersection::GetSimdLevel();
+	for (int level = 0; level <= static_cast<int>(Intersection::GetMaxSimdLevel()); level++) {
+		Intersection::SetSimdLevel(static_cast<Intersection::SimdLevel>(level));
+
+		// Results are written per packet lane, lanes past the packet count are skipped when comparing
+		std::vector<float> distances(numQueries * packets.size() * TrianglePacket::WIDTH);
+		std::vector<unsigned int> hits(numQueries * packets.size());
+		start = std::chrono::high_resolution_clock::now();
+		for (unsigned int q = 0; q < numQueries; q++) {
+			for (size_t p = 0; p < packets.size(); p++) {
+				Intersection::RayWithPaddedTriangles(queries[q].position, queries[q].direction, packets[p], RAY_PADDING, &distances[(q * packets.size() + p) * TrianglePacket::WIDTH]);
+			}
+		}
+		const float batchRayMs = MsSince(start);
+		start = std::chrono::high_resolution_clock::now();
+		for (unsigned int q = 0; q < numQueries; q++) {
+			for (size_t p = 0; p < packets.size(); p++) {
+				hits[q * packets.size() + p] = Intersection::AabbWithTriangles(queries[q].position, BOX_HALF_SIZE, packets[p]);
+			}
+		}
+		const float batchAabbMs = MsSince(start);
+
+		size_t numMismatches = 0;
+		for (unsigned int q = 0; q < numQueries; q++) {
+			size_t t = q * numTriangles;
+			for (size_t p = 0; p < packets.size(); p++) {
+				for (unsigned int lane = 0; lane < packets[p].count; lane++, t++) {
+					const float distance = distances[(q * packets.size() + p) * TrianglePacket::WIDTH + lane];
+					const bool hit = (hits[q * packets.size() + p] >> lane) & 1u;
+					if ((distance != referenceDistances[t] && (distance >= 0.0f || referenceDistances[t] >= 0.0f)) || hit != (referenceHits[t] != 0)) {
+						numMismatches++;
+					}
+				}
+			}
+		}
+
+		ss << "  " << Intersection::GetSimdLevelName(static_cast<Intersection::SimdLevel>(level)) << " packets: ray "
+			<< batchRayMs * 1000000.f / numTests << "ns (" << scalarRayMs / std::max(batchRayMs, 0.0001f) << "x), aabb "
+			<< batchAabbMs * 1000000.f / numTests << "ns (" << scalarAabbMs / std::max(batchAabbMs, 0.0001f) << "x) per triangle, "
+			<< numMismatches << " mismatches\n";
+	}
+	Intersection::SetSimdLevel(previousLevel);
+
+	return ss.str();
+}
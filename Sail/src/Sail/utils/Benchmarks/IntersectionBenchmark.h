@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+class Octree;
+
+namespace Benchmarks {
+	/*
+		Tests numQueries rays and player sized boxes against every triangle in the octree, one triangle at a time
+		with Intersection::RayWithPaddedTriangle/AabbWithTriangle and one packet at a time with the batched tests
+		at every SIMD level the CPU supports
+		Returns a summary of the time per triangle test for each and the number of results that differ from the scalar functions
+	*/
+	std::string RunIntersection(const Octree* octree, unsigned int numQueries);
+}
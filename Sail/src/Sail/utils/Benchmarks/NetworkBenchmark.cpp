@@ -0,0 +1,517 @@
+#include "pch.h"
+#include "NetworkBenchmark.h"
+#include "Sail/netcode/ArchiveHelperFunctions.h"
+#include "Sail/netcode/InterestFilter.h"
+#include "Sail/netcode/NetworkedStructs.h"
+#include "Sail/netcode/PacketCompressor.h"
+#include "Sail/netcode/TransformSnapshot.h"
+#include "Sail/netcode/WaterCells.h"
+
+#include "cereal/archives/portable_binary.hpp"
+#include "gzip/compress.hpp"
+#include "gzip/decompress.hpp"
+
+#include <iomanip>
+
+namespace {
+	struct BenchmarkEntity {
+		Netcode::ComponentID id;
+		glm::vec3 position;
+		glm::quat rotation;
+		unsigned int animationIndex;
+		float animationTime;
+		float pitch;
+	};
+
+	// Same layout as NetworkSenderSystem::update, every entity sends its transform and animation
+	template<typename Archive>
+	void WritePacket(Archive& ar, const std::vector<BenchmarkEntity>& entities, const std::vector<glm::vec3>& waterPoints) {
+		ar(Netcode::PlayerID{ 1 });
+		ar(entities.size());
+		for (const BenchmarkEntity& e : entities) {
+			ar(e.id);
+			ar(Netcode::EntityType::PLAYER_ENTITY);
+			ar(size_t{ 2 });
+			ar(Netcode::MessageType::CHANGE_ABSOLUTE_POS_AND_ROT);
+			ArchiveHelpers::saveVec3(ar, e.position);
+			ArchiveHelpers::saveQuat(ar, e.rotation);
+			ar(Netcode::MessageType::ANIMATION);
+			ar(e.animationIndex);
+			ar(e.animationTime);
+			ar(e.pitch);
+		}
+
+		ar(size_t{ 1 });
+		ar(Netcode::MessageType::SUBMIT_WATER_POINTS);
+		ar(waterPoints.size());
+		for (const glm::vec3& point : waterPoints) {
+			ArchiveHelpers::saveVec3(ar, point);
+		}
+	}
+
+	// Same as ReceiverBase::processData for the packets above, returns a checksum so that nothing is optimized away
+	template<typename Archive>
+	float ReadPacket(Archive& ar) {
+		float checksum = 0.f;
+		Netcode::PlayerID sender;
+		size_t nrOfEntities;
+		ar(sender);
+		ar(nrOfEntities);
+		for (size_t i = 0; i < nrOfEntities; i++) {
+			Netcode::ComponentID id;
+			Netcode::EntityType type;
+			size_t nrOfMessages;
+			Netcode::MessageType messageType;
+			glm::vec3 position;
+			glm::quat rotation;
+			unsigned int animationIndex;
+			float animationTime, pitch;
+			ar(id);
+			ar(type);
+			ar(nrOfMessages);
+			ar(messageType);
+			ArchiveHelpers::loadVec3(ar, position);
+			ArchiveHelpers::loadQuat(ar, rotation);
+			ar(messageType);
+			ar(animationIndex);
+			ar(animationTime);
+			ar(pitch);
+			checksum += position.x + rotation.w + animationTime;
+		}
+
+		size_t nrOfEvents, nrOfPoints;
+		Netcode::MessageType eventType;
+		ar(nrOfEvents);
+		ar(eventType);
+		ar(nrOfPoints);
+		for (size_t i = 0; i < nrOfPoints; i++) {
+			glm::vec3 point;
+			ArchiveHelpers::loadVec3(ar, point);
+			checksum += point.y;
+		}
+		return checksum;
+	}
+
+	// Same packets as above with the transforms sent as TRANSFORM_SNAPSHOT and the water as cells, as NetworkSenderSystem::update sends them
+	void WriteSnapshotPacket(Netcode::OutArchive& ar, const std::vector<BenchmarkEntity>& entities, const Netcode::WaterCells& waterCells, Netcode::SnapshotEncoder& encoder) {
+		ar(Netcode::PlayerID{ 1 });
+		ar(entities.size());
+		for (const BenchmarkEntity& e : entities) {
+			ar(e.id);
+			ar(Netcode::EntityType::PLAYER_ENTITY);
+			ar(size_t{ 2 });
+			ar(Netcode::MessageType::TRANSFORM_SNAPSHOT);
+			Netcode::TransformSnapshot::Transform transform;
+			transform.position = e.position;
+			transform.rotation = e.rotation;
+			encoder.write(e.id, Netcode::TransformSnapshot::POSITION | Netcode::TransformSnapshot::QUAT_ROTATION, transform, ar);
+			ar(Netcode::MessageType::ANIMATION);
+			ar(e.animationIndex);
+			ar(e.animationTime);
+			ar(e.pitch);
+		}
+
+		ar(size_t{ 1 });
+		ar(Netcode::MessageType::SUBMIT_WATER_POINTS);
+		waterCells.write(ar);
+	}
+
+	// Reads the packets above and keeps track of the largest error in the decoded transforms
+	void ReadSnapshotPacket(Netcode::InArchive& ar, const std::vector<BenchmarkEntity>& entities, Netcode::SnapshotDecoder& decoder, Netcode::WaterCells& waterCells, float& maxPositionError, float& maxRotationError) {
+		Netcode::PlayerID sender;
+		size_t nrOfEntities;
+		ar(sender);
+		ar(nrOfEntities);
+		Netcode::SnapshotDecoder::Result snapshot;
+		for (size_t i = 0; i < nrOfEntities; i++) {
+			Netcode::ComponentID id;
+			Netcode::EntityType type;
+			size_t nrOfMessages;
+			Netcode::MessageType messageType;
+			unsigned int animationIndex;
+			float animationTime, pitch;
+			ar(id);
+			ar(type);
+			ar(nrOfMessages);
+			ar(messageType);
+			decoder.read(ar, snapshot);
+			ar(messageType);
+			ar(animationIndex);
+			ar(animationTime);
+			ar(pitch);
+
+			if (snapshot.hasPosition) {
+				maxPositionError = std::max(maxPositionError, glm::length(snapshot.transform.position - entities[i].position));
+			}
+			if (snapshot.hasQuat) {
+				const float dot = std::min(std::abs(glm::dot(snapshot.transform.rotation, entities[i].rotation)), 1.f);
+				maxRotationError = std::max(maxRotationError, glm::degrees(2.f * std::acos(dot)));
+			}
+		}
+
+		size_t nrOfEvents;
+		Netcode::MessageType eventType;
+		ar(nrOfEvents);
+		ar(eventType);
+		waterCells.read(ar);
+	}
+
+	// Per tick state as NetworkSenderSystem sends it over the unreliable channel: a player, its gun and its candle
+	void WriteStatePacket(Netcode::OutArchive& ar, Netcode::PlayerID sender, const BenchmarkEntity& player, Netcode::SnapshotEncoder& encoder) {
+		ar(sender);
+		ar(size_t{ 3 });
+		for (Netcode::ComponentID i = 1; i <= 3; i++) {
+			const Netcode::ComponentID id = Netcode::generateID(sender, i);
+			const bool isPlayer = (i == Netcode::PLAYER_VALUE);
+			ar(id);
+			ar(isPlayer ? Netcode::EntityType::PLAYER_ENTITY : (i == Netcode::GUN_VALUE ? Netcode::EntityType::GUN_ENTITY : Netcode::EntityType::CANDLE_ENTITY));
+			ar(size_t{ isPlayer ? 2u : 1u });
+			ar(Netcode::MessageType::TRANSFORM_SNAPSHOT);
+			Netcode::TransformSnapshot::Transform transform;
+			transform.position = player.position + glm::vec3(0.f, 0.f, 0.3f * (i - 1));
+			transform.rotation = player.rotation;
+			encoder.write(id, Netcode::TransformSnapshot::POSITION | Netcode::TransformSnapshot::QUAT_ROTATION, transform, ar);
+			if (isPlayer) {
+				ar(Netcode::MessageType::ANIMATION);
+				ar(player.animationIndex);
+				ar(player.animationTime);
+				ar(player.pitch);
+			}
+		}
+		ar(size_t{ 0 });
+	}
+
+	// Same as ReceiverBase::processData for the packets above, returns how many transforms could be applied
+	size_t ReadStatePacket(Netcode::InArchive& ar, Netcode::SnapshotDecoder& decoder) {
+		size_t applied = 0;
+		Netcode::PlayerID sender;
+		size_t nrOfEntities;
+		ar(sender);
+		ar(nrOfEntities);
+		Netcode::SnapshotDecoder::Result snapshot;
+		for (size_t i = 0; i < nrOfEntities; i++) {
+			Netcode::ComponentID id;
+			Netcode::EntityType type;
+			size_t nrOfMessages;
+			ar(id);
+			ar(type);
+			ar(nrOfMessages);
+			for (size_t j = 0; j < nrOfMessages; j++) {
+				Netcode::MessageType messageType;
+				ar(messageType);
+				if (messageType == Netcode::MessageType::TRANSFORM_SNAPSHOT) {
+					decoder.read(ar, snapshot);
+					applied += snapshot.hasPosition;
+				} else {
+					unsigned int animationIndex;
+					float animationTime, pitch;
+					ar(animationIndex);
+					ar(animationTime);
+					ar(pitch);
+				}
+			}
+		}
+		return applied;
+	}
+
+	float MsSince(const std::chrono::high_resolution_clock::time_point& start) {
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+std::string Benchmarks::RunNetworkSerialization(unsigned int numEntities, unsigned int numTicks) {
+	std::mt19937 gen(1337);
+	std::uniform_real_distribution<float> dist(-20.f, 20.f);
+
+	std::vector<BenchmarkEntity> entities(numEntities);
+	for (unsigned int i = 0; i < numEntities; i++) {
+		entities[i] = { i + 1, glm::vec3(dist(gen), dist(gen), dist(gen)), glm::quat(glm::vec3(0.f, dist(gen), 0.f)), i % 4, 0.f, 0.f };
+	}
+	std::vector<glm::vec3> waterPoints(8);
+
+	// Entities move a little every tick so that the packets differ like they do in a game
+	auto tickEntities = [&](unsigned int tick) {
+		for (BenchmarkEntity& e : entities) {
+			e.position += glm::vec3(0.05f, 0.f, 0.03f);
+			e.rotation = glm::quat(glm::vec3(0.f, e.id + tick * 0.02f, 0.f));
+			e.animationTime = tick / 64.f;
+			e.pitch = std::sin(e.animationTime);
+		}
+		for (glm::vec3& point : waterPoints) {
+			point = glm::vec3(dist(gen), dist(gen), dist(gen));
+		}
+	};
+
+	// Old path: stream backed cereal archives and a new gzip stream and strings for every packet
+	float streamWriteMs = 0.f;
+	float streamReadMs = 0.f;
+	float checksumStream = 0.f;
+	size_t uncompressedSize = 0;
+	size_t compressedSize = 0;
+	std::vector<std::string> streamPackets(numTicks);
+	std::vector<std::string> streamUncompressed(numTicks);
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		tickEntities(tick);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		std::ostringstream os(std::ios::binary);
+		{
+			cereal::PortableBinaryOutputArchive ar(os);
+			WritePacket(ar, entities, waterPoints);
+		}
+		std::string uncompressed = os.str();
+		streamPackets[tick] = gzip::compress(uncompressed.data(), uncompressed.size());
+		streamWriteMs += MsSince(start);
+
+		uncompressedSize += uncompressed.size();
+		compressedSize += streamPackets[tick].size();
+		streamUncompressed[tick] = std::move(uncompressed);
+
+		start = std::chrono::high_resolution_clock::now();
+		std::string decompressed = gzip::decompress(streamPackets[tick].data(), streamPackets[tick].size());
+		std::istringstream is(decompressed);
+		cereal::PortableBinaryInputArchive ar(is);
+		checksumStream += ReadPacket(ar);
+		streamReadMs += MsSince(start);
+	}
+
+	// New path: the same buffers are reused for every packet, as in NetworkSenderSystem and ReceiverBase
+	gen.seed(1337);
+	for (unsigned int i = 0; i < numEntities; i++) {
+		entities[i] = { i + 1, glm::vec3(dist(gen), dist(gen), dist(gen)), glm::quat(glm::vec3(0.f, dist(gen), 0.f)), i % 4, 0.f, 0.f };
+	}
+	std::vector<char> writeBuffer;
+	std::string compressed;
+	std::vector<char> decompressed;
+	// Deflate without a size threshold gives the same bytes as gzip::compress
+	Netcode::PacketCompressor compressor(Netcode::PacketCodecType::DEFLATE, 0);
+	float bufferWriteMs = 0.f;
+	float bufferReadMs = 0.f;
+	float checksumBuffer = 0.f;
+	size_t numMismatches = 0;
+	unsigned int numBufferGrowths = 0;
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		tickEntities(tick);
+		const size_t capacities[] = { writeBuffer.capacity(), compressed.capacity(), decompressed.capacity() };
+
+		auto start = std::chrono::high_resolution_clock::now();
+		Netcode::ByteOutArchive out(writeBuffer);
+		WritePacket(out, entities, waterPoints);
+		compressor.compress(out.data(), out.size(), compressed);
+		bufferWriteMs += MsSince(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		compressor.decompress(compressed.data(), compressed.size(), decompressed);
+		Netcode::ByteInArchive in(decompressed.data(), decompressed.size());
+		checksumBuffer += ReadPacket(in);
+		bufferReadMs += MsSince(start);
+
+		if (compressed != streamPackets[tick] || std::string(out.data(), out.size()) != streamUncompressed[tick]) {
+			numMismatches++;
+		}
+		// Only the first tick(s) should need to grow the buffers
+		if (tick > 0 && (capacities[0] != writeBuffer.capacity() || capacities[1] != compressed.capacity() || capacities[2] != decompressed.capacity())) {
+			numBufferGrowths++;
+		}
+	}
+
+	// Snapshots: only the fields that changed in the last few packets are sent
+	gen.seed(1337);
+	for (unsigned int i = 0; i < numEntities; i++) {
+		entities[i] = { i + 1, glm::vec3(dist(gen), dist(gen), dist(gen)), glm::quat(glm::vec3(0.f, dist(gen), 0.f)), i % 4, 0.f, 0.f };
+	}
+	Netcode::TransformSnapshot::Bounds bounds;
+	bounds.min = glm::vec3(-64.f, -10.f, -64.f);
+	bounds.max = glm::vec3(192.f, 30.f, 192.f);
+	Netcode::SnapshotEncoder encoder;
+	Netcode::SnapshotDecoder decoder;
+	encoder.setBounds(bounds);
+	decoder.setBounds(bounds);
+	// Covers the positions the water points are spread over, with the cell size of the game's water
+	Netcode::WaterCells::Grid waterGrid;
+	waterGrid.mapStart = glm::vec3(-20.f);
+	waterGrid.mapSize = glm::vec3(40.f);
+	waterGrid.size = glm::ivec3(50, 37, 200);
+	Netcode::WaterCells waterCells;
+	Netcode::WaterCells receivedWaterCells;
+	waterCells.setGrid(waterGrid);
+	float snapshotWriteMs = 0.f;
+	float snapshotReadMs = 0.f;
+	float maxPositionError = 0.f;
+	float maxRotationError = 0.f;
+	size_t snapshotSize = 0;
+	size_t snapshotCompressedSize = 0;
+	size_t numWaterCells = 0;
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		tickEntities(tick);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		waterCells.clear();
+		for (const glm::vec3& point : waterPoints) {
+			waterCells.add(point);
+		}
+		Netcode::ByteOutArchive out(writeBuffer);
+		WriteSnapshotPacket(out, entities, waterCells, encoder);
+		compressor.compress(out.data(), out.size(), compressed);
+		snapshotWriteMs += MsSince(start);
+
+		snapshotSize += out.size();
+		snapshotCompressedSize += compressed.size();
+
+		start = std::chrono::high_resolution_clock::now();
+		compressor.decompress(compressed.data(), compressed.size(), decompressed);
+		Netcode::ByteInArchive in(decompressed.data(), decompressed.size());
+		ReadSnapshotPacket(in, entities, decoder, receivedWaterCells, maxPositionError, maxRotationError);
+		numWaterCells += receivedWaterCells.getCells().size();
+		snapshotReadMs += MsSince(start);
+	}
+
+	const float ticks = static_cast<float>(std::max(numTicks, 1u));
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(4);
+	ss << "Network serialization, " << numEntities << " entities, " << numTicks << " packets of " << uncompressedSize / std::max(numTicks, 1u)
+		<< " bytes (" << compressedSize / std::max(numTicks, 1u) << " compressed)\n";
+	ss << "  cereal + gzip: write " << streamWriteMs / ticks << "ms, read " << streamReadMs / ticks << "ms per packet\n";
+	ss << "  byte archive:  write " << bufferWriteMs / ticks << "ms, read " << bufferReadMs / ticks << "ms per packet\n";
+	ss << "  " << numMismatches << " packets differ, buffers grew after the first packet " << numBufferGrowths << " times";
+	ss << (checksumStream == checksumBuffer ? "" : ", read values differ") << "\n";
+	ss << "  snapshots:     write " << snapshotWriteMs / ticks << "ms, read " << snapshotReadMs / ticks << "ms per packet, "
+		<< snapshotSize / std::max(numTicks, 1u) << " bytes (" << snapshotCompressedSize / std::max(numTicks, 1u) << " compressed)\n";
+	ss << "  snapshot error: position " << maxPositionError << "m, rotation " << maxRotationError << " degrees\n";
+	ss << "  water: " << waterPoints.size() << " points sent as " << numWaterCells / ticks << " cells per packet\n";
+	return ss.str();
+}
+
+std::string Benchmarks::RunInterestManagement(unsigned int numPlayers, unsigned int numTicks) {
+	numPlayers = std::max(numPlayers, 2u);
+	std::mt19937 gen(1337);
+	std::uniform_real_distribution<float> mapDist(0.f, 128.f);
+	std::uniform_real_distribution<float> stepDist(-0.2f, 0.2f);
+
+	// Player 0 is the host
+	std::vector<BenchmarkEntity> players(numPlayers);
+	for (unsigned int i = 0; i < numPlayers; i++) {
+		players[i] = { Netcode::getPlayerCompID(i), glm::vec3(mapDist(gen), 0.f, mapDist(gen)), glm::quat(1.f, 0.f, 0.f, 0.f), i % 4, 0.f, 0.f };
+	}
+	std::vector<Netcode::SnapshotEncoder> encoders(numPlayers);
+	Netcode::TransformSnapshot::Bounds bounds;
+	bounds.min = glm::vec3(-8.f, -10.f, -8.f);
+	bounds.max = glm::vec3(136.f, 30.f, 136.f);
+	for (Netcode::SnapshotEncoder& encoder : encoders) {
+		encoder.setBounds(bounds);
+	}
+
+	// Every player sends a packet each tick, the host's packets are forwarded along with the clients'
+	std::vector<std::vector<std::string>> packets(numTicks, std::vector<std::string>(numPlayers));
+	std::vector<std::vector<glm::vec3>> positions(numTicks, std::vector<glm::vec3>(numPlayers));
+	std::vector<char> writeBuffer;
+	Netcode::PacketCompressor compressor;
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		for (unsigned int i = 0; i < numPlayers; i++) {
+			BenchmarkEntity& p = players[i];
+			p.position = glm::clamp(p.position + glm::vec3(stepDist(gen), 0.f, stepDist(gen)), glm::vec3(0.f), glm::vec3(128.f));
+			p.rotation = glm::quat(glm::vec3(0.f, i + tick * 0.02f, 0.f));
+			p.animationTime = tick / 64.f;
+			p.pitch = std::sin(p.animationTime);
+			positions[tick][i] = p.position;
+
+			Netcode::OutArchive ar(writeBuffer);
+			WriteStatePacket(ar, static_cast<Netcode::PlayerID>(i), p, encoders[i]);
+			compressor.compress(ar.data(), ar.size(), packets[tick][i]);
+		}
+	}
+
+	// Builds the message the same way NWrapper does before it is handed to the network
+	std::string message;
+	auto send = [&](const std::string& data) {
+		message.clear();
+		message += static_cast<char>(1);
+		message += data;
+		return message.size();
+	};
+
+	// Forwarding everything: every packet goes to every client but the host
+	const unsigned int numClients = numPlayers - 1;
+	size_t plainBytes = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		for (const std::string& packet : packets[tick]) {
+			for (unsigned int c = 0; c < numClients; c++) {
+				plainBytes += send(packet);
+			}
+		}
+	}
+	const float plainMs = MsSince(start);
+
+	// Split per client, what client 1 receives is kept so that reading it can be timed
+	Netcode::InterestFilter filter;
+	std::vector<char> decompressed;
+	std::vector<std::vector<char>> filtered;
+	std::string compressed;
+	std::vector<std::vector<std::string>> receivedFiltered(numTicks);
+	size_t filteredBytes = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (unsigned int tick = 0; tick < numTicks; tick++) {
+		filter.clear();
+		for (unsigned int i = 0; i < numPlayers; i++) {
+			filter.setPlayer(static_cast<Netcode::PlayerID>(i), positions[tick][i], -1, -1);
+		}
+		for (unsigned int i = 1; i < numPlayers; i++) {
+			filter.addViewer(static_cast<Netcode::PlayerID>(i), -1);
+		}
+
+		for (const std::string& packet : packets[tick]) {
+			if (!compressor.decompress(packet.data(), packet.size(), decompressed) || !filter.filter(decompressed.data(), decompressed.size(), filtered)) {
+				return "Error: a packet couldn't be split";
+			}
+			for (size_t v = 0; v < filtered.size(); v++) {
+				if (filtered[v].empty()) {
+					continue;
+				}
+				compressor.compress(filtered[v].data(), filtered[v].size(), compressed);
+				filteredBytes += send(compressed);
+				if (v == 0) {
+					receivedFiltered[tick].push_back(compressed);
+				}
+			}
+		}
+	}
+	const float filteredMs = MsSince(start);
+
+	// Client 1 reading everything versus reading its own packets
+	auto readAll = [&](bool split, size_t& applied) {
+		Netcode::SnapshotDecoder decoder;
+		decoder.setBounds(bounds);
+		const auto readStart = std::chrono::high_resolution_clock::now();
+		for (unsigned int tick = 0; tick < numTicks; tick++) {
+			const std::vector<std::string>& received = split ? receivedFiltered[tick] : packets[tick];
+			for (size_t i = 0; i < received.size(); i++) {
+				// Clients ignore their own packets when everything is forwarded to them
+				if (!split && i == 1) {
+					continue;
+				}
+				const std::string& packet = received[i];
+				compressor.decompress(packet.data(), packet.size(), decompressed);
+				Netcode::InArchive ar(decompressed.data(), decompressed.size());
+				applied += ReadStatePacket(ar, decoder);
+			}
+		}
+		return MsSince(readStart);
+	};
+	size_t plainApplied = 0;
+	size_t filteredApplied = 0;
+	const float plainReadMs = readAll(false, plainApplied);
+	const float filteredReadMs = readAll(true, filteredApplied);
+
+	const Netcode::InterestFilter::Stats& stats = filter.getStats();
+	const float ticks = static_cast<float>(std::max(numTicks, 1u));
+	std::stringstream ss;
+	ss << "Interest management, " << numPlayers << " players, " << numTicks << " ticks, relevant within " << filter.getSettings().distance << "m\n";
+	ss << std::fixed << std::setprecision(4);
+	ss << "  forward everything: host " << plainMs / ticks << "ms per tick, " << plainBytes / std::max(numTicks, 1u) << " bytes per tick\n";
+	ss << "  split per client:   host " << filteredMs / ticks << "ms per tick, " << filteredBytes / std::max(numTicks, 1u) << " bytes per tick, "
+		<< 100.f * stats.entitiesOut / std::max<size_t>(stats.entitiesIn, 1) << "% of the entities kept\n";
+	ss << "  client 1 reading:   " << plainReadMs / ticks << "ms per tick for everything (" << plainApplied << " transforms), "
+		<< filteredReadMs / ticks << "ms per tick split (" << filteredApplied << " transforms)\n";
+	return ss.str();
+}
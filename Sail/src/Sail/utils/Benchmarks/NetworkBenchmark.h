@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+namespace Benchmarks {
+	/*
+		Serializes and compresses numTicks packets with the per tick messages of numEntities players, then decompresses and reads them back
+		Done both with the old cereal/stream/gzip::compress path and the ByteArchive/PacketCompressor path used by the network systems
+		Returns a summary of the average time per packet for both, the packet sizes and whether the bytes are identical
+		Also sends the same packets as TRANSFORM_SNAPSHOT messages and reports their size and the largest quantization error
+	*/
+	std::string RunNetworkSerialization(unsigned int numEntities, unsigned int numTicks);
+	/*
+		Forwards numTicks ticks of per tick state from numPlayers players walking around a 128x128m map, the way the host does it
+		Done both by forwarding every packet to every client and by splitting them per client with a Netcode::InterestFilter
+		Returns the host time and bytes sent per tick for both and the time it takes a client to read what it receives
+	*/
+	std::string RunInterestManagement(unsigned int numPlayers, unsigned int numTicks);
+}
@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "ReplayBenchmark.h"
+#include "Sail/entities/systems/SystemScheduler.h"
+#include "Sail/entities/systems/Gameplay/LevelSystem/LevelSystem.h"
+
+#include <iomanip>
+
+namespace {
+	// Nearest rank percentile of sorted samples
+	float Percentile(const std::vector<float>& sorted, float percentile) {
+		if (sorted.empty()) {
+			return 0.f;
+		}
+		const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.f * sorted.size()));
+		return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+	}
+
+	void WriteHeader(std::ostringstream& ss) {
+		ss << std::left << std::setw(34) << "" << std::right;
+		for (const char* column : { "p50", "p90", "p99", "max", "mean" }) {
+			ss << std::setw(10) << column;
+		}
+		ss << "\n";
+	}
+
+	void WritePercentiles(std::ostringstream& ss, const std::string& name, std::vector<float> ms) {
+		std::sort(ms.begin(), ms.end());
+		float sum = 0.f;
+		for (float sample : ms) {
+			sum += sample;
+		}
+
+		ss << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(4);
+		for (float percentile : { 50.f, 90.f, 99.f, 100.f }) {
+			ss << std::setw(10) << Percentile(ms, percentile);
+		}
+		ss << std::setw(10) << (ms.empty() ? 0.f : sum / ms.size()) << "\n";
+	}
+}
+
+void Benchmarks::ReplayBenchmark::start(const std::string& description, size_t numTicks) {
+	m_running = numTicks > 0;
+	m_description = description;
+	m_numTicks = numTicks;
+	m_tick = 0;
+
+	m_ticks.name = "Tick";
+	m_ticks.ms.clear();
+	m_ticks.ms.reserve(numTicks);
+	m_systems.clear();
+}
+
+void Benchmarks::ReplayBenchmark::stop() {
+	m_running = false;
+}
+
+bool Benchmarks::ReplayBenchmark::isRunning() const {
+	return m_running;
+}
+
+void Benchmarks::ReplayBenchmark::beginTick() {
+	m_tickStart = std::chrono::high_resolution_clock::now();
+}
+
+void Benchmarks::ReplayBenchmark::addSample(const std::string& name, float ms) {
+	if (m_running) {
+		getSamples(name).ms.push_back(ms);
+	}
+}
+
+bool Benchmarks::ReplayBenchmark::endTick(const SystemScheduler& scheduler) {
+	if (!m_running) {
+		return false;
+	}
+
+	for (const SystemScheduler::Timing& timing : scheduler.getTimings()) {
+		if (timing.ran) {
+			getSamples(timing.name).ms.push_back(timing.lastMs);
+		}
+	}
+	return endTick();
+}
+
+bool Benchmarks::ReplayBenchmark::endTick() {
+	if (!m_running) {
+		return false;
+	}
+
+	m_ticks.ms.push_back(std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_tickStart).count());
+
+	if (++m_tick < m_numTicks) {
+		return false;
+	}
+	m_running = false;
+	return true;
+}
+
+std::string Benchmarks::ReplayBenchmark::getReport() const {
+	std::ostringstream ss;
+	ss << "Replay benchmark, " << m_description << ", " << m_ticks.ms.size() << " ticks (ms)\n";
+	WriteHeader(ss);
+	WritePercentiles(ss, m_ticks.name, m_ticks.ms);
+	for (const Samples& system : m_systems) {
+		WritePercentiles(ss, system.name, system.ms);
+	}
+	return ss.str();
+}
+
+Benchmarks::ReplayBenchmark::Samples& Benchmarks::ReplayBenchmark::getSamples(const std::string& name) {
+	for (Samples& samples : m_systems) {
+		if (samples.name == name) {
+			return samples;
+		}
+	}
+	m_systems.push_back({ name, {} });
+	m_systems.back().ms.reserve(m_numTicks);
+	return m_systems.back();
+}
+
+std::string Benchmarks::RunLevelGeneration(int seed, int sizeX, int sizeY, unsigned int numRuns) {
+	std::vector<float> ms;
+	ms.reserve(numRuns);
+	int numRooms = 0;
+
+	for (unsigned int i = 0; i < numRuns; i++) {
+		// A new system every run, generateMap() expects a level that hasn't been generated yet
+		LevelSystem level;
+		level.seed = seed;
+		level.xsize = sizeX;
+		level.ysize = sizeY;
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		level.generateMap();
+		ms.push_back(std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+		numRooms = level.numberOfRooms;
+	}
+
+	std::ostringstream ss;
+	ss << "Level generation, seed " << seed << ", " << sizeX << "x" << sizeY << " tiles, " << numRooms << " rooms, " << numRuns << " runs (ms)\n";
+	WriteHeader(ss);
+	WritePercentiles(ss, "LevelSystem::generateMap", std::move(ms));
+	return ss.str();
+}
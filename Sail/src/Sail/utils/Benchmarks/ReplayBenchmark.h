@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class SystemScheduler;
+
+namespace Benchmarks {
+	/*
+		Times the ticks of a replay while it is played back in the game, see the "benchmark replay" console command
+		The recorded match feeds the same packets to the systems every run and rand() is seeded from the map seed and the first tick,
+		so runs over the same ticks of the same replay can be compared on the same machine and settings
+
+		The systems and the entities the replay creates need the window, renderer and resources of a running game. Frames are rendered
+		between the ticks, only the ticks are timed. The ReplayBenchmark tool uses the same class to time reading a replay headless
+
+		The systems updated directly by GameState are timed with time(), the ones run by the SystemScheduler are taken from its timings
+		The report has percentiles of every system's time and of the whole tick
+	*/
+	class ReplayBenchmark {
+	public:
+		// Starts collecting from the next tick, description is put at the top of the report
+		void start(const std::string& description, size_t numTicks);
+		void stop();
+		bool isRunning() const;
+
+		void beginTick();
+		// Runs update and adds its time to the samples of name if the benchmark is running
+		template<typename Fn>
+		void time(const char* name, Fn&& update);
+		void addSample(const std::string& name, float ms);
+		// Returns true once the last tick has been collected
+		bool endTick(const SystemScheduler& scheduler);
+		// Same as above when nothing is run by a SystemScheduler
+		bool endTick();
+
+		// Percentiles and mean in ms of every system and of the whole tick
+		std::string getReport() const;
+
+	private:
+		struct Samples {
+			std::string name;
+			std::vector<float> ms;
+		};
+
+		Samples& getSamples(const std::string& name);
+
+	private:
+		bool m_running = false;
+		std::string m_description;
+		size_t m_numTicks = 0;
+		size_t m_tick = 0;
+		std::chrono::high_resolution_clock::time_point m_tickStart;
+
+		Samples m_ticks;
+		std::vector<Samples> m_systems; // In the order they first ran
+	};
+
+	/*
+		Generates a level numRuns times with LevelSystem::generateMap(), the way it is done at the start of a match
+		Note that generateMap() reseeds rand() with the seed
+		Returns percentiles of the time it took
+	*/
+	std::string RunLevelGeneration(int seed, int sizeX, int sizeY, unsigned int numRuns);
+
+	template<typename Fn>
+	void ReplayBenchmark::time(const char* name, Fn&& update) {
+		if (!m_running) {
+			update();
+			return;
+		}
+		const auto start = std::chrono::high_resolution_clock::now();
+		update();
+		addSample(name, std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+}
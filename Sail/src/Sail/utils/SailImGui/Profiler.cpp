@@ -5,6 +5,10 @@
 
 #include "Network/NWrapperSingleton.h"
 #include "Sail/entities/systems/Gameplay/ai/AiSystem.h"
+#include "Sail/entities/systems/physics/CollisionSystem.h"
+#include "Sail/entities/systems/Graphics/AnimationSystem.h"
+#include "Sail/entities/systems/network/NetworkSenderSystem.h"
+#include "Sail/entities/components/RenderInActiveGameComponent.h"
 #include "Sail/TimeSettings.h"
 
 Profiler::Profiler(bool showWindow) 
@@ -170,6 +174,16 @@ void Profiler::renderWindow() {
 			if (ImGui::CollapsingHeader("Packet Size Graph")) {
 				header = "\n\n\n" + m_averageSentPacketSize + "(kiloB/s)";
 				ImGui::PlotLines(header.c_str(), m_history.averageSentPacketSizeHistory, 100, 0, "", 0.f, 2000.f, ImVec2(0, 100));
+
+				// How much of the packets above the transforms would have taken without TRANSFORM_SNAPSHOT
+				auto* senderSystem = ECS::Instance()->getSystem<NetworkSenderSystem>();
+				if (senderSystem && senderSystem->getSnapshotStats().snapshots) {
+					const Netcode::SnapshotEncoder::Stats& stats = senderSystem->getSnapshotStats();
+					ImGui::Text(("Transform snapshots sent: " + std::to_string(stats.snapshots)).c_str());
+					ImGui::Text(("Transform bytes per snapshot: " + std::to_string((float)stats.bytes / stats.snapshots)).c_str());
+					ImGui::Text(("Transform bytes as separate messages: " + std::to_string((float)stats.unquantizedBytes / stats.snapshots)).c_str());
+					ImGui::Text(("Transform bytes saved: " + std::to_string(100.f - 100.f * stats.bytes / std::max<size_t>(stats.unquantizedBytes, 1)) + "%").c_str());
+				}
 			}
 			if (ImGui::CollapsingHeader("Resource Manager")) {
 				if (ImGui::CollapsingHeader("Models Graph")) {
@@ -203,6 +217,48 @@ void Profiler::renderWindow() {
 			if (ImGui::CollapsingHeader("Ai System")) {
 				ImGui::Text(("Average path search time: " + std::to_string(ECS::Instance()->getSystem<AiSystem>()->getAveragePathSearchTime()/1000.f) + "ms").c_str());
 				ImGui::Text(("Average update time: " + std::to_string(ECS::Instance()->getSystem<AiSystem>()->getAverageAiUpdateTime()/1000.f) + "ms").c_str());
+				ImGui::Text(("Queued path requests: " + std::to_string(ECS::Instance()->getSystem<AiSystem>()->getNumQueuedPathRequests())).c_str());
+			}
+
+			auto* collisionSystem = ECS::Instance()->getSystem<CollisionSystem<RenderInActiveGameComponent>>();
+			if (collisionSystem && collisionSystem->getOctree() && ImGui::CollapsingHeader("Collision Queries")) {
+				const Octree::QueryStats& stats = collisionSystem->getOctree()->getLastQueryStats();
+				ImGui::Text(("Queries last tick: " + std::to_string(stats.queries)).c_str());
+				ImGui::Text(("Result allocations last tick: " + std::to_string(stats.resultAllocations)).c_str());
+				ImGui::Text(("Cached static entities: " + std::to_string(collisionSystem->getOctree()->getNumCachedEntities())).c_str());
+			}
+
+			auto* animationSystem = ECS::Instance()->getSystem<AnimationSystem<RenderInActiveGameComponent>>();
+			if (animationSystem && ImGui::CollapsingHeader("Animation")) {
+				const AnimationSystem<RenderInActiveGameComponent>::Stats& stats = animationSystem->getStats();
+				ImGui::Text(("Poses evaluated last frame: " + std::to_string(stats.poseEvaluations)).c_str());
+				ImGui::Text(("Poses shared from the cache: " + std::to_string(stats.cachedPoses)).c_str());
+				ImGui::Text(("Updates skipped by LOD: " + std::to_string(stats.skippedUpdates)).c_str());
+			}
+
+			if (ImGui::CollapsingHeader("Unreliable Channel")) {
+				const Network::UnreliableStats stats = NWrapperSingleton::getInstance().getUnreliableStats();
+				const size_t expected = stats.received + stats.lost;
+				ImGui::Text(("Datagrams received: " + std::to_string(stats.received)).c_str());
+				ImGui::Text(("Datagrams lost: " + std::to_string(stats.lost) + " (" + std::to_string(expected ? 100.f * stats.lost / expected : 0.f) + "%)").c_str());
+				ImGui::Text(("Datagrams dropped for arriving late: " + std::to_string(stats.late)).c_str());
+			}
+
+			auto* senderSystem = ECS::Instance()->getSystem<NetworkSenderSystem>();
+			if (senderSystem && NWrapperSingleton::getInstance().isHost() && ImGui::CollapsingHeader("Interest Management")) {
+				const NetworkSenderSystem::ForwardStats& forward = senderSystem->getForwardStats();
+				const Netcode::InterestFilter::Stats& filter = senderSystem->getInterestFilter().getStats();
+				const float ticks = static_cast<float>(std::max(forward.ticks, 1u));
+				ImGui::Text(senderSystem->isInterestManagementEnabled() ? "Forwarding: split per client" : "Forwarding: everything to everyone");
+				ImGui::Text(("Forwarding time: " + std::to_string(forward.milliseconds / ticks) + "ms per tick").c_str());
+				ImGui::Text(("Bytes forwarded: " + std::to_string(forward.bytesSent / ticks) + " per tick").c_str());
+				if (filter.entitiesIn) {
+					ImGui::Text(("Entities kept: " + std::to_string(100.f * filter.entitiesOut / filter.entitiesIn) + "%").c_str());
+					ImGui::Text(("Uncompressed bytes kept: " + std::to_string(100.f * filter.bytesOut / std::max<size_t>(filter.bytesIn, 1)) + "%").c_str());
+				}
+				if (ImGui::Button("Reset")) {
+					senderSystem->resetForwardStats();
+				}
 			}
 #endif
 
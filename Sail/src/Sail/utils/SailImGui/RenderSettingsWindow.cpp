@@ -38,7 +38,7 @@ void RenderSettingsWindow::renderWindow() {
 	if (m_octree && m_cam) {
 		if (ImGui::Button("Pick entity")) {
 			Octree::RayIntersectionInfo tempInfo;
-			m_octree->getRayIntersection(m_cam->getPosition(), m_cam->getDirection(), &tempInfo);
+			m_octree->getClosestRayIntersection(m_cam->getPosition(), m_cam->getDirection(), &tempInfo);
 			if (tempInfo.closestHitIndex != -1) {
 				pickedEntity = tempInfo.info[tempInfo.closestHitIndex].entity;
 			}
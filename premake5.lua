@@ -103,6 +103,146 @@ project "SPLASH"
 		}
 
 
+-----------------------------------
+--------  ReplayConverter ---------
+-----------------------------------
+-- Headless tool that converts old replays to the indexed format, see Sail/src/Sail/netcode/ReplayFile.h
+project "ReplayConverter"
+	location "ReplayConverter"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "on"
+
+	targetdir (binDir)
+	objdir (intermediatesDir)
+
+	files {
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs {
+		"libraries",
+		"Sail/src",
+		"%{IncludeDir.FBX_SDK}",
+		"%{IncludeDir.ImGui}",
+		"%{IncludeDir.Assimp}",
+		"Physics"
+	}
+
+	links {
+		"Sail",
+		"Physics"
+	}
+
+	defines { "NOMINMAX",
+			  "WIN32_LEAN_AND_MEAN" }
+
+	flags { "MultiProcessorCompile" }
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines { "DEBUG", "DEVELOPMENT" }
+		symbols "On"
+		buildCfg = "debug"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		optimize "On"
+
+	filter "configurations:PerformanceTest"
+		defines { "NDEBUG", "_PERFORMANCE_TEST", "DEVELOPMENT" }
+		optimize "On"
+
+	filter "configurations:Dev-Release"
+		defines { "NDEBUG", "DEVELOPMENT" }
+		optimize "On"
+
+	filter { "action:vs2017 or vs2019", "platforms:*64" }
+		postbuildcommands {
+			"{COPY} \"../libraries/FBX_SDK/lib/vs2017/x64/%{buildCfg}/libfbxsdk.dll\" \"%{cfg.targetdir}\"",
+			"{COPY} \"../libraries/assimp/lib/x64/assimp-vc140-mt.dll\" \"%{cfg.targetdir}\""
+		}
+	filter { "action:vs2017 or vs2019", "platforms:*86" }
+		postbuildcommands {
+			"{COPY} \"../libraries/FBX_SDK/lib/vs2017/x86/%{buildCfg}/libfbxsdk.dll\" \"%{cfg.targetdir}\"",
+			"{COPY} \"../libraries/assimp/lib/x86/assimp-vc140-mt.dll\" \"%{cfg.targetdir}\""
+		}
+
+
+-----------------------------------
+---------  ReplayBenchmark --------
+-----------------------------------
+-- Headless tool that times reading a replay, see ReplayBenchmark/src/Main.cpp
+project "ReplayBenchmark"
+	location "ReplayBenchmark"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "on"
+
+	targetdir (binDir)
+	objdir (intermediatesDir)
+
+	files {
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs {
+		"libraries",
+		"Sail/src",
+		"%{IncludeDir.FBX_SDK}",
+		"%{IncludeDir.ImGui}",
+		"%{IncludeDir.Assimp}",
+		"Physics"
+	}
+
+	links {
+		"Sail",
+		"Physics"
+	}
+
+	defines { "NOMINMAX",
+			  "WIN32_LEAN_AND_MEAN" }
+
+	flags { "MultiProcessorCompile" }
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines { "DEBUG", "DEVELOPMENT" }
+		symbols "On"
+		buildCfg = "debug"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		optimize "On"
+
+	filter "configurations:PerformanceTest"
+		defines { "NDEBUG", "_PERFORMANCE_TEST", "DEVELOPMENT" }
+		optimize "On"
+
+	filter "configurations:Dev-Release"
+		defines { "NDEBUG", "DEVELOPMENT" }
+		optimize "On"
+
+	filter { "action:vs2017 or vs2019", "platforms:*64" }
+		postbuildcommands {
+			"{COPY} \"../libraries/FBX_SDK/lib/vs2017/x64/%{buildCfg}/libfbxsdk.dll\" \"%{cfg.targetdir}\"",
+			"{COPY} \"../libraries/assimp/lib/x64/assimp-vc140-mt.dll\" \"%{cfg.targetdir}\""
+		}
+	filter { "action:vs2017 or vs2019", "platforms:*86" }
+		postbuildcommands {
+			"{COPY} \"../libraries/FBX_SDK/lib/vs2017/x86/%{buildCfg}/libfbxsdk.dll\" \"%{cfg.targetdir}\"",
+			"{COPY} \"../libraries/assimp/lib/x86/assimp-vc140-mt.dll\" \"%{cfg.targetdir}\""
+		}
+
+
 -----------------------------------
 --------------  Sail --------------
 -----------------------------------
@@ -238,6 +378,14 @@ project "Physics"
 	filter "system:windows"
 		systemversion "latest"
 
+	-- The AVX2 intersection kernels are only called after checking that the CPU supports them
+	filter "files:Physics/IntersectionAVX2.cpp"
+		flags { "NoPCH" }
+	filter { "files:Physics/IntersectionAVX2.cpp", "action:vs*" }
+		buildoptions { "/arch:AVX2" }
+	filter { "files:Physics/IntersectionAVX2.cpp", "action:not vs*" }
+		buildoptions { "-mavx2" }
+
 	filter "configurations:Debug"
 		defines { "DEBUG", "DEVELOPMENT" }
 		symbols "On"